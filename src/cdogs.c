@@ -75,6 +75,7 @@
 #include <cdogs/music.h>
 #include <cdogs/net_client.h>
 #include <cdogs/net_server.h>
+#include <cdogs/net_stats.h>
 #include <cdogs/objs.h>
 #include <cdogs/palette.h>
 #include <cdogs/particle.h>
@@ -82,6 +83,8 @@
 #include <cdogs/pickup.h>
 #include <cdogs/pics.h>
 #include <cdogs/player_template.h>
+#include <cdogs/profiler.h>
+#include <cdogs/replay.h>
 #include <cdogs/sounds.h>
 #include <cdogs/SDL_JoystickButtonNames/SDL_joystickbuttonnames.h>
 #include <cdogs/triggers.h>
@@ -91,8 +94,10 @@
 #include "briefing_screens.h"
 #include "command_line.h"
 #include "credits.h"
+#include "dedicated.h"
 #include "mainmenu.h"
 #include "prep.h"
+#include "replay_screen.h"
 
 #ifdef __EMSCRIPTEN__
 #include <emscripten.h>
@@ -105,6 +110,7 @@ int main(int argc, char *argv[])
 #endif
 	int err = 0;
 	const char *loadCampaign = NULL;
+	bool dedicated = false;
 	ENetAddress connectAddr;
 	memset(&connectAddr, 0, sizeof connectAddr);
 
@@ -158,13 +164,14 @@ int main(int argc, char *argv[])
 	char buf[CDOGS_PATH_MAX];
 	ProcessCommandLine(buf, argc, argv);
 	LOG(LM_MAIN, LL_INFO, "Command line (%d args):%s", argc, buf);
-	if (!ParseArgs(argc, argv, &connectAddr, &loadCampaign))
+	if (!ParseArgs(argc, argv, &connectAddr, &loadCampaign, &dedicated))
 	{
 		goto bail;
 	}
 
 #ifndef __EMSCRIPTEN__
-	const int sdlFlags =
+	const int sdlFlags = dedicated ?
+		SDL_INIT_TIMER | SDL_INIT_EVENTS :
 		SDL_INIT_TIMER | SDL_INIT_AUDIO | SDL_INIT_VIDEO | SDL_INIT_HAPTIC |
 		SDL_INIT_GAMECONTROLLER;
 #else
@@ -189,36 +196,50 @@ int main(int argc, char *argv[])
 	LOG(LM_MAIN, LL_INFO, "data dir(%s)", buf);
 	LOG(LM_MAIN, LL_INFO, "config dir(%s)", GetConfigFilePath(""));
 
-	SoundInitialize(&gSoundDevice, "sounds");
-	if (!gSoundDevice.isInitialised)
+	// Dedicated servers have no audio
+	if (!dedicated)
 	{
-		LOG(LM_MAIN, LL_ERROR, "Sound initialization failed!");
-	}
+		SoundInitialize(&gSoundDevice, "sounds");
+		if (!gSoundDevice.isInitialised)
+		{
+			LOG(LM_MAIN, LL_ERROR, "Sound initialization failed!");
+		}
 
-	LoadSongs();
+		LoadSongs();
 
-	MusicPlayMenu(&gSoundDevice);
+		MusicPlayMenu(&gSoundDevice);
+	}
 
 	EventInit(&gEventHandlers, NULL, NULL, true);
 	NetServerInit(&gNetServer);
 	PicManagerInit(&gPicManager);
 	TileClassesInit(&gTileClasses);
 	GraphicsInit(&gGraphicsDevice, &gConfig);
-	GraphicsInitialize(&gGraphicsDevice);
-	if (!gGraphicsDevice.IsInitialized)
+	if (dedicated)
+	{
+		GraphicsInitializeHeadless(&gGraphicsDevice);
+	}
+	else
+	{
+		GraphicsInitialize(&gGraphicsDevice);
+	}
+	if (!gGraphicsDevice.IsInitialized && !dedicated)
 	{
 		LOG(LM_MAIN, LL_WARN, "Cannot initialise video; trying default config");
 		ConfigResetDefault(ConfigGet(&gConfig, "Graphics"));
 		GraphicsInit(&gGraphicsDevice, &gConfig);
 		GraphicsInitialize(&gGraphicsDevice);
 	}
-	if (!gGraphicsDevice.IsInitialized)
+	if (!gGraphicsDevice.IsInitialized && !dedicated)
 	{
 		LOG(LM_MAIN, LL_ERROR, "Video didn't init!");
 		err = EXIT_FAILURE;
 		goto bail;
 	}
-	FontLoadFromJSON(&gFont, "graphics/font.png", "graphics/font.json");
+	if (!dedicated)
+	{
+		FontLoadFromJSON(&gFont, "graphics/font.png", "graphics/font.json");
+	}
 	PicManagerLoad(&gPicManager);
 	CharSpriteClassesInit(&gCharSpriteClasses);
 
@@ -240,7 +261,22 @@ int main(int argc, char *argv[])
 	PlayerDataInit(&gPlayerDatas);
 
 	LoopRunner l = LoopRunnerNew(NULL);
-	LoopRunnerPush(&l, MainMenu(&gGraphicsDevice, &l));
+	if (gReplay.Mode == REPLAY_PLAYBACK)
+	{
+		// Replays set up everything from the file; skip the menus
+		if (ReplayPlaybackLoad(&gReplay) && ReplayPlaybackStart(&gReplay))
+		{
+			LoopRunnerPush(&l, ScreenReplay());
+		}
+		else
+		{
+			err = EXIT_FAILURE;
+		}
+	}
+	else if (!dedicated)
+	{
+		LoopRunnerPush(&l, MainMenu(&gGraphicsDevice, &l));
+	}
 	// Attempt to pre-load campaign if requested
 	if (loadCampaign != NULL)
 	{
@@ -266,13 +302,29 @@ int main(int argc, char *argv[])
 			printf("Failed to connect\n");
 		}
 	}
+	if (dedicated && gReplay.Mode != REPLAY_PLAYBACK)
+	{
+		if (gCampaign.IsLoaded)
+		{
+			LoopRunnerPush(&l, ScreenDedicatedServer());
+		}
+		else
+		{
+			LOG(LM_MAIN, LL_ERROR, "Dedicated server needs a campaign to host");
+			err = EXIT_FAILURE;
+		}
+	}
 	LOG(LM_MAIN, LL_INFO, "Starting game");
 	LoopRunnerRun(&l);
 	LoopRunnerTerminate(&l);
 
 bail:
+	ReplayTerminate(&gReplay);
+	ProfilerTerminate(&gProfiler);
+	NetStatsTerminate(&gNetStats);
 	NetServerTerminate(&gNetServer);
 	MapTerminate(&gMap);
+	MemArenaTerminate(&gMissionArena);
 	PlayerDataTerminate(&gPlayerDatas);
 	MapObjectsTerminate(&gMapObjects);
 	PickupClassesTerminate(&gPickupClasses);
@@ -283,6 +335,7 @@ bail:
 	CharacterClassesTerminate(&gCharacterClasses);
 	MissionOptionsTerminate(&gMission);
 	NetClientTerminate(&gNetClient);
+	NetPacketPoolTerminate();
 	atexit(enet_deinitialize);
 	EventTerminate(&gEventHandlers);
 	GraphicsTerminate(&gGraphicsDevice);
@@ -77,6 +77,7 @@
 #include "triggers.h"
 #include "mission.h"
 #include "game.h"
+#include "net_client.h"
 #include "utils.h"
 
 #define FOOTSTEP_DISTANCE_PLUS 250
@@ -101,6 +102,8 @@ CArray gPlayerIds;
 
 CArray gActors;
 static unsigned int sActorUIDs = 0;
+// Set while replaying predicted movement, which must not send events
+static bool sIsReplaying = false;
 
 
 void ActorSetState(TActor *actor, const ActorAnimation state)
@@ -262,7 +265,8 @@ bool TryMoveActor(TActor *actor, struct vec2 pos)
 				actor->health > 0 &&
 				(!object || !ObjIsDangerous(object)))
 			{
-				if (CanHit(actor->flags, actor->uid, target))
+				if (!sIsReplaying &&
+					CanHit(actor->flags, actor->uid, target))
 				{
 					// Tell the server that we want to melee something
 					GameEvent e = GameEventNew(GAME_EVENT_ACTOR_MELEE);
@@ -327,7 +331,11 @@ bool TryMoveActor(TActor *actor, struct vec2 pos)
 	}
 
 	actor->Pos = pos;
-	OnMove(actor);
+	// Replayed moves are only applied once, at the final position
+	if (!sIsReplaying)
+	{
+		OnMove(actor);
+	}
 
 	actor->hasCollided = false;
 	return true;
@@ -432,8 +440,57 @@ void ActorMove(const NActorMove am)
 	if (a == NULL || !a->isInUse) return;
 	a->Pos = NetToVec2(am.Pos);
 	a->MoveVel = NetToVec2(am.MoveVel);
+	a->InputSeq = am.Seq;
+	a->InputTicks = 0;
 	OnMove(a);
 }
+
+static struct vec2 ReplayMove(
+	void *data, const struct vec2 from, const struct vec2 delta);
+void ActorSetServerPos(
+	TActor *a, const struct vec2 pos, const uint32_t seq, const int ticks)
+{
+	NetPredict *p = gCampaign.IsClient && a->PlayerUID >= 0 ?
+		NetClientGetPredict(&gNetClient, a->uid) : NULL;
+	if (p == NULL)
+	{
+		a->Pos = pos;
+		return;
+	}
+	// Our own actor: rewind to the server's position and replay the inputs
+	// that it hasn't processed yet. Replaying must not change the actor's
+	// state otherwise, e.g. collisions would send another move event
+	const bool hasCollided = a->hasCollided;
+	const bool canPickupSpecial = a->CanPickupSpecial;
+	sIsReplaying = true;
+	const struct vec2 oldPos = a->Pos;
+	a->Pos = NetPredictReconcile(p, seq, ticks, pos, oldPos, ReplayMove, a);
+	sIsReplaying = false;
+	a->hasCollided = hasCollided;
+	a->CanPickupSpecial = canPickupSpecial;
+	if (!svec2_is_nearly_equal(oldPos, a->Pos, EPSILON_POS))
+	{
+		OnMove(a);
+	}
+	if (p->LastCorrection > 0)
+	{
+		LOG(LM_NET, LL_DEBUG,
+			"actor(%d) corrected seq(%u) ticks(%d) by %f",
+			a->uid, seq, ticks, p->LastCorrection);
+	}
+}
+static struct vec2 ReplayMove(
+	void *data, const struct vec2 from, const struct vec2 delta)
+{
+	TActor *a = data;
+	a->Pos = from;
+	const struct vec2 to = svec2_add(from, delta);
+	if (!svec2_is_nearly_equal(from, to, EPSILON_POS))
+	{
+		TryMoveActor(a, to);
+	}
+	return a->Pos;
+}
 static void CheckTrigger(const struct vec2i tilePos, const bool showLocked);
 static void CheckRescue(const TActor *a);
 static void OnMove(TActor *a)
@@ -867,10 +924,12 @@ static bool ActorTryMove(TActor *actor, int cmd, int hasShot, int ticks)
 	// If we have changed our move commands, send the move event
 	if (cmd != actor->lastCmd || actor->hasCollided)
 	{
+		actor->InputSeq++;
 		GameEvent e = GameEventNew(GAME_EVENT_ACTOR_MOVE);
 		e.u.ActorMove.UID = actor->uid;
 		e.u.ActorMove.Pos = Vec2ToNet(actor->Pos);
 		e.u.ActorMove.MoveVel = Vec2ToNet(actor->MoveVel);
+		e.u.ActorMove.Seq = actor->InputSeq;
 		GameEventsEnqueue(&gGameEvents, e);
 	}
 
@@ -958,10 +1017,14 @@ void UpdateAllActors(int ticks)
 					e.u.ActorImpulse.UID = actor->uid;
 					e.u.ActorImpulse.Vel = Vec2ToNet(v);
 					e.u.ActorImpulse.Pos = Vec2ToNet(actor->Pos);
+					e.u.ActorImpulse.Seq = actor->InputSeq;
+					e.u.ActorImpulse.Ticks = actor->InputTicks;
 					GameEventsEnqueue(&gGameEvents, e);
 					e.u.ActorImpulse.UID = collidingActor->uid;
 					e.u.ActorImpulse.Vel = Vec2ToNet(svec2_scale(v, -1));
 					e.u.ActorImpulse.Pos = Vec2ToNet(collidingActor->Pos);
+					e.u.ActorImpulse.Seq = collidingActor->InputSeq;
+					e.u.ActorImpulse.Ticks = collidingActor->InputTicks;
 					GameEventsEnqueue(&gGameEvents, e);
 				}
 			}
@@ -1012,6 +1075,19 @@ static void ActorUpdatePosition(TActor *actor, int ticks)
 		}
 	}
 
+	// Remember the movement so it can be replayed after server corrections
+	actor->InputTicks += ticks;
+	if (gCampaign.IsClient && actor->PlayerUID >= 0)
+	{
+		NetPredict *p = NetClientGetPredict(&gNetClient, actor->uid);
+		if (p != NULL)
+		{
+			NetPredictRecord(
+				p, actor->InputSeq, ticks, actor->Pos,
+				svec2_subtract(newPos, actor->Pos));
+		}
+	}
+
 	if (!svec2_is_nearly_equal(actor->Pos, newPos, EPSILON_POS))
 	{
 		TryMoveActor(actor, newPos);
@@ -1191,9 +1267,9 @@ static void ActorAddBloodPool(const TActor *a)
 	GameEventsEnqueue(&gGameEvents, e);
 }
 
-void ActorsInit(void)
+void ActorsInit(MemArena *arena)
 {
-	CArrayInit(&gActors, sizeof(TActor));
+	CArrayInitArena(&gActors, sizeof(TActor), arena);
 	CArrayReserve(&gActors, 64);
 	sActorUIDs = 0;
 }
@@ -1244,7 +1320,7 @@ TActor *ActorAdd(NActorAdd aa)
 	actor->uid = aa.UID;
 	LOG(LM_ACTOR, LL_DEBUG,
 		"add actor uid(%d) playerUID(%d)", actor->uid, aa.PlayerUID);
-	CArrayInit(&actor->ammo, sizeof(int));
+	CArrayInitArena(&actor->ammo, sizeof(int), gActors.arena);
 	for (int i = 0; i < AmmoGetNumClasses(&gAmmo); i++)
 	{
 		// Initialise with twice the standard ammo amount
@@ -1333,6 +1409,11 @@ TActor *ActorAdd(NActorAdd aa)
 	GoreEmitterInit(&actor->blood2, "blood2");
 	GoreEmitterInit(&actor->blood3, "blood3");
 
+	if (gCampaign.IsClient && PlayerIsLocal(aa.PlayerUID))
+	{
+		NetClientAddPredict(&gNetClient, aa.UID);
+	}
+
 	TryMoveActor(actor, NetToVec2(aa.Pos));
 
 	// Spawn sound for player actors
@@ -54,6 +54,7 @@
 #include "game_mode.h"
 #include "grafx.h"
 #include "mathc/mathc.h"
+#include "mem_arena.h"
 #include "player.h"
 #include "thing.h"
 #include "weapon.h"
@@ -108,6 +109,11 @@ typedef struct Actor
 	// Whether the player ran into something whilst trying to move
 	// In this situation, we interrupt dead reckoning and resend the position
 	bool hasCollided;
+	// Sequence number of the last movement input sent (by the owner) or
+	// processed (by the server), and ticks simulated since, so that clients
+	// can reconcile their predicted movement
+	uint32_t InputSeq;
+	int InputTicks;
 	// Whether the last special command was performed with a direction
 	// This differentiates between a special command and weapon switch
 	bool specialCmdDir;
@@ -178,6 +184,11 @@ void ActorSetState(TActor *actor, const ActorAnimation state);
 void UpdateActorState(TActor * actor, int ticks);
 bool TryMoveActor(TActor *actor, struct vec2 pos);
 void ActorMove(const NActorMove am);
+// Apply a position from the server; for local actors on clients, this
+// reconciles the predicted position with the server's, which was ticks after
+// processing movement input seq
+void ActorSetServerPos(
+	TActor *a, const struct vec2 pos, const uint32_t seq, const int ticks);
 void CommandActor(TActor *actor, int cmd, int ticks);
 void SlideActor(TActor *actor, int cmd);
 void UpdateAllActors(int ticks);
@@ -190,7 +201,7 @@ bool ActorUsesAmmo(const TActor *actor, const int ammoId);
 void ActorReplaceGun(const NActorReplaceGun rg);
 void ActorSetAIState(TActor *actor, const AIState s);
 
-void ActorsInit(void);
+void ActorsInit(MemArena *arena);
 void ActorsTerminate(void);
 int ActorsGetNextUID(void);
 int ActorsGetFreeIndex(void);
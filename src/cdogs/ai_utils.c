@@ -292,16 +292,15 @@ static bool IsTileNoWalkAroundObjects(void *data, const struct vec2i pos)
 }
 static bool IsTileWalkableOrOpenable(Map *map, struct vec2i pos)
 {
-	const Tile *tile = MapGetTile(map, pos);
-	if (tile == NULL)
+	if (!MapIsTileIn(map, pos))
 	{
 		return false;
 	}
-	if (TileCanWalk(tile))
+	if (MapTileBit(map, MAP_BITS_WALK, pos))
 	{
 		return true;
 	}
-	if (tile->Class->Type == TILE_CLASS_DOOR)
+	if (MapTileBit(map, MAP_BITS_DOOR, pos))
 	{
 		// A door; check if we can open it
 		int keycard = MapGetDoorKeycardFlag(map, pos);
@@ -352,7 +351,10 @@ bool AIHasClearShot(const struct vec2 from, const struct vec2 to)
 }
 static bool IsPosNoSee(void *data, struct vec2i pos)
 {
-	return TileIsOpaque(MapGetTile(data, Vec2iToTile(pos)));
+	const Map *map = data;
+	const struct vec2i tilePos = Vec2iToTile(pos);
+	return !MapIsTileIn(map, tilePos) ||
+		MapTileBit(map, MAP_BITS_OPAQUE, tilePos);
 }
 
 TObject *AIGetObjectRunningInto(TActor *a, int cmd)
@@ -56,6 +56,7 @@
 
 #include <SDL.h>
 
+#include "blit_kernels.h"
 #include "config.h"
 #include "log.h"
 
@@ -76,50 +77,53 @@ color_t *CharColorGetByType(CharColors *c, const CharColorType t)
 }
 
 
+// Clip a pic, placed at pos, to the device clipping rectangle.
+// Returns false if nothing is visible, otherwise the visible portion's
+// top-left relative to the pic, and its size.
+static bool ClipRect(
+	const GraphicsDevice *g, const struct vec2i pos, const struct vec2i size,
+	struct vec2i *start, struct vec2i *clipped)
+{
+	start->x = MAX(0, g->clipping.left - pos.x);
+	start->y = MAX(0, g->clipping.top - pos.y);
+	clipped->x = MIN(size.x, g->clipping.right - pos.x + 1) - start->x;
+	clipped->y = MIN(size.y, g->clipping.bottom - pos.y + 1) - start->y;
+	return clipped->x > 0 && clipped->y > 0;
+}
+
 void BlitPicHighlight(
 	GraphicsDevice *g, const Pic *pic, const struct vec2i pos, const color_t color)
 {
 	// Draw highlight around the picture
-	int i;
-	for (i = -1; i < pic->size.y + 1; i++)
+	// The highlight extends one pixel beyond the pic on each side
+	const struct vec2i origin =
+		svec2i_subtract(svec2i_add(pos, pic->offset), svec2i_one());
+	struct vec2i start, clipped;
+	if (!ClipRect(
+		g, origin, svec2i_add(pic->size, svec2i(2, 2)), &start, &clipped))
 	{
-		int j;
-		int yoff = i + pos.y + pic->offset.y;
-		if (yoff > g->clipping.bottom)
-		{
-			break;
-		}
-		if (yoff < g->clipping.top)
-		{
-			continue;
-		}
-		yoff *= g->cachedConfig.Res.x;
-		for (j = -1; j < pic->size.x + 1; j++)
+		return;
+	}
+	const Uint32 pixel = COLOR2PIXEL(color);
+	const Uint32 amask = g->Format->Amask;
+	const int ashift = g->Format->Ashift;
+	for (int i = start.y - 1; i < start.y + clipped.y - 1; i++)
+	{
+		Uint32 *target = g->buf +
+			(origin.y + i + 1) * g->cachedConfig.Res.x + origin.x + start.x;
+		for (int j = start.x - 1; j < start.x + clipped.x - 1; j++, target++)
 		{
-			int xoff = j + pos.x + pic->offset.x;
-			if (xoff < g->clipping.left)
-			{
-				continue;
-			}
-			if (xoff > g->clipping.right)
-			{
-				break;
-			}
 			// Draw highlight if current pixel is empty,
 			// and is next to a picture edge
-			bool isTopOrBottomEdge = i == -1 || i == pic->size.y;
-			bool isLeftOrRightEdge = j == -1 || j == pic->size.x;
-			bool isPixelEmpty =
+			const bool isTopOrBottomEdge = i == -1 || i == pic->size.y;
+			const bool isLeftOrRightEdge = j == -1 || j == pic->size.x;
+			const bool isPixelEmpty =
 				isTopOrBottomEdge || isLeftOrRightEdge ||
-				!PIXEL2COLOR(*(pic->Data + j + i * pic->size.x)).a;
+				!(pic->Data[j + i * pic->size.x] & amask);
 			if (isPixelEmpty &&
 				PicPxIsEdge(pic, svec2i(j, i), !isPixelEmpty))
 			{
-				Uint32 *target = g->buf + yoff + xoff;
-				const color_t targetColor = PIXEL2COLOR(*target);
-				const color_t blendedColor = ColorAlphaBlend(
-					targetColor, color);
-				*target = COLOR2PIXEL(blendedColor);
+				gBlitKernels->Blend(target, 1, pixel, amask, ashift);
 			}
 		}
 	}
@@ -127,44 +131,22 @@ void BlitPicHighlight(
 
 void Blit(GraphicsDevice *device, const Pic *pic, struct vec2i pos)
 {
-	Uint32 *current = pic->Data;
 	pos = svec2i_add(pos, pic->offset);
-	for (int i = 0; i < pic->size.y; i++)
+	struct vec2i start, clipped;
+	if (!ClipRect(device, pos, pic->size, &start, &clipped))
 	{
-		int yoff = i + pos.y;
-		if (yoff > device->clipping.bottom)
-		{
-			break;
-		}
-		if (yoff < device->clipping.top)
-		{
-			current += pic->size.x;
-			continue;
-		}
-		yoff *= device->cachedConfig.Res.x;
-		for (int j = 0; j < pic->size.x; j++)
-		{
-			Uint32 *target;
-			int xoff = j + pos.x;
-			if (xoff < device->clipping.left)
-			{
-				current++;
-				continue;
-			}
-			if (xoff > device->clipping.right)
-			{
-				current += pic->size.x - j;
-				break;
-			}
-			if ((*current & device->Format->Amask) == 0)
-			{
-				current++;
-				continue;
-			}
-			target = device->buf + yoff + xoff;
-			*target = *current;
-			current++;
-		}
+		return;
+	}
+	const Uint32 *current = pic->Data + start.y * pic->size.x + start.x;
+	Uint32 *target = device->buf +
+		(pos.y + start.y) * device->cachedConfig.Res.x + pos.x + start.x;
+	for (int i = 0; i < clipped.y; i++)
+	{
+		gBlitKernels->Copy(
+			target, current, clipped.x,
+			device->Format->Amask, device->Format->Ashift);
+		current += pic->size.x;
+		target += device->cachedConfig.Res.x;
 	}
 }
 
@@ -183,53 +165,30 @@ void BlitMasked(
 	color_t mask,
 	int isTransparent)
 {
-	Uint32 *current = pic->Data;
-	if (current == NULL)
+	if (pic->Data == NULL)
 	{
 		CASSERT(false, "unexpected NULL pic data");
 		return;
 	}
 	const Uint32 maskPixel = COLOR2PIXEL(mask);
-	int i;
 	pos = svec2i_add(pos, pic->offset);
-	for (i = 0; i < pic->size.y; i++)
+	struct vec2i start, clipped;
+	if (!ClipRect(device, pos, pic->size, &start, &clipped))
 	{
-		int yoff = i + pos.y;
-		if (yoff > device->clipping.bottom)
-		{
-			break;
-		}
-		if (yoff < device->clipping.top)
-		{
-			current += pic->size.x;
-			continue;
-		}
-		yoff *= device->cachedConfig.Res.x;
-		for (int j = 0; j < pic->size.x; j++)
-		{
-			Uint32 *target;
-			int xoff = j + pos.x;
-			if (xoff < device->clipping.left)
-			{
-				current++;
-				continue;
-			}
-			if (xoff > device->clipping.right)
-			{
-				current += pic->size.x - j;
-				break;
-			}
-			if (isTransparent &&
-				((*current & device->Format->Amask) >> device->Format->Ashift) < 3)
-			{
-				current++;
-				continue;
-			}
-			target = device->buf + yoff + xoff;
-			*target = PixelMult(*current, maskPixel);
-			*target |= device->Format->Amask;
-			current++;
-		}
+		return;
+	}
+	const Uint32 *current = pic->Data + start.y * pic->size.x + start.x;
+	Uint32 *target = device->buf +
+		(pos.y + start.y) * device->cachedConfig.Res.x + pos.x + start.x;
+	// Skip nearly-transparent pixels if transparent
+	const int alphaMin = isTransparent ? 3 : 0;
+	for (int i = 0; i < clipped.y; i++)
+	{
+		gBlitKernels->MaskedMult(
+			target, current, clipped.x, maskPixel,
+			device->Format->Amask, device->Format->Ashift, alphaMin);
+		current += pic->size.x;
+		target += device->cachedConfig.Res.x;
 	}
 }
 CharColors CharColorsFromOneColor(const color_t color)
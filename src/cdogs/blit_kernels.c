@@ -0,0 +1,418 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+
+    Copyright (c) 2018 Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "blit_kernels.h"
+
+#include <SDL_cpuinfo.h>
+#include <SDL_version.h>
+
+#include "log.h"
+#include "utils.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || \
+	(defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BLIT_SSE2
+#include <emmintrin.h>
+// AVX2 kernels are compiled with per-function target attributes and only
+// used if the CPU supports them
+#if defined(__clang__) || \
+	(defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+#define BLIT_AVX2
+#define BLIT_AVX2_FUNC __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && _MSC_VER >= 1800
+#define BLIT_AVX2
+#define BLIT_AVX2_FUNC
+#endif
+#ifdef BLIT_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define BLIT_NEON
+#include <arm_neon.h>
+#endif
+
+
+const char *BlitKernelsTypeStr(const BlitKernelsType t)
+{
+	switch (t)
+	{
+		T2S(BLIT_KERNELS_SCALAR, "scalar");
+		T2S(BLIT_KERNELS_SSE2, "SSE2");
+		T2S(BLIT_KERNELS_AVX2, "AVX2");
+		T2S(BLIT_KERNELS_NEON, "NEON");
+	default:
+		return "";
+	}
+}
+
+
+// Scalar kernels; also used for the tails of the vector kernels
+
+// Exact per-channel x * y / 255, same as PixelMult
+static Uint32 MultScalar(const Uint32 p, const Uint32 m)
+{
+	return
+		((p & 0xFF) * (m & 0xFF) / 0xFF) |
+		((((p & 0xFF00) >> 8) * ((m & 0xFF00) >> 8) / 0xFF) << 8) |
+		((((p & 0xFF0000) >> 16) * ((m & 0xFF0000) >> 16) / 0xFF) << 16) |
+		((((p & 0xFF000000) >> 24) * ((m & 0xFF000000) >> 24) / 0xFF) << 24);
+}
+static void CopyScalar(
+	Uint32 *dst, const Uint32 *src, const int n,
+	const Uint32 amask, const int ashift)
+{
+	UNUSED(ashift);
+	for (int i = 0; i < n; i++)
+	{
+		if (src[i] & amask)
+		{
+			dst[i] = src[i];
+		}
+	}
+}
+static void MaskedMultScalar(
+	Uint32 *dst, const Uint32 *src, const int n, const Uint32 mask,
+	const Uint32 amask, const int ashift, const int alphaMin)
+{
+	for (int i = 0; i < n; i++)
+	{
+		if ((int)((src[i] & amask) >> ashift) < alphaMin)
+		{
+			continue;
+		}
+		dst[i] = MultScalar(src[i], mask) | amask;
+	}
+}
+static void BlendScalar(
+	Uint32 *dst, const int n, const Uint32 c,
+	const Uint32 amask, const int ashift)
+{
+	const Uint32 a = (c & amask) >> ashift;
+	for (int i = 0; i < n; i++)
+	{
+		Uint32 out = 0;
+		for (int shift = 0; shift < 32; shift += 8)
+		{
+			const Uint32 d8 = (dst[i] >> shift) & 0xFF;
+			const Uint32 c8 = (c >> shift) & 0xFF;
+			out |= ((d8 * (255 - a) + c8 * a) / 255) << shift;
+		}
+		dst[i] = out | amask;
+	}
+}
+static const BlitKernels sKernelsScalar =
+{
+	CopyScalar, MaskedMultScalar, BlendScalar
+};
+
+
+// The vector kernels widen channels to 16 bits and divide by 255 with
+// (x + 1 + ((x + 1) >> 8)) >> 8, which is exact for x <= 255 * 255
+
+#ifdef BLIT_SSE2
+static __m128i Div255SSE2(__m128i x)
+{
+	x = _mm_add_epi16(x, _mm_set1_epi16(1));
+	return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+// Select a where mask is set, otherwise b
+static __m128i SelectSSE2(const __m128i mask, const __m128i a, const __m128i b)
+{
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+static void CopySSE2(
+	Uint32 *dst, const Uint32 *src, const int n,
+	const Uint32 amask, const int ashift)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i am = _mm_set1_epi32((int)amask);
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		const __m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+		const __m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+		const __m128i empty = _mm_cmpeq_epi32(_mm_and_si128(s, am), zero);
+		_mm_storeu_si128((__m128i *)(dst + i), SelectSSE2(empty, d, s));
+	}
+	CopyScalar(dst + i, src + i, n - i, amask, ashift);
+}
+static void MaskedMultSSE2(
+	Uint32 *dst, const Uint32 *src, const int n, const Uint32 mask,
+	const Uint32 amask, const int ashift, const int alphaMin)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i am = _mm_set1_epi32((int)amask);
+	const __m128i m = _mm_unpacklo_epi8(_mm_set1_epi32((int)mask), zero);
+	const __m128i aMin = _mm_set1_epi32(alphaMin - 1);
+	const __m128i aShift = _mm_cvtsi32_si128(ashift);
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		const __m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+		const __m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+		const __m128i lo =
+			Div255SSE2(_mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), m));
+		const __m128i hi =
+			Div255SSE2(_mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), m));
+		const __m128i r = _mm_or_si128(_mm_packus_epi16(lo, hi), am);
+		const __m128i keep = _mm_cmpgt_epi32(
+			_mm_srl_epi32(_mm_and_si128(s, am), aShift), aMin);
+		_mm_storeu_si128((__m128i *)(dst + i), SelectSSE2(keep, r, d));
+	}
+	MaskedMultScalar(
+		dst + i, src + i, n - i, mask, amask, ashift, alphaMin);
+}
+static void BlendSSE2(
+	Uint32 *dst, const int n, const Uint32 c,
+	const Uint32 amask, const int ashift)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i am = _mm_set1_epi32((int)amask);
+	const short a = (short)((c & amask) >> ashift);
+	const __m128i ca = _mm_mullo_epi16(
+		_mm_unpacklo_epi8(_mm_set1_epi32((int)c), zero), _mm_set1_epi16(a));
+	const __m128i inv = _mm_set1_epi16((short)(255 - a));
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		const __m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+		const __m128i lo = Div255SSE2(_mm_add_epi16(
+			_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), inv), ca));
+		const __m128i hi = Div255SSE2(_mm_add_epi16(
+			_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), inv), ca));
+		_mm_storeu_si128(
+			(__m128i *)(dst + i), _mm_or_si128(_mm_packus_epi16(lo, hi), am));
+	}
+	BlendScalar(dst + i, n - i, c, amask, ashift);
+}
+static const BlitKernels sKernelsSSE2 =
+{
+	CopySSE2, MaskedMultSSE2, BlendSSE2
+};
+#endif
+
+#ifdef BLIT_AVX2
+BLIT_AVX2_FUNC static __m256i Div255AVX2(__m256i x)
+{
+	x = _mm256_add_epi16(x, _mm256_set1_epi16(1));
+	return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+BLIT_AVX2_FUNC static void CopyAVX2(
+	Uint32 *dst, const Uint32 *src, const int n,
+	const Uint32 amask, const int ashift)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i am = _mm256_set1_epi32((int)amask);
+	int i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		const __m256i s = _mm256_loadu_si256((const __m256i *)(src + i));
+		const __m256i d = _mm256_loadu_si256((const __m256i *)(dst + i));
+		const __m256i empty =
+			_mm256_cmpeq_epi32(_mm256_and_si256(s, am), zero);
+		_mm256_storeu_si256(
+			(__m256i *)(dst + i), _mm256_blendv_epi8(s, d, empty));
+	}
+	CopyScalar(dst + i, src + i, n - i, amask, ashift);
+}
+BLIT_AVX2_FUNC static void MaskedMultAVX2(
+	Uint32 *dst, const Uint32 *src, const int n, const Uint32 mask,
+	const Uint32 amask, const int ashift, const int alphaMin)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i am = _mm256_set1_epi32((int)amask);
+	const __m256i m = _mm256_unpacklo_epi8(_mm256_set1_epi32((int)mask), zero);
+	const __m256i aMin = _mm256_set1_epi32(alphaMin - 1);
+	const __m128i aShift = _mm_cvtsi32_si128(ashift);
+	int i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		const __m256i s = _mm256_loadu_si256((const __m256i *)(src + i));
+		const __m256i d = _mm256_loadu_si256((const __m256i *)(dst + i));
+		// Unpack and pack both work within 128-bit lanes, so they cancel out
+		const __m256i lo = Div255AVX2(
+			_mm256_mullo_epi16(_mm256_unpacklo_epi8(s, zero), m));
+		const __m256i hi = Div255AVX2(
+			_mm256_mullo_epi16(_mm256_unpackhi_epi8(s, zero), m));
+		const __m256i r = _mm256_or_si256(_mm256_packus_epi16(lo, hi), am);
+		const __m256i keep = _mm256_cmpgt_epi32(
+			_mm256_srl_epi32(_mm256_and_si256(s, am), aShift), aMin);
+		_mm256_storeu_si256(
+			(__m256i *)(dst + i), _mm256_blendv_epi8(d, r, keep));
+	}
+	MaskedMultScalar(
+		dst + i, src + i, n - i, mask, amask, ashift, alphaMin);
+}
+BLIT_AVX2_FUNC static void BlendAVX2(
+	Uint32 *dst, const int n, const Uint32 c,
+	const Uint32 amask, const int ashift)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i am = _mm256_set1_epi32((int)amask);
+	const short a = (short)((c & amask) >> ashift);
+	const __m256i ca = _mm256_mullo_epi16(
+		_mm256_unpacklo_epi8(_mm256_set1_epi32((int)c), zero),
+		_mm256_set1_epi16(a));
+	const __m256i inv = _mm256_set1_epi16((short)(255 - a));
+	int i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		const __m256i d = _mm256_loadu_si256((const __m256i *)(dst + i));
+		const __m256i lo = Div255AVX2(_mm256_add_epi16(
+			_mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), inv), ca));
+		const __m256i hi = Div255AVX2(_mm256_add_epi16(
+			_mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), inv), ca));
+		_mm256_storeu_si256(
+			(__m256i *)(dst + i),
+			_mm256_or_si256(_mm256_packus_epi16(lo, hi), am));
+	}
+	BlendScalar(dst + i, n - i, c, amask, ashift);
+}
+static const BlitKernels sKernelsAVX2 =
+{
+	CopyAVX2, MaskedMultAVX2, BlendAVX2
+};
+#endif
+
+#ifdef BLIT_NEON
+static uint16x8_t Div255NEON(uint16x8_t x)
+{
+	x = vaddq_u16(x, vdupq_n_u16(1));
+	return vshrq_n_u16(vaddq_u16(x, vshrq_n_u16(x, 8)), 8);
+}
+static void CopyNEON(
+	Uint32 *dst, const Uint32 *src, const int n,
+	const Uint32 amask, const int ashift)
+{
+	const uint32x4_t am = vdupq_n_u32(amask);
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		const uint32x4_t s = vld1q_u32(src + i);
+		const uint32x4_t d = vld1q_u32(dst + i);
+		vst1q_u32(dst + i, vbslq_u32(vtstq_u32(s, am), s, d));
+	}
+	CopyScalar(dst + i, src + i, n - i, amask, ashift);
+}
+static void MaskedMultNEON(
+	Uint32 *dst, const Uint32 *src, const int n, const Uint32 mask,
+	const Uint32 amask, const int ashift, const int alphaMin)
+{
+	const uint32x4_t am = vdupq_n_u32(amask);
+	const uint8x8_t m = vreinterpret_u8_u32(vdup_n_u32(mask));
+	const uint32x4_t aMin = vdupq_n_u32((uint32_t)alphaMin);
+	const int32x4_t aShift = vdupq_n_s32(-ashift);
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		const uint32x4_t s = vld1q_u32(src + i);
+		const uint32x4_t d = vld1q_u32(dst + i);
+		const uint8x16_t s8 = vreinterpretq_u8_u32(s);
+		const uint16x8_t lo = Div255NEON(vmull_u8(vget_low_u8(s8), m));
+		const uint16x8_t hi = Div255NEON(vmull_u8(vget_high_u8(s8), m));
+		const uint32x4_t r = vorrq_u32(
+			vreinterpretq_u32_u8(vcombine_u8(vmovn_u16(lo), vmovn_u16(hi))),
+			am);
+		const uint32x4_t keep =
+			vcgeq_u32(vshlq_u32(vandq_u32(s, am), aShift), aMin);
+		vst1q_u32(dst + i, vbslq_u32(keep, r, d));
+	}
+	MaskedMultScalar(
+		dst + i, src + i, n - i, mask, amask, ashift, alphaMin);
+}
+static void BlendNEON(
+	Uint32 *dst, const int n, const Uint32 c,
+	const Uint32 amask, const int ashift)
+{
+	const uint32x4_t am = vdupq_n_u32(amask);
+	const uint8_t a = (uint8_t)((c & amask) >> ashift);
+	const uint16x8_t ca =
+		vmull_u8(vreinterpret_u8_u32(vdup_n_u32(c)), vdup_n_u8(a));
+	const uint8x8_t inv = vdup_n_u8((uint8_t)(255 - a));
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		const uint8x16_t d8 = vreinterpretq_u8_u32(vld1q_u32(dst + i));
+		const uint16x8_t lo = Div255NEON(vmlal_u8(ca, vget_low_u8(d8), inv));
+		const uint16x8_t hi = Div255NEON(vmlal_u8(ca, vget_high_u8(d8), inv));
+		vst1q_u32(dst + i, vorrq_u32(
+			vreinterpretq_u32_u8(vcombine_u8(vmovn_u16(lo), vmovn_u16(hi))),
+			am));
+	}
+	BlendScalar(dst + i, n - i, c, amask, ashift);
+}
+static const BlitKernels sKernelsNEON =
+{
+	CopyNEON, MaskedMultNEON, BlendNEON
+};
+#endif
+
+
+const BlitKernels *gBlitKernels = &sKernelsScalar;
+
+void BlitKernelsInit(void)
+{
+	// Use the widest kernels available
+	for (int i = (int)BLIT_KERNELS_COUNT - 1; i >= 0; i--)
+	{
+		const BlitKernels *k = BlitKernelsGet((BlitKernelsType)i);
+		if (k != NULL)
+		{
+			gBlitKernels = k;
+			LOG(LM_GFX, LL_DEBUG, "using %s blit kernels",
+				BlitKernelsTypeStr((BlitKernelsType)i));
+			break;
+		}
+	}
+}
+
+const BlitKernels *BlitKernelsGet(const BlitKernelsType t)
+{
+	switch (t)
+	{
+	case BLIT_KERNELS_SCALAR:
+		return &sKernelsScalar;
+#ifdef BLIT_SSE2
+	case BLIT_KERNELS_SSE2:
+		return SDL_HasSSE2() ? &sKernelsSSE2 : NULL;
+#endif
+#if defined(BLIT_AVX2) && SDL_VERSION_ATLEAST(2, 0, 4)
+	case BLIT_KERNELS_AVX2:
+		return SDL_HasAVX2() ? &sKernelsAVX2 : NULL;
+#endif
+#ifdef BLIT_NEON
+	case BLIT_KERNELS_NEON:
+		// Compiled with NEON enabled, so it must be available
+		return &sKernelsNEON;
+#endif
+	default:
+		return NULL;
+	}
+}
@@ -0,0 +1,70 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+
+    Copyright (c) 2018 Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+
+#include <SDL_stdinc.h>
+
+// Row kernels for the software blitters.
+// Each kernel processes n contiguous, already-clipped pixels; alpha is
+// located by amask/ashift so the kernels are agnostic to channel order.
+typedef struct
+{
+	// Copy src over dst, skipping pixels with zero alpha
+	void (*Copy)(
+		Uint32 *dst, const Uint32 *src, const int n,
+		const Uint32 amask, const int ashift);
+	// Multiply src by mask per channel and write it opaque;
+	// src pixels with alpha below alphaMin are skipped
+	void (*MaskedMult)(
+		Uint32 *dst, const Uint32 *src, const int n, const Uint32 mask,
+		const Uint32 amask, const int ashift, const int alphaMin);
+	// Alpha blend the colour c over dst and make it opaque
+	void (*Blend)(
+		Uint32 *dst, const int n, const Uint32 c,
+		const Uint32 amask, const int ashift);
+} BlitKernels;
+
+typedef enum
+{
+	BLIT_KERNELS_SCALAR,
+	BLIT_KERNELS_SSE2,
+	BLIT_KERNELS_AVX2,
+	BLIT_KERNELS_NEON,
+	BLIT_KERNELS_COUNT
+} BlitKernelsType;
+const char *BlitKernelsTypeStr(const BlitKernelsType t);
+
+// The kernels in use; set to the best supported by BlitKernelsInit
+extern const BlitKernels *gBlitKernels;
+
+void BlitKernelsInit(void);
+// Returns NULL if the kernels are not compiled in or not supported by CPU
+const BlitKernels *BlitKernelsGet(const BlitKernelsType t);
@@ -143,16 +143,15 @@ typedef struct
 	struct vec2 Pos;
 	struct vec2 Normal;
 } HitResult;
-static HitResult HitItem(
-	TMobileObject *obj, const struct vec2 pos, const bool multipleHits);
-bool BulletUpdate(struct MobileObject *obj, const int ticks)
+BulletUpdateResult BulletUpdateBegin(
+	struct MobileObject *obj, const int ticks, BulletStep *step)
 {
 	ThingUpdate(&obj->thing, ticks);
 	obj->count += ticks;
 	obj->specialLock = MAX(0, obj->specialLock - ticks);
 	if (obj->count < obj->bulletClass->Delay)
 	{
-		return true;
+		return BULLET_UPDATE_WAIT;
 	}
 
 	if (obj->range >= 0 && obj->count > obj->range)
@@ -169,7 +168,7 @@ bool BulletUpdate(struct MobileObject *obj, const int ticks)
 			s.u.AddParticle.Z = obj->z;
 			GameEventsEnqueue(&gGameEvents, s);
 		}
-		return false;
+		return BULLET_UPDATE_REMOVE;
 	}
 
 	const struct vec2 posStart = obj->thing.Pos;
@@ -180,7 +179,7 @@ bool BulletUpdate(struct MobileObject *obj, const int ticks)
 		const TActor *owner = ActorGetByUID(obj->ActorUID);
 		if (owner == NULL)
 		{
-			return false;
+			return BULLET_UPDATE_REMOVE;
 		}
 		const TActor *target = AIGetClosestEnemy(posStart, owner, obj->flags);
 		if (target && !target->dead)
@@ -195,10 +194,42 @@ bool BulletUpdate(struct MobileObject *obj, const int ticks)
 		}
 	}
 
+	step->Obj = obj;
+	step->PosStart = posStart;
+	step->HitsStart = 0;
+	step->HitsCount = 0;
+	return BULLET_UPDATE_MOVE;
+}
+
+void BulletsCollide(CArray *steps, CArray *hits)
+{
+	CArrayClear(hits);
+	if (gCampaign.IsClient || steps->size == 0)
+	{
+		return;
+	}
+	CollisionSweepTargetsUpdate(&gCollisionSystem);
+	CA_FOREACH(BulletStep, step, *steps)
+		step->HitsStart = (int)hits->size;
+		CollisionSweep(
+			&gCollisionSystem, &step->Obj->thing, step->PosStart,
+			step->Obj->thing.size, step->Obj->flags, step->Obj->ActorUID,
+			hits);
+		step->HitsCount = (int)hits->size - step->HitsStart;
+	CA_FOREACH_END()
+}
+
+static HitResult ResolveHits(
+	TMobileObject *obj, const BulletStep *step, const CArray *hits);
+bool BulletUpdateEnd(
+	const BulletStep *step, const CArray *hits, const int ticks)
+{
+	TMobileObject *obj = step->Obj;
+	const struct vec2 posStart = step->PosStart;
 	HitResult hit = { HIT_NONE, svec2_zero(), svec2_zero() };
 	if (!gCampaign.IsClient)
 	{
-		hit = HitItem(obj, posStart, obj->bulletClass->Persists);
+		hit = ResolveHits(obj, step, hits);
 	}
 	struct vec2 pos =
 		svec2_add(posStart, svec2_scale(obj->thing.Vel, (float)ticks));
@@ -221,10 +252,11 @@ bool BulletUpdate(struct MobileObject *obj, const int ticks)
 				alive = false;
 			}
 			// Leave a wall mark if hitting a south-facing wall
+			const struct vec2i belowPos =
+				Vec2ToTile(svec2(hit.Pos.x, hit.Pos.y + 1));
 			if (hit.Type == HIT_WALL && obj->thing.Vel.y < 0 &&
-				!TileIsOpaque(MapGetTile(
-					&gMap, Vec2ToTile(svec2(hit.Pos.x, hit.Pos.y + 1))
-				)))
+				MapIsTileIn(&gMap, belowPos) &&
+				!MapTileBit(&gMap, MAP_BITS_OPAQUE, belowPos))
 			{
 				b.u.BulletBounce.WallMark = true;
 			}
@@ -413,7 +445,6 @@ static void AddTrail(const TMobileObject *obj)
 typedef struct
 {
 	HitType HitType;
-	bool MultipleHits;
 	TMobileObject *Obj;
 	union
 	{
@@ -424,33 +455,46 @@ typedef struct
 	struct vec2 ColNormal;
 	float ColPosDist2;
 } HitItemData;
-static bool HitItemFunc(
-	Thing *ti, void *data, const struct vec2 colA, const struct vec2 colB,
-	const struct vec2 normal);
-static bool CheckWall(const struct vec2i tilePos);
-static bool HitWallFunc(
-	const struct vec2i tilePos, void *data,
-	const struct vec2 col, const struct vec2 normal);
 static void OnHit(HitItemData *data, Thing *target);
-static HitResult HitItem(
-	TMobileObject *obj, const struct vec2 pos, const bool multipleHits)
+static HitType GetHitType(
+	const Thing *ti, const TMobileObject *bullet, int *targetUID);
+static void SetClosestCollision(
+	HitItemData *data, const struct vec2 col, const struct vec2 normal,
+	const HitType ht, Thing *target, const struct vec2i tilePos);
+static HitResult ResolveHits(
+	TMobileObject *obj, const BulletStep *step, const CArray *hits)
 {
-	// Get all items that collide
 	HitItemData data;
 	data.HitType = HIT_NONE;
-	data.MultipleHits = multipleHits;
 	data.Obj = obj;
-	data.ColPos = pos;
+	data.ColPos = step->PosStart;
 	data.ColNormal = svec2_zero();
 	data.ColPosDist2 = -1;
-	const CollisionParams params =
-	{
-		THING_CAN_BE_SHOT, COLLISIONTEAM_NONE, IsPVP(gCampaign.Entry.Mode)
-	};
-	OverlapThings(
-		&obj->thing, pos,
-		obj->thing.size, params, HitItemFunc, &data,
-		CheckWall, HitWallFunc, &data);
+	// Hits are nearest first
+	const bool multipleHits = obj->bulletClass->Persists;
+	for (int i = step->HitsStart; i < step->HitsStart + step->HitsCount; i++)
+	{
+		const SweepHit *h = CArrayGet(hits, i);
+		if (h->Target == NULL)
+		{
+			SetClosestCollision(
+				&data, h->ColPos, h->Normal, HIT_WALL, NULL, h->TilePos);
+		}
+		else if (multipleHits)
+		{
+			// If we can hit multiple targets, just process those hits
+			// immediately
+			OnHit(&data, h->Target);
+		}
+		else
+		{
+			// Otherwise, find the closest target and only process the hit
+			// for that one at the end.
+			SetClosestCollision(
+				&data, h->ColPos, h->Normal,
+				GetHitType(h->Target, obj, NULL), h->Target, svec2i_zero());
+		}
+	}
 	if (!multipleHits && data.ColPosDist2 >= 0)
 	{
 		if (data.HitType == HIT_OBJECT || data.HitType == HIT_FLESH)
@@ -461,41 +505,6 @@ static HitResult HitItem(
 	HitResult hit = { data.HitType, data.ColPos, data.ColNormal };
 	return hit;
 }
-static HitType GetHitType(
-	const Thing *ti, const TMobileObject *bullet, int *targetUID);
-static void SetClosestCollision(
-	HitItemData *data, const struct vec2 col, const struct vec2 normal,
-	const HitType ht, Thing *target, const struct vec2i tilePos);
-static bool HitItemFunc(
-	Thing *ti, void *data, const struct vec2 colA, const struct vec2 colB,
-	const struct vec2 normal)
-{
-	UNUSED(colB);
-	HitItemData *hData = data;
-
-	// Check bullet-to-other collisions
-	if (!CanHit(hData->Obj->flags, hData->Obj->ActorUID, ti))
-	{
-		goto bail;
-	}
-
-	// If we can hit multiple targets, just process those hits immediately
-	// Otherwise, find the closest target and only process the hit for that one
-	// at the end.
-	if (hData->MultipleHits)
-	{
-		OnHit(hData, ti);
-	}
-	else
-	{
-		SetClosestCollision(
-			hData, colA, normal, GetHitType(ti, hData->Obj, NULL),
-			ti, svec2i_zero());
-	}
-
-bail:
-	return true;
-}
 static HitType GetHitType(
 	const Thing *ti, const TMobileObject *bullet, int *targetUID)
 {
@@ -529,21 +538,6 @@ static HitType GetHitType(
 	}
 	return ht;
 }
-static bool CheckWall(const struct vec2i tilePos)
-{
-	const Tile *t = MapGetTile(&gMap, tilePos);
-	return t == NULL || TileIsShootable(t);
-}
-static bool HitWallFunc(
-	const struct vec2i tilePos, void *data,
-	const struct vec2 col, const struct vec2 normal)
-{
-	HitItemData *hData = data;
-
-	SetClosestCollision(hData, col, normal, HIT_WALL, NULL, tilePos);
-
-	return true;
-}
 static void SetClosestCollision(
 	HitItemData *data, const struct vec2 col, const struct vec2 normal,
 	const HitType ht, Thing *target, const struct vec2i tilePos)
@@ -128,7 +128,31 @@ void BulletTerminate(BulletClasses *bullets);
 void BulletAdd(const NAddBullet add);
 void BulletDestroy(struct MobileObject *obj);
 
-bool BulletUpdate(struct MobileObject *obj, const int ticks);
+
+// Bullets are updated in three passes, so that the collisions of all of
+// them can be found together: begin (seek), collide, then end (resolve
+// hits in order, bounce, fall and move)
+typedef struct
+{
+	struct MobileObject *Obj;
+	struct vec2 PosStart;
+	// Range of this bullet's hits, nearest first
+	int HitsStart;
+	int HitsCount;
+} BulletStep;
+typedef enum
+{
+	BULLET_UPDATE_REMOVE,
+	BULLET_UPDATE_WAIT,	// not moving yet
+	BULLET_UPDATE_MOVE
+} BulletUpdateResult;
+BulletUpdateResult BulletUpdateBegin(
+	struct MobileObject *obj, const int ticks, BulletStep *step);
+// Find the hits of all moving bullets; steps of BulletStep, hits of SweepHit
+void BulletsCollide(CArray *steps, CArray *hits);
+// Returns false if the bullet should be removed
+bool BulletUpdateEnd(
+	const BulletStep *step, const CArray *hits, const int ticks);
 void BulletBounce(const NBulletBounce bb);
 
 // Type of material that the bullet hit
@@ -29,14 +29,20 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "mem_arena.h"
 #include "utils.h"
 
 void CArrayInit(CArray *a, size_t elemSize)
+{
+	CArrayInitArena(a, elemSize, NULL);
+}
+void CArrayInitArena(CArray *a, size_t elemSize, struct MemArena *arena)
 {
 	a->data = NULL;
 	a->elemSize = elemSize;
 	a->size = 0;
 	a->capacity = 0;
+	a->arena = arena;
 }
 void CArrayReserve(CArray *a, size_t capacity)
 {
@@ -44,11 +50,19 @@ void CArrayReserve(CArray *a, size_t capacity)
 	{
 		return;
 	}
+	const size_t oldSize = a->capacity * a->elemSize;
 	a->capacity = capacity;
 	const size_t size = a->capacity * a->elemSize;
 	if (size)
 	{
-		CREALLOC(a->data, size);
+		if (a->arena != NULL)
+		{
+			a->data = MemArenaRealloc(a->arena, a->data, oldSize, size);
+		}
+		else
+		{
+			CREALLOC(a->data, size);
+		}
 	}
 }
 static void GrowIfFull(CArray *a)
@@ -61,8 +75,9 @@ static void GrowIfFull(CArray *a)
 }
 void CArrayCopy(CArray *dst, const CArray *src)
 {
+	struct MemArena *arena = dst->arena;
 	CArrayTerminate(dst);
-	CArrayInit(dst, src->elemSize);
+	CArrayInitArena(dst, src->elemSize, arena);
 	CArrayReserve(dst, (int)src->size);
 	for (int i = 0; i < (int)src->size; i++)
 	{
@@ -190,6 +205,13 @@ void CArrayTerminate(CArray *a)
 	{
 		return;
 	}
-	CFREE(a->data);
+	if (a->arena != NULL)
+	{
+		MemArenaFree(a->arena, a->data, a->capacity * a->elemSize);
+	}
+	else
+	{
+		CFREE(a->data);
+	}
 	memset(a, 0, sizeof *a);
 }
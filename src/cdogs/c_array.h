@@ -28,6 +28,8 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+struct MemArena;
+
 // dynamic array
 typedef struct
 {
@@ -35,9 +37,11 @@ typedef struct
 	size_t elemSize;
 	size_t size;
 	size_t capacity;
+	struct MemArena *arena;	// if set, storage comes from this arena
 } CArray;
 
 void CArrayInit(CArray *a, size_t elemSize);
+void CArrayInitArena(CArray *a, size_t elemSize, struct MemArena *arena);
 void CArrayReserve(CArray *a, size_t capacity);
 void CArrayCopy(CArray *dst, const CArray *src);
 void CArrayPushBack(CArray *a, const void *elem);	// insert address
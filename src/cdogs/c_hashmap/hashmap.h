@@ -47,7 +47,8 @@ map_t hashmap_new(void);
 int hashmap_iterate(map_t in, PFany f, any_t item);
 
 /*
- * Add an element to the hashmap. Return MAP_OK or MAP_OMEM.
+ * Add an element to the hashmap, replacing any element with the same key.
+ * Return MAP_OK or MAP_OMEM.
  */
 int hashmap_put(map_t in, const char* key, any_t value);
 
@@ -56,6 +57,19 @@ int hashmap_put(map_t in, const char* key, any_t value);
  */
 int hashmap_get(const map_t in, const char* key, any_t *arg);
 
+/*
+ * Hash a key for hashmap_get_hashed. The hash does not depend on the map, so
+ * a key that is looked up in several maps only needs hashing once.
+ */
+unsigned int hashmap_hash_key(const char* key);
+
+/*
+ * Get an element using a hash from hashmap_hash_key.
+ * Return MAP_OK or MAP_MISSING.
+ */
+int hashmap_get_hashed(
+	const map_t in, const char* key, unsigned int hash, any_t *arg);
+
 /*
  * Remove an element from the hashmap. Return MAP_OK or MAP_MISSING.
  */
@@ -42,6 +42,7 @@ void CameraInit(Camera *camera)
 {
 	memset(camera, 0, sizeof *camera);
 	CameraReset(camera);
+	LOSViewsInit(&camera->LOS);
 	camera->lastPosition = svec2_zero();
 	HUDInit(&camera->HUD, &gGraphicsDevice, &gMission);
 	camera->shake = ScreenShakeZero();
@@ -57,6 +58,7 @@ void CameraReset(Camera *camera)
 void CameraTerminate(Camera *camera)
 {
 	DrawBufferTerminate(&camera->Buffer);
+	LOSViewsTerminate(&camera->LOS);
 	HUDTerminate(&camera->HUD);
 }
 
@@ -262,6 +264,10 @@ void CameraUpdate(Camera *camera, const int ticks, const int ms)
 			CASSERT(false, "not implemented yet");
 		}
 	}
+
+	camera->drawFrom = camera->drawTo;
+	camera->drawTo = camera->lastPosition;
+	camera->drawTick = gThingInterpolation.Ticks;
 }
 // Try to follow a player
 static struct vec2 GetFollowPlayerPos(
@@ -274,7 +280,9 @@ static struct vec2 GetFollowPlayerPos(
 
 static void DoBuffer(
 	DrawBuffer *b, const struct vec2 center, const int w, const struct vec2 noise,
-	const struct vec2i offset);
+	const struct vec2i offset, const int view, const TileBitset *los);
+static void CalcViewsLOS(Camera *camera, const HUDDrawData *drawData);
+static struct vec2 GetDrawPos(const Camera *camera);
 void CameraDraw(Camera *camera, const HUDDrawData drawData)
 {
 	struct vec2i centerOffset = svec2i_zero();
@@ -282,44 +290,24 @@ void CameraDraw(Camera *camera, const HUDDrawData drawData)
 	const int h = gGraphicsDevice.cachedConfig.Res.y;
 
 	const struct vec2 noise = ScreenShakeGetDelta(camera->shake);
+	const struct vec2 center = GetDrawPos(camera);
 
 	GraphicsResetBlitClip(&gGraphicsDevice);
+	CalcViewsLOS(camera, &drawData);
 	if (drawData.NumScreens == 0)
 	{
 		DoBuffer(
-			&camera->Buffer,
-			camera->lastPosition,
-			X_TILES, noise, centerOffset);
+			&camera->Buffer, center, X_TILES, noise, centerOffset, 0,
+			LOSViewsGet(&camera->LOS, &gMap, 0));
 	}
 	else
 	{
-		// Redo LOS if PVP, so that each split screen has its own LOS
-		if (IsPVP(gCampaign.Entry.Mode) && drawData.NumScreens > 0)
-		{
-			LOSReset(&gMap.LOS);
-		}
 		if (camera->NumViews == 1)
 		{
 			// Single camera screen
-
-			// Redo LOS for every local human player
-			if (IsPVP(gCampaign.Entry.Mode))
-			{
-				CA_FOREACH(const PlayerData, p, gPlayerDatas)
-					if (!p->IsLocal || !IsPlayerAliveOrDying(p) ||
-						!IsPlayerHuman(p))
-					{
-						continue;
-					}
-					const TActor *a = ActorGetByUID(p->ActorUID);
-					LOSCalcFrom(&gMap, Vec2ToTile(a->thing.Pos), false);
-				CA_FOREACH_END()
-			}
-
 			DoBuffer(
-				&camera->Buffer,
-				camera->lastPosition,
-				X_TILES, noise, centerOffset);
+				&camera->Buffer, center, X_TILES, noise, centerOffset, 0,
+				LOSViewsGet(&camera->LOS, &gMap, 0));
 		}
 		else if (drawData.NumScreens == 2)
 		{
@@ -337,6 +325,7 @@ void CameraDraw(Camera *camera, const HUDDrawData drawData)
 					continue;
 				}
 				camera->lastPosition = a->thing.Pos;
+				const struct vec2 drawPos = ThingGetDrawPos(&a->thing);
 				struct vec2i centerOffsetPlayer = centerOffset;
 				const int clipLeft = (i & 1) ? w / 2 : 0;
 				const int clipRight = (i & 1) ? w - 1 : (w / 2) - 1;
@@ -347,11 +336,11 @@ void CameraDraw(Camera *camera, const HUDDrawData drawData)
 					centerOffsetPlayer.x += w / 2;
 				}
 
-				LOSCalcFrom(&gMap, Vec2ToTile(camera->lastPosition), false);
 				DoBuffer(
 					&camera->Buffer,
-					camera->lastPosition,
-					X_TILES_HALF, noise, centerOffsetPlayer);
+					drawPos,
+					X_TILES_HALF, noise, centerOffsetPlayer, i,
+					LOSViewsGet(&camera->LOS, &gMap, i));
 			}
 			Draw_Line(w / 2 - 1, 0, w / 2 - 1, h - 1, colorBlack);
 			Draw_Line(w / 2, 0, w / 2, h - 1, colorBlack);
@@ -372,6 +361,7 @@ void CameraDraw(Camera *camera, const HUDDrawData drawData)
 					continue;
 				}
 				camera->lastPosition = a->thing.Pos;
+				const struct vec2 drawPos = ThingGetDrawPos(&a->thing);
 				struct vec2i centerOffsetPlayer = centerOffset;
 				const int clipLeft = (i & 1) ? w / 2 : 0;
 				const int clipTop = (i < 2) ? 0 : h / 2 - 1;
@@ -392,11 +382,11 @@ void CameraDraw(Camera *camera, const HUDDrawData drawData)
 				{
 					centerOffsetPlayer.y += h / 4;
 				}
-				LOSCalcFrom(&gMap, Vec2ToTile(camera->lastPosition), false);
 				DoBuffer(
 					&camera->Buffer,
-					camera->lastPosition,
-					X_TILES_HALF, noise, centerOffsetPlayer);
+					drawPos,
+					X_TILES_HALF, noise, centerOffsetPlayer, i,
+					LOSViewsGet(&camera->LOS, &gMap, i));
 			}
 			Draw_Line(w / 2 - 1, 0, w / 2 - 1, h - 1, colorBlack);
 			Draw_Line(w / 2, 0, w / 2, h - 1, colorBlack);
@@ -410,14 +400,109 @@ void CameraDraw(Camera *camera, const HUDDrawData drawData)
 	}
 	GraphicsResetBlitClip(&gGraphicsDevice);
 }
+// PvP views only see from their own players, calculated in parallel.
+// Otherwise views share the LOS that the simulation calculated from all
+// players, as do PvP views that happen to have the same players.
+static void SetViewLOS(
+	LOSView *v, const PlayerData *const *players, const int n);
+static void CalcViewsLOS(Camera *camera, const HUDDrawData *drawData)
+{
+	LOSViewsReset(&camera->LOS);
+	if (drawData->NumScreens == 0 || !IsPVP(gCampaign.Entry.Mode))
+	{
+		return;
+	}
+	if (camera->NumViews == 1)
+	{
+		// Single screen sees from every local human player
+		const PlayerData *players[MAX_LOCAL_PLAYERS];
+		int n = 0;
+		CA_FOREACH(const PlayerData, p, gPlayerDatas)
+			if (!p->IsLocal || !IsPlayerAliveOrDying(p) || !IsPlayerHuman(p))
+			{
+				continue;
+			}
+			if (n == MAX_LOCAL_PLAYERS)
+			{
+				break;
+			}
+			players[n] = p;
+			n++;
+		CA_FOREACH_END()
+		SetViewLOS(&camera->LOS.Views[0], players, n);
+	}
+	else
+	{
+		for (int i = 0; i < drawData->NumScreens; i++)
+		{
+			// Dead players' views see nothing
+			const PlayerData *p = drawData->Players[i];
+			SetViewLOS(&camera->LOS.Views[i], &p, IsPlayerAliveOrDying(p));
+		}
+	}
+	LOSViewsCalc(&camera->LOS, &gMap, gMission.time);
+}
+static bool IsSimulationLOS(const PlayerData *const *players, const int n);
+static void SetViewLOS(
+	LOSView *v, const PlayerData *const *players, const int n)
+{
+	for (int i = 0; i < n; i++)
+	{
+		const TActor *a = ActorGetByUID(players[i]->ActorUID);
+		if (a != NULL)
+		{
+			LOSViewAddViewer(v, Vec2ToTile(a->thing.Pos));
+		}
+	}
+	v->UseMapLOS = IsSimulationLOS(players, n);
+}
+// Whether the simulation's LOS, which is from all players alive or dying,
+// is from these players only
+static bool IsSimulationLOS(const PlayerData *const *players, const int n)
+{
+	if (n == 0)
+	{
+		return false;
+	}
+	int numSimulation = 0;
+	CA_FOREACH(const PlayerData, p, gPlayerDatas)
+		if (!IsPlayerAliveOrDying(p))
+		{
+			continue;
+		}
+		numSimulation++;
+		bool found = false;
+		for (int i = 0; i < n; i++)
+		{
+			found = found || players[i] == p;
+		}
+		if (!found)
+		{
+			return false;
+		}
+	CA_FOREACH_END()
+	return numSimulation == n;
+}
+// Camera position between the last two updates, unless it hasn't been
+// updated this tick (e.g. paused)
+static struct vec2 GetDrawPos(const Camera *camera)
+{
+	if (camera->drawTick != gThingInterpolation.Ticks)
+	{
+		return camera->drawTo;
+	}
+	return Vec2Interpolate(
+		camera->drawFrom, camera->drawTo, gThingInterpolation.Alpha);
+}
 static void DoBuffer(
 	DrawBuffer *b, const struct vec2 center, const int w, const struct vec2 noise,
-	const struct vec2i offset)
+	const struct vec2i offset, const int view, const TileBitset *los)
 {
+	DrawBufferSetView(b, view);
 	DrawBufferSetFromMap(b, &gMap, svec2_add(center, noise), w);
 	if (gPlayerDatas.size > 0)
 	{
-		DrawBufferFix(b);
+		DrawBufferFix(b, los);
 	}
 	DrawBufferDraw(b, offset, NULL);
 }
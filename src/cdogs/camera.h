@@ -28,6 +28,7 @@
 
 #include "draw/draw_buffer.h"
 #include "hud/hud.h"
+#include "los_views.h"
 #include "screen_shake.h"
 
 #define CAMERA_SPLIT_PADDING 40
@@ -42,7 +43,12 @@ typedef enum
 typedef struct
 {
 	DrawBuffer Buffer;
+	LOSViews LOS;
 	struct vec2 lastPosition;
+	// Positions after the last two updates; drawn interpolated in between
+	struct vec2 drawFrom;
+	struct vec2 drawTo;
+	int drawTick;
 	HUD HUD;
 	ScreenShake shake;
 	SpectateMode spectateMode;
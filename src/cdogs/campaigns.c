@@ -210,10 +210,14 @@ Mission *CampaignGetCurrentMission(CampaignOptions *campaign)
 	return CArrayGet(&campaign->Setting.Missions, campaign->MissionIndex);
 }
 
-void CampaignSeedRandom(const CampaignOptions *campaign)
+int CampaignGetSeed(const CampaignOptions *campaign)
 {
-	const int seed =
+	return
 		10 * campaign->MissionIndex + ConfigGetInt(&gConfig, "Game.RandomSeed");
+}
+void CampaignSeedRandom(const CampaignOptions *campaign)
+{
+	const int seed = CampaignGetSeed(campaign);
 	LOG(LM_MAIN, LL_INFO, "Seeding with %d", seed);
 	srand((unsigned int)seed);
 }
@@ -81,6 +81,7 @@ void LoadAllCampaigns(custom_campaigns_t *campaigns);
 void UnloadAllCampaigns(custom_campaigns_t *campaigns);
 
 Mission *CampaignGetCurrentMission(CampaignOptions *campaign);
+int CampaignGetSeed(const CampaignOptions *campaign);
 void CampaignSeedRandom(const CampaignOptions *campaign);
 
 void CampaignAndMissionSetup(
@@ -120,14 +120,13 @@ void CharacterLoadJSON(CharacterStore *c, json_t *root, int version)
 	}
 }
 
-bool CharacterSave(CharacterStore *s, const char *path)
+json_t *CharacterSaveJSON(const CharacterStore *s)
 {
 	json_t *root = json_new_object();
 	AddIntPair(root, "Version", CHARACTER_VERSION);
-	bool res = true;
-	
+
 	json_t *charNode = json_new_array();
-	CA_FOREACH(Character, c, s->OtherChars)
+	CA_FOREACH(const Character, c, s->OtherChars)
 		json_t *node = json_new_object();
 		AddStringPair(node, "Class", c->Class->Name);
 		AddColorPair(node, "Skin", c->Colors.Skin);
@@ -147,15 +146,14 @@ bool CharacterSave(CharacterStore *s, const char *path)
 		json_insert_child(charNode, node);
 	CA_FOREACH_END()
 	json_insert_pair_into_object(root, "Characters", charNode);
+	return root;
+}
+bool CharacterSave(const CharacterStore *s, const char *path)
+{
+	json_t *root = CharacterSaveJSON(s);
 	char buf[CDOGS_PATH_MAX];
 	sprintf(buf, "%s/characters.json", path);
-	if (!TrySaveJSONFile(root, buf))
-	{
-		res = false;
-		goto bail;
-	}
-
-bail:
+	const bool res = TrySaveJSONFile(root, buf);
 	json_free_value(&root);
 	return res;
 }
@@ -65,7 +65,8 @@ void CharacterStoreInit(CharacterStore *store);
 void CharacterStoreTerminate(CharacterStore *store);
 void CharacterStoreResetOthers(CharacterStore *store);
 void CharacterLoadJSON(CharacterStore *c, json_t *root, int version);
-bool CharacterSave(CharacterStore *s, const char *path);
+json_t *CharacterSaveJSON(const CharacterStore *s);
+bool CharacterSave(const CharacterStore *s, const char *path);
 Character *CharacterStoreAddOther(CharacterStore *store);
 Character *CharacterStoreInsertOther(CharacterStore *store, const size_t idx);
 void CharacterStoreDeleteOther(CharacterStore *store, int idx);
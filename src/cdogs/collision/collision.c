@@ -48,6 +48,9 @@
 */
 #include "collision.h"
 
+#include <math.h>
+#include <stdlib.h>
+
 #include "actors.h"
 #include "algorithms.h"
 #include "campaigns.h"
@@ -126,6 +129,7 @@ void CollisionSystemInit(CollisionSystem *cs)
 {
 	CollisionSystemReset(cs);
 	TileCacheInit(&cs->tileCache);
+	CArrayInit(&cs->sweepTargets, sizeof(SweepTarget));
 }
 void CollisionSystemReset(CollisionSystem *cs)
 {
@@ -134,6 +138,7 @@ void CollisionSystemReset(CollisionSystem *cs)
 void CollisionSystemTerminate(CollisionSystem *cs)
 {
 	TileCacheTerminate(&cs->tileCache);
+	CArrayTerminate(&cs->sweepTargets);
 }
 
 CollisionTeam CalcCollisionTeam(const bool isActor, const TActor *actor)
@@ -448,3 +453,218 @@ void GetWallBouncePosVel(
 		colNormal.x == 0 ? vel.x : colNormal.x * fabsf(vel.x),
 		colNormal.y == 0 ? vel.y : colNormal.y * fabsf(vel.y));
 }
+
+void TileWalkInit(TileWalk *w, const struct vec2 from, const struct vec2 to)
+{
+	// Amanatides-Woo: step to whichever tile edge the line reaches first
+	w->Tile = Vec2ToTile(from);
+	const struct vec2i end = Vec2ToTile(to);
+	w->step = svec2i(to.x > from.x ? 1 : -1, to.y > from.y ? 1 : -1);
+	w->remaining = svec2i(abs(end.x - w->Tile.x), abs(end.y - w->Tile.y));
+	const struct vec2 d = svec2(fabsf(to.x - from.x), fabsf(to.y - from.y));
+	// Only used on axes with steps remaining, which have non-zero length
+	w->tDelta = svec2(
+		d.x > 0 ? TILE_WIDTH / d.x : 0, d.y > 0 ? TILE_HEIGHT / d.y : 0);
+	const struct vec2 edge = svec2(
+		(float)((w->Tile.x + (w->step.x > 0 ? 1 : 0)) * TILE_WIDTH),
+		(float)((w->Tile.y + (w->step.y > 0 ? 1 : 0)) * TILE_HEIGHT));
+	w->tMax = svec2(
+		d.x > 0 ? fabsf(edge.x - from.x) / d.x : 0,
+		d.y > 0 ? fabsf(edge.y - from.y) / d.y : 0);
+}
+bool TileWalkNext(TileWalk *w)
+{
+	if (w->remaining.x > 0 &&
+		(w->remaining.y == 0 || w->tMax.x < w->tMax.y))
+	{
+		w->Tile.x += w->step.x;
+		w->tMax.x += w->tDelta.x;
+		w->remaining.x--;
+		return true;
+	}
+	if (w->remaining.y > 0)
+	{
+		w->Tile.y += w->step.y;
+		w->tMax.y += w->tDelta.y;
+		w->remaining.y--;
+		return true;
+	}
+	return false;
+}
+
+static void AddSweepTarget(CollisionSystem *cs, Thing *ti);
+static int CompareSweepTargets(const void *v1, const void *v2);
+void CollisionSweepTargetsUpdate(CollisionSystem *cs)
+{
+	CArrayClear(&cs->sweepTargets);
+	cs->sweepTargetsMaxWidth = 0;
+	CA_FOREACH(TActor, a, gActors)
+		if (a->isInUse)
+		{
+			AddSweepTarget(cs, &a->thing);
+		}
+	CA_FOREACH_END()
+	CA_FOREACH(TObject, o, gObjs)
+		if (o->isInUse)
+		{
+			AddSweepTarget(cs, &o->thing);
+		}
+	CA_FOREACH_END()
+	qsort(
+		cs->sweepTargets.data, cs->sweepTargets.size,
+		cs->sweepTargets.elemSize, CompareSweepTargets);
+}
+static void AddSweepTarget(CollisionSystem *cs, Thing *ti)
+{
+	if (!(ti->flags & THING_CAN_BE_SHOT))
+	{
+		return;
+	}
+	SweepTarget t;
+	t.Thing = ti;
+	const struct vec2 half = svec2_scale(svec2_assign_vec2i(ti->size), 0.5f);
+	const struct vec2 end = svec2_add(ti->Pos, ti->Vel);
+	t.Min = svec2_subtract(svec2_min(ti->Pos, end), half);
+	t.Max = svec2_add(svec2_max(ti->Pos, end), half);
+	cs->sweepTargetsMaxWidth = MAX(cs->sweepTargetsMaxWidth, t.Max.x - t.Min.x);
+	CArrayPushBack(&cs->sweepTargets, &t);
+}
+static int CompareSweepTargets(const void *v1, const void *v2)
+{
+	const SweepTarget *t1 = v1;
+	const SweepTarget *t2 = v2;
+	if (t1->Min.x != t2->Min.x)
+	{
+		return t1->Min.x < t2->Min.x ? -1 : 1;
+	}
+	// Keep the order deterministic
+	if (t1->Thing->kind != t2->Thing->kind)
+	{
+		return (int)t1->Thing->kind - (int)t2->Thing->kind;
+	}
+	return t1->Thing->id - t2->Thing->id;
+}
+
+static int CompareSweepHits(const void *v1, const void *v2);
+void CollisionSweep(
+	const CollisionSystem *cs, const Thing *item, const struct vec2 pos,
+	const struct vec2i size, const int flags, const int uid, CArray *hits)
+{
+	const size_t start = hits->size;
+	const struct vec2 vel = item->Vel;
+	struct vec2 colA, colB, normal;
+
+	// Walls, nearest first; stop at the first one
+	// Hack: bullets always considered 0x0 when colliding with walls
+	// TODO: bullet size for walls
+	float wallDist2 = -1;
+	TileWalk tw;
+	TileWalkInit(&tw, pos, svec2_add(pos, vel));
+	do
+	{
+		// Tiles outside the map count as walls
+		if (MapIsTileIn(&gMap, tw.Tile) &&
+			!MapTileBit(&gMap, MAP_BITS_SHOOT, tw.Tile))
+		{
+			continue;
+		}
+		if (!MinkowskiHexCollide(
+			pos, vel, svec2i_zero(), Vec2CenterOfTile(tw.Tile), svec2_zero(),
+			TILE_SIZE, &colA, &colB, &normal))
+		{
+			continue;
+		}
+		SweepHit h;
+		h.Target = NULL;
+		h.TilePos = tw.Tile;
+		h.ColPos = colA;
+		h.Normal = normal;
+		h.Dist2 = svec2_distance_squared(colA, pos);
+		wallDist2 = h.Dist2;
+		CArrayPushBack(hits, &h);
+		break;
+	} while (TileWalkNext(&tw));
+
+	// Things whose swept bounds overlap ours, up to the wall
+	const struct vec2 half = svec2_scale(svec2_assign_vec2i(size), 0.5f);
+	const struct vec2 end = svec2_add(pos, vel);
+	const struct vec2 min = svec2_subtract(svec2_min(pos, end), half);
+	const struct vec2 max = svec2_add(svec2_max(pos, end), half);
+	// Binary search for the first target that could reach us
+	const float minX = min.x - cs->sweepTargetsMaxWidth;
+	int lo = 0;
+	int hi = (int)cs->sweepTargets.size;
+	while (lo < hi)
+	{
+		const int mid = (lo + hi) / 2;
+		const SweepTarget *t = CArrayGet(&cs->sweepTargets, mid);
+		if (t->Min.x < minX)
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+	for (int i = lo; i < (int)cs->sweepTargets.size; i++)
+	{
+		const SweepTarget *t = CArrayGet(&cs->sweepTargets, i);
+		if (t->Min.x > max.x)
+		{
+			break;
+		}
+		if (t->Max.x < min.x || t->Max.y < min.y || t->Min.y > max.y ||
+			t->Thing == item || !CanHit(flags, uid, t->Thing))
+		{
+			continue;
+		}
+		if (!MinkowskiHexCollide(
+			pos, vel, size, t->Thing->Pos, t->Thing->Vel, t->Thing->size,
+			&colA, &colB, &normal))
+		{
+			continue;
+		}
+		SweepHit h;
+		h.Target = t->Thing;
+		h.TilePos = svec2i_zero();
+		h.ColPos = colA;
+		h.Normal = normal;
+		h.Dist2 = svec2_distance_squared(colA, pos);
+		if (wallDist2 >= 0 && h.Dist2 > wallDist2)
+		{
+			continue;
+		}
+		CArrayPushBack(hits, &h);
+	}
+
+	if (hits->size > start)
+	{
+		qsort(
+			CArrayGet(hits, start), hits->size - start, hits->elemSize,
+			CompareSweepHits);
+	}
+}
+static int CompareSweepHits(const void *v1, const void *v2)
+{
+	const SweepHit *h1 = v1;
+	const SweepHit *h2 = v2;
+	if (h1->Dist2 != h2->Dist2)
+	{
+		return h1->Dist2 < h2->Dist2 ? -1 : 1;
+	}
+	// Things before walls, then in a fixed order
+	if ((h1->Target == NULL) != (h2->Target == NULL))
+	{
+		return h1->Target == NULL ? 1 : -1;
+	}
+	if (h1->Target == NULL)
+	{
+		return 0;
+	}
+	if (h1->Target->kind != h2->Target->kind)
+	{
+		return (int)h1->Target->kind - (int)h2->Target->kind;
+	}
+	return h1->Target->id - h2->Target->id;
+}
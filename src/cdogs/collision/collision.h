@@ -56,6 +56,9 @@ typedef struct
 	AllyCollision allyCollision;
 	// Cache of tiles to check for potential collisions, of tile coords
 	CArray tileCache;	// of struct vec2i
+	// Shootable things, sorted by left edge, for sweeping many movers against
+	CArray sweepTargets;	// of SweepTarget
+	float sweepTargetsMaxWidth;
 } CollisionSystem;
 
 extern CollisionSystem gCollisionSystem;
@@ -65,10 +68,10 @@ void CollisionSystemReset(CollisionSystem *cs);
 void CollisionSystemTerminate(CollisionSystem *cs);
 
 #define HitWall(x, y)\
-	(!TileCanWalk(MapGetTile(\
-		&gMap,\
+	(!MapTileBit(\
+		&gMap, MAP_BITS_WALK,\
 		svec2i((int)(x)/TILE_WIDTH, (int)(y)/TILE_HEIGHT)\
-	)))
+	))
 
 // Which "team" the actor's on, for collision
 // Actors on the same team don't have to collide
@@ -115,6 +118,45 @@ bool AABBOverlap(
 	const struct vec2 pos1, const struct vec2 pos2,
 	const struct vec2i size1, const struct vec2i size2);
 
+// Walk the tiles that a line passes through, in order
+typedef struct
+{
+	struct vec2i Tile;
+	struct vec2i step;
+	struct vec2i remaining;
+	struct vec2 tMax;
+	struct vec2 tDelta;
+} TileWalk;
+void TileWalkInit(TileWalk *w, const struct vec2 from, const struct vec2 to);
+// Move to the next tile; returns false at the end of the line
+bool TileWalkNext(TileWalk *w);
+
+// Batched collisions for many small movers (i.e. bullets): the shootable
+// things are gathered once, then each mover is swept against them and the
+// walls along its path
+typedef struct
+{
+	Thing *Thing;
+	// Bounds swept over the tick
+	struct vec2 Min;
+	struct vec2 Max;
+} SweepTarget;
+typedef struct
+{
+	Thing *Target;	// NULL for walls
+	struct vec2i TilePos;
+	struct vec2 ColPos;
+	struct vec2 Normal;
+	float Dist2;
+} SweepHit;
+void CollisionSweepTargetsUpdate(CollisionSystem *cs);
+// Append the hits of an item moving from pos by its velocity, nearest
+// first, to hits; ends at the first wall.
+// Things are only hit if CanHit with the flags and owner UID.
+void CollisionSweep(
+	const CollisionSystem *cs, const Thing *item, const struct vec2 pos,
+	const struct vec2i size, const int flags, const int uid, CArray *hits);
+
 // Resolve wall bounces
 void GetWallBouncePosVel(
 	const struct vec2 pos, const struct vec2 vel, const struct vec2 colPos,
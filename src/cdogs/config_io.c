@@ -30,6 +30,7 @@
 
 #include "config_json.h"
 #include "log.h"
+#include "replay.h"
 
 
 Config ConfigLoad(const char *filename)
@@ -64,5 +65,12 @@ Config ConfigLoad(const char *filename)
 
 void ConfigSave(const Config *config, const char *filename)
 {
+	// Replay playback overwrites the config with the recorded one;
+	// don't save that over the user's
+	if (gReplay.Mode == REPLAY_PLAYBACK)
+	{
+		LOG(LM_MAIN, LL_DEBUG, "not saving config during replay playback");
+		return;
+	}
 	ConfigSaveJSON(config, filename);
 }
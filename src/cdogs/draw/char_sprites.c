@@ -43,9 +43,11 @@ CharSpriteClasses gCharSpriteClasses;
 const CharSprites *StrCharSpriteClass(const char *s)
 {
 	CharSprites *c;
-	int error = hashmap_get(gCharSpriteClasses.customClasses, s, (any_t *)&c);
+	const unsigned int hash = hashmap_hash_key(s);
+	int error = hashmap_get_hashed(
+		gCharSpriteClasses.customClasses, s, hash, (any_t *)&c);
 	if (error == MAP_OK) return c;
-	error = hashmap_get(gCharSpriteClasses.classes, s, (any_t *)&c);
+	error = hashmap_get_hashed(gCharSpriteClasses.classes, s, hash, (any_t *)&c);
 	if (error == MAP_OK) return c;
 	return NULL;
 }
@@ -59,11 +59,13 @@
 #include "draw/drawtools.h"
 #include "font.h"
 #include "game_events.h"
+#include "log.h"
 #include "net_util.h"
 #include "objs.h"
 #include "pickup.h"
 #include "pics.h"
 #include "draw/draw.h"
+#include "draw/map_chunks.h"
 #include "blit.h"
 #include "pic_manager.h"
 
@@ -119,19 +121,23 @@ static void DrawLOSPic(
 }
 
 
-static void DrawFloor(DrawBuffer *b, struct vec2i offset);
+static bool CanUseMapChunks(const DrawBuffer *b);
+static void DrawFloor(DrawBuffer *b, struct vec2i offset, const bool useChunks);
 static void DrawDebris(DrawBuffer *b, struct vec2i offset);
-static void DrawWallsAndThings(DrawBuffer *b, struct vec2i offset);
+static void DrawWallsAndThings(
+	DrawBuffer *b, struct vec2i offset, const bool useChunks);
 static void DrawExtra(DrawBuffer *b, struct vec2i offset, GrafxDrawExtra *extra);
 
 void DrawBufferDraw(DrawBuffer *b, struct vec2i offset, GrafxDrawExtra *extra)
 {
+	DrawBufferBuildDrawList(b);
+	const bool useChunks = CanUseMapChunks(b);
 	// First draw the floor tiles (which do not obstruct anything)
-	DrawFloor(b, offset);
+	DrawFloor(b, offset, useChunks);
 	// Then draw debris (wrecks)
 	DrawDebris(b, offset);
 	// Now draw walls and (non-wreck) things in proper order
-	DrawWallsAndThings(b, offset);
+	DrawWallsAndThings(b, offset, useChunks);
 	// Draw objective highlights, for visible and always-visible objectives
 	DrawObjectiveHighlights(b, offset);
 	// Draw actor chatter
@@ -143,12 +149,46 @@ void DrawBufferDraw(DrawBuffer *b, struct vec2i offset, GrafxDrawExtra *extra)
 	}
 }
 
-static void DrawFloor(DrawBuffer *b, struct vec2i offset)
+static bool CanUseMapChunks(const DrawBuffer *b)
+{
+	return b->map != NULL && !b->g->IsHeadless &&
+		MapChunksUpdate(&gMapChunks, b->map, b->g->gameWindow.renderer);
+}
+static const Tile *BufferGetTile(
+	const DrawBuffer *b, const struct vec2i mapTile)
+{
+	return &b->tiles[0][
+		(mapTile.y - b->yStart) * b->OrigSize.x + mapTile.x - b->xStart];
+}
+static struct vec2i BufferGetTilePos(
+	const DrawBuffer *b, const struct vec2i offset, const struct vec2i mapTile)
+{
+	return svec2i(
+		b->dx + offset.x + (mapTile.x - b->xStart) * TILE_WIDTH,
+		b->dy + offset.y + (mapTile.y - b->yStart) * TILE_HEIGHT);
+}
+// The range of map tiles in the buffer; chunks are only drawn for these
+static void BufferGetMapRange(
+	const DrawBuffer *b, struct vec2i *start, struct vec2i *end)
+{
+	*start = svec2i_max(svec2i(b->xStart, b->yStart), svec2i_zero());
+	*end = svec2i_min(
+		svec2i(b->xStart + b->Size.x, b->yStart + b->Size.y), b->map->Size);
+}
+
+static void DrawFloorChunks(
+	const DrawBuffer *b, const struct vec2i offset, const bool useFog);
+static void DrawFloor(DrawBuffer *b, struct vec2i offset, const bool useChunks)
 {
 	int x, y;
 	struct vec2i pos;
 	const Tile *tile = &b->tiles[0][0];
 	const bool useFog = ConfigGetBool(&gConfig, "Game.Fog");
+	if (useChunks)
+	{
+		DrawFloorChunks(b, offset, useFog);
+		return;
+	}
 	for (y = 0, pos.y = b->dy + offset.y;
 		 y < Y_TILES;
 		 y++, pos.y += TILE_HEIGHT)
@@ -169,51 +209,138 @@ static void DrawFloor(DrawBuffer *b, struct vec2i offset)
 	}
 }
 
-static void DrawThing(
-	DrawBuffer *b, const Thing *t, const struct vec2i offset);
-
-static void DrawDebris(DrawBuffer *b, struct vec2i offset)
+static void DrawLOSOverlay(
+	SDL_Renderer *r, const DrawBuffer *b, const struct vec2i offset,
+	const struct vec2i mapTile, const int width, const TileLOS los);
+static void DrawFloorChunks(
+	const DrawBuffer *b, const struct vec2i offset, const bool useFog)
 {
-	Tile *tile = &b->tiles[0][0];
-	for (int y = 0; y < Y_TILES; y++)
+	SDL_Renderer *r = b->g->gameWindow.renderer;
+	struct vec2i start, end;
+	BufferGetMapRange(b, &start, &end);
+	if (start.x >= end.x || start.y >= end.y)
 	{
-		CArrayClear(&b->displaylist);
-		for (int x = 0; x < b->Size.x; x++, tile++)
+		return;
+	}
+	struct vec2i c;
+	for (c.y = start.y / MAP_CHUNK_TILES; c.y * MAP_CHUNK_TILES < end.y; c.y++)
+	{
+		for (c.x = start.x / MAP_CHUNK_TILES;
+			c.x * MAP_CHUNK_TILES < end.x;
+			c.x++)
 		{
-			if (tile->outOfSight)
+			const MapChunk *chunk = MapChunksGet(&gMapChunks, c);
+			if (chunk == NULL)
 			{
 				continue;
 			}
-			CA_FOREACH(ThingId, tid, tile->things)
-				const Thing *ti = ThingIdGetThing(tid);
-				if (ThingDrawLast(ti))
-				{
-					CArrayPushBack(&b->displaylist, &ti);
-				}
-			CA_FOREACH_END()
+			const struct vec2i chunkStart = svec2i_scale(c, MAP_CHUNK_TILES);
+			const struct vec2i from = svec2i_max(start, chunkStart);
+			const struct vec2i to = svec2i_min(end, svec2i_add(
+				chunkStart, svec2i(MAP_CHUNK_TILES, MAP_CHUNK_TILES)));
+			const SDL_Rect src = {
+				(from.x - chunkStart.x) * TILE_WIDTH,
+				(from.y - chunkStart.y) * TILE_HEIGHT,
+				(to.x - from.x) * TILE_WIDTH,
+				(to.y - from.y) * TILE_HEIGHT
+			};
+			const struct vec2i pos = BufferGetTilePos(b, offset, from);
+			const SDL_Rect dst = { pos.x, pos.y, src.w, src.h };
+			if (SDL_RenderCopy(r, chunk->Floor, &src, &dst) != 0)
+			{
+				LOG(LM_GFX, LL_ERROR, "cannot draw map chunk: %s",
+					SDL_GetError());
+			}
 		}
-		DrawBufferSortDisplayList(b);
-		CA_FOREACH(const Thing *, tp, b->displaylist)
-			DrawThing(b, *tp, offset);
-		CA_FOREACH_END()
-		tile += X_TILES - b->Size.x;
 	}
+
+	// Chunks are drawn in full colour; darken the tiles not in sight,
+	// in runs of the same LOS per row
+	struct vec2i t;
+	for (t.y = start.y; t.y < end.y; t.y++)
+	{
+		int runStart = start.x;
+		TileLOS runLOS =
+			GetTileLOS(BufferGetTile(b, svec2i(start.x, t.y)), useFog);
+		for (t.x = start.x + 1; t.x <= end.x; t.x++)
+		{
+			const TileLOS los = t.x < end.x ?
+				GetTileLOS(BufferGetTile(b, t), useFog) : TILE_LOS_NORMAL;
+			if (t.x < end.x && los == runLOS)
+			{
+				continue;
+			}
+			DrawLOSOverlay(
+				r, b, offset, svec2i(runStart, t.y), t.x - runStart, runLOS);
+			runStart = t.x;
+			runLOS = los;
+		}
+	}
+}
+static void DrawLOSOverlay(
+	SDL_Renderer *r, const DrawBuffer *b, const struct vec2i offset,
+	const struct vec2i mapTile, const int width, const TileLOS los)
+{
+	Uint8 alpha;
+	switch (los)
+	{
+	case TILE_LOS_FOG:
+		// Blending black over the tiles is the same as the fog colour mask
+		alpha = (Uint8)(255 - colorFog.r);
+		break;
+	case TILE_LOS_NONE:
+		alpha = 255;
+		break;
+	default:
+		return;
+	}
+	const struct vec2i pos = BufferGetTilePos(b, offset, mapTile);
+	const SDL_Rect rect = { pos.x, pos.y, width * TILE_WIDTH, TILE_HEIGHT };
+	SDL_SetRenderDrawBlendMode(r, SDL_BLENDMODE_BLEND);
+	SDL_SetRenderDrawColor(r, 0, 0, 0, alpha);
+	if (SDL_RenderFillRect(r, &rect) != 0)
+	{
+		LOG(LM_GFX, LL_ERROR, "cannot draw LOS overlay: %s", SDL_GetError());
+	}
+}
+
+static void DrawThing(
+	DrawBuffer *b, const Thing *t, const struct vec2i offset);
+
+static void DrawDebris(DrawBuffer *b, struct vec2i offset)
+{
+	// Debris is below everything else, so draw it all in y order
+	CA_FOREACH(const DrawListEntry, e, *DrawBufferGetDrawList(b))
+		if (e->DrawLast)
+		{
+			DrawThing(b, e->Thing, offset);
+		}
+	CA_FOREACH_END()
 }
 
-#define WALL_OFFSET_Y (-12)
-static void DrawWallsAndThings(DrawBuffer *b, struct vec2i offset)
+static void DrawWallChunksRow(
+	const DrawBuffer *b, const struct vec2i offset, const int y,
+	const bool useFog);
+static void DrawWallsAndThings(
+	DrawBuffer *b, struct vec2i offset, const bool useChunks)
 {
 	struct vec2i pos;
 	Tile *tile = &b->tiles[0][0];
 	pos.y = b->dy + WALL_OFFSET_Y + offset.y;
 	const bool useFog = ConfigGetBool(&gConfig, "Game.Fog");
+	// The draw list is sorted by y, so each row's things follow the last's
+	const CArray *drawList = DrawBufferGetDrawList(b);
+	int drawIdx = 0;
 	for (int y = 0; y < Y_TILES; y++, pos.y += TILE_HEIGHT)
 	{
-		CArrayClear(&b->displaylist);
+		if (useChunks)
+		{
+			DrawWallChunksRow(b, offset, y, useFog);
+		}
 		pos.x = b->dx + offset.x;
 		for (int x = 0; x < b->Size.x; x++, tile++, pos.x += TILE_WIDTH)
 		{
-			if (tile->Class->Type == TILE_CLASS_WALL)
+			if (tile->Class->Type == TILE_CLASS_WALL && !useChunks)
 			{
 				DrawLOSPic(tile, tile->Class->Pic, pos, useFog);
 			}
@@ -232,35 +359,121 @@ static void DrawWallsAndThings(DrawBuffer *b, struct vec2i offset)
 				}
 				DrawLOSPic(tile, pic, doorPos, useFog);
 			}
-
-			// Draw the items that are in LOS
-			if (tile->outOfSight)
+		}
+		// Draw the row's things that are in LOS
+		for (; drawIdx < (int)drawList->size; drawIdx++)
+		{
+			const DrawListEntry *e = CArrayGet(drawList, drawIdx);
+			if (e->Row > y)
 			{
-				continue;
+				break;
+			}
+			// Debris is drawn earlier
+			if (!e->DrawLast)
+			{
+				DrawThing(b, e->Thing, offset);
 			}
-			CA_FOREACH(ThingId, tid, tile->things)
-				const Thing *ti = ThingIdGetThing(tid);
-				// Drawn later
-				if (ThingDrawLast(ti))
-				{
-					continue;
-				}
-				CArrayPushBack(&b->displaylist, &ti);
-			CA_FOREACH_END()
 		}
-		DrawBufferSortDisplayList(b);
-		CA_FOREACH(const Thing *, tp, b->displaylist)
-			DrawThing(b, *tp, offset);
-		CA_FOREACH_END()
 		tile += X_TILES - b->Size.x;
 	}
 }
+static void DrawWallStrip(
+	SDL_Renderer *r, const DrawBuffer *b, const struct vec2i offset,
+	const MapChunk *chunk, const struct vec2i chunkStart,
+	const struct vec2i mapTile, const int width, const TileLOS los);
+static void DrawWallChunksRow(
+	const DrawBuffer *b, const struct vec2i offset, const int y,
+	const bool useFog)
+{
+	SDL_Renderer *r = b->g->gameWindow.renderer;
+	struct vec2i start, end;
+	BufferGetMapRange(b, &start, &end);
+	const int mapY = b->yStart + y;
+	if (start.x >= end.x || mapY < start.y || mapY >= end.y)
+	{
+		return;
+	}
+	for (int cx = start.x / MAP_CHUNK_TILES;
+		cx * MAP_CHUNK_TILES < end.x;
+		cx++)
+	{
+		const struct vec2i c = svec2i(cx, mapY / MAP_CHUNK_TILES);
+		const MapChunk *chunk = MapChunksGet(&gMapChunks, c);
+		if (chunk == NULL)
+		{
+			continue;
+		}
+		const struct vec2i chunkStart = svec2i_scale(c, MAP_CHUNK_TILES);
+		const int to = MIN(end.x, chunkStart.x + MAP_CHUNK_TILES);
+		// Copy runs of walls with the same LOS; floor tiles are transparent
+		// in the strip so they can join any run
+		int runStart = MAX(start.x, chunkStart.x);
+		int runLOS = -1;
+		for (int x = runStart; x < to; x++)
+		{
+			const Tile *tile = BufferGetTile(b, svec2i(x, mapY));
+			if (tile->Class->Type != TILE_CLASS_WALL)
+			{
+				continue;
+			}
+			const TileLOS los = GetTileLOS(tile, useFog);
+			if (runLOS != -1 && (int)los != runLOS)
+			{
+				DrawWallStrip(
+					r, b, offset, chunk, chunkStart, svec2i(runStart, mapY),
+					x - runStart, (TileLOS)runLOS);
+				runStart = x;
+			}
+			runLOS = (int)los;
+		}
+		if (runLOS != -1)
+		{
+			DrawWallStrip(
+				r, b, offset, chunk, chunkStart, svec2i(runStart, mapY),
+				to - runStart, (TileLOS)runLOS);
+		}
+	}
+}
+static void DrawWallStrip(
+	SDL_Renderer *r, const DrawBuffer *b, const struct vec2i offset,
+	const MapChunk *chunk, const struct vec2i chunkStart,
+	const struct vec2i mapTile, const int width, const TileLOS los)
+{
+	color_t mask;
+	switch (los)
+	{
+	case TILE_LOS_NORMAL:
+		mask = colorWhite;
+		break;
+	case TILE_LOS_FOG:
+		mask = colorFog;
+		break;
+	default:
+		// don't draw
+		return;
+	}
+	SDL_Texture *strip = chunk->Walls[mapTile.y - chunkStart.y];
+	if (SDL_SetTextureColorMod(strip, mask.r, mask.g, mask.b) != 0)
+	{
+		LOG(LM_GFX, LL_ERROR, "cannot set texture mask: %s", SDL_GetError());
+	}
+	const SDL_Rect src = {
+		(mapTile.x - chunkStart.x) * TILE_WIDTH, 0,
+		width * TILE_WIDTH, WALL_STRIP_HEIGHT
+	};
+	const struct vec2i pos = BufferGetTilePos(b, offset, mapTile);
+	const SDL_Rect dst = { pos.x, pos.y + WALL_OFFSET_Y, src.w, src.h };
+	if (SDL_RenderCopy(r, strip, &src, &dst) != 0)
+	{
+		LOG(LM_GFX, LL_ERROR, "cannot draw map chunk: %s", SDL_GetError());
+	}
+}
 static void DrawThing(
 	DrawBuffer *b, const Thing *t, const struct vec2i offset)
 {
 	const struct vec2i picPos = svec2i_add(
 		svec2i_subtract(
-			svec2i_floor(svec2_add(t->Pos, t->drawShake)),
+			svec2i_floor(svec2_add(ThingGetDrawPos(t), t->drawShake)),
 			svec2i(b->xTop, b->yTop)),
 		offset);
 
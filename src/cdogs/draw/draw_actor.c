@@ -446,10 +446,11 @@ static void DrawChatter(
 	// Draw character text
 	if (strlen(a->Chatter) > 0)
 	{
+		const struct vec2 drawPos = ThingGetDrawPos(&a->thing);
 		const struct vec2i textPos = svec2i(
-			(int)a->thing.Pos.x - b->xTop + offset.x -
+			(int)drawPos.x - b->xTop + offset.x -
 			FontStrW(a->Chatter) / 2,
-			(int)a->thing.Pos.y - b->yTop + offset.y - ACTOR_HEIGHT);
+			(int)drawPos.y - b->yTop + offset.y - ACTOR_HEIGHT);
 		FontStr(a->Chatter, textPos);
 	}
 }
@@ -49,9 +49,15 @@
 #include "draw/draw_buffer.h"
 
 #include <assert.h>
+#include <stddef.h>
 
+#include "actors.h"
 #include "algorithms.h"
 #include "los.h"
+#include "objs.h"
+#include "particle.h"
+#include "pickup.h"
+#include "profiler.h"
 
 
 void DrawBufferInit(DrawBuffer *b, struct vec2i size, GraphicsDevice *g)
@@ -64,8 +70,15 @@ void DrawBufferInit(DrawBuffer *b, struct vec2i size, GraphicsDevice *g)
 		b->tiles[i] = b->tiles[0] + i * size.y;
 	}
 	b->g = g;
-	CArrayInit(&b->displaylist, sizeof(const Thing *));
-	CArrayReserve(&b->displaylist, 32);
+	b->map = NULL;
+	for (int i = 0; i < DRAW_BUFFER_VIEWS; i++)
+	{
+		CArrayInit(&b->drawLists[i], sizeof(DrawListEntry));
+		CArrayReserve(&b->drawLists[i], 32);
+	}
+	b->view = 0;
+	CArrayInit(&b->drawListFound, sizeof(Thing *));
+	CArrayReserve(&b->drawListFound, 32);
 }
 void DrawBufferTerminate(DrawBuffer *b)
 {
@@ -74,7 +87,11 @@ void DrawBufferTerminate(DrawBuffer *b)
 		CFREE(b->tiles[0]);
 		CFREE(b->tiles);
 	}
-	CArrayTerminate(&b->displaylist);
+	for (int i = 0; i < DRAW_BUFFER_VIEWS; i++)
+	{
+		CArrayTerminate(&b->drawLists[i]);
+	}
+	CArrayTerminate(&b->drawListFound);
 }
 
 void DrawBufferSetFromMap(
@@ -84,6 +101,7 @@ void DrawBufferSetFromMap(
 	int x, y;
 	Tile *bufTile;
 
+	buffer->map = map;
 	buffer->Size = svec2i(width, buffer->OrigSize.y);
 
 	buffer->xTop = (int)origin.x - TILE_WIDTH * width / 2;
@@ -124,8 +142,9 @@ void DrawBufferSetFromMap(
 }
 
 // Set visibility and draw order for wall/door columns
-void DrawBufferFix(DrawBuffer *buffer)
+void DrawBufferFix(DrawBuffer *buffer, const TileBitset *los)
 {
+	const Map *map = buffer->map;
 	Tile *tile = &buffer->tiles[0][0];
 	for (int y = 0; y < Y_TILES; y++)
 	{
@@ -133,32 +152,138 @@ void DrawBufferFix(DrawBuffer *buffer)
 		{
 			const struct vec2i mapTile =
 				svec2i(x + buffer->xStart, y + buffer->yStart);
-			tile->outOfSight = !LOSTileIsVisible(&gMap, mapTile);
+			tile->outOfSight = !MapIsTileIn(map, mapTile) ||
+				!MapBitsGet(map, los->Bits, mapTile);
 		}
 		tile += X_TILES - buffer->Size.x;
 	}
 }
 
-static int CompareY(const void *v1, const void *v2);
-void DrawBufferSortDisplayList(DrawBuffer *buffer)
+void DrawBufferSetView(DrawBuffer *buffer, const int view)
 {
-	qsort(
-		buffer->displaylist.data,
-		buffer->displaylist.size,
-		buffer->displaylist.elemSize,
-		CompareY);
+	CASSERT(view >= 0 && view < DRAW_BUFFER_VIEWS, "invalid view");
+	buffer->view = view;
 }
-static int CompareY(const void *v1, const void *v2)
+
+// Where things of each kind are stored, to look them up without going
+// through ThingIdGetThing for each one
+typedef struct
 {
-	const Thing * const *t1 = v1;
-	const Thing * const *t2 = v2;
-	if ((*t1)->Pos.y < (*t2)->Pos.y)
+	const CArray *Array;
+	size_t ThingOffset;
+} ThingStore;
+static void GetThingStores(ThingStore stores[KIND_COUNT])
+{
+	stores[KIND_CHARACTER].Array = &gActors;
+	stores[KIND_CHARACTER].ThingOffset = offsetof(TActor, thing);
+	stores[KIND_PARTICLE].Array = &gParticles;
+	stores[KIND_PARTICLE].ThingOffset = offsetof(Particle, thing);
+	stores[KIND_MOBILEOBJECT].Array = &gMobObjs;
+	stores[KIND_MOBILEOBJECT].ThingOffset = offsetof(TMobileObject, thing);
+	stores[KIND_OBJECT].Array = &gObjs;
+	stores[KIND_OBJECT].ThingOffset = offsetof(TObject, thing);
+	stores[KIND_PICKUP].Array = &gPickups;
+	stores[KIND_PICKUP].ThingOffset = offsetof(Pickup, thing);
+}
+// Returns NULL if the id is no longer valid, e.g. after a map change
+static Thing *StoreGetThing(const ThingStore *stores, const ThingId *tid)
+{
+	const CArray *a = stores[tid->Kind].Array;
+	if (tid->Id < 0 || tid->Id >= (int)a->size)
+	{
+		return NULL;
+	}
+	return (Thing *)((char *)a->data +
+		(size_t)tid->Id * a->elemSize + stores[tid->Kind].ThingOffset);
+}
+static DrawListEntry MakeDrawListEntry(const DrawBuffer *b, const Thing *t)
+{
+	DrawListEntry e;
+	// Sort by where things are drawn, which is between ticks
+	e.Y = ThingGetDrawPos(t).y;
+	// Things are kept in the tile they are positioned in
+	e.Row = Vec2ToTile(t->Pos).y - b->yStart;
+	e.DrawLast = ThingDrawLast(t);
+	e.Id.Id = t->id;
+	e.Id.Kind = t->kind;
+	e.Thing = t;
+	return e;
+}
+static unsigned int sDrawListStamp = 0;
+void DrawBufferBuildDrawList(DrawBuffer *buffer)
+{
+	PROFILE_BEGIN(PROFILE_DRAW_LIST);
+	ThingStore stores[KIND_COUNT];
+	GetThingStores(stores);
+	// Things in sight are stamped as found, then as listed once they are in
+	// the draw list, so that each is listed once
+	sDrawListStamp += 2;
+	const unsigned int found = sDrawListStamp;
+	const unsigned int listed = found + 1;
+
+	CArrayClear(&buffer->drawListFound);
+	const Tile *tile = &buffer->tiles[0][0];
+	for (int y = 0; y < Y_TILES; y++)
+	{
+		for (int x = 0; x < buffer->Size.x; x++, tile++)
+		{
+			if (tile->outOfSight)
+			{
+				continue;
+			}
+			CA_FOREACH(const ThingId, tid, tile->things)
+				Thing *t = StoreGetThing(stores, tid);
+				t->drawListStamp = found;
+				CArrayPushBack(&buffer->drawListFound, &t);
+			CA_FOREACH_END()
+		}
+		tile += X_TILES - buffer->Size.x;
+	}
+
+	// Keep last frame's order for the things still in sight...
+	CArray *list = &buffer->drawLists[buffer->view];
+	DrawListEntry *entries = list->data;
+	size_t n = 0;
+	for (size_t i = 0; i < list->size; i++)
 	{
-		return -1;
+		Thing *t = StoreGetThing(stores, &entries[i].Id);
+		if (t == NULL || t->drawListStamp != found)
+		{
+			continue;
+		}
+		t->drawListStamp = listed;
+		entries[n] = MakeDrawListEntry(buffer, t);
+		n++;
 	}
-	else if ((*t1)->Pos.y >(*t2)->Pos.y)
+	CArrayResize(list, n, NULL);
+	// ...and add the things that have come into sight
+	CA_FOREACH(Thing *, tp, buffer->drawListFound)
+		if ((*tp)->drawListStamp != found)
+		{
+			continue;
+		}
+		(*tp)->drawListStamp = listed;
+		const DrawListEntry e = MakeDrawListEntry(buffer, *tp);
+		CArrayPushBack(list, &e);
+	CA_FOREACH_END()
+
+	// Insertion sort by y, which is close to linear as the list is nearly
+	// sorted already. It's also stable, so things at the same y don't swap
+	// between frames
+	entries = list->data;
+	for (int i = 1; i < (int)list->size; i++)
 	{
-		return 1;
+		const DrawListEntry e = entries[i];
+		int j = i - 1;
+		for (; j >= 0 && entries[j].Y > e.Y; j--)
+		{
+			entries[j + 1] = entries[j];
+		}
+		entries[j + 1] = e;
 	}
-	return 0;
+	PROFILE_END(PROFILE_DRAW_LIST);
+}
+const CArray *DrawBufferGetDrawList(const DrawBuffer *buffer)
+{
+	return &buffer->drawLists[buffer->view];
 }
@@ -50,16 +50,34 @@
 
 #include "map.h"
 
+#define DRAW_BUFFER_VIEWS 4
+
+// Sort keys are kept inline, so that sorting doesn't chase each thing
+typedef struct
+{
+	float Y;
+	int Row;	// tile row in the buffer
+	bool DrawLast;
+	ThingId Id;
+	// Only valid for the frame the list was built in
+	const Thing *Thing;
+} DrawListEntry;
+
 typedef struct
 {
 	GraphicsDevice *g;
+	const Map *map;
 	int xTop, yTop;	// offset from top/left in pixels
 	int xStart, yStart;	// starting tile of buffer
 	int dx, dy;	// remainder pixel offset from starting tile
 	struct vec2i OrigSize;
 	struct vec2i Size;	// size in tiles
 	Tile **tiles;
-	CArray displaylist;	// of const Thing *, to determine draw order
+	// Things in sight, in draw order; one per view as the buffer is reused
+	// for split screen. Kept between frames, as the order rarely changes
+	CArray drawLists[DRAW_BUFFER_VIEWS];	// of DrawListEntry
+	int view;
+	CArray drawListFound;	// of Thing *, scratch
 } DrawBuffer;
 
 void DrawBufferInit(DrawBuffer *b, struct vec2i size, GraphicsDevice *g);
@@ -68,5 +86,10 @@ void DrawBufferTerminate(DrawBuffer *b);
 void DrawBufferSetFromMap(
 	DrawBuffer *buffer, const Map *map, const struct vec2 origin,
 	const int width);
-void DrawBufferFix(DrawBuffer *buffer);
-void DrawBufferSortDisplayList(DrawBuffer *buffer);
+// Set visibility from a view's LOS, of bool per map tile
+void DrawBufferFix(DrawBuffer *buffer, const TileBitset *los);
+// Select the split screen view to draw next
+void DrawBufferSetView(DrawBuffer *buffer, const int view);
+// Find the things in sight and sort them into the view's draw list
+void DrawBufferBuildDrawList(DrawBuffer *buffer);
+const CArray *DrawBufferGetDrawList(const DrawBuffer *buffer);
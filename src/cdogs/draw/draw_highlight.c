@@ -111,9 +111,10 @@ static void DrawObjectiveHighlight(
 		return;
 	}
 	
+	const struct vec2 drawPos = ThingGetDrawPos(ti);
 	const struct vec2i pos = svec2i(
-		(int)ti->Pos.x - b->xTop + offset.x,
-		(int)ti->Pos.y - b->yTop + offset.y);
+		(int)drawPos.x - b->xTop + offset.x,
+		(int)drawPos.y - b->yTop + offset.y);
 	color.a = (Uint8)Pulse256(gMission.time);
 	if (ti->kind == KIND_CHARACTER)
 	{
@@ -55,6 +55,7 @@
 #include "texture.h"
 #include "utils.h"
 #include "blit.h"
+#include "blit_kernels.h"
 #include "grafx.h"
 
 
@@ -200,6 +201,21 @@ void DrawPointTint(GraphicsDevice *device, struct vec2i pos, HSV tint)
 	screen[idx] = COLOR2PIXEL(c);
 }
 
+// Blend a horizontal run of pixels [x0, x1) with the colour, clipped
+static void DrawRow(
+	GraphicsDevice *g, const int y, const int x0, const int x1,
+	const Uint32 pixel)
+{
+	const int left = MAX(x0, g->clipping.left);
+	const int right = MIN(x1, g->clipping.right + 1);
+	if (right <= left)
+	{
+		return;
+	}
+	gBlitKernels->Blend(
+		g->buf + y * g->cachedConfig.Res.x + left, right - left, pixel,
+		g->Format->Amask, g->Format->Ashift);
+}
 void DrawRectangle(
 	GraphicsDevice *device, struct vec2i pos, struct vec2i size, color_t color, int flags)
 {
@@ -208,6 +224,7 @@ void DrawRectangle(
 	{
 		flags &= ~DRAW_FLAG_ROUNDED;
 	}
+	const Uint32 pixel = COLOR2PIXEL(color);
 	for (y = MAX(pos.y, device->clipping.top);
 		y < MIN(pos.y + size.y, device->clipping.bottom + 1);
 		y++)
@@ -215,13 +232,7 @@ void DrawRectangle(
 		int isFirstOrLastLine = y == pos.y || y == pos.y + size.y - 1;
 		if (isFirstOrLastLine && (flags & DRAW_FLAG_ROUNDED))
 		{
-			int x;
-			for (x = MAX(pos.x + 1, device->clipping.left);
-				x < MIN(pos.x + size.x - 1, device->clipping.right + 1);
-				x++)
-			{
-				Draw_Point(x, y, color);
-			}
+			DrawRow(device, y, pos.x + 1, pos.x + size.x - 1, pixel);
 		}
 		else if (!isFirstOrLastLine && (flags & DRAW_FLAG_LINE))
 		{
@@ -230,13 +241,7 @@ void DrawRectangle(
 		}
 		else
 		{
-			int x;
-			for (x = MAX(pos.x, device->clipping.left);
-				x < MIN(pos.x + size.x, device->clipping.right + 1);
-				x++)
-			{
-				Draw_Point(x, y, color);
-			}
+			DrawRow(device, y, pos.x, pos.x + size.x, pixel);
 		}
 	}
 }
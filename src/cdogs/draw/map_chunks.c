@@ -0,0 +1,229 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+
+    Copyright (c) 2018 Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "map_chunks.h"
+
+#include <string.h>
+
+#include "log.h"
+#include "texture.h"
+#include "utils.h"
+
+MapChunks gMapChunks;
+
+
+static void ChunkDestroyTextures(MapChunk *c);
+void MapChunksTerminate(MapChunks *mc)
+{
+	if (mc->chunks != NULL)
+	{
+		for (int i = 0; i < mc->Size.x * mc->Size.y; i++)
+		{
+			ChunkDestroyTextures(&mc->chunks[i]);
+		}
+	}
+	CFREE(mc->chunks);
+	memset(mc, 0, sizeof *mc);
+}
+static void ChunkDestroyTextures(MapChunk *c)
+{
+	if (c->Floor != NULL)
+	{
+		SDL_DestroyTexture(c->Floor);
+	}
+	for (int i = 0; i < MAP_CHUNK_TILES; i++)
+	{
+		if (c->Walls[i] != NULL)
+		{
+			SDL_DestroyTexture(c->Walls[i]);
+		}
+	}
+	memset(c, 0, sizeof *c);
+}
+
+bool MapChunksUpdate(MapChunks *mc, const Map *map, SDL_Renderer *renderer)
+{
+	const struct vec2i size = svec2i(
+		(map->Size.x + MAP_CHUNK_TILES - 1) / MAP_CHUNK_TILES,
+		(map->Size.y + MAP_CHUNK_TILES - 1) / MAP_CHUNK_TILES);
+	if (mc->renderer == renderer && mc->map == map &&
+		svec2i_is_equal(mc->Size, size))
+	{
+		return !mc->isUnsupported;
+	}
+	MapChunksTerminate(mc);
+	mc->map = map;
+	mc->renderer = renderer;
+	mc->Size = size;
+	if (!SDL_RenderTargetSupported(renderer))
+	{
+		LOG(LM_GFX, LL_WARN,
+			"renderer does not support render to texture; "
+			"map will be drawn per tile");
+		mc->isUnsupported = true;
+		return false;
+	}
+	CCALLOC(mc->chunks, sizeof *mc->chunks * size.x * size.y);
+	MapChunksInvalidate(mc);
+	return true;
+}
+
+void MapChunksInvalidate(MapChunks *mc)
+{
+	if (mc->chunks == NULL)
+	{
+		return;
+	}
+	for (int i = 0; i < mc->Size.x * mc->Size.y; i++)
+	{
+		mc->chunks[i].IsDirty = true;
+	}
+}
+void MapChunksInvalidateTile(MapChunks *mc, const struct vec2i tile)
+{
+	if (mc->chunks == NULL)
+	{
+		return;
+	}
+	const struct vec2i pos = svec2i_scale_divide(tile, MAP_CHUNK_TILES);
+	if (pos.x < 0 || pos.x >= mc->Size.x || pos.y < 0 || pos.y >= mc->Size.y)
+	{
+		return;
+	}
+	mc->chunks[pos.y * mc->Size.x + pos.x].IsDirty = true;
+}
+
+static bool ChunkCreateTextures(MapChunk *c, SDL_Renderer *renderer);
+static void ChunkRender(
+	MapChunk *c, const Map *map, SDL_Renderer *renderer,
+	const struct vec2i pos);
+const MapChunk *MapChunksGet(MapChunks *mc, const struct vec2i pos)
+{
+	MapChunk *c = &mc->chunks[pos.y * mc->Size.x + pos.x];
+	if (c->Floor == NULL && !ChunkCreateTextures(c, mc->renderer))
+	{
+		return NULL;
+	}
+	if (c->IsDirty)
+	{
+		ChunkRender(c, mc->map, mc->renderer, pos);
+		c->IsDirty = false;
+	}
+	return c;
+}
+static bool ChunkCreateTextures(MapChunk *c, SDL_Renderer *renderer)
+{
+	c->Floor = TextureCreate(
+		renderer, SDL_TEXTUREACCESS_TARGET,
+		svec2i_scale(TILE_SIZE, MAP_CHUNK_TILES), SDL_BLENDMODE_BLEND, 255);
+	if (c->Floor == NULL)
+	{
+		goto bail;
+	}
+	for (int i = 0; i < MAP_CHUNK_TILES; i++)
+	{
+		c->Walls[i] = TextureCreate(
+			renderer, SDL_TEXTUREACCESS_TARGET,
+			svec2i(TILE_WIDTH * MAP_CHUNK_TILES, WALL_STRIP_HEIGHT),
+			SDL_BLENDMODE_BLEND, 255);
+		if (c->Walls[i] == NULL)
+		{
+			goto bail;
+		}
+	}
+	c->IsDirty = true;
+	return true;
+
+bail:
+	ChunkDestroyTextures(c);
+	return false;
+}
+static void SetTargetAndClear(SDL_Renderer *renderer, SDL_Texture *t);
+static void ChunkRender(
+	MapChunk *c, const Map *map, SDL_Renderer *renderer,
+	const struct vec2i pos)
+{
+	// May be rendering to a texture already, e.g. the menu background
+	SDL_Texture *prevTarget = SDL_GetRenderTarget(renderer);
+	const struct vec2i start = svec2i_scale(pos, MAP_CHUNK_TILES);
+	const struct vec2i end = svec2i_min(
+		svec2i_add(start, svec2i(MAP_CHUNK_TILES, MAP_CHUNK_TILES)),
+		map->Size);
+
+	SetTargetAndClear(renderer, c->Floor);
+	struct vec2i tilePos;
+	for (tilePos.y = start.y; tilePos.y < end.y; tilePos.y++)
+	{
+		for (tilePos.x = start.x; tilePos.x < end.x; tilePos.x++)
+		{
+			const Tile *tile = MapGetTile(map, tilePos);
+			if (tile->Class != NULL &&
+				tile->Class->Pic != NULL &&
+				tile->Class->Pic->Data != NULL &&
+				tile->Class->Type != TILE_CLASS_WALL)
+			{
+				PicRender(
+					tile->Class->Pic, renderer,
+					svec2i_multiply(svec2i_subtract(tilePos, start), TILE_SIZE),
+					colorWhite, 0, svec2_one());
+			}
+		}
+	}
+
+	for (tilePos.y = start.y; tilePos.y < end.y; tilePos.y++)
+	{
+		SetTargetAndClear(renderer, c->Walls[tilePos.y - start.y]);
+		for (tilePos.x = start.x; tilePos.x < end.x; tilePos.x++)
+		{
+			const Tile *tile = MapGetTile(map, tilePos);
+			if (tile->Class != NULL &&
+				tile->Class->Pic != NULL &&
+				tile->Class->Type == TILE_CLASS_WALL)
+			{
+				PicRender(
+					tile->Class->Pic, renderer,
+					svec2i((tilePos.x - start.x) * TILE_WIDTH, 0),
+					colorWhite, 0, svec2_one());
+			}
+		}
+	}
+
+	if (SDL_SetRenderTarget(renderer, prevTarget) != 0)
+	{
+		LOG(LM_GFX, LL_ERROR, "cannot set render target: %s", SDL_GetError());
+	}
+}
+static void SetTargetAndClear(SDL_Renderer *renderer, SDL_Texture *t)
+{
+	if (SDL_SetRenderTarget(renderer, t) != 0)
+	{
+		LOG(LM_GFX, LL_ERROR, "cannot set render target: %s", SDL_GetError());
+	}
+	SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+	SDL_RenderClear(renderer);
+}
@@ -0,0 +1,69 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+
+    Copyright (c) 2018 Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <SDL_render.h>
+
+#include "map.h"
+
+// Static map layers (floors and walls) are pre-rendered into textures of
+// MAP_CHUNK_TILES x MAP_CHUNK_TILES tiles, redrawn only when their tiles
+// change. Line of sight is applied when the chunks are drawn.
+#define MAP_CHUNK_TILES 16
+#define WALL_OFFSET_Y (-12)
+#define WALL_STRIP_HEIGHT (TILE_HEIGHT - WALL_OFFSET_Y)
+
+typedef struct
+{
+	SDL_Texture *Floor;
+	// Walls overlap the row above, and must be drawn in order with the
+	// things in each row, so each row of walls is its own strip
+	SDL_Texture *Walls[MAP_CHUNK_TILES];
+	bool IsDirty;
+} MapChunk;
+typedef struct
+{
+	const Map *map;
+	SDL_Renderer *renderer;
+	struct vec2i Size;	// in chunks
+	MapChunk *chunks;
+	bool isUnsupported;
+} MapChunks;
+extern MapChunks gMapChunks;
+
+void MapChunksTerminate(MapChunks *mc);
+// Returns false if chunks cannot be used with this renderer; use the
+// per-tile drawing instead
+bool MapChunksUpdate(MapChunks *mc, const Map *map, SDL_Renderer *renderer);
+// Redraw all chunks, e.g. on a new map or lost render targets
+void MapChunksInvalidate(MapChunks *mc);
+void MapChunksInvalidateTile(MapChunks *mc, const struct vec2i tile);
+// Get a chunk by chunk coordinates, redrawing it if needed
+// Returns NULL on error
+const MapChunk *MapChunksGet(MapChunks *mc, const struct vec2i pos);
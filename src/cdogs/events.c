@@ -33,6 +33,7 @@
 #include <SDL_timer.h>
 
 #include "config_io.h"
+#include "draw/map_chunks.h"
 #include "files.h"
 #include "gamedata.h"
 #include "log.h"
@@ -217,6 +218,10 @@ void EventPoll(EventHandlers *handlers, Uint32 ticks)
 				break;
 			}
 			break;
+		case SDL_RENDER_TARGETS_RESET:
+			// Pre-rendered map chunks are lost
+			MapChunksInvalidate(&gMapChunks);
+			break;
 		case SDL_QUIT:
 			handlers->HasQuit = true;
 			break;
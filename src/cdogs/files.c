@@ -56,6 +56,9 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <SDL.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
 
 #include "door.h"
 #include "log.h"
@@ -632,6 +635,91 @@ bool mkdir_deep(const char *path)
 	return true;
 }
 
+static bool FileHasContents(const char *path, const char *data, const size_t len);
+bool TrySaveFileAtomic(const char *path, const char *data, const size_t len)
+{
+	if (FileHasContents(path, data, len))
+	{
+		LOG(LM_MAIN, LL_DEBUG, "skipping unchanged file %s", path);
+		return true;
+	}
+	bool res = true;
+	char tmp[CDOGS_PATH_MAX];
+	sprintf(tmp, "%s.tmp", path);
+	// Text mode, so that line endings are native as before
+	FILE *f = fopen(tmp, "w");
+	if (f == NULL)
+	{
+		LOG(LM_MAIN, LL_ERROR, "failed to open file(%s) for saving: %s",
+			tmp, strerror(errno));
+		return false;
+	}
+	const size_t rc = fwrite(data, 1, len, f);
+	if (rc != len)
+	{
+		LOG(LM_MAIN, LL_ERROR, "Wrote (%d) of (%d) bytes: %s",
+			(int)rc, (int)len, strerror(errno));
+		res = false;
+	}
+	if (fclose(f) != 0)
+	{
+		res = false;
+	}
+	if (!res)
+	{
+		remove(tmp);
+		return false;
+	}
+#ifdef _WIN32
+	// rename does not replace existing files on Windows
+	if (!MoveFileExA(
+			tmp, path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+	{
+		LOG(LM_MAIN, LL_ERROR, "failed to rename %s to %s: error %lu",
+			tmp, path, (unsigned long)GetLastError());
+		remove(tmp);
+		return false;
+	}
+#else
+	if (rename(tmp, path) != 0)
+	{
+		LOG(LM_MAIN, LL_ERROR, "failed to rename %s to %s: %s",
+			tmp, path, strerror(errno));
+		remove(tmp);
+		return false;
+	}
+#endif
+	return true;
+}
+static bool FileHasContents(const char *path, const char *data, const size_t len)
+{
+	// Read in text mode too, so that line endings compare as written
+	FILE *f = fopen(path, "r");
+	if (f == NULL)
+	{
+		return false;
+	}
+	bool res = false;
+	// Compare in chunks to avoid reading the whole file at once
+	char buf[4096];
+	size_t offset = 0;
+	while (offset < len)
+	{
+		const size_t n = fread(buf, 1, MIN(sizeof buf, len - offset), f);
+		if (n == 0 || memcmp(buf, data + offset, n) != 0)
+		{
+			goto bail;
+		}
+		offset += n;
+	}
+	// The file must not be any longer
+	res = fgetc(f) == EOF;
+
+bail:
+	fclose(f);
+	return res;
+}
+
 void SetupConfigDir(void)
 {
 	const char *cfg_p = GetConfigFilePath("");
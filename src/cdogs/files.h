@@ -225,3 +225,6 @@ color_t RangeToColor(const int range);
 #define COLORRANGE_COUNT 27
 
 bool mkdir_deep(const char *path);
+// Write a whole file via a temporary file and rename, so that readers never
+// see it half-written; does nothing if the file already has these contents
+bool TrySaveFileAtomic(const char *path, const char *data, const size_t len);
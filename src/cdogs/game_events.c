@@ -33,6 +33,7 @@
 #include "actors.h"
 #include "net_client.h"
 #include "net_server.h"
+#include "sounds.h"
 #include "utils.h"
 
 
@@ -65,10 +66,12 @@ static GameEventEntry sGameEventEntries[] =
 	{ GAME_EVENT_MAP_OBJECT_REMOVE, true, false, true, true, NMapObjectRemove_fields },
 	{ GAME_EVENT_CLIENT_READY, false, false, false, false, NULL },
 	{ GAME_EVENT_NET_GAME_START, false, false, false, false, NULL },
+	{ GAME_EVENT_NET_SNAPSHOT, false, false, false, false, NULL },
 
 	{ GAME_EVENT_CONFIG, true, false, true, false, NConfig_fields },
 	{ GAME_EVENT_SCORE, true, true, true, true, NScore_fields },
-	{ GAME_EVENT_SOUND_AT, true, false, true, true, NSound_fields },
+	// Broadcast when handled, after identical sounds are merged
+	{ GAME_EVENT_SOUND_AT, false, false, true, true, NSound_fields },
 	{ GAME_EVENT_SCREEN_SHAKE, false, false, true, true, NULL },
 	{ GAME_EVENT_SET_MESSAGE, false, false, true, true, NULL },
 
@@ -117,13 +120,79 @@ GameEventEntry GameEventGetEntry(const GameEventType e)
 {
 	return sGameEventEntries[(int)e];
 }
+const char *GameEventTypeStr(const GameEventType e)
+{
+	switch (e)
+	{
+		T2S(GAME_EVENT_NONE, "None");
+		T2S(GAME_EVENT_CLIENT_CONNECT, "ClientConnect");
+		T2S(GAME_EVENT_CLIENT_ID, "ClientId");
+		T2S(GAME_EVENT_CAMPAIGN_DEF, "CampaignDef");
+		T2S(GAME_EVENT_PLAYER_DATA, "PlayerData");
+		T2S(GAME_EVENT_PLAYER_REMOVE, "PlayerRemove");
+		T2S(GAME_EVENT_TILE_SET, "TileSet");
+		T2S(GAME_EVENT_THING_DAMAGE, "ThingDamage");
+		T2S(GAME_EVENT_MAP_OBJECT_ADD, "MapObjectAdd");
+		T2S(GAME_EVENT_MAP_OBJECT_REMOVE, "MapObjectRemove");
+		T2S(GAME_EVENT_CLIENT_READY, "ClientReady");
+		T2S(GAME_EVENT_NET_GAME_START, "NetGameStart");
+		T2S(GAME_EVENT_NET_SNAPSHOT, "NetSnapshot");
+		T2S(GAME_EVENT_CONFIG, "Config");
+		T2S(GAME_EVENT_SCORE, "Score");
+		T2S(GAME_EVENT_SOUND_AT, "SoundAt");
+		T2S(GAME_EVENT_SCREEN_SHAKE, "ScreenShake");
+		T2S(GAME_EVENT_SET_MESSAGE, "SetMessage");
+		T2S(GAME_EVENT_GAME_START, "GameStart");
+		T2S(GAME_EVENT_GAME_BEGIN, "GameBegin");
+		T2S(GAME_EVENT_ACTOR_ADD, "ActorAdd");
+		T2S(GAME_EVENT_ACTOR_MOVE, "ActorMove");
+		T2S(GAME_EVENT_ACTOR_STATE, "ActorState");
+		T2S(GAME_EVENT_ACTOR_DIR, "ActorDir");
+		T2S(GAME_EVENT_ACTOR_SLIDE, "ActorSlide");
+		T2S(GAME_EVENT_ACTOR_IMPULSE, "ActorImpulse");
+		T2S(GAME_EVENT_ACTOR_SWITCH_GUN, "ActorSwitchGun");
+		T2S(GAME_EVENT_ACTOR_PICKUP_ALL, "ActorPickupAll");
+		T2S(GAME_EVENT_ACTOR_REPLACE_GUN, "ActorReplaceGun");
+		T2S(GAME_EVENT_ACTOR_HEAL, "ActorHeal");
+		T2S(GAME_EVENT_ACTOR_ADD_AMMO, "ActorAddAmmo");
+		T2S(GAME_EVENT_ACTOR_USE_AMMO, "ActorUseAmmo");
+		T2S(GAME_EVENT_ACTOR_DIE, "ActorDie");
+		T2S(GAME_EVENT_ACTOR_MELEE, "ActorMelee");
+		T2S(GAME_EVENT_ADD_PICKUP, "AddPickup");
+		T2S(GAME_EVENT_REMOVE_PICKUP, "RemovePickup");
+		T2S(GAME_EVENT_BULLET_BOUNCE, "BulletBounce");
+		T2S(GAME_EVENT_REMOVE_BULLET, "RemoveBullet");
+		T2S(GAME_EVENT_PARTICLE_REMOVE, "ParticleRemove");
+		T2S(GAME_EVENT_GUN_FIRE, "GunFire");
+		T2S(GAME_EVENT_GUN_RELOAD, "GunReload");
+		T2S(GAME_EVENT_GUN_STATE, "GunState");
+		T2S(GAME_EVENT_ADD_BULLET, "AddBullet");
+		T2S(GAME_EVENT_ADD_PARTICLE, "AddParticle");
+		T2S(GAME_EVENT_TRIGGER, "Trigger");
+		T2S(GAME_EVENT_EXPLORE_TILES, "ExploreTiles");
+		T2S(GAME_EVENT_RESCUE_CHARACTER, "RescueCharacter");
+		T2S(GAME_EVENT_OBJECTIVE_UPDATE, "ObjectiveUpdate");
+		T2S(GAME_EVENT_ADD_KEYS, "AddKeys");
+		T2S(GAME_EVENT_MISSION_COMPLETE, "MissionComplete");
+		T2S(GAME_EVENT_MISSION_INCOMPLETE, "MissionIncomplete");
+		T2S(GAME_EVENT_MISSION_PICKUP, "MissionPickup");
+		T2S(GAME_EVENT_MISSION_END, "MissionEnd");
+	default:
+		return "";
+	}
+}
 
+static bool SoundAtMerge(CArray *store, const GameEvent *e);
 void GameEventsEnqueue(CArray *store, GameEvent e)
 {
 	if (store->elemSize == 0)
 	{
 		return;
 	}
+	if (e.Type == GAME_EVENT_SOUND_AT && SoundAtMerge(store, &e))
+	{
+		return;
+	}
 	// If we're the server, broadcast any events that clients need
 	// If we're the client, pass along to server, but only if it's for a local player
 	// Otherwise we'd ping-pong the same updates from the server
@@ -170,6 +239,35 @@ void GameEventsEnqueue(CArray *store, GameEvent e)
 
 	CArrayPushBack(store, &e);
 }
+// Merge identical sounds close together into one queued sound event, so
+// that only one is played and sent to clients
+static bool SoundAtMerge(CArray *store, const GameEvent *e)
+{
+	const NSound *s = &e->u.SoundAt;
+	const struct vec2 pos = NetToVec2(s->Pos);
+	CA_FOREACH(GameEvent, qe, *store)
+		NSound *qs = &qe->u.SoundAt;
+		if (qe->Type != GAME_EVENT_SOUND_AT || qe->Delay != e->Delay ||
+			qs->IsHit != s->IsHit || strcmp(qs->Sound, s->Sound) != 0)
+		{
+			continue;
+		}
+		const struct vec2 qpos = NetToVec2(qs->Pos);
+		if (svec2_distance_squared(qpos, pos) >
+			SOUND_COALESCE_DISTANCE * SOUND_COALESCE_DISTANCE)
+		{
+			continue;
+		}
+		const int count = MAX(s->Count, 1);
+		const int total = MAX(qs->Count, 1) + count;
+		qs->Pos = Vec2ToNet(svec2_scale(svec2_add(
+			svec2_scale(qpos, (float)(total - count)),
+			svec2_scale(pos, (float)count)), 1.0f / total));
+		qs->Count = total;
+		return true;
+	CA_FOREACH_END()
+	return false;
+}
 static bool EventComplete(const void *elem);
 void GameEventsClear(CArray *store)
 {
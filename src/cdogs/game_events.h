@@ -54,6 +54,8 @@ typedef enum
 	GAME_EVENT_MAP_OBJECT_REMOVE,
 	GAME_EVENT_CLIENT_READY,
 	GAME_EVENT_NET_GAME_START,
+	// Late-join snapshot; fragments over the net, whole when enqueued
+	GAME_EVENT_NET_SNAPSHOT,
 
 	GAME_EVENT_CONFIG,
 	GAME_EVENT_SCORE,
@@ -107,6 +109,7 @@ typedef enum
 	GAME_EVENT_MISSION_PICKUP,
 	GAME_EVENT_MISSION_END
 } GameEventType;
+const char *GameEventTypeStr(const GameEventType e);
 
 // Which game events should be passed along to server or client
 typedef struct
@@ -146,6 +149,11 @@ typedef struct
 			int Ticks;
 		} SetMessage;
 		NGameBegin GameBegin;
+		struct
+		{
+			uint8_t *Data;
+			size_t Size;
+		} NetSnapshot;
 		NActorAdd ActorAdd;
 		NActorMove ActorMove;
 		NActorState ActorState;
@@ -72,6 +72,7 @@
 CampaignOptions gCampaign;
 
 struct MissionOptions gMission;
+MemArena gMissionArena;
 
 struct SongDef *gGameSongs = NULL;
 struct SongDef *gMenuSongs = NULL;
@@ -134,6 +135,12 @@ void MissionOptionsTerminate(struct MissionOptions *mo)
 	PickupsTerminate();
 	ParticlesTerminate(&gParticles);
 	WatchesTerminate();
+	if (gMissionArena.Stats.Allocs > 0)
+	{
+		LOG(LM_MAIN, LL_INFO, "mission arena: " MEM_ARENA_STATS_FMT,
+			MEM_ARENA_STATS_ARGS(&gMissionArena));
+	}
+	MemArenaReset(&gMissionArena);
 	CA_FOREACH(PlayerData, p, gPlayerDatas)
 		p->ActorUID = -1;
 	CA_FOREACH_END()
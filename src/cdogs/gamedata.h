@@ -52,6 +52,7 @@
 #include "character.h"
 #include "map_new.h"
 #include "map_object.h"
+#include "mem_arena.h"
 #include "pics.h"
 #include "tile.h"
 #include "weapon.h"
@@ -66,6 +67,8 @@
 
 
 extern struct MissionOptions gMission;
+// Storage for actors, objects and watches; reset when the mission ends
+extern MemArena gMissionArena;
 
 struct SongDef {
 	char path[255];
@@ -62,9 +62,11 @@
 #include <SDL_mouse.h>
 
 #include "blit.h"
+#include "blit_kernels.h"
 #include "config.h"
 #include "defs.h"
 #include "draw/drawtools.h"
+#include "draw/map_chunks.h"
 #include "grafx_bg.h"
 #include "log.h"
 #include "palette.h"
@@ -77,6 +79,7 @@ GraphicsDevice gGraphicsDevice;
 void GraphicsInit(GraphicsDevice *device, Config *c)
 {
 	memset(device, 0, sizeof *device);
+	BlitKernelsInit();
 	GraphicsConfigSetFromConfig(&device->cachedConfig, c);
 	device->cachedConfig.RestartFlags = RESTART_ALL;
 }
@@ -133,6 +136,7 @@ void GraphicsInitialize(GraphicsDevice *g)
 			windowDim.Pos = svec2i_zero();
 		}
 		LOG(LM_GFX, LL_DEBUG, "destroying previous renderer");
+		MapChunksTerminate(&gMapChunks);
 		WindowContextDestroy(&g->gameWindow);
 		WindowContextDestroy(&g->secondWindow);
 		SDL_FreeFormat(g->Format);
@@ -294,9 +298,23 @@ void GraphicsInitialize(GraphicsDevice *g)
 	g->cachedConfig.RestartFlags = 0;
 }
 
+// Set up just enough for pics to be loaded and the game simulated, without
+// creating a window; used by dedicated servers
+void GraphicsInitializeHeadless(GraphicsDevice *g)
+{
+	LOG(LM_GFX, LL_INFO, "graphics headless");
+	g->IsHeadless = true;
+	g->Format = SDL_AllocFormat(SDL_PIXELFORMAT_ARGB8888);
+	CCALLOC(g->buf, GraphicsGetMemSize(&g->cachedConfig));
+	GraphicsSetBlitClip(
+		g, 0, 0, g->cachedConfig.Res.x - 1, g->cachedConfig.Res.y - 1);
+	g->cachedConfig.RestartFlags = 0;
+}
+
 void GraphicsTerminate(GraphicsDevice *g)
 {
 	SDL_FreeSurface(g->icon);
+	MapChunksTerminate(&gMapChunks);
 	WindowContextDestroy(&g->gameWindow);
 	WindowContextDestroy(&g->secondWindow);
 	SDL_FreeFormat(g->Format);
@@ -88,6 +88,8 @@ typedef struct
 {
 	int IsInitialized;
 	int IsWindowInitialized;
+	// No window or renderer; pics are loaded without textures
+	bool IsHeadless;
 	SDL_Surface *icon;
 	SDL_Texture *screen;
 	SDL_Texture *hud;
@@ -109,6 +111,7 @@ extern GraphicsDevice gGraphicsDevice;
 
 void GraphicsInit(GraphicsDevice *device, Config *c);
 void GraphicsInitialize(GraphicsDevice *g);
+void GraphicsInitializeHeadless(GraphicsDevice *g);
 void GraphicsTerminate(GraphicsDevice *g);
 int GraphicsGetScreenSize(GraphicsConfig *config);
 int GraphicsGetMemSize(GraphicsConfig *config);
@@ -31,11 +31,13 @@
 #include "actors.h"
 #include "ai_utils.h"
 #include "damage.h"
+#include "draw/map_chunks.h"
 #include "events.h"
 #include "game_events.h"
 #include "joystick.h"
 #include "log.h"
 #include "net_server.h"
+#include "net_snapshot.h"
 #include "objs.h"
 #include "particle.h"
 #include "pickup.h"
@@ -97,6 +99,8 @@ static void HandleGameEvent(
 				Tile *t = MapGetTile(&gMap, pos);
 				t->Class = tileClass;
 				t->ClassAlt = tileClassAlt;
+				MapUpdateTileBits(&gMap, pos);
+				MapChunksInvalidateTile(&gMapChunks, pos);
 				pos.x++;
 				if (pos.x == gMap.Size.x)
 				{
@@ -106,6 +110,10 @@ static void HandleGameEvent(
 			}
 		}
 		break;
+	case GAME_EVENT_NET_SNAPSHOT:
+		NetSnapshotApply(e.u.NetSnapshot.Data, e.u.NetSnapshot.Size);
+		CFREE(e.u.NetSnapshot.Data);
+		break;
 	case GAME_EVENT_THING_DAMAGE:
 		ThingDamage(e.u.ThingDamage);
 		break;
@@ -157,11 +165,13 @@ static void HandleGameEvent(
 		}
 		break;
 	case GAME_EVENT_SOUND_AT:
+		NetServerSendMsg(
+			&gNetServer, NET_SERVER_BCAST, GAME_EVENT_SOUND_AT, &e.u.SoundAt);
 		if (!e.u.SoundAt.IsHit || ConfigGetBool(&gConfig, "Sound.Hits"))
 		{
-			SoundPlayAt(
-				&gSoundDevice,
-				StrSound(e.u.SoundAt.Sound), NetToVec2(e.u.SoundAt.Pos));
+			SoundPlayAtMerged(
+				&gSoundDevice, StrSound(e.u.SoundAt.Sound),
+				NetToVec2(e.u.SoundAt.Pos), MAX(e.u.SoundAt.Count, 1));
 		}
 		break;
 	case GAME_EVENT_SCREEN_SHAKE:
@@ -227,7 +237,8 @@ static void HandleGameEvent(
 			const struct vec2 pos = NetToVec2(e.u.ActorImpulse.Pos);
 			if (!svec2_is_zero(pos))
 			{
-				a->Pos = pos;
+				ActorSetServerPos(
+					a, pos, e.u.ActorImpulse.Seq, e.u.ActorImpulse.Ticks);
 			}
 		}
 		break;
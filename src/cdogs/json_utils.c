@@ -32,6 +32,7 @@
 #include <stdlib.h>
 
 #include "config.h"
+#include "files.h"
 #include "log.h"
 #include "weapon.h"
 #include "pic_manager.h"
@@ -234,31 +235,11 @@ bail:
 
 bool TrySaveJSONFile(json_t *node, const char *filename)
 {
-	bool res = true;
 	char *text;
 	json_tree_to_string(node, &text);
 	char *ftext = json_format_string(text);
-	FILE *f = fopen(filename, "w");
-	if (f == NULL)
-	{
-		LOG(LM_MAIN, LL_ERROR, "failed to open file(%s) for saving: %s",
-			filename, strerror(errno));
-		res = false;
-		goto bail;
-	}
-	size_t writeLen = strlen(ftext);
-	const size_t rc = fwrite(ftext, 1, writeLen, f);
-	if (rc != writeLen)
-	{
-		LOG(LM_MAIN, LL_ERROR, "Wrote (%d) of (%d) bytes: %s",
-			(int)rc, (int)writeLen, strerror(errno));
-		res = false;
-		goto bail;
-	}
-
-bail:
+	const bool res = TrySaveFileAtomic(filename, ftext, strlen(ftext));
 	CFREE(text);
 	CFREE(ftext);
-	if (f != NULL) fclose(f);
 	return res;
 }
@@ -28,6 +28,10 @@
 #include <errno.h>
 #include <stdarg.h>
 
+#include <SDL_atomic.h>
+#include <SDL_thread.h>
+#include <SDL_timer.h>
+
 #include "rlutil/rlutil.h"
 #include "utils.h"
 
@@ -110,9 +114,67 @@ LogLevel StrLogLevel(const char *s)
 #ifdef __APPLE__
 #include <os/log.h>
 #endif
+
+// Log lines are queued in a fixed-size ring shared by all threads.
+// Each slot has a sequence number saying whether it is free to be claimed
+// for a given position, or has been filled and is ready to be written.
+// Writers claim positions with a CAS on the head; there is one reader, the
+// writer thread. If the ring is full, lines are dropped and counted.
+#define LOG_QUEUE_SIZE 1024	// must be a power of 2
+#define LOG_MSG_MAX 512
+#define LOG_WRITER_SLEEP_MS 10
+typedef struct
+{
+	SDL_atomic_t Seq;
+	LogModule Module;
+	LogLevel Level;
+	const char *Filename;
+	int Line;
+	const char *Function;
+	char Msg[LOG_MSG_MAX];
+} LogRecord;
+static LogRecord sQueue[LOG_QUEUE_SIZE];
+static SDL_atomic_t sHead;
+static int sTail;	// writer thread only
+static SDL_atomic_t sNumWritten;
+static SDL_atomic_t sNumDropped;
+static int sNumDroppedReported;	// writer thread only
+static SDL_atomic_t sQuit;
+static SDL_sem *sWake;
+static SDL_Thread *sWriter;
+
+static int LogWriterRun(void *data);
 void LogInit(void)
 {
 	saveStreamDefaultColor(stderr);
+	for (int i = 0; i < LOG_QUEUE_SIZE; i++)
+	{
+		SDL_AtomicSet(&sQueue[i].Seq, i);
+	}
+	SDL_AtomicSet(&sHead, 0);
+	sTail = 0;
+	SDL_AtomicSet(&sNumWritten, 0);
+	SDL_AtomicSet(&sNumDropped, 0);
+	sNumDroppedReported = 0;
+	SDL_AtomicSet(&sQuit, 0);
+#ifndef __EMSCRIPTEN__
+	sWake = SDL_CreateSemaphore(0);
+	if (sWake != NULL)
+	{
+		sWriter = SDL_CreateThread(LogWriterRun, "log", NULL);
+	}
+	if (sWriter == NULL)
+	{
+		// Fall back to writing log lines as they come
+		if (sWake != NULL)
+		{
+			SDL_DestroySemaphore(sWake);
+			sWake = NULL;
+		}
+		LOG(LM_MAIN, LL_WARN, "cannot create log thread: %s",
+			SDL_GetError());
+	}
+#endif
 }
 void LogOpenFile(const char *filename)
 {
@@ -126,9 +188,20 @@ void LogOpenFile(const char *filename)
 }
 void LogTerminate(void)
 {
+	if (sWriter != NULL)
+	{
+		// The writer drains the queue before quitting
+		SDL_AtomicSet(&sQuit, 1);
+		SDL_SemPost(sWake);
+		SDL_WaitThread(sWriter, NULL);
+		sWriter = NULL;
+		SDL_DestroySemaphore(sWake);
+		sWake = NULL;
+	}
 	if (gLogFile != NULL)
 	{
 		fclose(gLogFile);
+		gLogFile = NULL;
 	}
 }
 
@@ -186,27 +259,13 @@ static void LogResetColor(void)
 		printf(_fmt, ##__VA_ARGS__);\
 	}
 
-#define LOG_VSTR(_level, _stream, _fmt, _args)\
-	if (_level >= LL_WARN)\
-	{\
-		vfprintf(_stream, _fmt, _args);\
-	}\
-	else\
-	{\
-		vprintf(_fmt, _args);\
-	}
-
 #else
 
 #define LOG_STR(_level, _stream, _fmt, ...)\
 	fprintf(_stream, _fmt, ##__VA_ARGS__)
-#define LOG_VSTR(_level, _stream, _fmt, _args)\
-	vfprintf(_stream, _fmt, _args)
 
 #endif
-void LogLine(
-	FILE *stream, const LogModule m, const LogLevel l, const char *filename,
-	const int line, const char *function, const char *fmt, ...)
+static void WriteRecord(FILE *stream, const LogRecord *r)
 {
 	if (stream == NULL
 #if defined(__APPLE__) && !defined(NDEBUG)
@@ -217,27 +276,25 @@ void LogLine(
 	{
 		return;
 	}
+	const LogLevel l = r->Level;
 	LogSetLevelColor(l);
 	LOG_STR(l, stream, "%-5s ", LogLevelName(l));
 	LogResetColor();
 	LOG_STR(l, stream, "[");
 	LogSetModuleColor();
-	LOG_STR(l, stream, "%-5s", LogModuleName(m));
+	LOG_STR(l, stream, "%-5s", LogModuleName(r->Module));
 	LogResetColor();
 	LOG_STR(l, stream, "] [");
 	LogSetFileColor();
-	LOG_STR(l, stream, "%s:%d", filename, line);
+	LOG_STR(l, stream, "%s:%d", r->Filename, r->Line);
 	LogResetColor();
 	LOG_STR(l, stream, "] ");
 	LogSetFuncColor();
-	LOG_STR(l, stream, "%s()", function);
+	LOG_STR(l, stream, "%s()", r->Function);
 	LogResetColor();
 	LOG_STR(l, stream, ": ");
 	LogSetLevelColor(l);
-	va_list args;
-	va_start(args, fmt);
-	LOG_VSTR(l, stream, fmt, args);
-	va_end(args);
+	LOG_STR(l, stream, "%s", r->Msg);
 	LogResetColor();
 	LOG_STR(l, stream, "\n");
 	if (l >= LL_WARN)
@@ -246,7 +303,171 @@ void LogLine(
 	}
 }
 
-void LogFlush(FILE *stream)
+static LogRecord *ClaimRecord(int *pos);
+void LogLine(
+	const LogModule m, const LogLevel l, const char *filename,
+	const int line, const char *function, const char *fmt, ...)
+{
+	LogRecord syncRecord;
+	LogRecord *r = &syncRecord;
+	int pos = 0;
+	if (sWriter != NULL)
+	{
+		for (;;)
+		{
+			r = ClaimRecord(&pos);
+			if (r != NULL)
+			{
+				break;
+			}
+			if (l < LL_WARN)
+			{
+				SDL_AtomicIncRef(&sNumDropped);
+				return;
+			}
+			// Don't drop warnings and errors; wait for the writer instead
+			SDL_SemPost(sWake);
+			SDL_Delay(1);
+		}
+	}
+	r->Module = m;
+	r->Level = l;
+	r->Filename = filename;
+	r->Line = line;
+	r->Function = function;
+	va_list args;
+	va_start(args, fmt);
+	vsnprintf(r->Msg, sizeof r->Msg, fmt, args);
+	va_end(args);
+
+	if (sWriter == NULL)
+	{
+		WriteRecord(stderr, r);
+		WriteRecord(gLogFile, r);
+		return;
+	}
+	// Publish the record for the writer
+	SDL_AtomicSet(&r->Seq, (int)((unsigned)pos + 1));
+	// Wake the writer early for important lines, or if the queue is filling
+	const int queued =
+		(int)((unsigned)pos - (unsigned)SDL_AtomicGet(&sNumWritten));
+	if (l >= LL_WARN || queued > LOG_QUEUE_SIZE / 2)
+	{
+		SDL_SemPost(sWake);
+	}
+	if (l >= LL_ERROR)
+	{
+		// Make sure errors are written in case we are about to crash
+		LogFlush();
+	}
+}
+static LogRecord *ClaimRecord(int *pos)
+{
+	int p = SDL_AtomicGet(&sHead);
+	for (;;)
+	{
+		LogRecord *r = &sQueue[p & (LOG_QUEUE_SIZE - 1)];
+		const int diff =
+			(int)((unsigned)SDL_AtomicGet(&r->Seq) - (unsigned)p);
+		if (diff == 0)
+		{
+			// Slot is free for this position; try to claim it
+			if (SDL_AtomicCAS(&sHead, p, (int)((unsigned)p + 1)))
+			{
+				*pos = p;
+				return r;
+			}
+		}
+		else if (diff < 0)
+		{
+			// Slot still holds a record from one lap ago; queue is full
+			return NULL;
+		}
+		p = SDL_AtomicGet(&sHead);
+	}
+}
+
+static int DrainQueue(void);
+static int LogWriterRun(void *data)
+{
+	UNUSED(data);
+	for (;;)
+	{
+		const bool quit = SDL_AtomicGet(&sQuit);
+		const int n = DrainQueue();
+		if (quit)
+		{
+			break;
+		}
+		if (n == 0)
+		{
+			SDL_SemWaitTimeout(sWake, LOG_WRITER_SLEEP_MS);
+		}
+	}
+	return 0;
+}
+static int DrainQueue(void)
+{
+	int n = 0;
+	for (;;)
+	{
+		LogRecord *r = &sQueue[sTail & (LOG_QUEUE_SIZE - 1)];
+		const int next = (int)((unsigned)sTail + 1);
+		if (SDL_AtomicGet(&r->Seq) != next)
+		{
+			break;
+		}
+		WriteRecord(stderr, r);
+		WriteRecord(gLogFile, r);
+		// Free the slot for the next lap
+		SDL_AtomicSet(&r->Seq, (int)((unsigned)sTail + LOG_QUEUE_SIZE));
+		sTail = next;
+		n++;
+	}
+	const int numDropped = SDL_AtomicGet(&sNumDropped);
+	if (numDropped != sNumDroppedReported)
+	{
+		LogRecord r;
+		r.Module = LM_MAIN;
+		r.Level = LL_WARN;
+		r.Filename = __FILENAME__;
+		r.Line = __LINE__;
+		r.Function = __FUNCTION__;
+		sprintf(
+			r.Msg, "log queue full; dropped %d lines",
+			numDropped - sNumDroppedReported);
+		WriteRecord(stderr, &r);
+		WriteRecord(gLogFile, &r);
+		sNumDroppedReported = numDropped;
+	}
+	if (n > 0 && gLogFile != NULL)
+	{
+		fflush(gLogFile);
+	}
+	SDL_AtomicSet(&sNumWritten, sTail);
+	return n;
+}
+
+void LogFlush(void)
+{
+	if (sWriter == NULL)
+	{
+		fflush(stderr);
+		if (gLogFile != NULL)
+		{
+			fflush(gLogFile);
+		}
+		return;
+	}
+	const int target = SDL_AtomicGet(&sHead);
+	while ((int)((unsigned)SDL_AtomicGet(&sNumWritten) - (unsigned)target) < 0)
+	{
+		SDL_SemPost(sWake);
+		SDL_Delay(1);
+	}
+}
+
+int LogGetNumDropped(void)
 {
-	fflush(stream);
+	return SDL_AtomicGet(&sNumDropped);
 }
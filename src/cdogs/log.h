@@ -62,12 +62,25 @@ const char *LogLevelName(const LogLevel l);
 LogLevel StrLogLevel(const char *s);
 
 FILE *gLogFile;
+// Log lines are queued and written to stderr and the log file by a
+// background thread, so that logging doesn't stall the game
 void LogInit(void);
 void LogOpenFile(const char *filename);
 void LogTerminate(void);
 
-// Only log the file base name
-#ifdef _WIN32
+// Levels below this are compiled out; trace logs are debug builds only
+#ifndef LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define LOG_MIN_LEVEL LL_DEBUG
+#else
+#define LOG_MIN_LEVEL LL_TRACE
+#endif
+#endif
+
+// Only log the file base name; use the compiler's if it has one
+#if defined(__FILE_NAME__)
+#define __FILENAME__ __FILE_NAME__
+#elif defined(_WIN32)
 #define __FILENAME__ (strrchr(__FILE__, '\\') ? strrchr(__FILE__, '\\') + 1 : __FILE__)
 #else
 #define __FILENAME__ (strrchr(__FILE__, '/') ? strrchr(__FILE__, '/') + 1 : __FILE__)
@@ -75,25 +88,22 @@ void LogTerminate(void);
 #define LOG(_module, _level, _fmt, ...)\
 	do\
 	{\
-		if (_level >= LogModuleGetLevel(_module))\
+		if ((int)(_level) >= (int)LOG_MIN_LEVEL &&\
+			_level >= LogModuleGetLevel(_module))\
 		{\
 			LogLine(\
-				stderr, _module, _level, __FILENAME__, __LINE__,\
-				__FUNCTION__, _fmt, ##__VA_ARGS__);\
-			LogLine(\
-				gLogFile, _module, _level, __FILENAME__, __LINE__,\
+				_module, _level, __FILENAME__, __LINE__,\
 				__FUNCTION__, _fmt, ##__VA_ARGS__);\
 		}\
 	} while ((void)0, 0)
 
-#define LOG_FLUSH()\
-	do\
-	{\
-		LogFlush(stderr);\
-		LogFlush(gLogFile);\
-	} while ((void)0, 0)
+// Wait until all queued log lines have been written
+#define LOG_FLUSH() LogFlush()
 
+// filename and function must outlive the call, e.g. string literals
 void LogLine(
-	FILE *stream, const LogModule m, const LogLevel l, const char *filename,
+	const LogModule m, const LogLevel l, const char *filename,
 	const int line, const char *function, const char *fmt, ...);
-void LogFlush(FILE *stream);
+void LogFlush(void);
+// Number of log lines dropped because the queue was full
+int LogGetNumDropped(void);
@@ -27,6 +27,8 @@
 */
 #include "los.h"
 
+#include <string.h>
+
 #include "actors.h"
 #include "algorithms.h"
 #include "game_events.h"
@@ -35,57 +37,203 @@
 
 void LOSInit(Map *map)
 {
-	CArrayInit(&map->LOS.LOS, sizeof(bool));
-	CArrayInit(&map->LOS.Explored, sizeof(bool));
-	struct vec2i v;
-	for (v.y = 0; v.y < map->Size.y; v.y++)
+	const size_t size = map->BitsStride * map->Size.y * sizeof(uint64_t);
+	map->LOS.LOS.Bits = MemArenaCalloc(&map->arena, size);
+	map->LOS.Explored.Bits = MemArenaCalloc(&map->arena, size);
+	TileBitsetReset(&map->LOS.LOS);
+	TileBitsetReset(&map->LOS.Explored);
+}
+void LOSTerminate(LineOfSight *los)
+{
+	// The bitsets are in the map arena
+	memset(los, 0, sizeof *los);
+}
+
+void TileBitsetReset(TileBitset *b)
+{
+	b->Min = svec2i_zero();
+	b->Max = svec2i(-1, -1);
+}
+static void TileBitsetExpand(
+	TileBitset *b, const struct vec2i min, const struct vec2i max)
+{
+	if (b->Min.x > b->Max.x)
 	{
-		for (v.x = 0; v.x < map->Size.x; v.x++)
-		{
-			const bool f = false;
-			CArrayPushBack(&map->LOS.LOS, &f);
-			CArrayPushBack(&map->LOS.Explored, &f);
-		}
+		b->Min = min;
+		b->Max = max;
+	}
+	else
+	{
+		b->Min = svec2i_min(b->Min, min);
+		b->Max = svec2i_max(b->Max, max);
 	}
 }
-void LOSTerminate(LineOfSight *los)
+void TileBitsetClear(const Map *map, TileBitset *b)
 {
-	CArrayTerminate(&los->LOS);
-	CArrayTerminate(&los->Explored);
+	if (b->Min.x > b->Max.x)
+	{
+		return;
+	}
+	const int w0 = b->Min.x / 64;
+	const size_t numWords = b->Max.x / 64 - w0 + 1;
+	for (int y = b->Min.y; y <= b->Max.y; y++)
+	{
+		memset(
+			&b->Bits[y * map->BitsStride + w0], 0,
+			numWords * sizeof *b->Bits);
+	}
+	TileBitsetReset(b);
 }
 
 // Reset lines of sight by setting all cells to unseen
-void LOSReset(LineOfSight *los)
+void LOSReset(Map *map)
 {
-	CArrayFillZero(&los->LOS);
-	CArrayFillZero(&los->Explored);
+	TileBitsetClear(map, &map->LOS.LOS);
+	TileBitsetClear(map, &map->LOS.Explored);
 }
-void LOSSetAllVisible(LineOfSight *los)
+void LOSSetAllVisible(Map *map)
 {
-	CA_FOREACH(bool, l, los->LOS)
-		*l = true;
-	CA_FOREACH_END()
+	if (map->Size.x == 0 || map->Size.y == 0)
+	{
+		return;
+	}
+	// Only set bits for tiles in the map
+	const int lastBits = map->Size.x % 64;
+	const uint64_t lastMask =
+		lastBits == 0 ? ~(uint64_t)0 : ((uint64_t)1 << lastBits) - 1;
+	for (int y = 0; y < map->Size.y; y++)
+	{
+		uint64_t *row = &map->LOS.LOS.Bits[y * map->BitsStride];
+		memset(row, 0xff, map->BitsStride * sizeof *row);
+		row[map->BitsStride - 1] = lastMask;
+	}
+	TileBitsetExpand(
+		&map->LOS.LOS, svec2i_zero(), svec2i_subtract(map->Size, svec2i(1, 1)));
 }
 
 typedef struct
 {
-	Map *Map;
+	const Map *Map;
 	struct vec2i Center;
+	int SightRange;
 	int SightRange2;
-	bool Explore;
+	TileBitset *LOS;
+	// Newly explored tiles; NULL if not exploring
+	TileBitset *Explored;
+	// Mark actors in sight as visible, for AI
+	bool SetActorsVisible;
 } LOSData;
 // Calculate LOS cells from a certain start position
-// Sight range based on config
-static void SetLOSVisible(Map *map, const struct vec2i pos, const bool explore);
+static void CalcLOS(LOSData *data);
+static void AddExploreRun(
+	GameEvent *e, const struct vec2i tile, const int len, const bool extend);
+void LOSCalcFrom(Map *map, const struct vec2i pos, const bool explore)
+{
+	TileBitset *explored = &map->LOS.Explored;
+	TileBitsetClear(map, explored);
+
+	LOSData data;
+	data.Map = map;
+	data.Center = pos;
+	// Sight range based on config
+	data.SightRange = ConfigGetInt(&gConfig, "Game.SightRange");
+	data.LOS = &map->LOS.LOS;
+	data.Explored = explore ? explored : NULL;
+	data.SetActorsVisible = true;
+	CalcLOS(&data);
+	if (data.SightRange == 0) return;
+
+	// Find all the newly visible tiles and set events for them
+	// Scan the explored bits a word at a time, extracting runs of set bits
+	GameEvent e = GameEventNew(GAME_EVENT_EXPLORE_TILES);
+	e.u.ExploreTiles.Runs_count = 0;
+	for (int y = explored->Min.y; y <= explored->Max.y; y++)
+	{
+		// Runs continue across words, but not rows
+		int runEnd = -1;
+		for (int i = explored->Min.x / 64; i <= explored->Max.x / 64; i++)
+		{
+			uint64_t w = explored->Bits[y * map->BitsStride + i];
+			while (w)
+			{
+				const int start = CountTrailingZeros64(w);
+				const uint64_t rest = ~(w >> start);
+				const int len = rest == 0 ? 64 : CountTrailingZeros64(rest);
+				const int x = i * 64 + start;
+				AddExploreRun(&e, svec2i(x, y), len, x == runEnd);
+				runEnd = x + len;
+				if (len == 64)
+				{
+					break;
+				}
+				w &= ~((((uint64_t)1 << len) - 1) << start);
+			}
+		}
+	}
+	if (e.u.ExploreTiles.Runs_count > 0)
+	{
+		GameEventsEnqueue(&gGameEvents, e);
+	}
+	TileBitsetClear(map, explored);
+}
+static void AddExploreRun(
+	GameEvent *e, const struct vec2i tile, const int len, const bool extend)
+{
+	NExploreTiles *runs = &e->u.ExploreTiles;
+	if (extend)
+	{
+		runs->Runs[runs->Runs_count - 1].Run += len;
+		return;
+	}
+	// If we have too many runs, send off the event and start a new one
+	if (runs->Runs_count == sizeof runs->Runs / sizeof runs->Runs[0])
+	{
+		GameEventsEnqueue(&gGameEvents, *e);
+		runs->Runs_count = 0;
+	}
+	runs->Runs_count++;
+	runs->Runs[runs->Runs_count - 1].Tile = Vec2i2Net(tile);
+	runs->Runs[runs->Runs_count - 1].Run = len;
+}
+void LOSCalcView(
+	const Map *map, TileBitset *los, const struct vec2i pos,
+	const int sightRange)
+{
+	LOSData data;
+	data.Map = map;
+	data.Center = pos;
+	data.SightRange = sightRange;
+	data.LOS = los;
+	data.Explored = NULL;
+	data.SetActorsVisible = false;
+	CalcLOS(&data);
+}
+static void SetLOSVisible(const LOSData *data, const struct vec2i pos);
 static bool IsNextTileBlockedAndSetVisibility(void *data, struct vec2i pos);
 static void SetObstructionVisible(
-	Map *map, const struct vec2i pos, const bool explore);
-void LOSCalcFrom(Map *map, const struct vec2i pos, const bool explore)
+	const LOSData *data, const struct vec2i pos);
+static void CalcLOS(LOSData *data)
 {
 	// Perform LOS by casting rays from the centre to the edges, terminating
 	// whenever an obstruction or out-of-range is reached.
+	const struct vec2i pos = data->Center;
 
-	CArrayFillZero(&map->LOS.Explored);
+	// All the tiles we may set are within sight range of the center
+	const int boxRange = MAX(data->SightRange, 1);
+	const struct vec2i boxMin = svec2i_max(
+		svec2i_subtract(pos, svec2i(boxRange, boxRange)), svec2i_zero());
+	const struct vec2i boxMax = svec2i_min(
+		svec2i_add(pos, svec2i(boxRange, boxRange)),
+		svec2i_subtract(data->Map->Size, svec2i(1, 1)));
+	if (boxMin.x > boxMax.x || boxMin.y > boxMax.y)
+	{
+		return;
+	}
+	TileBitsetExpand(data->LOS, boxMin, boxMax);
+	if (data->Explored != NULL)
+	{
+		TileBitsetExpand(data->Explored, boxMin, boxMax);
+	}
 
 	// First mark center tile and all adjacent tiles as visible
 	// +-+-+-+
@@ -100,28 +248,24 @@ void LOSCalcFrom(Map *map, const struct vec2i pos, const bool explore)
 	{
 		for (end.y = pos.y - 1; end.y <= pos.y + 1; end.y++)
 		{
-			SetLOSVisible(map, end, explore);
+			SetLOSVisible(data, end);
 		}
 	}
 
-	const int sightRange = ConfigGetInt(&gConfig, "Game.SightRange");
+	const int sightRange = data->SightRange;
 	if (sightRange == 0) return;
 
 	// Limit the perimeter to the sight range
 	const struct vec2i origin = svec2i(pos.x - sightRange, pos.y - sightRange);
 	const struct vec2i perimSize = svec2i_scale(svec2i_subtract(pos, origin), 2);
 
-	LOSData data;
-	data.Map = map;
-	data.Center = pos;
-	data.SightRange2 = sightRange * sightRange;
-	data.Explore = explore;
+	data->SightRange2 = sightRange * sightRange;
 
 	// Start from the top-left cell, and proceed clockwise around
 	end = origin;
 	HasClearLineData lineData;
 	lineData.IsBlocked = IsNextTileBlockedAndSetVisibility;
-	lineData.data = &data;
+	lineData.data = data;
 	// Top edge
 	for (; end.x < origin.x + perimSize.x; end.x++)
 	{
@@ -150,55 +294,37 @@ void LOSCalcFrom(Map *map, const struct vec2i pos, const bool explore)
 	{
 		for (end.x = origin.x; end.x < origin.x + perimSize.x; end.x++)
 		{
-			const Tile *tile = MapGetTile(map, end);
-			if (!tile || !TileIsOpaque(tile))
+			if (!MapIsTileIn(data->Map, end) ||
+				!MapTileBit(data->Map, MAP_BITS_OPAQUE, end))
 			{
 				continue;
 			}
 			// Check sight range
-			if (svec2i_distance_squared(pos, end) >= data.SightRange2)
+			if (svec2i_distance_squared(pos, end) >= data->SightRange2)
 			{
 				continue;
 			}
-			SetObstructionVisible(map, end, explore);
+			SetObstructionVisible(data, end);
 		}
 	}
-
-	// Find all the newly visible tiles and set events for them
-	GameEvent e = GameEventNew(GAME_EVENT_EXPLORE_TILES);
-	e.u.ExploreTiles.Runs_count = 0;
-	e.u.ExploreTiles.Runs[0].Run = 0;
-	bool run = false;
-	for (end.y = 0; end.y < map->Size.y; end.y++)
+}
+static void SetLOSVisible(const LOSData *data, const struct vec2i pos)
+{
+	if (!MapIsTileIn(data->Map, pos)) return;
+	MapBitsSet(data->Map, data->LOS->Bits, pos);
+	if (data->Explored == NULL && !data->SetActorsVisible)
 	{
-		for (end.x = 0; end.x < map->Size.x; end.x++)
-		{
-			if (LOSAddRun(
-				&e.u.ExploreTiles, &run, end,
-				*((bool *)CArrayGet(&map->LOS.Explored, end.y * map->Size.x + end.x))))
-			{
-				GameEventsEnqueue(&gGameEvents, e);
-				e.u.ExploreTiles.Runs_count = 0;
-				e.u.ExploreTiles.Runs[0].Run = 0;
-				run = false;
-			}
-		}
+		return;
 	}
-	if (e.u.ExploreTiles.Runs_count > 0)
+	const Tile *t = MapGetTile(data->Map, pos);
+	if (!t->isVisited && data->Explored != NULL)
 	{
-		GameEventsEnqueue(&gGameEvents, e);
+		// Cache the newly explored tile
+		MapBitsSet(data->Map, data->Explored->Bits, pos);
 	}
-	CArrayFillZero(&map->LOS.Explored);
-}
-static void SetLOSVisible(Map *map, const struct vec2i pos, const bool explore)
-{
-	const Tile *t = MapGetTile(map, pos);
-	if (t == NULL) return;
-	*((bool *)CArrayGet(&map->LOS.LOS, pos.y * map->Size.x + pos.x)) = true;
-	if (!t->isVisited && explore)
+	if (!data->SetActorsVisible)
 	{
-		// Cache the newly explored tile
-		*((bool *)CArrayGet(&map->LOS.Explored, pos.y * map->Size.x + pos.x)) = true;
+		return;
 	}
 	// Mark any actors on this tile as visible
 	// This affects some AI
@@ -213,70 +339,43 @@ static void SetLOSVisible(Map *map, const struct vec2i pos, const bool explore)
 }
 static bool IsNextTileBlockedAndSetVisibility(void *data, struct vec2i pos)
 {
-	LOSData *lData = data;
+	const LOSData *lData = data;
 	// Check sight range
 	if (svec2i_distance_squared(lData->Center, pos) >= lData->SightRange2) return true;
 	// Check map range
-	const Tile *t = MapGetTile(lData->Map, pos);
-	if (t == NULL) return true;
-	SetLOSVisible(lData->Map, pos, lData->Explore);
+	if (!MapIsTileIn(lData->Map, pos)) return true;
+	SetLOSVisible(lData, pos);
 	// Check if this tile is an obstruction
-	return TileIsOpaque(t);
+	return MapTileBit(lData->Map, MAP_BITS_OPAQUE, pos);
 }
-static bool IsTileVisibleNonObstruction(Map *map, const struct vec2i pos);
+static bool IsTileVisibleNonObstruction(
+	const LOSData *data, const struct vec2i pos);
 static void SetObstructionVisible(
-	Map *map, const struct vec2i pos, const bool explore)
+	const LOSData *data, const struct vec2i pos)
 {
 	struct vec2i d;
 	for (d.x = -1; d.x < 2; d.x++)
 	{
 		for (d.y = -1; d.y < 2; d.y++)
 		{
-			if (IsTileVisibleNonObstruction(map, svec2i_add(pos, d)))
+			if (IsTileVisibleNonObstruction(data, svec2i_add(pos, d)))
 			{
-				SetLOSVisible(map, pos, explore);
+				SetLOSVisible(data, pos);
 				return;
 			}
 		}
 	}
 }
-static bool IsTileVisibleNonObstruction(Map *map, const struct vec2i pos)
+static bool IsTileVisibleNonObstruction(
+	const LOSData *data, const struct vec2i pos)
 {
-	const Tile *t = MapGetTile(map, pos);
-	if (t == NULL) return false;
-	return !TileIsOpaque(t) && LOSTileIsVisible(map, pos);
-}
-
-bool LOSAddRun(
-	NExploreTiles *runs, bool *run, const struct vec2i tile, const bool explored)
-{
-	if (explored)
-	{
-		if (!*run)
-		{
-			// Start of new run
-			runs->Runs_count++;
-			runs->Runs[runs->Runs_count - 1].Tile = Vec2i2Net(tile);
-			runs->Runs[runs->Runs_count - 1].Run = 0;
-		}
-		runs->Runs[runs->Runs_count - 1].Run++;
-		*run = true;
-	}
-	else
-	{
-		// End of run
-		// If we have too many runs, send off the event and start a new one
-		if (runs->Runs_count == sizeof runs->Runs / sizeof runs->Runs[0])
-		{
-			return true;
-		}
-		*run = false;
-	}
-	return false;
+	if (!MapIsTileIn(data->Map, pos)) return false;
+	return !MapTileBit(data->Map, MAP_BITS_OPAQUE, pos) &&
+		MapBitsGet(data->Map, data->LOS->Bits, pos);
 }
 
 bool LOSTileIsVisible(Map *map, const struct vec2i pos)
 {
-	if (MapGetTile(map, pos) == NULL) return false;
-	return *((bool *)CArrayGet(&map->LOS.LOS, pos.y * map->Size.x + pos.x));
+	if (!MapIsTileIn(map, pos)) return false;
+	return MapBitsGet(map, map->LOS.LOS.Bits, pos);
 }
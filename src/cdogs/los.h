@@ -34,12 +34,18 @@
 
 void LOSInit(Map *map);
 void LOSTerminate(LineOfSight *los);
-void LOSReset(LineOfSight *los);
-void LOSSetAllVisible(LineOfSight *los);
+void LOSReset(Map *map);
+void LOSSetAllVisible(Map *map);
 void LOSCalcFrom(Map *map, const struct vec2i pos, const bool explore);
+// Add the tiles visible from pos to a separate LOS bitset, without exploring
+// or marking actors visible; safe to call from other threads
+void LOSCalcView(
+	const Map *map, TileBitset *los, const struct vec2i pos,
+	const int sightRange);
+
+// Mark a bitset as empty, without touching its bits
+void TileBitsetReset(TileBitset *b);
+// Clear the bits that were set, and mark it as empty
+void TileBitsetClear(const Map *map, TileBitset *b);
 
-// Helper function for populating explore tiles runs
-// Returns true if the runs have filled
-bool LOSAddRun(
-	NExploreTiles *runs, bool *run, const struct vec2i tile, const bool explored);
 bool LOSTileIsVisible(Map *map, const struct vec2i pos);
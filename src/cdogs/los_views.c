@@ -0,0 +1,233 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+
+    Copyright (c) 2018 Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "los_views.h"
+
+#include <string.h>
+
+#include "config.h"
+#include "log.h"
+#include "los.h"
+
+
+void LOSViewsInit(LOSViews *v)
+{
+	memset(v, 0, sizeof *v);
+	for (int i = 0; i < LOS_VIEWS_MAX; i++)
+	{
+		CArrayInit(&v->Views[i].bits, sizeof(uint64_t));
+	}
+}
+static void WorkerTerminate(LOSWorker *w);
+void LOSViewsTerminate(LOSViews *v)
+{
+	for (int i = 0; i < v->numWorkers; i++)
+	{
+		WorkerTerminate(&v->workers[i]);
+	}
+	for (int i = 0; i < LOS_VIEWS_MAX; i++)
+	{
+		CArrayTerminate(&v->Views[i].bits);
+	}
+	memset(v, 0, sizeof *v);
+}
+static void WorkerTerminate(LOSWorker *w)
+{
+	w->Quit = true;
+	SDL_SemPost(w->Start);
+	SDL_WaitThread(w->Thread, NULL);
+	SDL_DestroySemaphore(w->Start);
+	SDL_DestroySemaphore(w->Done);
+}
+
+void LOSViewsReset(LOSViews *v)
+{
+	for (int i = 0; i < LOS_VIEWS_MAX; i++)
+	{
+		v->Views[i].NumViewers = 0;
+		v->Views[i].UseMapLOS = true;
+	}
+}
+void LOSViewAddViewer(LOSView *v, const struct vec2i tile)
+{
+	CASSERT(v->NumViewers < MAX_LOCAL_PLAYERS, "too many LOS viewers");
+	v->Viewers[v->NumViewers] = tile;
+	v->NumViewers++;
+}
+
+static bool ViewNeedsCalc(const LOSView *v, const Map *map, const int time);
+static void ViewCalc(LOSView *v, const Map *map, const int sightRange);
+static bool StartWorkers(LOSViews *v, const int n);
+void LOSViewsCalc(LOSViews *v, const Map *map, const int time)
+{
+	v->map = map;
+	v->sightRange = ConfigGetInt(&gConfig, "Game.SightRange");
+	LOSView *jobs[LOS_VIEWS_MAX];
+	int numJobs = 0;
+	for (int i = 0; i < LOS_VIEWS_MAX; i++)
+	{
+		LOSView *view = &v->Views[i];
+		if (!ViewNeedsCalc(view, map, time))
+		{
+			continue;
+		}
+		memcpy(
+			view->lastViewers, view->Viewers,
+			view->NumViewers * sizeof view->Viewers[0]);
+		view->lastNumViewers = view->NumViewers;
+		view->lastTime = time;
+		view->lastMap = map;
+		jobs[numJobs] = view;
+		numJobs++;
+	}
+	if (numJobs == 0)
+	{
+		return;
+	}
+
+	// Hand all but the first view to workers; the map must not be modified
+	// until they are done
+	int numParallel = 0;
+	if (numJobs > 1 && StartWorkers(v, numJobs - 1))
+	{
+		numParallel = numJobs - 1;
+	}
+	for (int i = 0; i < numParallel; i++)
+	{
+		v->workers[i].Job = jobs[i + 1];
+		SDL_SemPost(v->workers[i].Start);
+	}
+	ViewCalc(jobs[0], map, v->sightRange);
+	for (int i = numParallel + 1; i < numJobs; i++)
+	{
+		ViewCalc(jobs[i], map, v->sightRange);
+	}
+	for (int i = 0; i < numParallel; i++)
+	{
+		SDL_SemWait(v->workers[i].Done);
+	}
+}
+static bool ViewNeedsCalc(const LOSView *v, const Map *map, const int time)
+{
+	if (v->UseMapLOS)
+	{
+		return false;
+	}
+	// Tiles can change during any tick, e.g. doors opening
+	return v->lastMap != map || v->lastTime != time ||
+		v->bits.size != (size_t)(map->BitsStride * map->Size.y) ||
+		v->lastNumViewers != v->NumViewers ||
+		memcmp(
+			v->lastViewers, v->Viewers,
+			v->NumViewers * sizeof v->Viewers[0]) != 0;
+}
+static void ViewCalc(LOSView *v, const Map *map, const int sightRange)
+{
+	const size_t size = map->BitsStride * map->Size.y;
+	if (v->bits.size != size)
+	{
+		CArrayResize(&v->bits, size, NULL);
+		CArrayFillZero(&v->bits);
+		TileBitsetReset(&v->LOS);
+	}
+	v->LOS.Bits = v->bits.data;
+	// Only the tiles seen last time need clearing
+	TileBitsetClear(map, &v->LOS);
+	for (int i = 0; i < v->NumViewers; i++)
+	{
+		LOSCalcView(map, &v->LOS, v->Viewers[i], sightRange);
+	}
+}
+static int WorkerRun(void *data);
+static bool StartWorkers(LOSViews *v, const int n)
+{
+	for (; v->numWorkers < n; v->numWorkers++)
+	{
+		LOSWorker *w = &v->workers[v->numWorkers];
+		memset(w, 0, sizeof *w);
+		w->Owner = v;
+		w->Start = SDL_CreateSemaphore(0);
+		w->Done = SDL_CreateSemaphore(0);
+		if (w->Start == NULL || w->Done == NULL)
+		{
+			LOG(LM_MAIN, LL_ERROR, "cannot create semaphore: %s",
+				SDL_GetError());
+			goto bail;
+		}
+		w->Thread = SDL_CreateThread(WorkerRun, "LOS", w);
+		if (w->Thread == NULL)
+		{
+			LOG(LM_MAIN, LL_ERROR, "cannot create LOS thread: %s",
+				SDL_GetError());
+			goto bail;
+		}
+	}
+	return true;
+
+bail:
+	{
+		LOSWorker *w = &v->workers[v->numWorkers];
+		if (w->Start != NULL)
+		{
+			SDL_DestroySemaphore(w->Start);
+		}
+		if (w->Done != NULL)
+		{
+			SDL_DestroySemaphore(w->Done);
+		}
+		memset(w, 0, sizeof *w);
+	}
+	return false;
+}
+static int WorkerRun(void *data)
+{
+	LOSWorker *w = data;
+	const LOSViews *v = w->Owner;
+	for (;;)
+	{
+		SDL_SemWait(w->Start);
+		if (w->Quit)
+		{
+			break;
+		}
+		ViewCalc(w->Job, v->map, v->sightRange);
+		SDL_SemPost(w->Done);
+	}
+	return 0;
+}
+
+const TileBitset *LOSViewsGet(
+	const LOSViews *v, const Map *map, const int view)
+{
+	const LOSView *lv = &v->Views[view];
+	if (lv->UseMapLOS)
+	{
+		return &map->LOS.LOS;
+	}
+	return &lv->LOS;
+}
@@ -0,0 +1,89 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+
+    Copyright (c) 2018 Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <SDL_thread.h>
+
+#include "map.h"
+#include "player.h"
+
+#define LOS_VIEWS_MAX MAX_LOCAL_PLAYERS
+
+// Line of sight for one split screen view, separate from the map's LOS
+// which the simulation uses
+typedef struct
+{
+	CArray bits;	// of uint64_t, storage for LOS
+	TileBitset LOS;
+	// Tiles of the players this view sees from
+	struct vec2i Viewers[MAX_LOCAL_PLAYERS];
+	int NumViewers;
+	// Use the map's LOS instead, if it was calculated from the same players;
+	// otherwise a view with no viewers sees nothing
+	bool UseMapLOS;
+	// Skip recalculating if nothing has changed since
+	struct vec2i lastViewers[MAX_LOCAL_PLAYERS];
+	int lastNumViewers;
+	int lastTime;
+	const Map *lastMap;
+} LOSView;
+
+struct LOSViews;
+typedef struct
+{
+	const struct LOSViews *Owner;
+	SDL_Thread *Thread;
+	SDL_sem *Start;
+	SDL_sem *Done;
+	LOSView *Job;
+	bool Quit;
+} LOSWorker;
+
+typedef struct LOSViews
+{
+	LOSView Views[LOS_VIEWS_MAX];
+	// Views are calculated in parallel; the calling thread takes one
+	LOSWorker workers[LOS_VIEWS_MAX - 1];
+	int numWorkers;
+	const Map *map;
+	int sightRange;
+} LOSViews;
+
+void LOSViewsInit(LOSViews *v);
+void LOSViewsTerminate(LOSViews *v);
+
+// Clear the viewers of all views, before adding the ones for this frame;
+// views use the map's LOS until they are given their own
+void LOSViewsReset(LOSViews *v);
+void LOSViewAddViewer(LOSView *v, const struct vec2i tile);
+// Recalculate all views with viewers that have changed since the last time
+void LOSViewsCalc(LOSViews *v, const Map *map, const int time);
+// Get the visibility of a view, one bit per map tile
+const TileBitset *LOSViewsGet(
+	const LOSViews *v, const Map *map, const int view);
@@ -57,6 +57,7 @@
 #include "collision/collision.h"
 #include "config.h"
 #include "door.h"
+#include "draw/map_chunks.h"
 #include "game_events.h"
 #include "gamedata.h"
 #include "log.h"
@@ -127,6 +128,53 @@ bool MapIsTileIn(const Map *map, const struct vec2i pos)
 	return !(pos.x < 0 || pos.y < 0 ||
 		pos.x > map->Size.x - 1 || pos.y > map->Size.y - 1);
 }
+
+static void SetTileBit(
+	Map *map, const MapBitsType type, const struct vec2i pos, const bool v)
+{
+	if (v)
+	{
+		MapBitsSet(map, map->Bits[type], pos);
+	}
+	else
+	{
+		map->Bits[type][MAP_BITS_WORD(map, pos)] &= ~MAP_BITS_MASK(pos);
+	}
+}
+void MapUpdateTileBits(Map *map, const struct vec2i pos)
+{
+	const Tile *t = MapGetTile(map, pos);
+	if (t == NULL || t->Class == NULL)
+	{
+		return;
+	}
+	SetTileBit(map, MAP_BITS_WALK, pos, TileCanWalk(t));
+	SetTileBit(map, MAP_BITS_OPAQUE, pos, TileIsOpaque(t));
+	SetTileBit(map, MAP_BITS_SHOOT, pos, TileIsShootable(t));
+	SetTileBit(map, MAP_BITS_DOOR, pos, t->Class->Type == TILE_CLASS_DOOR);
+}
+void MapUpdateAllTileBits(Map *map)
+{
+	struct vec2i v;
+	for (v.y = 0; v.y < map->Size.y; v.y++)
+	{
+		for (v.x = 0; v.x < map->Size.x; v.x++)
+		{
+			MapUpdateTileBits(map, v);
+		}
+	}
+}
+int MapCountTileBits(const Map *map, const MapBitsType type)
+{
+	// Bits past the end of each row are never set, so count whole words
+	int count = 0;
+	const int numWords = map->BitsStride * map->Size.y;
+	for (int i = 0; i < numWords; i++)
+	{
+		count += CountBits64(map->Bits[type][i]);
+	}
+	return count;
+}
 static bool MapIsPosIn(const Map *map, const struct vec2 pos)
 {
 	// Check that the pos is within the interior of the map
@@ -155,7 +203,6 @@ bool MapTryMoveThing(Map *map, Thing *t, const struct vec2 pos)
 	{
 		return false;
 	}
-	t->LastPos = t->Pos;
 	// When first initialised, position is -1
 	const bool doRemove = t->Pos.x >= 0 && t->Pos.y >= 0;
 	const struct vec2i t1 = Vec2ToTile(t->Pos);
@@ -163,7 +210,7 @@ bool MapTryMoveThing(Map *map, Thing *t, const struct vec2 pos)
 	// If we'll be in the same tile, do nothing
 	if (svec2i_is_equal(t1, t2) && doRemove)
 	{
-		t->Pos = pos;
+		ThingSetPos(t, pos);
 		return true;
 	}
 	// Moving; remove from old tile...
@@ -172,7 +219,7 @@ bool MapTryMoveThing(Map *map, Thing *t, const struct vec2 pos)
 		MapRemoveThing(map, t);
 	}
 	// ...move and add to new tile
-	t->Pos = pos;
+	ThingSetPos(t, pos);
 	AddItemToTile(t, MapGetTile(map, t2));
 	return true;
 }
@@ -236,13 +283,11 @@ static void MapChangeFloor(
 	{
 		return;
 	}
-	if (!canSeeTileAbove)
+	const TileClass *tc = canSeeTileAbove ? normal : shadow;
+	if (t->Class != tc)
 	{
-		t->Class = shadow;
-	}
-	else
-	{
-		t->Class = normal;
+		t->Class = tc;
+		MapChunksInvalidateTile(&gMapChunks, pos);
 	}
 }
 
@@ -438,49 +483,57 @@ int MapGetDoorKeycardFlag(Map *map, struct vec2i pos)
 	return MapGetAccessLevel(map, svec2i(pos.x, pos.y + 1));
 }
 
-void MapTerminate(Map *map)
+// Tiles, triggers and their arrays are all in the map arena; they are
+// released together when the arena is reset or terminated
+static void MapRelease(Map *map)
 {
-	CA_FOREACH(Trigger *, t, map->triggers)
-		TriggerTerminate(*t);
-	CA_FOREACH_END()
-	CArrayTerminate(&map->triggers);
-	struct vec2i v;
-	for (v.y = 0; v.y < map->Size.y; v.y++)
+	if (map->arena.Stats.Allocs > 0)
 	{
-		for (v.x = 0; v.x < map->Size.x; v.x++)
-		{
-			Tile *t = MapGetTile(map, v);
-			TileDestroy(t);
-		}
+		LOG(LM_MAP, LL_INFO, "map arena: " MEM_ARENA_STATS_FMT,
+			MEM_ARENA_STATS_ARGS(&map->arena));
 	}
-	CArrayTerminate(&map->Tiles);
 	LOSTerminate(&map->LOS);
-	CArrayTerminate(&map->access);
 	PathCacheTerminate(&gPathCache);
 }
+void MapTerminate(Map *map)
+{
+	MapRelease(map);
+	MemArenaTerminate(&map->arena);
+	memset(map, 0, sizeof *map);
+}
 
 void MapInit(Map *map, const struct vec2i size)
 {
-	MapTerminate(map);
+	MapRelease(map);
 
-	// Init map
+	// Init map, keeping the arena's blocks from the last map
+	MemArena arena = map->arena;
+	MemArenaReset(&arena);
 	memset(map, 0, sizeof *map);
-	CArrayInit(&map->Tiles, sizeof(Tile));
+	map->arena = arena;
+	CArrayInitArena(&map->Tiles, sizeof(Tile), &map->arena);
 	map->Size = size;
-	LOSInit(map);
-	CArrayInit(&map->access, sizeof(uint16_t));
+	CArrayInitArena(&map->access, sizeof(uint16_t), &map->arena);
 	CArrayResize(&map->access, size.x * size.y, NULL);
 	CArrayFillZero(&map->access);
-	CArrayInit(&map->triggers, sizeof(Trigger *));
+	CArrayInitArena(&map->triggers, sizeof(Trigger *), &map->arena);
+	map->BitsStride = (size.x + 63) / 64;
+	for (int i = 0; i < MAP_BITS_COUNT; i++)
+	{
+		map->Bits[i] = MemArenaCalloc(
+			&map->arena, map->BitsStride * size.y * sizeof(uint64_t));
+	}
+	LOSInit(map);
 	PathCacheInit(&gPathCache, map);
 
+	CArrayReserve(&map->Tiles, size.x * size.y);
 	struct vec2i v;
 	for (v.y = 0; v.y < map->Size.y; v.y++)
 	{
 		for (v.x = 0; v.x < map->Size.x; v.x++)
 		{
 			Tile t;
-			TileInit(&t);
+			TileInit(&t, &map->arena);
 			CArrayPushBack(&map->Tiles, &t);
 		}
 	}
@@ -624,7 +677,7 @@ bool MapTileIsUnexplored(Map *map, struct vec2i tile)
 // Only creates the trigger, but does not place it
 Trigger *MapNewTrigger(Map *map)
 {
-	Trigger *t = TriggerNew();
+	Trigger *t = TriggerNew(&map->arena);
 	CArrayPushBack(&map->triggers, &t);
 	t->id = map->triggerId++;
 	return t;
@@ -51,6 +51,7 @@
 #include <stdbool.h>
 
 #include "map_object.h"
+#include "mem_arena.h"
 #include "mission.h"
 #include "pic.h"
 #include "thing.h"
@@ -80,20 +81,48 @@ IMapType StrIMapType(const char *s);
 #define MAP_MASKACCESS      0xFF
 #define MAP_ACCESSBITS      0x0F00
 
+// Bitset of one bit per map tile, laid out like the map's bitplanes
 typedef struct
 {
-	// Array of bools to set lines of sight
-	CArray LOS;	// of bool
+	uint64_t *Bits;
+	// Box of tiles that may have bits set, so that clearing only touches
+	// those; empty if Min > Max
+	struct vec2i Min;
+	struct vec2i Max;
+} TileBitset;
 
-	// Array of bools for tracking new tiles in line of sight, for delayed messaging
-	CArray Explored; // of bool
+typedef struct
+{
+	// Tiles in line of sight
+	TileBitset LOS;
+
+	// New tiles in line of sight, for delayed messaging
+	TileBitset Explored;
 } LineOfSight;
 
+// Per-tile flags, packed into bitplanes of one bit per tile so that hot
+// queries (collision, LOS, pathfinding) don't have to go through the tile
+// and its class. Each row starts on a new 64-bit word.
+typedef enum
+{
+	MAP_BITS_WALK,
+	MAP_BITS_OPAQUE,
+	MAP_BITS_SHOOT,
+	MAP_BITS_DOOR,
+	MAP_BITS_COUNT
+} MapBitsType;
+
 typedef struct
 {
+	// Storage for everything below that lives as long as the map
+	MemArena arena;
+
 	CArray Tiles;	// of Tile
 	struct vec2i Size;
 
+	uint64_t *Bits[MAP_BITS_COUNT];
+	int BitsStride;	// words per row
+
 	LineOfSight LOS;
 	CArray access;	// of uint16_t
 
@@ -115,6 +144,20 @@ uint16_t GetAccessMask(const int k);
 
 Tile *MapGetTile(const Map *map, const struct vec2i pos);
 bool MapIsTileIn(const Map *map, const struct vec2i pos);
+
+// Access a tile's bit in a bitplane or TileBitset; pos must be in the map
+#define MAP_BITS_WORD(_map, _pos) ((_pos).y * (_map)->BitsStride + (_pos).x / 64)
+#define MAP_BITS_MASK(_pos) ((uint64_t)1 << ((_pos).x % 64))
+#define MapBitsGet(_map, _bits, _pos)\
+	(((_bits)[MAP_BITS_WORD(_map, _pos)] & MAP_BITS_MASK(_pos)) != 0)
+#define MapBitsSet(_map, _bits, _pos)\
+	((_bits)[MAP_BITS_WORD(_map, _pos)] |= MAP_BITS_MASK(_pos))
+#define MapTileBit(_map, _type, _pos)\
+	MapBitsGet(_map, (_map)->Bits[_type], _pos)
+// Sync bitplanes after changing a tile's class
+void MapUpdateTileBits(Map *map, const struct vec2i pos);
+void MapUpdateAllTileBits(Map *map);
+int MapCountTileBits(const Map *map, const MapBitsType type);
 bool MapIsTileInExit(const Map *map, const Thing *ti);
 
 // TODO: remove this function
@@ -258,11 +258,32 @@ end:
 }
 
 
-static json_t *SaveMissions(CArray *a);
-int MapArchiveSave(const char *filename, CampaignSetting *c)
+// A copy of a campaign as it will be written, so that it can be written
+// without the original, e.g. on another thread.
+// Everything except static tiles is formatted up front; tiles are copied
+// and streamed straight into the output when writing.
+typedef struct
 {
-	int res = 1;
-	json_t *root = NULL;
+	// Formatted mission, with an empty "Tiles" array for static missions
+	char *Text;
+	int Width;
+	CArray Tiles;	// of uint16_t
+} MissionSnapshot;
+struct MapArchiveSnapshot
+{
+	char Path[CDOGS_PATH_MAX];
+	char *Campaign;
+	char *Characters;
+	CArray Missions;	// of MissionSnapshot
+};
+
+static char *FormatJSON(json_t *root);
+static json_t *SaveMission(Mission *mission);
+static MapArchiveSnapshot *SnapshotNew(
+	const char *filename, CampaignSetting *c)
+{
+	MapArchiveSnapshot *s;
+	CCALLOC(s, sizeof *s);
 
 	char relbuf[CDOGS_PATH_MAX];
 	if (strcmp(StrGetFileExt(filename), "cdogscpn") == 0 ||
@@ -274,47 +295,240 @@ int MapArchiveSave(const char *filename, CampaignSetting *c)
 	{
 		sprintf(relbuf, "%s.cdogscpn", filename);
 	}
-	char buf[CDOGS_PATH_MAX];
-	RealPath(relbuf, buf);
-	// Make dir but ignore error, as we may be saving over an existing dir
-	mkdir_deep(buf);
+	RealPath(relbuf, s->Path);
 
 	// Campaign
-	root = json_new_object();
+	json_t *root = json_new_object();
 	AddIntPair(root, "Version", MAP_VERSION);
 	AddStringPair(root, "Title", c->Title);
 	AddStringPair(root, "Author", c->Author);
 	AddStringPair(root, "Description", c->Description);
 	AddIntPair(root, "Missions", (int)c->Missions.size);
-	char buf2[CDOGS_PATH_MAX];
-	sprintf(buf2, "%s/campaign.json", buf);
-	if (!TrySaveJSONFile(root, buf2))
+	s->Campaign = FormatJSON(root);
+
+	s->Characters = FormatJSON(CharacterSaveJSON(&c->characters));
+
+	CArrayInit(&s->Missions, sizeof(MissionSnapshot));
+	CA_FOREACH(Mission, m, c->Missions)
+		MissionSnapshot ms;
+		memset(&ms, 0, sizeof ms);
+		ms.Text = FormatJSON(SaveMission(m));
+		ms.Width = m->Size.x;
+		CArrayInit(&ms.Tiles, sizeof(uint16_t));
+		if (m->Type == MAPTYPE_STATIC && m->u.Static.Tiles.size > 0)
+		{
+			CArrayResize(&ms.Tiles, m->u.Static.Tiles.size, NULL);
+			memcpy(
+				ms.Tiles.data, m->u.Static.Tiles.data,
+				ms.Tiles.size * ms.Tiles.elemSize);
+		}
+		CArrayPushBack(&s->Missions, &ms);
+	CA_FOREACH_END()
+	return s;
+}
+static char *FormatJSON(json_t *root)
+{
+	char *text;
+	json_tree_to_string(root, &text);
+	char *ftext = json_format_string(text);
+	CFREE(text);
+	json_free_value(&root);
+	return ftext;
+}
+static void SnapshotDelete(MapArchiveSnapshot *s)
+{
+	if (s == NULL) return;
+	CFREE(s->Campaign);
+	CFREE(s->Characters);
+	CA_FOREACH(MissionSnapshot, ms, s->Missions)
+		CFREE(ms->Text);
+		CArrayTerminate(&ms->Tiles);
+	CA_FOREACH_END()
+	CArrayTerminate(&s->Missions);
+	CFREE(s);
+}
+
+static void SnapshotWriteMissions(CArray *out, const MapArchiveSnapshot *s);
+static int SnapshotWrite(const MapArchiveSnapshot *s)
+{
+	// Make dir but ignore error, as we may be saving over an existing dir
+	mkdir_deep(s->Path);
+
+	char buf[CDOGS_PATH_MAX];
+	sprintf(buf, "%s/campaign.json", s->Path);
+	if (!TrySaveFileAtomic(buf, s->Campaign, strlen(s->Campaign)))
 	{
-		res = 0;
-		goto bail;
+		return 0;
 	}
 
-	json_free_value(&root);
-	root = json_new_object();
-	json_insert_pair_into_object(root, "Missions", SaveMissions(&c->Missions));
-	sprintf(buf2, "%s/missions.json", buf);
-	if (!TrySaveJSONFile(root, buf2))
+	CArray missions;
+	CArrayInit(&missions, sizeof(char));
+	SnapshotWriteMissions(&missions, s);
+	sprintf(buf, "%s/missions.json", s->Path);
+	const bool ok = TrySaveFileAtomic(buf, missions.data, missions.size);
+	CArrayTerminate(&missions);
+	if (!ok)
 	{
-		res = 0;
-		goto bail;
+		return 0;
 	}
 
-	if (!CharacterSave(&c->characters, buf))
+	sprintf(buf, "%s/characters.json", s->Path);
+	if (!TrySaveFileAtomic(buf, s->Characters, strlen(s->Characters)))
 	{
-		res = 0;
-		goto bail;
+		return 0;
+	}
+	return 1;
+}
+// Write the missions as formatting the whole document would, but with
+// tile rows written directly instead of through json nodes
+#define TILES_KEY "\n\t\"Tiles\": ["
+static void TextAppend(CArray *text, const char *s, const size_t len);
+static void TextAppendIndented(CArray *text, const char *s, const size_t len);
+static void TextAppendTiles(CArray *text, const MissionSnapshot *ms);
+static void SnapshotWriteMissions(CArray *out, const MapArchiveSnapshot *s)
+{
+	TextAppend(out, "{\n\t\"Missions\": [", strlen("{\n\t\"Missions\": ["));
+	CA_FOREACH(const MissionSnapshot, ms, s->Missions)
+		if (_ca_index > 0)
+		{
+			TextAppend(out, ",\n\t", strlen(",\n\t"));
+		}
+		// Missions are nested one level deeper than when formatted alone
+		const char *tiles =
+			ms->Tiles.size > 0 ? strstr(ms->Text, TILES_KEY) : NULL;
+		if (tiles == NULL)
+		{
+			TextAppendIndented(out, ms->Text, strlen(ms->Text));
+			continue;
+		}
+		const char *rest = tiles + strlen(TILES_KEY);
+		TextAppendIndented(out, ms->Text, rest - ms->Text);
+		TextAppendTiles(out, ms);
+		TextAppendIndented(out, rest, strlen(rest));
+	CA_FOREACH_END()
+	TextAppend(out, "]\n}", strlen("]\n}"));
+}
+static void TextAppend(CArray *text, const char *s, const size_t len)
+{
+	if (len == 0) return;
+	const size_t start = text->size;
+	if (text->capacity < start + len)
+	{
+		CArrayReserve(text, MAX(start + len, text->capacity * 2));
 	}
+	CArrayResize(text, start + len, NULL);
+	memcpy(CArrayGet(text, start), s, len);
+}
+static void TextAppendIndented(CArray *text, const char *s, const size_t len)
+{
+	const char *line = s;
+	for (const char *p = s; p < s + len; p++)
+	{
+		if (*p == '\n')
+		{
+			TextAppend(text, line, p + 1 - line);
+			TextAppend(text, "\t", 1);
+			line = p + 1;
+		}
+	}
+	TextAppend(text, line, s + len - line);
+}
+static void TextAppendTiles(CArray *text, const MissionSnapshot *ms)
+{
+	// Each row is a CSV string of tiles; tiles are at most 5 digits,
+	// plus a comma, plus the quotes and separator between rows
+	char *rowBuf;
+	CMALLOC(rowBuf, ms->Width * 6 + 8);
+	const uint16_t *tiles = ms->Tiles.data;
+	const int height = (int)ms->Tiles.size / ms->Width;
+	for (int y = 0; y < height; y++)
+	{
+		char *p = rowBuf;
+		if (y > 0)
+		{
+			memcpy(p, ",\n\t\t", 4);
+			p += 4;
+		}
+		*p++ = '"';
+		for (int x = 0; x < ms->Width; x++)
+		{
+			if (x > 0)
+			{
+				*p++ = ',';
+			}
+			char digits[5];
+			int n = 0;
+			unsigned v = tiles[y * ms->Width + x];
+			do
+			{
+				digits[n++] = (char)('0' + v % 10);
+				v /= 10;
+			} while (v > 0);
+			while (n > 0)
+			{
+				*p++ = digits[--n];
+			}
+		}
+		*p++ = '"';
+		TextAppend(text, rowBuf, p - rowBuf);
+	}
+	CFREE(rowBuf);
+}
 
-bail:
-	json_free_value(&root);
+int MapArchiveSave(const char *filename, CampaignSetting *c)
+{
+	MapArchiveSnapshot *s = SnapshotNew(filename, c);
+	const int res = SnapshotWrite(s);
+	SnapshotDelete(s);
 	return res;
 }
 
+static int SaveRun(void *data)
+{
+	MapArchiveSaver *s = data;
+	s->Result = SnapshotWrite(s->snapshot);
+	SDL_AtomicSet(&s->Done, 1);
+	return 0;
+}
+bool MapArchiveSaveAsync(
+	MapArchiveSaver *s, const char *filename, CampaignSetting *c)
+{
+	if (s->Thread != NULL)
+	{
+		if (!SDL_AtomicGet(&s->Done))
+		{
+			return false;
+		}
+		MapArchiveSaveWait(s);
+	}
+	s->snapshot = SnapshotNew(filename, c);
+	SDL_AtomicSet(&s->Done, 0);
+#ifndef __EMSCRIPTEN__
+	s->Thread = SDL_CreateThread(SaveRun, "save", s);
+	if (s->Thread != NULL)
+	{
+		return true;
+	}
+	LOG(LM_MAP, LL_WARN, "cannot create save thread: %s", SDL_GetError());
+#endif
+	// Fall back to saving now
+	SaveRun(s);
+	SnapshotDelete(s->snapshot);
+	s->snapshot = NULL;
+	return true;
+}
+int MapArchiveSaveWait(MapArchiveSaver *s)
+{
+	if (s->Thread != NULL)
+	{
+		SDL_WaitThread(s->Thread, NULL);
+		s->Thread = NULL;
+	}
+	SnapshotDelete(s->snapshot);
+	s->snapshot = NULL;
+	return s->Result;
+}
+
 static json_t *SaveObjectives(CArray *a);
 static json_t *SaveIntArray(CArray *a);
 static json_t *SaveVec2i(struct vec2i v);
@@ -322,119 +536,111 @@ static json_t *SaveWeapons(const CArray *weapons);
 static json_t *SaveRooms(const RoomParams r);
 static json_t *SaveClassicDoors(Mission *m);
 static json_t *SaveClassicPillars(Mission *m);
-static json_t *SaveStaticTiles(Mission *m);
 static json_t *SaveStaticItems(Mission *m);
 static json_t *SaveStaticCharacters(Mission *m);
 static json_t *SaveStaticObjectives(Mission *m);
 static json_t *SaveStaticKeys(Mission *m);
-static json_t *SaveMissions(CArray *a)
-{
-	json_t *missionsNode = json_new_array();
-	for (int i = 0; i < (int)a->size; i++)
-	{
-		json_t *node = json_new_object();
-		Mission *mission = CArrayGet(a, i);
-		AddStringPair(node, "Title", mission->Title);
-		AddStringPair(node, "Description", mission->Description);
-		AddStringPair(node, "Type", MapTypeStr(mission->Type));
-		AddIntPair(node, "Width", mission->Size.x);
-		AddIntPair(node, "Height", mission->Size.y);
-
-		AddStringPair(node, "WallStyle", mission->WallStyle);
-		AddStringPair(node, "FloorStyle", mission->FloorStyle);
-		AddStringPair(node, "RoomStyle", mission->RoomStyle);
-		AddStringPair(node, "ExitStyle", mission->ExitStyle);
-		AddStringPair(node, "KeyStyle", mission->KeyStyle);
-		AddStringPair(node, "DoorStyle", mission->DoorStyle);
+static json_t *SaveMission(Mission *mission)
+{
+	json_t *node = json_new_object();
+	AddStringPair(node, "Title", mission->Title);
+	AddStringPair(node, "Description", mission->Description);
+	AddStringPair(node, "Type", MapTypeStr(mission->Type));
+	AddIntPair(node, "Width", mission->Size.x);
+	AddIntPair(node, "Height", mission->Size.y);
+
+	AddStringPair(node, "WallStyle", mission->WallStyle);
+	AddStringPair(node, "FloorStyle", mission->FloorStyle);
+	AddStringPair(node, "RoomStyle", mission->RoomStyle);
+	AddStringPair(node, "ExitStyle", mission->ExitStyle);
+	AddStringPair(node, "KeyStyle", mission->KeyStyle);
+	AddStringPair(node, "DoorStyle", mission->DoorStyle);
+
+	json_insert_pair_into_object(
+		node, "Objectives", SaveObjectives(&mission->Objectives));
+	json_insert_pair_into_object(
+		node, "Enemies", SaveIntArray(&mission->Enemies));
+	json_insert_pair_into_object(
+		node, "SpecialChars", SaveIntArray(&mission->SpecialChars));
+	json_t *modsNode = json_new_array();
+	for (int j = 0; j < (int)mission->MapObjectDensities.size; j++)
+	{
+		const MapObjectDensity *mod =
+			CArrayGet(&mission->MapObjectDensities, j);
+		json_t *modNode = json_new_object();
+		AddStringPair(modNode, "MapObject", mod->M->Name);
+		AddIntPair(modNode, "Density", mod->Density);
+		json_insert_child(modsNode, modNode);
+	}
+	json_insert_pair_into_object(node, "MapObjectDensities", modsNode);
+
+	AddIntPair(node, "EnemyDensity", mission->EnemyDensity);
+	json_insert_pair_into_object(
+		node, "Weapons", SaveWeapons(&mission->Weapons));
+
+	json_insert_pair_into_object(
+		node, "Song", json_new_string(mission->Song));
+
+	AddColorPair(node, "WallMask", mission->WallMask);
+	AddColorPair(node, "FloorMask", mission->FloorMask);
+	AddColorPair(node, "RoomMask", mission->RoomMask);
+	AddColorPair(node, "AltMask", mission->AltMask);
 
+	switch (mission->Type)
+	{
+	case MAPTYPE_CLASSIC:
+		AddIntPair(node, "Walls", mission->u.Classic.Walls);
+		AddIntPair(node, "WallLength", mission->u.Classic.WallLength);
+		AddIntPair(
+			node, "CorridorWidth", mission->u.Classic.CorridorWidth);
 		json_insert_pair_into_object(
-			node, "Objectives", SaveObjectives(&mission->Objectives));
+			node, "Rooms", SaveRooms(mission->u.Classic.Rooms));
+		AddIntPair(node, "Squares", mission->u.Classic.Squares);
 		json_insert_pair_into_object(
-			node, "Enemies", SaveIntArray(&mission->Enemies));
+			node, "Doors", SaveClassicDoors(mission));
 		json_insert_pair_into_object(
-			node, "SpecialChars", SaveIntArray(&mission->SpecialChars));
-		json_t *modsNode = json_new_array();
-		for (int j = 0; j < (int)mission->MapObjectDensities.size; j++)
+			node, "Pillars", SaveClassicPillars(mission));
+		break;
+	case MAPTYPE_STATIC:
 		{
-			const MapObjectDensity *mod =
-				CArrayGet(&mission->MapObjectDensities, j);
-			json_t *modNode = json_new_object();
-			AddStringPair(modNode, "MapObject", mod->M->Name);
-			AddIntPair(modNode, "Density", mod->Density);
-			json_insert_child(modsNode, modNode);
-		}
-		json_insert_pair_into_object(node, "MapObjectDensities", modsNode);
-
-		AddIntPair(node, "EnemyDensity", mission->EnemyDensity);
-		json_insert_pair_into_object(
-			node, "Weapons", SaveWeapons(&mission->Weapons));
-
-		json_insert_pair_into_object(
-			node, "Song", json_new_string(mission->Song));
-
-		AddColorPair(node, "WallMask", mission->WallMask);
-		AddColorPair(node, "FloorMask", mission->FloorMask);
-		AddColorPair(node, "RoomMask", mission->RoomMask);
-		AddColorPair(node, "AltMask", mission->AltMask);
+			// Tiles are streamed in place of this when writing
+			json_insert_pair_into_object(node, "Tiles", json_new_array());
+			json_insert_pair_into_object(
+				node, "StaticItems", SaveStaticItems(mission));
+			json_insert_pair_into_object(
+				node, "StaticCharacters", SaveStaticCharacters(mission));
+			json_insert_pair_into_object(
+				node, "StaticObjectives", SaveStaticObjectives(mission));
+			json_insert_pair_into_object(
+				node, "StaticKeys", SaveStaticKeys(mission));
 
-		switch (mission->Type)
-		{
-		case MAPTYPE_CLASSIC:
-			AddIntPair(node, "Walls", mission->u.Classic.Walls);
-			AddIntPair(node, "WallLength", mission->u.Classic.WallLength);
-			AddIntPair(
-				node, "CorridorWidth", mission->u.Classic.CorridorWidth);
 			json_insert_pair_into_object(
-				node, "Rooms", SaveRooms(mission->u.Classic.Rooms));
-			AddIntPair(node, "Squares", mission->u.Classic.Squares);
+				node, "Start", SaveVec2i(mission->u.Static.Start));
+			json_t *exitNode = json_new_object();
 			json_insert_pair_into_object(
-				node, "Doors", SaveClassicDoors(mission));
+				exitNode, "Start",
+				SaveVec2i(mission->u.Static.Exit.Start));
 			json_insert_pair_into_object(
-				node, "Pillars", SaveClassicPillars(mission));
-			break;
-		case MAPTYPE_STATIC:
-			{
-				json_insert_pair_into_object(
-					node, "Tiles", SaveStaticTiles(mission));
-				json_insert_pair_into_object(
-					node, "StaticItems", SaveStaticItems(mission));
-				json_insert_pair_into_object(
-					node, "StaticCharacters", SaveStaticCharacters(mission));
-				json_insert_pair_into_object(
-					node, "StaticObjectives", SaveStaticObjectives(mission));
-				json_insert_pair_into_object(
-					node, "StaticKeys", SaveStaticKeys(mission));
-
-				json_insert_pair_into_object(
-					node, "Start", SaveVec2i(mission->u.Static.Start));
-				json_t *exitNode = json_new_object();
-				json_insert_pair_into_object(
-					exitNode, "Start",
-					SaveVec2i(mission->u.Static.Exit.Start));
-				json_insert_pair_into_object(
-					exitNode, "End",
-					SaveVec2i(mission->u.Static.Exit.End));
-				json_insert_pair_into_object(node, "Exit", exitNode);
-			}
-			break;
-		case MAPTYPE_CAVE:
-			AddIntPair(node, "FillPercent", mission->u.Cave.FillPercent);
-			AddIntPair(node, "Repeat", mission->u.Cave.Repeat);
-			AddIntPair(node, "R1", mission->u.Cave.R1);
-			AddIntPair(node, "R2", mission->u.Cave.R2);
-				json_insert_pair_into_object(
-					node, "Rooms", SaveRooms(mission->u.Cave.Rooms));
-			AddIntPair(node, "Squares", mission->u.Cave.Squares);
-			AddBoolPair(node, "DoorsEnabled", mission->u.Cave.DoorsEnabled);
-			break;
-		default:
-			assert(0 && "unknown map type");
-			break;
+				exitNode, "End",
+				SaveVec2i(mission->u.Static.Exit.End));
+			json_insert_pair_into_object(node, "Exit", exitNode);
 		}
-
-		json_insert_child(missionsNode, node);
+		break;
+	case MAPTYPE_CAVE:
+		AddIntPair(node, "FillPercent", mission->u.Cave.FillPercent);
+		AddIntPair(node, "Repeat", mission->u.Cave.Repeat);
+		AddIntPair(node, "R1", mission->u.Cave.R1);
+		AddIntPair(node, "R2", mission->u.Cave.R2);
+			json_insert_pair_into_object(
+				node, "Rooms", SaveRooms(mission->u.Cave.Rooms));
+		AddIntPair(node, "Squares", mission->u.Cave.Squares);
+		AddBoolPair(node, "DoorsEnabled", mission->u.Cave.DoorsEnabled);
+		break;
+	default:
+		assert(0 && "unknown map type");
+		break;
 	}
-	return missionsNode;
+	return node;
 }
 static json_t *SaveRooms(const RoomParams r)
 {
@@ -466,36 +672,6 @@ static json_t *SaveClassicDoors(Mission *m)
 	return node;
 }
 
-static json_t *SaveStaticTiles(Mission *m)
-{
-	// Write out each row of tiles individually as a single CSV
-	json_t *rows = json_new_array();
-	// Create a text buffer for CSV
-	// The buffer will contain n*5 chars (tiles, allow 5 chars each),
-	// and n - 1 commas, so 6n total
-	char *rowBuf;
-	CMALLOC(rowBuf, m->Size.x * 6);
-	for (int i = 0; i < m->Size.y; i++)
-	{
-		char *pBuf = rowBuf;
-		*pBuf = '\0';
-		for (int j = 0; j < m->Size.x; j++)
-		{
-			char buf[32];
-			sprintf(buf, "%d", *(uint16_t *)CArrayGet(
-				&m->u.Static.Tiles, i * m->Size.x + j));
-			strcpy(pBuf, buf);
-			pBuf += strlen(buf);
-			if (j < m->Size.x - 1)
-			{
-				*pBuf++ = ',';
-			}
-		}
-		json_insert_child(rows, json_new_string(rowBuf));
-	}
-	CFREE(rowBuf);
-	return rows;
-}
 static json_t *SaveStaticItems(Mission *m)
 {
 	json_t *items = json_new_array();
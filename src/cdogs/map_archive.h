@@ -27,11 +27,31 @@
 */
 #pragma once
 
+#include <SDL_atomic.h>
+#include <SDL_thread.h>
+
 #include "campaigns.h"
 
 #define MAP_VERSION 15
 
+typedef struct MapArchiveSnapshot MapArchiveSnapshot;
+// Saves campaigns in the background, one at a time
+typedef struct
+{
+	SDL_Thread *Thread;
+	MapArchiveSnapshot *snapshot;
+	SDL_atomic_t Done;
+	int Result;
+} MapArchiveSaver;
+
 int MapNewScanArchive(
 	const char *filename, char **title, int *numMissions);
 int MapNewLoadArchive(const char *filename, CampaignSetting *c);
 int MapArchiveSave(const char *filename, CampaignSetting *c);
+// Save a snapshot of the campaign on another thread; the campaign can be
+// changed straight away. Returns false if the last save is still running.
+bool MapArchiveSaveAsync(
+	MapArchiveSaver *s, const char *filename, CampaignSetting *c);
+// Wait for the background save to finish, returning its result as with
+// MapArchiveSave
+int MapArchiveSaveWait(MapArchiveSaver *s);
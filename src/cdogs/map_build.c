@@ -50,10 +50,12 @@
 
 #include "collision/collision.h"
 #include "door.h"
+#include "draw/map_chunks.h"
 #include "log.h"
 #include "map_cave.h"
 #include "map_classic.h"
 #include "map_static.h"
+#include "mission_convert.h"
 #include "net_util.h"
 #include "objs.h"
 
@@ -96,6 +98,7 @@ void MapBuild(Map *m, const Mission *mission, const CampaignOptions *co)
 	MapSetupTilesAndWalls(&mb);
 	MapSetupDoors(&mb);
 	DebugPrintMap(&mb);
+	MapChunksInvalidate(&gMapChunks);
 
 	if (mb.mission->Type == MAPTYPE_CLASSIC)
 	{
@@ -108,19 +111,12 @@ void MapBuild(Map *m, const Mission *mission, const CampaignOptions *co)
 		MapGenerateRandomExitArea(mb.Map);
 	}
 
+	// All tile classes are set; from here on the bitplanes are kept in sync
+	// as tiles change
+	MapUpdateAllTileBits(mb.Map);
+
 	// Count total number of reachable tiles, for explored %
-	mb.Map->NumExplorableTiles = 0;
-	struct vec2i v;
-	for (v.y = 0; v.y < mb.Map->Size.y; v.y++)
-	{
-		for (v.x = 0; v.x < mb.Map->Size.x; v.x++)
-		{
-			if (TileCanWalk(MapGetTile(mb.Map, v)))
-			{
-				mb.Map->NumExplorableTiles++;
-			}
-		}
-	}
+	mb.Map->NumExplorableTiles = MapCountTileBits(mb.Map, MAP_BITS_WALK);
 
 	if (!co->IsClient)
 	{
@@ -684,11 +680,23 @@ void MapBuildTile(
 	MapSetupTile(&mb, pos);
 	RECT_FOREACH(Rect2iNew(svec2i_subtract(pos, svec2i(1, 1)), svec2i(3, 3)))
 		MapSetupTile(&mb, _v);
+		MapUpdateTileBits(m, _v);
+		MapChunksInvalidateTile(&gMapChunks, _v);
 	RECT_FOREACH_END()
 	CArrayCopy(&mb.Map->access, &mb.access);
 	DebugPrintMap(&mb);
 	MapBuilderTerminate(&mb);
 }
+void MapBuildTiles(Map *m, Mission *mission, const Rect2i r)
+{
+	RECT_FOREACH(r)
+		if (MapIsTileIn(m, _v))
+		{
+			MapBuildTile(m, mission, _v, MapBuildGetTileFromType(
+				MissionGetTile(mission, _v) & MAP_MASKACCESS));
+		}
+	RECT_FOREACH_END()
+}
 
 static bool MapTileIsNormalFloor(const MapBuilder *mb, const struct vec2i pos)
 {
@@ -132,6 +132,8 @@ const TileClass *MapBuildGetTileFromType(const uint16_t tile);
 void MapBuildTile(
 	Map *m, const Mission *mission, const struct vec2i pos,
 	const TileClass *tile);
+// Rebuild the map tiles in a rectangle from the mission's static tiles
+void MapBuildTiles(Map *m, Mission *mission, const Rect2i r);
 
 uint16_t GenerateAccessMask(int *accessLevel);
 void MapGenerateRandomExitArea(Map *map);
@@ -0,0 +1,231 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+
+    Copyright (c) 2018 Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "mem_arena.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils.h"
+
+#define MEM_ARENA_ALIGN 16
+
+struct MemArenaBlock
+{
+	MemArenaBlock *next;
+	MemArenaBlock *prev;	// for large blocks only
+	size_t size;
+	size_t used;
+};
+// Keep block data aligned
+#define BLOCK_HEADER_SIZE \
+	((sizeof(MemArenaBlock) + MEM_ARENA_ALIGN - 1) & ~(size_t)(MEM_ARENA_ALIGN - 1))
+#define BLOCK_DATA(_b) ((char *)(_b) + BLOCK_HEADER_SIZE)
+
+
+void MemArenaInit(MemArena *a)
+{
+	memset(a, 0, sizeof *a);
+}
+static void FreeLargeBlocks(MemArena *a);
+void MemArenaTerminate(MemArena *a)
+{
+	FreeLargeBlocks(a);
+	MemArenaBlock *b = a->blocks;
+	while (b != NULL)
+	{
+		MemArenaBlock *next = b->next;
+		CFREE(b);
+		b = next;
+	}
+	MemArenaInit(a);
+}
+void MemArenaReset(MemArena *a)
+{
+	FreeLargeBlocks(a);
+	for (MemArenaBlock *b = a->blocks; b != NULL; b = b->next)
+	{
+		b->used = 0;
+	}
+	a->current = a->blocks;
+	memset(a->freeLists, 0, sizeof a->freeLists);
+	a->bytes = 0;
+	memset(&a->Stats, 0, sizeof a->Stats);
+}
+static void FreeLargeBlocks(MemArena *a)
+{
+	MemArenaBlock *b = a->large;
+	while (b != NULL)
+	{
+		MemArenaBlock *next = b->next;
+		CFREE(b);
+		b = next;
+	}
+	a->large = NULL;
+}
+
+static int SizeClass(const size_t size)
+{
+	int c = MEM_ARENA_MIN_CLASS;
+	while (((size_t)1 << c) < size)
+	{
+		c++;
+	}
+	return c;
+}
+static MemArenaBlock *NewBlock(MemArena *a, const size_t size)
+{
+	MemArenaBlock *b;
+	CMALLOC(b, BLOCK_HEADER_SIZE + size);
+	memset(b, 0, sizeof *b);
+	b->size = size;
+	a->Stats.HeapAllocs++;
+	return b;
+}
+static void AddBytes(MemArena *a, const size_t size)
+{
+	a->bytes += size;
+	a->Stats.PeakBytes = MAX(a->Stats.PeakBytes, a->bytes);
+}
+void *MemArenaAlloc(MemArena *a, const size_t size)
+{
+	if (size == 0)
+	{
+		return NULL;
+	}
+	a->Stats.Allocs++;
+	const int c = SizeClass(size);
+	if (c > MEM_ARENA_MAX_CLASS)
+	{
+		MemArenaBlock *b = NewBlock(a, size);
+		b->next = a->large;
+		if (a->large != NULL)
+		{
+			a->large->prev = b;
+		}
+		a->large = b;
+		AddBytes(a, size);
+		return BLOCK_DATA(b);
+	}
+
+	const size_t classSize = (size_t)1 << c;
+	AddBytes(a, classSize);
+	void **freeList = &a->freeLists[c - MEM_ARENA_MIN_CLASS];
+	if (*freeList != NULL)
+	{
+		void *ptr = *freeList;
+		*freeList = *(void **)ptr;
+		a->Stats.SlabReuses++;
+		return ptr;
+	}
+
+	// Bump allocate from the current block, moving on to the next one
+	// (kept from before the last reset) or a new one when it is full
+	if (a->current == NULL)
+	{
+		if (a->blocks == NULL)
+		{
+			a->blocks = NewBlock(a, MEM_ARENA_BLOCK_SIZE);
+		}
+		a->current = a->blocks;
+	}
+	while (a->current->used + classSize > a->current->size)
+	{
+		if (a->current->next == NULL)
+		{
+			a->current->next = NewBlock(a, MEM_ARENA_BLOCK_SIZE);
+		}
+		a->current = a->current->next;
+	}
+	void *ptr = BLOCK_DATA(a->current) + a->current->used;
+	a->current->used += classSize;
+	return ptr;
+}
+void *MemArenaCalloc(MemArena *a, const size_t size)
+{
+	void *ptr = MemArenaAlloc(a, size);
+	if (ptr != NULL)
+	{
+		memset(ptr, 0, size);
+	}
+	return ptr;
+}
+void *MemArenaRealloc(
+	MemArena *a, void *ptr, const size_t oldSize, const size_t size)
+{
+	if (ptr == NULL)
+	{
+		return MemArenaAlloc(a, size);
+	}
+	const int c = SizeClass(size);
+	if (c <= MEM_ARENA_MAX_CLASS && c == SizeClass(oldSize))
+	{
+		// Still fits in the same slot
+		return ptr;
+	}
+	void *newPtr = MemArenaAlloc(a, size);
+	if (newPtr != NULL)
+	{
+		memcpy(newPtr, ptr, MIN(oldSize, size));
+	}
+	MemArenaFree(a, ptr, oldSize);
+	return newPtr;
+}
+void MemArenaFree(MemArena *a, void *ptr, const size_t size)
+{
+	if (ptr == NULL)
+	{
+		return;
+	}
+	a->Stats.Frees++;
+	const int c = SizeClass(size);
+	if (c > MEM_ARENA_MAX_CLASS)
+	{
+		MemArenaBlock *b = (MemArenaBlock *)((char *)ptr - BLOCK_HEADER_SIZE);
+		if (b->prev != NULL)
+		{
+			b->prev->next = b->next;
+		}
+		else
+		{
+			a->large = b->next;
+		}
+		if (b->next != NULL)
+		{
+			b->next->prev = b->prev;
+		}
+		a->bytes -= b->size;
+		CFREE(b);
+		return;
+	}
+	void **freeList = &a->freeLists[c - MEM_ARENA_MIN_CLASS];
+	*(void **)ptr = *freeList;
+	*freeList = ptr;
+	a->bytes -= (size_t)1 << c;
+}
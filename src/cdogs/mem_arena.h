@@ -0,0 +1,81 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+
+    Copyright (c) 2018 Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Arena for storage that lives as long as a mission (or a map).
+// Memory is carved out of large blocks; freed allocations go back to
+// per-size-class free lists (slabs) so that small, growing arrays can be
+// reused without going back to the heap. Everything is released at once
+// with MemArenaReset; the blocks are kept for the next mission.
+#define MEM_ARENA_BLOCK_SIZE (64 * 1024)
+#define MEM_ARENA_MIN_CLASS 4	// 16 bytes
+#define MEM_ARENA_MAX_CLASS 14	// 16KB; larger allocations get their own block
+#define MEM_ARENA_NUM_CLASSES (MEM_ARENA_MAX_CLASS - MEM_ARENA_MIN_CLASS + 1)
+
+typedef struct
+{
+	int Allocs;		// requests served by the arena
+	int SlabReuses;	// requests served from a free list
+	int Frees;
+	int HeapAllocs;	// requests that had to go to the heap
+	size_t PeakBytes;
+} MemArenaStats;
+
+typedef struct MemArenaBlock MemArenaBlock;
+typedef struct MemArena
+{
+	MemArenaBlock *blocks;	// blocks for slab allocations
+	MemArenaBlock *current;
+	MemArenaBlock *large;	// dedicated blocks for large allocations
+	void *freeLists[MEM_ARENA_NUM_CLASSES];
+	size_t bytes;
+	MemArenaStats Stats;
+} MemArena;
+
+void MemArenaInit(MemArena *a);
+void MemArenaTerminate(MemArena *a);
+// Release all allocations, keeping the blocks for reuse
+void MemArenaReset(MemArena *a);
+
+void *MemArenaAlloc(MemArena *a, const size_t size);
+void *MemArenaCalloc(MemArena *a, const size_t size);
+// Resize an allocation; oldSize must be the size previously requested
+void *MemArenaRealloc(
+	MemArena *a, void *ptr, const size_t oldSize, const size_t size);
+void MemArenaFree(MemArena *a, void *ptr, const size_t size);
+
+// For logging allocator traffic, e.g. before a reset
+#define MEM_ARENA_STATS_FMT \
+	"%d allocs (%d reused from slabs, %d freed), %d heap allocs, peak %dKB"
+#define MEM_ARENA_STATS_ARGS(_a) \
+	(_a)->Stats.Allocs, (_a)->Stats.SlabReuses, (_a)->Stats.Frees, \
+	(_a)->Stats.HeapAllocs, (int)((_a)->Stats.PeakBytes / 1024)
@@ -317,12 +317,13 @@ void SetupMission(Mission *m, struct MissionOptions *mo, int missionIndex)
 	mo->index = missionIndex;
 	mo->missionData = m;
 
-	ActorsInit();
-	ObjsInit();
-	MobObjsInit();
+	// Entity storage lives until MissionOptionsTerminate
+	ActorsInit(&gMissionArena);
+	ObjsInit(&gMissionArena);
+	MobObjsInit(&gMissionArena);
 	PickupsInit();
 	ParticlesInit(&gParticles);
-	WatchesInit();
+	WatchesInit(&gMissionArena);
 	SetupObjectives(m);
 	SetupBadguysForMission(m);
 	SetupWeapons(&mo->Weapons, &m->Weapons);
@@ -37,9 +37,14 @@
 #include "gamedata.h"
 #include "log.h"
 #include "net_server.h"
+#include "net_snapshot.h"
+#include "net_stats.h"
 #include "player.h"
 #include "utils.h"
 
+// How long to hold game messages waiting for a snapshot
+#define NET_SNAPSHOT_TIMEOUT_MS 10000
+
 
 NetClient gNetClient;
 
@@ -54,7 +59,7 @@ void NetClientInit(NetClient *n)
 	memset(n, 0, sizeof *n);
 	n->ClientId = -1;	// -1 is unset
 	n->scanner = ENET_SOCKET_NULL;
-	n->client = enet_host_create(NULL, 1, 2,
+	n->client = enet_host_create(NULL, 1, NET_CHANNEL_COUNT,
 		57600 / 8 /* 56K modem with 56 Kbps downstream bandwidth */,
 		14400 / 8 /* 56K modem with 14 Kbps upstream bandwidth */);
 	if (n->client == NULL)
@@ -63,6 +68,9 @@ void NetClientInit(NetClient *n)
 	}
 	CArrayInit(&n->ScannedAddrs, sizeof(ScanInfo));
 	CArrayInit(&n->scannedAddrBuf, sizeof(ScanInfo));
+	CArrayInit(&n->Predictions, sizeof(NetPredict));
+	CArrayInit(&n->SnapshotData, sizeof(uint8_t));
+	CArrayInit(&n->SnapshotDeferred, sizeof(GameEvent));
 }
 void NetClientTerminate(NetClient *n)
 {
@@ -81,6 +89,9 @@ void NetClientTerminate(NetClient *n)
 	}
 	CArrayTerminate(&n->ScannedAddrs);
 	CArrayTerminate(&n->scannedAddrBuf);
+	CArrayTerminate(&n->Predictions);
+	CArrayTerminate(&n->SnapshotData);
+	CArrayTerminate(&n->SnapshotDeferred);
 }
 
 static bool TryScanHost(NetClient *n, const enet_uint32 host);
@@ -157,7 +168,7 @@ bool NetClientTryConnect(NetClient *n, const ENetAddress addr)
 	LOG(LM_NET, LL_INFO, "Connecting client to %s:%u...", buf, addr.port);
 
 	/* Initiate the connection, allocating the two channels 0 and 1. */
-	n->peer = enet_host_connect(n->client, &addr, 2, 0);
+	n->peer = enet_host_connect(n->client, &addr, NET_CHANNEL_COUNT, 0);
 	if (n->peer == NULL)
 	{
 		LOG(LM_NET, LL_WARN, "No server connection found");
@@ -274,10 +285,15 @@ void NetClientDisconnect(NetClient *n)
 	// Also reset the scanned address buffer
 	CArrayClear(&n->ScannedAddrs);
 	CArrayClear(&n->scannedAddrBuf);
+	CArrayClear(&n->Predictions);
+	n->SnapshotPending = false;
+	CArrayClear(&n->SnapshotData);
+	CArrayClear(&n->SnapshotDeferred);
 }
 
 static void OnReceive(NetClient *n, ENetEvent event);
 static void Scanning(NetClient *n);
+static void SnapshotEnd(NetClient *n);
 void NetClientPoll(NetClient *n)
 {
 	// Check to see if LAN servers have been scanned
@@ -317,6 +333,14 @@ void NetClientPoll(NetClient *n)
 			}
 		}
 	} while (check > 0);
+
+	// Don't hold game messages forever if the snapshot never arrives
+	if (n->SnapshotPending &&
+		SDL_GetTicks() - n->SnapshotStartTicks > NET_SNAPSHOT_TIMEOUT_MS)
+	{
+		LOG(LM_NET, LL_ERROR, "timed out waiting for snapshot");
+		SnapshotEnd(n);
+	}
 }
 static void Scanning(NetClient *n)
 {
@@ -369,10 +393,23 @@ static void Scanning(NetClient *n)
 		}
 	}
 }
+static void SnapshotBegin(NetClient *n);
+static void OnSnapshotFragment(NetClient *n, const ENetPacket *packet);
 static void OnReceive(NetClient *n, ENetEvent event)
 {
-	const GameEventType msg = (GameEventType)*(uint32_t *)event.packet->data;
+	GameEventType msg;
+	if (!NetDecodeType(event.packet, &msg))
+	{
+		enet_packet_destroy(event.packet);
+		return;
+	}
 	LOG(LM_NET, LL_TRACE, "recv msg(%u)", msg);
+	NET_STATS_COUNT(NET_STATS_RECV, msg, (int)event.packet->dataLength, 1);
+	if (n->RecvFunc != NULL)
+	{
+		n->RecvFunc(n->RecvData, msg, event.packet);
+		return;
+	}
 	const GameEventEntry gee = GameEventGetEntry(msg);
 	if (gee.Enqueue)
 	{
@@ -386,9 +423,11 @@ static void OnReceive(NetClient *n, ENetEvent event)
 			// Game event message; decode and add to event queue
 			LOG(LM_NET, LL_TRACE, "recv gameEvent(%d)", (int)gee.Type);
 			GameEvent e = GameEventNew(gee.Type);
-			if (gee.Fields != NULL)
+			if (gee.Fields != NULL &&
+				!NetDecode(event.packet, &e.u, gee.Fields))
 			{
-				NetDecode(event.packet, &e.u, gee.Fields);
+				enet_packet_destroy(event.packet);
+				return;
 			}
 
 			// For actor events, check if UID is not for local player
@@ -427,6 +466,19 @@ static void OnReceive(NetClient *n, ENetEvent event)
 			if (actorIsLocal)
 			{
 				LOG(LM_NET, LL_TRACE, "game event is for local player, ignoring");
+				// The server echoes our moves once it has processed them
+				if (gee.Type == GAME_EVENT_ACTOR_MOVE)
+				{
+					NetPredict *p = NetClientGetPredict(n, actorUID);
+					if (p != NULL)
+					{
+						NetPredictAck(p, e.u.ActorMove.Seq);
+					}
+				}
+			}
+			else if (n->SnapshotPending)
+			{
+				CArrayPushBack(&n->SnapshotDeferred, &e);
 			}
 			else
 			{
@@ -444,7 +496,10 @@ static void OnReceive(NetClient *n, ENetEvent event)
 					n->ClientId == -1,
 					"unexpected client ID message, already set");
 				NClientId cid;
-				NetDecode(event.packet, &cid, NClientId_fields);
+				if (!NetDecode(event.packet, &cid, NClientId_fields))
+				{
+					break;
+				}
 				LOG(LM_NET, LL_DEBUG, "recv clientId(%u) uid(%u)",
 					cid.Id, cid.FirstPlayerUID);
 				n->ClientId = (int)cid.Id;
@@ -460,7 +515,11 @@ static void OnReceive(NetClient *n, ENetEvent event)
 			{
 				LOG(LM_NET, LL_DEBUG, "NetClient: received campaign def, loading...");
 				NCampaignDef def;
-				NetDecode(event.packet, &def, NCampaignDef_fields);
+				if (!NetDecode(event.packet, &def, NCampaignDef_fields))
+				{
+					gCampaign.IsError = true;
+					break;
+				}
 				gCampaign.Entry.Mode = (GameMode)def.GameMode;
 				// Normalise the path
 				char buf[CDOGS_PATH_MAX];
@@ -488,14 +547,66 @@ static void OnReceive(NetClient *n, ENetEvent event)
 			{
 				gMission.HasStarted = true;
 			}
+			// The server follows up with a snapshot
+			SnapshotBegin(n);
+			break;
+		case GAME_EVENT_NET_SNAPSHOT:
+			OnSnapshotFragment(n, event.packet);
 			break;
 		default:
-			CASSERT(false, "unexpected message type");
+			LOG(LM_NET, LL_WARN, "unexpected msg(%u)", msg);
 			break;
 		}
 	}
 	enet_packet_destroy(event.packet);
 }
+static void SnapshotBegin(NetClient *n)
+{
+	n->SnapshotPending = true;
+	n->SnapshotStartTicks = SDL_GetTicks();
+	CArrayClear(&n->SnapshotData);
+}
+static void OnSnapshotFragment(NetClient *n, const ENetPacket *packet)
+{
+	if (!n->SnapshotPending)
+	{
+		// A snapshot without game start; hold messages from here anyway,
+		// any fragment but the first will fail and release them
+		LOG(LM_NET, LL_WARN, "unexpected snapshot fragment");
+		SnapshotBegin(n);
+	}
+	bool complete = false;
+	if (!NetSnapshotAddFragment(&n->SnapshotData, packet, &complete))
+	{
+		LOG(LM_NET, LL_ERROR, "failed to receive snapshot");
+	}
+	else if (!complete)
+	{
+		return;
+	}
+	else if (gMission.HasStarted)
+	{
+		// Hand the buffer over to the event, which frees it once applied
+		LOG(LM_NET, LL_DEBUG, "recv snapshot size(%d)",
+			(int)n->SnapshotData.size);
+		GameEvent e = GameEventNew(GAME_EVENT_NET_SNAPSHOT);
+		e.u.NetSnapshot.Data = n->SnapshotData.data;
+		e.u.NetSnapshot.Size = n->SnapshotData.size;
+		GameEventsEnqueue(&gGameEvents, e);
+		CArrayInit(&n->SnapshotData, sizeof(uint8_t));
+	}
+	SnapshotEnd(n);
+}
+// Release the game messages held while receiving
+static void SnapshotEnd(NetClient *n)
+{
+	n->SnapshotPending = false;
+	CArrayClear(&n->SnapshotData);
+	CA_FOREACH(const GameEvent, e, n->SnapshotDeferred)
+		GameEventsEnqueue(&gGameEvents, *e);
+	CA_FOREACH_END()
+	CArrayClear(&n->SnapshotDeferred);
+}
 
 void NetClientFlush(NetClient *n)
 {
@@ -511,10 +622,36 @@ void NetClientSendMsg(NetClient *n, const GameEventType e, const void *data)
 	}
 
 	LOG(LM_NET, LL_TRACE, "NetClient: send msg type %d", (int)e);
-	enet_peer_send(n->peer, 0, NetEncode(e, data));
+	ENetPacket *packet = NetEncode(e, data);
+	NET_STATS_COUNT(NET_STATS_SENT, e, (int)packet->dataLength, 1);
+	enet_peer_send(n->peer, NET_CHANNEL_GAME, packet);
 }
 
 bool NetClientIsConnected(const NetClient *n)
 {
 	return n->client && n->peer;
 }
+
+NetPredict *NetClientAddPredict(NetClient *n, const int actorUID)
+{
+	NetPredict *p = NetClientGetPredict(n, actorUID);
+	if (p == NULL)
+	{
+		NetPredict np;
+		NetPredictInit(&np, actorUID);
+		CArrayPushBack(&n->Predictions, &np);
+		return CArrayGet(&n->Predictions, n->Predictions.size - 1);
+	}
+	NetPredictInit(p, actorUID);
+	return p;
+}
+NetPredict *NetClientGetPredict(NetClient *n, const int actorUID)
+{
+	CA_FOREACH(NetPredict, p, n->Predictions)
+		if (p->ActorUID == actorUID)
+		{
+			return p;
+		}
+	CA_FOREACH_END()
+	return NULL;
+}
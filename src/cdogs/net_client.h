@@ -30,6 +30,7 @@
 
 #include <time.h>
 
+#include "net_predict.h"
 #include "net_util.h"
 
 // Stored information about game servers scanned
@@ -40,6 +41,11 @@ typedef struct
 	int LatencyMS;
 } ScanInfo;
 
+// Receives every message instead of the game, for headless clients; owns
+// the packet
+typedef void (*NetClientRecvFunc)(
+	void *data, const GameEventType e, ENetPacket *packet);
+
 typedef struct
 {
 	ENetHost *client;
@@ -55,6 +61,16 @@ typedef struct
 	CArray ScannedAddrs;		// of ScanInfo
 	// Buffer of scanned addresses - new ones will be scanned here
 	CArray scannedAddrBuf;	// of ScanInfo
+	// Movement prediction for local actors
+	CArray Predictions;	// of NetPredict
+	// Late-join snapshot being received; game messages are held until it
+	// is applied, as they may refer to things in it, or until it times out
+	bool SnapshotPending;
+	Uint32 SnapshotStartTicks;
+	CArray SnapshotData;	// of uint8_t
+	CArray SnapshotDeferred;	// of GameEvent
+	NetClientRecvFunc RecvFunc;
+	void *RecvData;
 } NetClient;
 
 extern NetClient gNetClient;
@@ -76,3 +92,8 @@ void NetClientFlush(NetClient *n);
 void NetClientSendMsg(NetClient *n, const GameEventType e, const void *data);
 
 bool NetClientIsConnected(const NetClient *n);
+
+// Start (or restart) predicting movement for a local actor
+NetPredict *NetClientAddPredict(NetClient *n, const int actorUID);
+// Get the prediction for a local actor, or NULL if not predicted
+NetPredict *NetClientGetPredict(NetClient *n, const int actorUID);
@@ -0,0 +1,146 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+
+    Copyright (c) 2018 Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "net_predict.h"
+
+#include <string.h>
+
+
+#define FRAME(_p, _i) \
+	(&(_p)->Frames[((_p)->Start + (_i)) % NET_PREDICT_HISTORY])
+// Sequence numbers wrap; compare by signed difference
+#define SEQ_BEFORE(_a, _b) ((int32_t)((_a) - (_b)) < 0)
+
+void NetPredictInit(NetPredict *p, const int actorUID)
+{
+	memset(p, 0, sizeof *p);
+	p->ActorUID = actorUID;
+}
+
+void NetPredictRecord(
+	NetPredict *p, const uint32_t seq, const int ticks,
+	const struct vec2 pos, const struct vec2 delta)
+{
+	if (p->Count == NET_PREDICT_HISTORY)
+	{
+		// Oldest frame is never going to be acknowledged in time; drop it
+		p->Start = (p->Start + 1) % NET_PREDICT_HISTORY;
+		p->Count--;
+	}
+	if (!p->hasLast || p->lastSeq != seq)
+	{
+		p->hasLast = true;
+		p->lastSeq = seq;
+		p->lastSeqTicks = 0;
+	}
+	NetPredictFrame *f = FRAME(p, p->Count);
+	f->Seq = seq;
+	f->SeqTicks = p->lastSeqTicks;
+	f->Ticks = ticks;
+	p->lastSeqTicks += ticks;
+	f->Pos = pos;
+	f->Delta = delta;
+	p->Count++;
+}
+
+// Index of the first frame still held with seq, or -1
+static int FindSeq(const NetPredict *p, const uint32_t seq)
+{
+	for (int i = 0; i < p->Count; i++)
+	{
+		const NetPredictFrame *f = FRAME(p, i);
+		if (f->Seq == seq)
+		{
+			return i;
+		}
+		if (!SEQ_BEFORE(f->Seq, seq))
+		{
+			break;
+		}
+	}
+	return -1;
+}
+
+static void DropFrames(NetPredict *p, const int n)
+{
+	p->Start = (p->Start + n) % NET_PREDICT_HISTORY;
+	p->Count -= n;
+}
+
+void NetPredictAck(NetPredict *p, const uint32_t seq)
+{
+	int n = 0;
+	while (n < p->Count && SEQ_BEFORE(FRAME(p, n)->Seq, seq))
+	{
+		n++;
+	}
+	DropFrames(p, n);
+}
+
+struct vec2 NetPredictReconcile(
+	NetPredict *p, const uint32_t seq, const int ticks,
+	const struct vec2 serverPos, const struct vec2 pos,
+	NetPredictMoveFunc move, void *data)
+{
+	const int first = FindSeq(p, seq);
+	// If the input was held for longer than the history, its first frames
+	// may have been dropped, even those up to where the server is
+	if (first < 0 || FRAME(p, first)->SeqTicks > ticks)
+	{
+		// Input is no longer (or not yet) in the history; nothing to replay
+		// from so take the server's position as is
+		p->LastCorrection = svec2_distance(serverPos, pos);
+		p->Count = 0;
+		return serverPos;
+	}
+	DropFrames(p, first);
+
+	// Find the frame that starts where the server's simulation is
+	int i = 0;
+	for (int t = FRAME(p, 0)->SeqTicks; i < p->Count && t < ticks; i++)
+	{
+		t += FRAME(p, i)->Ticks;
+	}
+	const struct vec2 predicted = i < p->Count ? FRAME(p, i)->Pos : pos;
+	if (svec2_distance(predicted, serverPos) < NET_PREDICT_EPSILON)
+	{
+		p->LastCorrection = 0;
+		return pos;
+	}
+
+	// Replay the frames the server hasn't simulated yet
+	struct vec2 replayed = serverPos;
+	for (; i < p->Count; i++)
+	{
+		NetPredictFrame *f = FRAME(p, i);
+		f->Pos = replayed;
+		replayed = move(data, replayed, f->Delta);
+	}
+	p->LastCorrection = svec2_distance(replayed, pos);
+	return replayed;
+}
@@ -0,0 +1,92 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+
+    Copyright (c) 2018 Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "mathc/mathc.h"
+
+// Number of frames of local movement kept for replay; about 2 seconds
+#define NET_PREDICT_HISTORY 128
+// Corrections smaller than this are treated as agreement with the server
+#define NET_PREDICT_EPSILON 0.01f
+
+// One frame of predicted movement for a local actor
+typedef struct
+{
+	// Sequence number of the movement input that was in effect
+	uint32_t Seq;
+	// Ticks since the input took effect, at the start of the frame
+	int SeqTicks;
+	int Ticks;
+	// Position at the start of the frame
+	struct vec2 Pos;
+	// Movement attempted during the frame
+	struct vec2 Delta;
+} NetPredictFrame;
+
+// Client-side prediction history for one local actor
+// Frames are recorded as the actor moves; when the server reports its
+// position as of an input, frames before that input are dropped and, if the
+// positions disagree, the frames after it are replayed from the server's
+// position.
+typedef struct
+{
+	int ActorUID;
+	NetPredictFrame Frames[NET_PREDICT_HISTORY];
+	int Start;
+	int Count;
+	// The last recorded input and how long it has been in effect; kept
+	// apart from the frames as inputs can be held longer than the history
+	bool hasLast;
+	uint32_t lastSeq;
+	int lastSeqTicks;
+	// Distance between the predicted and corrected positions at the last
+	// correction
+	float LastCorrection;
+} NetPredict;
+
+// Move from a position by a delta, returning the resulting position
+typedef struct vec2 (*NetPredictMoveFunc)(
+	void *data, const struct vec2 from, const struct vec2 delta);
+
+void NetPredictInit(NetPredict *p, const int actorUID);
+void NetPredictRecord(
+	NetPredict *p, const uint32_t seq, const int ticks,
+	const struct vec2 pos, const struct vec2 delta);
+// The server has processed input seq; drop older frames
+void NetPredictAck(NetPredict *p, const uint32_t seq);
+// The server's position was serverPos, ticks after processing input seq.
+// Returns the corrected current position, which is pos if the prediction
+// agrees with the server.
+struct vec2 NetPredictReconcile(
+	NetPredict *p, const uint32_t seq, const int ticks,
+	const struct vec2 serverPos, const struct vec2 pos,
+	NetPredictMoveFunc move, void *data);
@@ -34,20 +34,31 @@
 
 #include "actor_placement.h"
 #include "ai_utils.h"
+#include "bullet_class.h"
 #include "campaign_entry.h"
 #include "events.h"
 #include "game_events.h"
 #include "gamedata.h"
 #include "handle_game_events.h"
 #include "log.h"
-#include "los.h"
+#include "net_snapshot.h"
+#include "net_stats.h"
+#include "objs.h"
 #include "pickup.h"
 #include "player.h"
+#include "sounds.h"
 #include "sys_config.h"
 #include "utils.h"
 
 NetServer gNetServer;
 
+// Area of interest around each player, large enough to cover the screen of a
+// client at twice the default resolution; also covers the sight range
+#define AOI_HALF_W 320
+#define AOI_HALF_H 240
+// Extra distance so that NPCs are brought up to date before they are visible
+#define AOI_MARGIN (TILE_WIDTH * 4)
+
 
 void NetServerInit(NetServer *n)
 {
@@ -97,7 +108,8 @@ static ENetHost *HostOpen(void)
 	ENetAddress address;
 	address.host = ENET_HOST_ANY;
 	address.port = ENET_PORT_ANY;
-	ENetHost *host = enet_host_create(&address, NET_SERVER_MAX_CLIENTS, 2, 0, 0);
+	ENetHost *host = enet_host_create(
+		&address, NET_SERVER_MAX_CLIENTS, NET_CHANNEL_COUNT, 0, 0);
 	if (host == NULL)
 	{
 		LOG(LM_NET, LL_ERROR, "cannot create server host");
@@ -150,6 +162,12 @@ void NetServerClose(NetServer *n)
 		{
 			ENetPeer *peer = n->server->peers + i;
 			enet_peer_disconnect_now(peer, 0);
+			if (peer->data != NULL)
+			{
+				CArrayTerminate(&((NetPeerData *)peer->data)->ActorsInView);
+				CFREE(peer->data);
+				peer->data = NULL;
+			}
 		}
 		enet_host_destroy(n->server);
 	}
@@ -265,7 +283,13 @@ static void PollListener(NetServer *n)
 static void OnConnect(NetServer *n, ENetEvent event);
 static void OnReceive(NetServer *n, ENetEvent event)
 {
-	const GameEventType msg = (GameEventType)*(uint32_t *)event.packet->data;
+	GameEventType msg;
+	if (!NetDecodeType(event.packet, &msg))
+	{
+		enet_packet_destroy(event.packet);
+		return;
+	}
+	NET_STATS_COUNT(NET_STATS_RECV, msg, (int)event.packet->dataLength, 1);
 	int peerId = -1;
 	if (event.peer->data != NULL)
 	{
@@ -280,8 +304,10 @@ static void OnReceive(NetServer *n, ENetEvent event)
 		// Game event message; decode and add to event queue
 		LOG(LM_NET, LL_TRACE, "recv gameEvent(%d)", (int)gee.Type);
 		GameEvent e = GameEventNew(gee.Type);
-		NetDecode(event.packet, &e.u, gee.Fields);
-		GameEventsEnqueue(&gGameEvents, e);
+		if (gee.Fields == NULL || NetDecode(event.packet, &e.u, gee.Fields))
+		{
+			GameEventsEnqueue(&gGameEvents, e);
+		}
 	}
 	else
 	{
@@ -342,7 +368,7 @@ static void OnReceive(NetServer *n, ENetEvent event)
 			NetServerFlush(n);
 			break;
 		default:
-			CASSERT(false, "unexpected message type");
+			LOG(LM_NET, LL_WARN, "unexpected msg(%d)", (int)msg);
 			break;
 		}
 	}
@@ -355,9 +381,12 @@ static void OnConnect(NetServer *n, ENetEvent event)
 	LOG(LM_NET, LL_INFO, "new client connected from %s:%u",
 		buf, event.peer->address.port);
 	/* Store any relevant client information here. */
-	CMALLOC(event.peer->data, sizeof(NetPeerData));
+	NetPeerData *pd;
+	CCALLOC(pd, sizeof *pd);
 	const int peerId = n->peerId;
-	((NetPeerData *)event.peer->data)->Id = peerId;
+	pd->Id = peerId;
+	CArrayInit(&pd->ActorsInView, sizeof(bool));
+	event.peer->data = pd;
 	n->peerId++;
 
 	// Send the client ID
@@ -383,6 +412,7 @@ static void OnDisconnect(const ENetEvent event)
 	if (event.peer->data != NULL)
 	{
 		peerId = ((NetPeerData *)event.peer->data)->Id;
+		CArrayTerminate(&((NetPeerData *)event.peer->data)->ActorsInView);
 		CFREE(event.peer->data);
 		event.peer->data = NULL;
 	}
@@ -408,6 +438,7 @@ void NetServerFlush(NetServer *n)
 
 static void SendConfig(
 	Config *config, const char *name, NetServer *n, const int peerId);
+static void SendSnapshot(NetServer *n, const int peerId);
 void NetServerSendGameStartMessages(NetServer *n, const int peerId)
 {
 	// Send details of all current players
@@ -428,24 +459,9 @@ void NetServerSendGameStartMessages(NetServer *n, const int peerId)
 
 	NetServerSendMsg(n, peerId, GAME_EVENT_NET_GAME_START, NULL);
 
-	// Send all actors
-	CA_FOREACH(const TActor, a, gActors)
-		if (!a->isInUse)
-		{
-			continue;
-		}
-		NActorAdd aa = NActorAdd_init_default;
-		aa.UID = a->uid;
-		aa.CharId = a->charId;
-		aa.Health = a->health;
-		aa.Direction = (int32_t)a->direction;
-		aa.PlayerUID = a->PlayerUID;
-		aa.ThingFlags = a->thing.flags;
-		aa.Pos = Vec2ToNet(a->Pos);
-		LOG(LM_NET, LL_DEBUG, "send add actor UID(%d) playerUID(%d)",
-			(int)aa.UID, (int)aa.PlayerUID);
-		NetServerSendMsg(n, peerId, GAME_EVENT_ACTOR_ADD, &aa);
-	CA_FOREACH_END()
+	// Send tiles and entities as one snapshot; the client holds game messages
+	// until it has applied it
+	SendSnapshot(n, peerId);
 
 	// Send key state
 	NAddKeys ak = NAddKeys_init_default;
@@ -460,93 +476,6 @@ void NetServerSendGameStartMessages(NetServer *n, const int peerId)
 		NetServerSendMsg(n, peerId, GAME_EVENT_OBJECTIVE_UPDATE, &ou);
 	CA_FOREACH_END()
 
-	// Send all tiles, RLE
-	const Tile *tLast = NULL;
-	NTileSet ts = NTileSet_init_default;
-	struct vec2i pos;
-	for (pos.y = 0; pos.y < gMap.Size.y; pos.y++)
-	{
-		for (pos.x = 0; pos.x < gMap.Size.x; pos.x++)
-		{
-			const Tile *t = MapGetTile(&gMap, pos);
-			// Use RLE, so check if the current tile is the same as the last
-			if (tLast != NULL && t->Class == tLast->Class)
-			{
-				ts.RunLength++;
-			}
-			else
-			{
-				// Send the last run
-				if (tLast != NULL)
-				{
-					NetServerSendMsg(n, peerId, GAME_EVENT_TILE_SET, &ts);
-				}
-				// Begin the next run
-				memset(&ts, 0, sizeof ts);
-				ts.Pos = Vec2i2Net(pos);
-				if (t->Class != NULL && t->Class->Name)
-				{
-					strcpy(ts.ClassName, t->Class->Name);
-				}
-				ts.RunLength = 0;
-			}
-			tLast = t;
-		}
-	}
-	NetServerSendMsg(n, peerId, GAME_EVENT_TILE_SET, &ts);
-
-	// Send all the tiles visited so far
-	NExploreTiles et = NExploreTiles_init_default;
-	et.Runs_count = 0;
-	et.Runs[0].Run = 0;
-	bool run = false;
-	for (pos.y = 0; pos.y < gMap.Size.y; pos.y++)
-	{
-		for (pos.x = 0; pos.x < gMap.Size.x; pos.x++)
-		{
-			const Tile *t = MapGetTile(&gMap, pos);
-			if (LOSAddRun(&et, &run, pos, t->isVisited))
-			{
-				NetServerSendMsg(n, peerId, GAME_EVENT_EXPLORE_TILES, &et);
-				et.Runs_count = 0;
-				et.Runs[0].Run = 0;
-				run = false;
-			}
-		}
-	}
-	if (et.Runs_count > 0)
-	{
-		NetServerSendMsg(n, peerId, GAME_EVENT_EXPLORE_TILES, &et);
-	}
-
-	// Send all pickups
-	CA_FOREACH(const Pickup, p, gPickups)
-		if (!p->isInUse) continue;
-		NAddPickup api = NAddPickup_init_default;
-		api.UID = p->UID;
-		strcpy(api.PickupClass, p->class->Name);
-		api.IsRandomSpawned = p->IsRandomSpawned;
-		api.SpawnerUID = p->SpawnerUID;
-		api.ThingFlags = p->thing.flags;
-		api.Pos = Vec2ToNet(p->thing.Pos);
-		NetServerSendMsg(n, peerId, GAME_EVENT_ADD_PICKUP, &api);
-	CA_FOREACH_END()
-
-	// Send all map objects
-	CA_FOREACH(const TObject, o, gObjs)
-		if (!o->isInUse) continue;
-		NMapObjectAdd amo = NMapObjectAdd_init_default;
-		amo.UID = o->uid;
-		strcpy(amo.MapObjectClass, o->Class->Name);
-		amo.Pos = Vec2ToNet(o->thing.Pos);
-		amo.ThingFlags = o->thing.flags;
-		amo.Health = o->Health;
-		LOG(LM_NET, LL_DEBUG,
-			"send add map object UID(%d) pos(%d, %d) flags(%x) health(%d)",
-			(int)amo.UID, amo.Pos.x, amo.Pos.y, amo.ThingFlags, amo.Health);
-		NetServerSendMsg(n, peerId, GAME_EVENT_MAP_OBJECT_ADD, &amo);
-	CA_FOREACH_END()
-
 	// If mission complete already, send message
 	if (CanCompleteMission(&gMission))
 	{
@@ -554,6 +483,32 @@ void NetServerSendGameStartMessages(NetServer *n, const int peerId)
 		NetServerSendMsg(n, peerId, GAME_EVENT_MISSION_COMPLETE, &mc);
 	}
 }
+static void SendSnapshot(NetServer *n, const int peerId)
+{
+	if (!n->server || n->server->connectedPeers == 0) return;
+	CArray blob;
+	CArrayInit(&blob, sizeof(uint8_t));
+	NetSnapshotMake(&blob);
+	for (int i = 0; i < (int)n->server->peerCount; i++)
+	{
+		ENetPeer *peer = n->server->peers + i;
+		if (peer->state != ENET_PEER_STATE_CONNECTED || peer->data == NULL ||
+			(peerId >= 0 && ((NetPeerData *)peer->data)->Id != peerId))
+		{
+			continue;
+		}
+		for (size_t offset = 0; offset < blob.size;
+			offset += NET_SNAPSHOT_FRAGMENT_SIZE)
+		{
+			ENetPacket *packet = NetSnapshotFragment(&blob, offset);
+			NET_STATS_COUNT(
+				NET_STATS_SENT, GAME_EVENT_NET_SNAPSHOT,
+				(int)packet->dataLength, 1);
+			enet_peer_send(peer, NET_CHANNEL_GAME, packet);
+		}
+	}
+	CArrayTerminate(&blob);
+}
 static void SendConfig(
 	Config *config, const char *name, NetServer *n, const int peerId)
 {
@@ -587,6 +542,11 @@ static void SendConfig(
 	NetServerSendMsg(n, peerId, GAME_EVENT_CONFIG, &msg);
 }
 
+static bool GetEventArea(
+	const GameEventType e, const void *data, struct vec2 *pos, float *reach);
+static void SendToInterested(
+	NetServer *n, const GameEventType e, const void *data,
+	const struct vec2 pos, const float reach);
 void NetServerSendMsg(
 	NetServer *n, const int peerId, const GameEventType e, const void *data)
 {
@@ -603,7 +563,10 @@ void NetServerSendMsg(
 			if (peer->data != NULL &&
 				((NetPeerData *)peer->data)->Id == peerId)
 			{
-				enet_peer_send(peer, 0, NetEncode(e, data));
+				ENetPacket *packet = NetEncode(e, data);
+				NET_STATS_COUNT(
+					NET_STATS_SENT, e, (int)packet->dataLength, 1);
+				enet_peer_send(peer, NET_CHANNEL_GAME, packet);
 				return;
 			}
 		}
@@ -611,8 +574,191 @@ void NetServerSendMsg(
 	}
 	else
 	{
+		struct vec2 pos;
+		float reach;
+		if (GetEventArea(e, data, &pos, &reach))
+		{
+			SendToInterested(n, e, data, pos, reach);
+			return;
+		}
 		LOG(LM_NET, LL_TRACE, "bcast msg(%d) to peers(%d)",
 			(int)e, (int)n->server->connectedPeers);
-		enet_host_broadcast(n->server, 0, NetEncode(e, data));
+		ENetPacket *packet = NetEncode(e, data);
+		NET_STATS_COUNT(
+			NET_STATS_SENT, e, (int)packet->dataLength,
+			(int)n->server->connectedPeers);
+		enet_host_broadcast(n->server, NET_CHANNEL_GAME, packet);
+	}
+}
+static float BulletReach(const BulletClass *b)
+{
+	return b == NULL ? 0 : b->SpeedHigh * (float)b->RangeHigh;
+}
+static bool GetNPCPos(const int uid, struct vec2 *pos)
+{
+	const TActor *a = ActorGetByUID(uid);
+	if (a == NULL || !a->isInUse || a->PlayerUID >= 0) return false;
+	*pos = a->Pos;
+	return true;
+}
+static bool GetBulletArea(const int uid, struct vec2 *pos, float *reach)
+{
+	const TMobileObject *o = MobObjGetByUID(uid);
+	if (o == NULL || !o->isInUse) return false;
+	*pos = o->thing.Pos;
+	*reach = BulletReach(o->bulletClass);
+	return true;
+}
+static bool GetEventArea(
+	const GameEventType e, const void *data, struct vec2 *pos, float *reach)
+{
+	*reach = 0;
+	switch (e)
+	{
+	case GAME_EVENT_ADD_BULLET:
+		{
+			// Bullets can fly into view; include their full travel
+			const NAddBullet *ab = data;
+			*pos = NetToVec2(ab->MuzzlePos);
+			*reach = BulletReach(StrBulletClass(ab->BulletClass));
+		}
+		return true;
+	case GAME_EVENT_BULLET_BOUNCE:
+		{
+			// Peers that have the bullet need the bounce, or their copy of
+			// it diverges
+			const NBulletBounce *bb = data;
+			if (!GetBulletArea((int)bb->UID, pos, reach)) return false;
+			*pos = NetToVec2(bb->BouncePos);
+		}
+		return true;
+	case GAME_EVENT_REMOVE_BULLET:
+		return GetBulletArea(
+			(int)((const NRemoveBullet *)data)->UID, pos, reach);
+	case GAME_EVENT_SOUND_AT:
+		// Sounds are heard from further than a screen away, in any direction
+		*pos = NetToVec2(((const NSound *)data)->Pos);
+		*reach = SoundGetMaxDistance(AOI_HALF_W * 2);
+		return true;
+	case GAME_EVENT_ACTOR_MOVE:
+		return GetNPCPos((int)((const NActorMove *)data)->UID, pos);
+	case GAME_EVENT_ACTOR_DIR:
+		return GetNPCPos((int)((const NActorDir *)data)->UID, pos);
+	case GAME_EVENT_ACTOR_STATE:
+		return GetNPCPos((int)((const NActorState *)data)->UID, pos);
+	default:
+		return false;
+	}
+}
+static bool PeerIsInterested(
+	const NetPeerData *pd, const struct vec2 pos, const struct vec2 halfSize)
+{
+	if (pd->NumViews == 0) return true;
+	for (int i = 0; i < pd->NumViews; i++)
+	{
+		if (fabsf(pos.x - pd->Views[i].x) <= halfSize.x &&
+			fabsf(pos.y - pd->Views[i].y) <= halfSize.y)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+static void SendToInterested(
+	NetServer *n, const GameEventType e, const void *data,
+	const struct vec2 pos, const float reach)
+{
+	const struct vec2 halfSize = svec2_add(n->AOIHalfSize, svec2(reach, reach));
+	ENetPacket *packet = NetEncode(e, data);
+	int sent = 0;
+	for (int i = 0; i < (int)n->server->peerCount; i++)
+	{
+		ENetPeer *peer = n->server->peers + i;
+		if (peer->state != ENET_PEER_STATE_CONNECTED) continue;
+		if (peer->data != NULL &&
+			!PeerIsInterested(peer->data, pos, halfSize))
+		{
+			continue;
+		}
+		enet_peer_send(peer, NET_CHANNEL_GAME, packet);
+		sent++;
 	}
+	NET_STATS_COUNT(NET_STATS_SENT, e, (int)packet->dataLength, sent);
+	LOG(LM_NET, LL_TRACE, "send msg(%d) to interested peers(%d/%d)",
+		(int)e, sent, (int)n->server->connectedPeers);
+	if (packet->referenceCount == 0)
+	{
+		enet_packet_destroy(packet);
+	}
+}
+
+static void UpdatePeerInterest(NetServer *n, NetPeerData *pd);
+void NetServerUpdateInterest(NetServer *n)
+{
+	if (!n->server) return;
+
+	const float sight = ConfigGetBool(&gConfig, "Game.Fog") ?
+		(float)(ConfigGetInt(&gConfig, "Game.SightRange") * TILE_WIDTH) : 0;
+	n->AOIHalfSize = svec2(
+		MAX(AOI_HALF_W, sight) + AOI_MARGIN,
+		MAX(AOI_HALF_H, sight) + AOI_MARGIN);
+
+	for (int i = 0; i < (int)n->server->peerCount; i++)
+	{
+		ENetPeer *peer = n->server->peers + i;
+		if (peer->state != ENET_PEER_STATE_CONNECTED || peer->data == NULL)
+		{
+			continue;
+		}
+		UpdatePeerInterest(n, peer->data);
+	}
+}
+static void SendActorState(NetServer *n, const int peerId, const TActor *a);
+static void UpdatePeerInterest(NetServer *n, NetPeerData *pd)
+{
+	pd->NumViews = 0;
+	for (int i = 0; i < MAX_LOCAL_PLAYERS; i++)
+	{
+		const int uid = (pd->Id + 1) * MAX_LOCAL_PLAYERS + i;
+		const PlayerData *p = PlayerDataGetByUID(uid);
+		if (p == NULL) continue;
+		const TActor *a = ActorGetByUID(p->ActorUID);
+		if (a == NULL || !a->isInUse || a->dead) continue;
+		pd->Views[pd->NumViews++] = a->Pos;
+	}
+
+	// NPC updates are not sent outside the area of interest, so bring NPCs
+	// up to date as they enter it
+	while (pd->ActorsInView.size < gActors.size)
+	{
+		const bool f = false;
+		CArrayPushBack(&pd->ActorsInView, &f);
+	}
+	CA_FOREACH(const TActor, a, gActors)
+		bool *wasInView = CArrayGet(&pd->ActorsInView, _ca_index);
+		const bool inView = a->isInUse && a->PlayerUID < 0 &&
+			PeerIsInterested(pd, a->Pos, n->AOIHalfSize);
+		if (inView && !*wasInView)
+		{
+			SendActorState(n, pd->Id, a);
+		}
+		*wasInView = inView;
+	CA_FOREACH_END()
+}
+static void SendActorState(NetServer *n, const int peerId, const TActor *a)
+{
+	NActorMove am = NActorMove_init_default;
+	am.UID = a->uid;
+	am.Pos = Vec2ToNet(a->Pos);
+	am.MoveVel = Vec2ToNet(a->MoveVel);
+	am.Seq = a->InputSeq;
+	NetServerSendMsg(n, peerId, GAME_EVENT_ACTOR_MOVE, &am);
+	NActorDir ad = NActorDir_init_default;
+	ad.UID = a->uid;
+	ad.Dir = (int32_t)a->direction;
+	NetServerSendMsg(n, peerId, GAME_EVENT_ACTOR_DIR, &ad);
+	NActorState as = NActorState_init_default;
+	as.UID = a->uid;
+	as.State = (int32_t)a->anim.Type;
+	NetServerSendMsg(n, peerId, GAME_EVENT_ACTOR_STATE, &as);
 }
@@ -47,6 +47,8 @@ typedef struct
 	int PrevCmd;
 	int Cmd;
 	int peerId;	// auto-incrementing id for the next connected peer
+	// Half size of each player's area of interest
+	struct vec2 AOIHalfSize;
 } NetServer;
 
 extern NetServer gNetServer;
@@ -54,6 +56,13 @@ extern NetServer gNetServer;
 typedef struct
 {
 	int Id;
+	// Positions of the peer's live players; spatially local events far from
+	// all of these are not sent to the peer. With no views, send everything.
+	struct vec2 Views[MAX_LOCAL_PLAYERS];
+	int NumViews;
+	// Whether each NPC (by index into gActors) was in the peer's area of
+	// interest at the last update
+	CArray ActorsInView;	// of bool
 } NetPeerData;
 
 void NetServerInit(NetServer *n);
@@ -68,7 +77,12 @@ void NetServerPoll(NetServer *n);
 void NetServerFlush(NetServer *n);
 
 // If peerId is -1, broadcast
+// Broadcasts of spatially local events only go to peers whose players are
+// near the event
 void NetServerSendMsg(
 	NetServer *n, const int peerId, const GameEventType e, const void *data);
+// Update each peer's area of interest from its players' positions, and send
+// it the state of NPCs that have entered it
+void NetServerUpdateInterest(NetServer *n);
 
 void NetServerSendGameStartMessages(NetServer *n, const int peerId);
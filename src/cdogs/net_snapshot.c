@@ -0,0 +1,480 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+
+    Copyright (c) 2018 Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "net_snapshot.h"
+
+#include <limits.h>
+#include <string.h>
+
+#include "proto/nanopb/pb_decode.h"
+#include "proto/nanopb/pb_encode.h"
+#include "actors.h"
+#include "draw/map_chunks.h"
+#include "log.h"
+#include "map.h"
+#include "objs.h"
+#include "pickup.h"
+#include "tile_class.h"
+#include "utils.h"
+
+#define SNAPSHOT_MAGIC "CDSN"
+#define SNAPSHOT_MAGIC_SIZE 4
+// Reject fragments claiming more than this, to bound memory use
+#define SNAPSHOT_SIZE_MAX (64 * 1024 * 1024)
+#define TILE_CLASS_NAME_MAX 128
+
+typedef struct
+{
+	int Run;
+	int Class;
+	int ClassAlt;
+} TileRun;
+
+
+static bool WriteToArray(
+	pb_ostream_t *stream, const uint8_t *buf, size_t count)
+{
+	CArray *a = stream->state;
+	const size_t size = a->size;
+	if (size + count > a->capacity)
+	{
+		CArrayReserve(a, MAX(a->capacity * 2, size + count));
+	}
+	CArrayResize(a, size + count, NULL);
+	memcpy((uint8_t *)a->data + size, buf, count);
+	return true;
+}
+static int TileClassIndex(CArray *dict, const TileClass *tc)
+{
+	CA_FOREACH(const TileClass *, dtc, *dict)
+		if (*dtc == tc) return _ca_index;
+	CA_FOREACH_END()
+	CArrayPushBack(dict, &tc);
+	return (int)dict->size - 1;
+}
+static void WriteTiles(pb_ostream_t *stream)
+{
+	// Collect runs first, as the dictionary is written before them
+	CArray dict;
+	CArrayInit(&dict, sizeof(const TileClass *));
+	CArray runs;
+	CArrayInit(&runs, sizeof(TileRun));
+	TileRun run = { 0, -1, -1 };
+	struct vec2i pos;
+	for (pos.y = 0; pos.y < gMap.Size.y; pos.y++)
+	{
+		for (pos.x = 0; pos.x < gMap.Size.x; pos.x++)
+		{
+			const Tile *t = MapGetTile(&gMap, pos);
+			const int c = TileClassIndex(&dict, t->Class);
+			const int alt = TileClassIndex(&dict, t->ClassAlt);
+			if (run.Run > 0 && c == run.Class && alt == run.ClassAlt)
+			{
+				run.Run++;
+				continue;
+			}
+			if (run.Run > 0)
+			{
+				CArrayPushBack(&runs, &run);
+			}
+			run.Run = 1;
+			run.Class = c;
+			run.ClassAlt = alt;
+		}
+	}
+	if (run.Run > 0)
+	{
+		CArrayPushBack(&runs, &run);
+	}
+
+	pb_encode_varint(stream, dict.size);
+	CA_FOREACH(const TileClass *, tc, dict)
+		const char *name =
+			(*tc != NULL && (*tc)->Name != NULL) ? (*tc)->Name : "";
+		pb_encode_string(stream, (const uint8_t *)name, strlen(name));
+	CA_FOREACH_END()
+	pb_encode_varint(stream, runs.size);
+	CA_FOREACH(const TileRun, r, runs)
+		pb_encode_varint(stream, r->Run);
+		pb_encode_varint(stream, r->Class);
+		pb_encode_varint(stream, r->ClassAlt);
+	CA_FOREACH_END()
+	CArrayTerminate(&dict);
+	CArrayTerminate(&runs);
+}
+static void WriteExplored(pb_ostream_t *stream)
+{
+	// Runs alternate between unexplored and explored, starting unexplored
+	CArray runs;
+	CArrayInit(&runs, sizeof(int));
+	bool explored = false;
+	int run = 0;
+	struct vec2i pos;
+	for (pos.y = 0; pos.y < gMap.Size.y; pos.y++)
+	{
+		for (pos.x = 0; pos.x < gMap.Size.x; pos.x++)
+		{
+			if (MapGetTile(&gMap, pos)->isVisited != explored)
+			{
+				CArrayPushBack(&runs, &run);
+				explored = !explored;
+				run = 0;
+			}
+			run++;
+		}
+	}
+	CArrayPushBack(&runs, &run);
+	pb_encode_varint(stream, runs.size);
+	CA_FOREACH(const int, r, runs)
+		pb_encode_varint(stream, *r);
+	CA_FOREACH_END()
+	CArrayTerminate(&runs);
+}
+static void WriteActors(pb_ostream_t *stream)
+{
+	int count = 0;
+	CA_FOREACH(const TActor, a, gActors)
+		if (a->isInUse) count++;
+	CA_FOREACH_END()
+	pb_encode_varint(stream, count);
+	CA_FOREACH(const TActor, a, gActors)
+		if (!a->isInUse) continue;
+		NActorAdd aa = NActorAdd_init_default;
+		aa.UID = a->uid;
+		aa.CharId = a->charId;
+		aa.Health = a->health;
+		aa.Direction = (int32_t)a->direction;
+		aa.PlayerUID = a->PlayerUID;
+		aa.ThingFlags = a->thing.flags;
+		aa.Pos = Vec2ToNet(a->Pos);
+		pb_encode_delimited(stream, NActorAdd_fields, &aa);
+	CA_FOREACH_END()
+}
+static void WritePickups(pb_ostream_t *stream)
+{
+	int count = 0;
+	CA_FOREACH(const Pickup, p, gPickups)
+		if (p->isInUse) count++;
+	CA_FOREACH_END()
+	pb_encode_varint(stream, count);
+	CA_FOREACH(const Pickup, p, gPickups)
+		if (!p->isInUse) continue;
+		NAddPickup api = NAddPickup_init_default;
+		api.UID = p->UID;
+		strcpy(api.PickupClass, p->class->Name);
+		api.IsRandomSpawned = p->IsRandomSpawned;
+		api.SpawnerUID = p->SpawnerUID;
+		api.ThingFlags = p->thing.flags;
+		api.Pos = Vec2ToNet(p->thing.Pos);
+		pb_encode_delimited(stream, NAddPickup_fields, &api);
+	CA_FOREACH_END()
+}
+static void WriteObjects(pb_ostream_t *stream)
+{
+	int count = 0;
+	CA_FOREACH(const TObject, o, gObjs)
+		if (o->isInUse) count++;
+	CA_FOREACH_END()
+	pb_encode_varint(stream, count);
+	CA_FOREACH(const TObject, o, gObjs)
+		if (!o->isInUse) continue;
+		NMapObjectAdd amo = NMapObjectAdd_init_default;
+		amo.UID = o->uid;
+		strcpy(amo.MapObjectClass, o->Class->Name);
+		amo.Pos = Vec2ToNet(o->thing.Pos);
+		amo.ThingFlags = o->thing.flags;
+		amo.Health = o->Health;
+		pb_encode_delimited(stream, NMapObjectAdd_fields, &amo);
+	CA_FOREACH_END()
+}
+void NetSnapshotMake(CArray *blob)
+{
+	CArrayClear(blob);
+	pb_ostream_t stream;
+	memset(&stream, 0, sizeof stream);
+	stream.callback = WriteToArray;
+	stream.state = blob;
+	stream.max_size = SIZE_MAX;
+	pb_write(&stream, (const uint8_t *)SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE);
+	pb_encode_varint(&stream, NET_SNAPSHOT_VERSION);
+	pb_encode_varint(&stream, gMap.Size.x);
+	pb_encode_varint(&stream, gMap.Size.y);
+	WriteTiles(&stream);
+	WriteExplored(&stream);
+	WriteActors(&stream);
+	WritePickups(&stream);
+	WriteObjects(&stream);
+	LOG(LM_NET, LL_DEBUG, "made snapshot size(%d)", (int)blob->size);
+}
+
+ENetPacket *NetSnapshotFragment(const CArray *blob, const size_t offset)
+{
+	const size_t size = MIN(blob->size - offset, NET_SNAPSHOT_FRAGMENT_SIZE);
+	ENetPacket *packet = NetPacketNew(
+		GAME_EVENT_NET_SNAPSHOT, 2 * sizeof(uint32_t) + size);
+	uint8_t *buf = packet->data + NET_MSG_SIZE;
+	const uint32_t header[2] = { (uint32_t)offset, (uint32_t)blob->size };
+	memcpy(buf, header, sizeof header);
+	memcpy(buf + sizeof header, (const uint8_t *)blob->data + offset, size);
+	return packet;
+}
+
+bool NetSnapshotAddFragment(
+	CArray *data, const ENetPacket *packet, bool *complete)
+{
+	uint32_t header[2];
+	if (packet->dataLength < NET_MSG_SIZE + sizeof header)
+	{
+		LOG(LM_NET, LL_WARN, "snapshot fragment too short");
+		return false;
+	}
+	memcpy(header, packet->data + NET_MSG_SIZE, sizeof header);
+	const size_t offset = header[0];
+	const size_t total = header[1];
+	const size_t size = packet->dataLength - NET_MSG_SIZE - sizeof header;
+	if (offset == 0)
+	{
+		CArrayClear(data);
+	}
+	// Fragments arrive in order, on a reliable channel
+	if (offset != data->size || total > SNAPSHOT_SIZE_MAX ||
+		offset + size > total)
+	{
+		LOG(LM_NET, LL_WARN,
+			"bad snapshot fragment offset(%d) size(%d) total(%d) have(%d)",
+			(int)offset, (int)size, (int)total, (int)data->size);
+		return false;
+	}
+	CArrayReserve(data, total);
+	CArrayResize(data, offset + size, NULL);
+	memcpy(
+		(uint8_t *)data->data + offset,
+		packet->data + NET_MSG_SIZE + sizeof header, size);
+	*complete = data->size == total;
+	return true;
+}
+
+static bool ReadCount(pb_istream_t *stream, const int max, int *count)
+{
+	uint64_t v;
+	if (max < 0 || !pb_decode_varint(stream, &v) || v > (uint64_t)max)
+	{
+		return false;
+	}
+	*count = (int)v;
+	return true;
+}
+static bool ReadTiles(
+	pb_istream_t *stream, const int numTiles, CArray *dict, CArray *runs)
+{
+	int dictSize;
+	if (!ReadCount(stream, numTiles * 2, &dictSize)) return false;
+	for (int i = 0; i < dictSize; i++)
+	{
+		int len;
+		char name[TILE_CLASS_NAME_MAX];
+		if (!ReadCount(stream, TILE_CLASS_NAME_MAX - 1, &len) ||
+			!pb_read(stream, (uint8_t *)name, len))
+		{
+			return false;
+		}
+		name[len] = '\0';
+		const TileClass *tc = StrTileClass(name);
+		CArrayPushBack(dict, &tc);
+	}
+	int numRuns;
+	if (!ReadCount(stream, numTiles, &numRuns)) return false;
+	int total = 0;
+	for (int i = 0; i < numRuns; i++)
+	{
+		TileRun r;
+		if (!ReadCount(stream, numTiles - total, &r.Run) ||
+			!ReadCount(stream, dictSize - 1, &r.Class) ||
+			!ReadCount(stream, dictSize - 1, &r.ClassAlt))
+		{
+			return false;
+		}
+		total += r.Run;
+		CArrayPushBack(runs, &r);
+	}
+	return total == numTiles;
+}
+static bool ReadExplored(pb_istream_t *stream, const int numTiles, CArray *runs)
+{
+	int numRuns;
+	if (!ReadCount(stream, numTiles + 1, &numRuns)) return false;
+	int total = 0;
+	for (int i = 0; i < numRuns; i++)
+	{
+		int r;
+		if (!ReadCount(stream, numTiles - total, &r)) return false;
+		total += r;
+		CArrayPushBack(runs, &r);
+	}
+	return total == numTiles;
+}
+static bool ReadEntities(
+	pb_istream_t *stream, CArray *entities, const pb_field_t *fields)
+{
+	int count;
+	if (!ReadCount(stream, (int)MIN(stream->bytes_left, INT_MAX), &count))
+	{
+		return false;
+	}
+	// Decode into a scratch entity and only then keep it, so that a bad
+	// count cannot allocate more than the entities actually received
+	bool ok = true;
+	void *e;
+	CMALLOC(e, entities->elemSize);
+	for (int i = 0; i < count; i++)
+	{
+		if (!pb_decode_delimited(stream, fields, e))
+		{
+			ok = false;
+			break;
+		}
+		CArrayPushBack(entities, e);
+	}
+	CFREE(e);
+	return ok;
+}
+static void ApplyTiles(const CArray *dict, const CArray *runs)
+{
+	struct vec2i pos = svec2i_zero();
+	CA_FOREACH(const TileRun, r, *runs)
+		const TileClass *tc = *(const TileClass **)CArrayGet(dict, r->Class);
+		const TileClass *tcAlt =
+			*(const TileClass **)CArrayGet(dict, r->ClassAlt);
+		for (int i = 0; i < r->Run; i++)
+		{
+			Tile *t = MapGetTile(&gMap, pos);
+			t->Class = tc;
+			t->ClassAlt = tcAlt;
+			MapUpdateTileBits(&gMap, pos);
+			MapChunksInvalidateTile(&gMapChunks, pos);
+			pos.x++;
+			if (pos.x == gMap.Size.x)
+			{
+				pos.x = 0;
+				pos.y++;
+			}
+		}
+	CA_FOREACH_END()
+}
+static void ApplyExplored(const CArray *runs)
+{
+	struct vec2i pos = svec2i_zero();
+	CA_FOREACH(const int, r, *runs)
+		const bool explored = _ca_index % 2 == 1;
+		for (int i = 0; i < *r; i++)
+		{
+			if (explored)
+			{
+				MapMarkAsVisited(&gMap, pos);
+			}
+			pos.x++;
+			if (pos.x == gMap.Size.x)
+			{
+				pos.x = 0;
+				pos.y++;
+			}
+		}
+	CA_FOREACH_END()
+}
+bool NetSnapshotApply(uint8_t *data, const size_t size)
+{
+	bool ok = false;
+	CArray dict;
+	CArrayInit(&dict, sizeof(const TileClass *));
+	CArray tileRuns;
+	CArrayInit(&tileRuns, sizeof(TileRun));
+	CArray exploredRuns;
+	CArrayInit(&exploredRuns, sizeof(int));
+	CArray actors;
+	CArrayInit(&actors, sizeof(NActorAdd));
+	CArray pickups;
+	CArrayInit(&pickups, sizeof(NAddPickup));
+	CArray objs;
+	CArrayInit(&objs, sizeof(NMapObjectAdd));
+
+	// Read and validate everything before changing the game
+	pb_istream_t stream = pb_istream_from_buffer(data, size);
+	char magic[SNAPSHOT_MAGIC_SIZE];
+	uint64_t version, w, h;
+	if (!pb_read(&stream, (uint8_t *)magic, SNAPSHOT_MAGIC_SIZE) ||
+		memcmp(magic, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE) != 0 ||
+		!pb_decode_varint(&stream, &version) ||
+		version != NET_SNAPSHOT_VERSION)
+	{
+		LOG(LM_NET, LL_ERROR, "unknown snapshot format");
+		goto bail;
+	}
+	if (!pb_decode_varint(&stream, &w) || !pb_decode_varint(&stream, &h) ||
+		w != (uint64_t)gMap.Size.x || h != (uint64_t)gMap.Size.y)
+	{
+		LOG(LM_NET, LL_ERROR, "snapshot map size does not match");
+		goto bail;
+	}
+	const int numTiles = gMap.Size.x * gMap.Size.y;
+	if (!ReadTiles(&stream, numTiles, &dict, &tileRuns) ||
+		!ReadExplored(&stream, numTiles, &exploredRuns) ||
+		!ReadEntities(&stream, &actors, NActorAdd_fields) ||
+		!ReadEntities(&stream, &pickups, NAddPickup_fields) ||
+		!ReadEntities(&stream, &objs, NMapObjectAdd_fields))
+	{
+		LOG(LM_NET, LL_ERROR, "malformed snapshot: %s",
+			PB_GET_ERROR(&stream));
+		goto bail;
+	}
+
+	ApplyTiles(&dict, &tileRuns);
+	ApplyExplored(&exploredRuns);
+	CA_FOREACH(const NActorAdd, aa, actors)
+		ActorAdd(*aa);
+	CA_FOREACH_END()
+	CA_FOREACH(const NAddPickup, ap, pickups)
+		PickupAdd(*ap);
+	CA_FOREACH_END()
+	CA_FOREACH(const NMapObjectAdd, amo, objs)
+		ObjAdd(*amo);
+	CA_FOREACH_END()
+	LOG(LM_NET, LL_DEBUG,
+		"applied snapshot size(%d) runs(%d) actors(%d) pickups(%d) objs(%d)",
+		(int)size, (int)tileRuns.size, (int)actors.size,
+		(int)pickups.size, (int)objs.size);
+	ok = true;
+
+bail:
+	CArrayTerminate(&dict);
+	CArrayTerminate(&tileRuns);
+	CArrayTerminate(&exploredRuns);
+	CArrayTerminate(&actors);
+	CArrayTerminate(&pickups);
+	CArrayTerminate(&objs);
+	return ok;
+}
@@ -0,0 +1,58 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+
+    Copyright (c) 2018 Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "c_array.h"
+#include "net_util.h"
+
+// A snapshot of everything a joining client needs to catch up: tiles,
+// explored tiles, actors, pickups and map objects, in one versioned blob.
+// Tiles are a dictionary of tile classes plus runs of (class, alt class)
+// indices, explored tiles are alternating runs, and entities are
+// length-delimited protobuf messages; all counts are varints.
+#define NET_SNAPSHOT_VERSION 1
+// Fragment body size, so that fragments fit in one packet buffer and
+// under a typical MTU
+#define NET_SNAPSHOT_FRAGMENT_SIZE (1024 - NET_MSG_SIZE - 2 * sizeof(uint32_t))
+
+// Encode the current game state into blob, an array of uint8_t
+void NetSnapshotMake(CArray *blob);
+// Packet carrying the fragment of the blob that starts at offset
+ENetPacket *NetSnapshotFragment(const CArray *blob, const size_t offset);
+// Append a received fragment to data; returns false if the fragment is
+// malformed or out of order, otherwise sets whether data is complete
+bool NetSnapshotAddFragment(
+	CArray *data, const ENetPacket *packet, bool *complete);
+// Validate the whole snapshot and then apply it to the game;
+// nothing is applied if it is malformed
+bool NetSnapshotApply(uint8_t *data, const size_t size);
@@ -0,0 +1,278 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+
+    Copyright (c) 2018 Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "net_stats.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <SDL_timer.h>
+
+#include "font.h"
+#include "grafx.h"
+#include "log.h"
+#include "net_client.h"
+#include "net_server.h"
+#include "utils.h"
+
+// Window over which peers are sampled and throughput is aggregated
+#define WINDOW_MS 1000
+// Number of message types shown in the overlay
+#define DRAW_TOP_TYPES 8
+
+
+NetStats gNetStats;
+
+const char *NetStatsDirStr(const NetStatsDir d)
+{
+	switch (d)
+	{
+		T2S(NET_STATS_SENT, "sent");
+		T2S(NET_STATS_RECV, "recv");
+	default:
+		return "";
+	}
+}
+
+static void ResetCounters(NetStats *s)
+{
+	memset(s->Counters, 0, sizeof s->Counters);
+}
+
+void NetStatsInit(NetStats *s, const char *filename)
+{
+	memset(s, 0, sizeof *s);
+	s->Enabled = true;
+	CArrayInit(&s->Peers, sizeof(NetStatsPeer));
+	if (filename != NULL)
+	{
+		strncpy(s->Filename, filename, CDOGS_PATH_MAX - 1);
+	}
+	s->WindowStart = SDL_GetTicks();
+	LOG(LM_NET, LL_INFO, "net stats enabled, file(%s)", s->Filename);
+}
+void NetStatsTerminate(NetStats *s)
+{
+	if (!s->Enabled)
+	{
+		return;
+	}
+	CArrayTerminate(&s->Peers);
+	s->Enabled = false;
+}
+
+void NetStatsCount(
+	NetStats *s, const NetStatsDir d, const GameEventType e,
+	const int bytes, const int packets)
+{
+	if ((int)e < 0 || (int)e >= NET_STATS_MSG_TYPES)
+	{
+		return;
+	}
+	NetStatsCounter *c = &s->Counters[d][(int)e];
+	c->Msgs++;
+	c->Packets += packets;
+	c->Bytes += (Uint64)bytes * packets;
+	s->WindowBytes[d] += (Uint64)bytes * packets;
+}
+
+static void SamplePeer(NetStats *s, const ENetPeer *peer, const int peerId)
+{
+	NetStatsPeer p;
+	p.PeerId = peerId;
+	p.RTT = peer->roundTripTime;
+	p.PacketLoss = (float)peer->packetLoss / ENET_PEER_PACKET_LOSS_SCALE;
+	p.Throttle =
+		(float)peer->packetThrottle / ENET_PEER_PACKET_THROTTLE_SCALE;
+	CArrayPushBack(&s->Peers, &p);
+}
+void NetStatsUpdate(NetStats *s, const Uint32 ticksNow)
+{
+	const Uint32 elapsed = ticksNow - s->WindowStart;
+	if (elapsed < WINDOW_MS)
+	{
+		return;
+	}
+	for (int i = 0; i < (int)NET_STATS_DIR_COUNT; i++)
+	{
+		s->BytesPerSec[i] = s->WindowBytes[i] * 1000.0 / elapsed;
+		s->WindowBytes[i] = 0;
+	}
+	s->WindowStart = ticksNow;
+
+	CArrayClear(&s->Peers);
+	if (gNetServer.server != NULL)
+	{
+		for (int i = 0; i < (int)gNetServer.server->peerCount; i++)
+		{
+			const ENetPeer *peer = gNetServer.server->peers + i;
+			if (peer->state != ENET_PEER_STATE_CONNECTED) continue;
+			const NetPeerData *pd = peer->data;
+			SamplePeer(s, peer, pd != NULL ? pd->Id : -1);
+		}
+	}
+	if (NetClientIsConnected(&gNetClient))
+	{
+		SamplePeer(s, gNetClient.peer, -1);
+	}
+}
+
+void NetStatsMissionEnd(NetStats *s)
+{
+	if (strlen(s->Filename) > 0)
+	{
+		NetStatsWrite(s, s->Filename);
+	}
+	ResetCounters(s);
+	s->Mission++;
+}
+
+static Uint64 TypeBytes(const NetStats *s, const int type)
+{
+	return s->Counters[NET_STATS_SENT][type].Bytes +
+		s->Counters[NET_STATS_RECV][type].Bytes;
+}
+void NetStatsDraw(const NetStats *s)
+{
+	// Draw on the right, to leave room for the profiler
+	const int w = FontStrW("ActorImpulse: 99999/99999 msgs 9999999 B");
+	struct vec2i pos = svec2i(gGraphicsDevice.cachedConfig.Res.x - w - 5, 5);
+	char buf[256];
+	sprintf(buf, "net: sent %.0f B/s recv %.0f B/s",
+		s->BytesPerSec[NET_STATS_SENT], s->BytesPerSec[NET_STATS_RECV]);
+	FontStrMask(buf, pos, colorYellow);
+	pos.y += FontH();
+	CA_FOREACH(const NetStatsPeer, p, s->Peers)
+		sprintf(buf, "peer %d: rtt %ums loss %.1f%% throttle %.0f%%",
+			p->PeerId, (unsigned)p->RTT, p->PacketLoss * 100.0f,
+			p->Throttle * 100.0f);
+		FontStr(buf, pos);
+		pos.y += FontH();
+	CA_FOREACH_END()
+
+	// Message types with the most bytes this mission, sent + received
+	bool shown[NET_STATS_MSG_TYPES];
+	memset(shown, 0, sizeof shown);
+	for (int n = 0; n < DRAW_TOP_TYPES; n++)
+	{
+		int top = -1;
+		for (int i = 0; i < NET_STATS_MSG_TYPES; i++)
+		{
+			if (shown[i] || TypeBytes(s, i) == 0) continue;
+			if (top == -1 || TypeBytes(s, i) > TypeBytes(s, top))
+			{
+				top = i;
+			}
+		}
+		if (top == -1)
+		{
+			break;
+		}
+		shown[top] = true;
+		sprintf(buf, "%s: %d/%d msgs %llu B",
+			GameEventTypeStr((GameEventType)top),
+			s->Counters[NET_STATS_SENT][top].Msgs,
+			s->Counters[NET_STATS_RECV][top].Msgs,
+			(unsigned long long)TypeBytes(s, top));
+		FontStr(buf, pos);
+		pos.y += FontH();
+	}
+}
+
+static void WriteCSV(const NetStats *s, FILE *f)
+{
+	if (s->Mission == 0)
+	{
+		fprintf(f, "mission,direction,type,msgs,packets,bytes\n");
+	}
+	for (int d = 0; d < (int)NET_STATS_DIR_COUNT; d++)
+	{
+		for (int i = 0; i < NET_STATS_MSG_TYPES; i++)
+		{
+			const NetStatsCounter *c = &s->Counters[d][i];
+			if (c->Msgs == 0) continue;
+			fprintf(f, "%d,%s,%s,%d,%d,%llu\n",
+				s->Mission, NetStatsDirStr((NetStatsDir)d),
+				GameEventTypeStr((GameEventType)i),
+				c->Msgs, c->Packets, (unsigned long long)c->Bytes);
+		}
+	}
+}
+static void WriteJSON(const NetStats *s, FILE *f)
+{
+	fprintf(f, "{\"mission\":%d,\"peers\":[", s->Mission);
+	CA_FOREACH(const NetStatsPeer, p, s->Peers)
+		fprintf(f,
+			"%s{\"id\":%d,\"rtt\":%u,\"loss\":%.4f,\"throttle\":%.4f}",
+			_ca_index > 0 ? "," : "", p->PeerId, (unsigned)p->RTT,
+			p->PacketLoss, p->Throttle);
+	CA_FOREACH_END()
+	fprintf(f, "]");
+	for (int d = 0; d < (int)NET_STATS_DIR_COUNT; d++)
+	{
+		fprintf(f, ",\"%s\":{", NetStatsDirStr((NetStatsDir)d));
+		bool first = true;
+		for (int i = 0; i < NET_STATS_MSG_TYPES; i++)
+		{
+			const NetStatsCounter *c = &s->Counters[d][i];
+			if (c->Msgs == 0) continue;
+			fprintf(f,
+				"%s\"%s\":{\"msgs\":%d,\"packets\":%d,\"bytes\":%llu}",
+				first ? "" : ",", GameEventTypeStr((GameEventType)i),
+				c->Msgs, c->Packets, (unsigned long long)c->Bytes);
+			first = false;
+		}
+		fprintf(f, "}");
+	}
+	fprintf(f, "}\n");
+}
+bool NetStatsWrite(const NetStats *s, const char *filename)
+{
+	// Overwrite on the first mission, append for the rest
+	FILE *f = fopen(filename, s->Mission == 0 ? "w" : "a");
+	if (f == NULL)
+	{
+		LOG(LM_NET, LL_ERROR, "Cannot open net stats file %s: %s",
+			filename, strerror(errno));
+		return false;
+	}
+	const char *ext = strrchr(filename, '.');
+	if (ext != NULL && strcmp(ext, ".csv") == 0)
+	{
+		WriteCSV(s, f);
+	}
+	else
+	{
+		WriteJSON(s, f);
+	}
+	fclose(f);
+	LOG(LM_NET, LL_INFO, "Wrote mission %d net stats to %s",
+		s->Mission, filename);
+	return true;
+}
@@ -0,0 +1,106 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+
+    Copyright (c) 2018 Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+
+#include <SDL_stdinc.h>
+
+#include "c_array.h"
+#include "game_events.h"
+#include "sys_config.h"
+
+#define NET_STATS_MSG_TYPES ((int)GAME_EVENT_MISSION_END + 1)
+
+typedef enum
+{
+	NET_STATS_SENT,
+	NET_STATS_RECV,
+	NET_STATS_DIR_COUNT
+} NetStatsDir;
+const char *NetStatsDirStr(const NetStatsDir d);
+
+typedef struct
+{
+	int Msgs;
+	int Packets;
+	Uint64 Bytes;
+} NetStatsCounter;
+
+// Link quality of a peer, as reported by ENet
+typedef struct
+{
+	// -1 for the server, as seen by a client
+	int PeerId;
+	Uint32 RTT;
+	float PacketLoss;
+	float Throttle;
+} NetStatsPeer;
+
+typedef struct
+{
+	bool Enabled;
+	// Per-mission dump; CSV if it ends in .csv, otherwise JSON lines
+	char Filename[CDOGS_PATH_MAX];
+	int Mission;
+	// Totals for the current mission, by message type
+	NetStatsCounter Counters[NET_STATS_DIR_COUNT][NET_STATS_MSG_TYPES];
+	// Throughput over the last complete window, in bytes/s
+	Uint64 WindowBytes[NET_STATS_DIR_COUNT];
+	double BytesPerSec[NET_STATS_DIR_COUNT];
+	Uint32 WindowStart;
+	CArray Peers;	// of NetStatsPeer, as of the last sample
+} NetStats;
+extern NetStats gNetStats;
+
+// Enable net stats; if filename is non-empty, also dump them there at the
+// end of each mission
+void NetStatsInit(NetStats *s, const char *filename);
+void NetStatsTerminate(NetStats *s);
+
+void NetStatsCount(
+	NetStats *s, const NetStatsDir d, const GameEventType e,
+	const int bytes, const int packets);
+// Sample peer link quality and throughput, once per window
+void NetStatsUpdate(NetStats *s, const Uint32 ticksNow);
+// Dump the mission's stats, if there is a file, and reset them
+void NetStatsMissionEnd(NetStats *s);
+
+void NetStatsDraw(const NetStats *s);
+bool NetStatsWrite(const NetStats *s, const char *filename);
+
+// Counting costs a single branch when stats are disabled
+#define NET_STATS_COUNT(_d, _e, _bytes, _packets)\
+	do\
+	{\
+		if (gNetStats.Enabled)\
+		{\
+			NetStatsCount(&gNetStats, _d, _e, _bytes, _packets);\
+		}\
+	} while ((void)0, 0)
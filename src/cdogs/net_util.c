@@ -28,34 +28,157 @@
 */
 #include "net_util.h"
 
+#include <string.h>
+
 #include "proto/nanopb/pb_decode.h"
 #include "proto/nanopb/pb_encode.h"
+#include "log.h"
+#include "utils.h"
+
+
+// Packet buffers are recycled in size classes, so that sending does not
+// allocate once the pools have warmed up
+#define PACKET_POOL_CLASSES 4
+static const size_t sPacketPoolSizes[PACKET_POOL_CLASSES] =
+{
+	64, 256, 1024, 4096
+};
+static CArray sPacketPools[PACKET_POOL_CLASSES];	// of uint8_t *
+static int sPacketPoolAllocs = 0;
 
+static int PacketPoolClass(const size_t size)
+{
+	for (int i = 0; i < PACKET_POOL_CLASSES; i++)
+	{
+		if (size <= sPacketPoolSizes[i]) return i;
+	}
+	return -1;
+}
+static uint8_t *PacketPoolGet(const int poolClass, const size_t size)
+{
+	if (poolClass < 0)
+	{
+		// Oversized; allocate just for this packet
+		sPacketPoolAllocs++;
+		uint8_t *data;
+		CMALLOC(data, size);
+		return data;
+	}
+	CArray *pool = &sPacketPools[poolClass];
+	if (pool->elemSize == 0)
+	{
+		CArrayInit(pool, sizeof(uint8_t *));
+	}
+	if (pool->size == 0)
+	{
+		sPacketPoolAllocs++;
+		uint8_t *data;
+		CMALLOC(data, sPacketPoolSizes[poolClass]);
+		return data;
+	}
+	uint8_t *data = *(uint8_t **)CArrayGet(pool, pool->size - 1);
+	CArrayDelete(pool, pool->size - 1);
+	return data;
+}
+static void PacketPoolPut(const int poolClass, uint8_t *data)
+{
+	if (poolClass < 0)
+	{
+		CFREE(data);
+		return;
+	}
+	CArrayPushBack(&sPacketPools[poolClass], &data);
+}
+static void PacketFree(ENetPacket *packet)
+{
+	PacketPoolPut((int)(intptr_t)packet->userData, packet->data);
+}
+void NetPacketPoolTerminate(void)
+{
+	for (int i = 0; i < PACKET_POOL_CLASSES; i++)
+	{
+		CA_FOREACH(uint8_t *, data, sPacketPools[i])
+			CFREE(*data);
+		CA_FOREACH_END()
+		CArrayTerminate(&sPacketPools[i]);
+	}
+}
+int NetPacketPoolAllocs(void)
+{
+	return sPacketPoolAllocs;
+}
 
 ENetPacket *NetEncode(const GameEventType e, const void *data)
 {
-	uint8_t buffer[1024];
-	pb_ostream_t stream = pb_ostream_from_buffer(buffer, sizeof buffer);
 	const pb_field_t *fields = GameEventGetEntry(e).Fields;
-	const bool status =
-		(data && fields) ? pb_encode(&stream, fields, data) : true;
-	CASSERT(status, "Failed to encode pb");
-	int msgId = (int)e;
+	size_t size = 0;
+	if (data && fields)
+	{
+		const bool status = pb_get_encoded_size(&size, fields, data);
+		CASSERT(status, "Failed to size pb");
+	}
+	ENetPacket *packet = NetPacketNew(e, size);
+	if (data && fields)
+	{
+		pb_ostream_t stream =
+			pb_ostream_from_buffer(packet->data + NET_MSG_SIZE, size);
+		const bool status = pb_encode(&stream, fields, data);
+		CASSERT(status, "Failed to encode pb");
+	}
+	return packet;
+}
+ENetPacket *NetPacketNew(const GameEventType e, const size_t size)
+{
+	const size_t packetSize = NET_MSG_SIZE + size;
+	const int poolClass = PacketPoolClass(packetSize);
+	uint8_t *buf = PacketPoolGet(poolClass, packetSize);
+	const uint32_t msgId = (uint32_t)e;
+	memcpy(buf, &msgId, NET_MSG_SIZE);
 	ENetPacket *packet = enet_packet_create(
-		&msgId, NET_MSG_SIZE + stream.bytes_written,
-		ENET_PACKET_FLAG_RELIABLE);
-	memcpy(packet->data + NET_MSG_SIZE, buffer, stream.bytes_written);
+		buf, packetSize,
+		ENET_PACKET_FLAG_RELIABLE | ENET_PACKET_FLAG_NO_ALLOCATE);
+	packet->freeCallback = PacketFree;
+	packet->userData = (void *)(intptr_t)poolClass;
 	return packet;
 }
 
+bool NetDecodeType(const ENetPacket *packet, GameEventType *e)
+{
+	if (packet->dataLength < NET_MSG_SIZE)
+	{
+		LOG(LM_NET, LL_WARN, "Dropping packet too short (%d)",
+			(int)packet->dataLength);
+		return false;
+	}
+	uint32_t msgId;
+	memcpy(&msgId, packet->data, NET_MSG_SIZE);
+	if (msgId > (uint32_t)GAME_EVENT_MISSION_END)
+	{
+		LOG(LM_NET, LL_WARN, "Dropping packet with unknown msg(%u)", msgId);
+		return false;
+	}
+	*e = (GameEventType)msgId;
+	return true;
+}
+
 bool NetDecode(
 	ENetPacket *packet, void *dest, const pb_field_t *fields)
 {
+	if (packet->dataLength < NET_MSG_SIZE)
+	{
+		LOG(LM_NET, LL_WARN, "Dropping packet too short (%d)",
+			(int)packet->dataLength);
+		return false;
+	}
 	pb_istream_t stream = pb_istream_from_buffer(
 		packet->data + NET_MSG_SIZE, packet->dataLength - NET_MSG_SIZE);
-	bool status = pb_decode(&stream, fields, dest);
-	CASSERT(status, "Failed to decode pb");
-	return status;
+	if (!pb_decode(&stream, fields, dest))
+	{
+		LOG(LM_NET, LL_WARN, "Failed to decode pb: %s",
+			PB_GET_ERROR(&stream));
+		return false;
+	}
+	return true;
 }
 
 
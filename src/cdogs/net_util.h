@@ -40,16 +40,31 @@
 
 #define NET_LISTEN_PORT 34219
 
-#define NET_PROTOCOL_VERSION 7
+#define NET_PROTOCOL_VERSION 10
 
 // Messages
 
 // All messages start with 4 bytes message type followed by the message struct
 #define NET_MSG_SIZE sizeof(uint32_t)
 
+// All messages go on the first channel, including the late-join snapshot,
+// as ENet only keeps packets in order within a channel
+#define NET_CHANNEL_GAME 0
+#define NET_CHANNEL_COUNT 2
 
+
+// Encode a message into a pooled packet; the buffer returns to the pool when
+// ENet destroys the packet
 ENetPacket *NetEncode(const GameEventType e, const void *data);
+// Pooled packet with the message type set and size bytes of body to fill
+ENetPacket *NetPacketNew(const GameEventType e, const size_t size);
+// Read the message type, or return false if the packet is malformed
+bool NetDecodeType(const ENetPacket *packet, GameEventType *e);
+// Decode the message body, or return false if it is malformed
 bool NetDecode(ENetPacket *packet, void *dest, const pb_field_t *fields);
+void NetPacketPoolTerminate(void);
+// Number of packet buffers allocated so far, for measuring the pool
+int NetPacketPoolAllocs(void);
 
 NPlayerData NMakePlayerData(const PlayerData *p);
 NCampaignDef NMakeCampaignDef(const CampaignOptions *co);
@@ -51,6 +51,7 @@
 #include <assert.h>
 
 #include "bullet_class.h"
+#include "collision/collision.h"
 #include "damage.h"
 #include "log.h"
 #include "net_util.h"
@@ -61,6 +62,9 @@ CArray gObjs;
 CArray gMobObjs;
 static unsigned int sObjUIDs = 0;
 static unsigned int sMobObjUIDs = 0;
+// Scratch for bullet updates
+static CArray sBulletSteps;	// of BulletStep
+static CArray sBulletHits;	// of SweepHit
 
 
 // Draw functions
@@ -351,6 +355,8 @@ static void DoDamageCharacter(
 		ei.u.ActorImpulse.UID = actor->uid;
 		ei.u.ActorImpulse.Vel = Vec2ToNet(vel);
 		ei.u.ActorImpulse.Pos = Vec2ToNet(actor->Pos);
+		ei.u.ActorImpulse.Seq = actor->InputSeq;
+		ei.u.ActorImpulse.Ticks = actor->InputTicks;
 		GameEventsEnqueue(&gGameEvents, ei);
 	}
 
@@ -386,27 +392,53 @@ static void DoDamageCharacter(
 }
 
 
+static void RemoveBullet(const TMobileObject *obj);
 void UpdateMobileObjects(int ticks)
 {
+	// Bullets don't hit each other, and hits are only applied through game
+	// events, so all their hits can be found in one batch and resolved after
+	CArrayClear(&sBulletSteps);
 	CA_FOREACH(TMobileObject, obj, gMobObjs)
 		if (!obj->isInUse)
 		{
 			continue;
 		}
-		if (!BulletUpdate(obj, ticks) && !gCampaign.IsClient)
+		BulletStep step;
+		switch (BulletUpdateBegin(obj, ticks, &step))
 		{
-			GameEvent e = GameEventNew(GAME_EVENT_REMOVE_BULLET);
-			e.u.RemoveBullet.UID = obj->UID;
-			GameEventsEnqueue(&gGameEvents, e);
-			continue;
+		case BULLET_UPDATE_REMOVE:
+			RemoveBullet(obj);
+			break;
+		case BULLET_UPDATE_MOVE:
+			CArrayPushBack(&sBulletSteps, &step);
+			break;
+		default:
+			break;
 		}
 	CA_FOREACH_END()
+	BulletsCollide(&sBulletSteps, &sBulletHits);
+	CA_FOREACH(const BulletStep, step, sBulletSteps)
+		if (!BulletUpdateEnd(step, &sBulletHits, ticks))
+		{
+			RemoveBullet(step->Obj);
+		}
+	CA_FOREACH_END()
+}
+static void RemoveBullet(const TMobileObject *obj)
+{
+	if (gCampaign.IsClient)
+	{
+		return;
+	}
+	GameEvent e = GameEventNew(GAME_EVENT_REMOVE_BULLET);
+	e.u.RemoveBullet.UID = obj->UID;
+	GameEventsEnqueue(&gGameEvents, e);
 }
 
 
-void ObjsInit(void)
+void ObjsInit(MemArena *arena)
 {
-	CArrayInit(&gObjs, sizeof(TObject));
+	CArrayInitArena(&gObjs, sizeof(TObject), arena);
 	CArrayReserve(&gObjs, 1024);
 	sObjUIDs = 0;
 }
@@ -539,11 +571,13 @@ TObject *ObjGetByUID(const int uid)
 }
 
 
-void MobObjsInit(void)
+void MobObjsInit(MemArena *arena)
 {
-	CArrayInit(&gMobObjs, sizeof(TMobileObject));
+	CArrayInitArena(&gMobObjs, sizeof(TMobileObject), arena);
 	CArrayReserve(&gMobObjs, 1024);
 	sMobObjUIDs = 0;
+	CArrayInitArena(&sBulletSteps, sizeof(BulletStep), arena);
+	CArrayInitArena(&sBulletHits, sizeof(SweepHit), arena);
 }
 void MobObjsTerminate(void)
 {
@@ -554,6 +588,8 @@ void MobObjsTerminate(void)
 		}
 	CA_FOREACH_END()
 	CArrayTerminate(&gMobObjs);
+	CArrayTerminate(&sBulletSteps);
+	CArrayTerminate(&sBulletHits);
 }
 int MobObjsObjsGetNextUID(void)
 {
@@ -108,7 +108,7 @@ void Damage(
 	const ThingKind targetKind, const int targetUID,
 	const special_damage_e special);
 
-void ObjsInit(void);
+void ObjsInit(MemArena *arena);
 void ObjsTerminate(void);
 int ObjsGetNextUID(void);
 void ObjAdd(const NMapObjectAdd amo);
@@ -125,7 +125,7 @@ TObject *ObjGetByUID(const int uid);
 void DamageObject(const NThingDamage d);
 
 void UpdateMobileObjects(int ticks);
-void MobObjsInit(void);
+void MobObjsInit(MemArena *arena);
 void MobObjsTerminate(void);
 int MobObjsObjsGetNextUID(void);
 TMobileObject *MobObjGetByUID(const int uid);
@@ -375,8 +375,8 @@ static void SetClosestCollision(
 	HitWallData *data, const struct vec2 col, const struct vec2 normal);
 static bool CheckWall(const struct vec2i tilePos)
 {
-	const Tile *t = MapGetTile(&gMap, tilePos);
-	return t == NULL || TileIsShootable(t);
+	return !MapIsTileIn(&gMap, tilePos) ||
+		MapTileBit(&gMap, MAP_BITS_SHOOT, tilePos);
 }
 static bool HitWallFunc(
 	const struct vec2i tilePos, void *data, const struct vec2 col,
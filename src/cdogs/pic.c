@@ -98,6 +98,10 @@ bail:
 }
 bool PicTryMakeTex(Pic *p)
 {
+	if (gGraphicsDevice.IsHeadless)
+	{
+		return true;
+	}
 	SDL_DestroyTexture(p->Tex);
 	p->Tex = TextureCreate(
 		gGraphicsDevice.gameWindow.renderer, SDL_TEXTUREACCESS_STATIC,
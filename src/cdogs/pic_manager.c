@@ -473,12 +473,13 @@ static int ReloadSpriteTexture(any_t data, any_t item)
 NamedPic *PicManagerGetNamedPic(const PicManager *pm, const char *name)
 {
 	NamedPic *n;
-	int error = hashmap_get(pm->customPics, name, (any_t *)&n);
+	const unsigned int hash = hashmap_hash_key(name);
+	int error = hashmap_get_hashed(pm->customPics, name, hash, (any_t *)&n);
 	if (error == MAP_OK)
 	{
 		return n;
 	}
-	error = hashmap_get(pm->pics, name, (any_t *)&n);
+	error = hashmap_get_hashed(pm->pics, name, hash, (any_t *)&n);
 	if (error == MAP_OK)
 	{
 		return n;
@@ -495,12 +496,14 @@ const NamedSprites *PicManagerGetSprites(
 	const PicManager *pm, const char *name)
 {
 	NamedSprites *n;
-	int error = hashmap_get(pm->customSprites, name, (any_t *)&n);
+	const unsigned int hash = hashmap_hash_key(name);
+	int error = hashmap_get_hashed(
+		pm->customSprites, name, hash, (any_t *)&n);
 	if (error == MAP_OK)
 	{
 		return n;
 	}
-	error = hashmap_get(pm->sprites, name, (any_t *)&n);
+	error = hashmap_get_hashed(pm->sprites, name, hash, (any_t *)&n);
 	if (error == MAP_OK)
 	{
 		return n;
@@ -210,6 +210,7 @@ void PickupPickup(TActor *a, Pickup *p, const bool pickupAll)
 			strcpy(es.u.SoundAt.Sound, sound);
 			es.u.SoundAt.Pos = Vec2ToNet(actorPos);
 			es.u.SoundAt.IsHit = false;
+			es.u.SoundAt.Count = 1;
 			GameEventsEnqueue(&gGameEvents, es);
 		}
 		GameEvent e = GameEventNew(GAME_EVENT_REMOVE_PICKUP);
@@ -0,0 +1,200 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+
+    Copyright (c) 2018 Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "profiler.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <SDL_timer.h>
+
+#include "font.h"
+#include "grafx.h"
+#include "log.h"
+#include "utils.h"
+
+// Stop recording trace events past this many, to bound memory use
+#define TRACE_EVENTS_MAX (1024 * 1024)
+// Window over which the overlay figures are aggregated
+#define WINDOW_MS 1000
+
+
+Profiler gProfiler;
+
+const char *ProfileSectionStr(const ProfileSection s)
+{
+	switch (s)
+	{
+		T2S(PROFILE_FRAME, "Frame");
+		T2S(PROFILE_SLEEP, "Sleep");
+		T2S(PROFILE_NET_POLL, "NetPoll");
+		T2S(PROFILE_UPDATE, "Update");
+		T2S(PROFILE_LOS, "LOS");
+		T2S(PROFILE_AI, "AICommand");
+		T2S(PROFILE_ACTORS, "UpdateAllActors");
+		T2S(PROFILE_MOBILE_OBJECTS, "UpdateMobileObjects");
+		T2S(PROFILE_PARTICLES, "ParticlesUpdate");
+		T2S(PROFILE_GAME_EVENTS, "HandleGameEvents");
+		T2S(PROFILE_NET_FLUSH, "NetFlush");
+		T2S(PROFILE_DRAW, "Draw");
+		T2S(PROFILE_CAMERA_DRAW, "CameraDraw");
+		T2S(PROFILE_DRAW_LIST, "DrawListBuild");
+		T2S(PROFILE_HUD_DRAW, "HUDDraw");
+	default:
+		return "";
+	}
+}
+
+void ProfilerInit(Profiler *p, const char *traceFilename)
+{
+	memset(p, 0, sizeof *p);
+	p->Enabled = true;
+	p->Freq = SDL_GetPerformanceFrequency();
+	CArrayInit(&p->TraceEvents, sizeof(ProfileTraceEvent));
+	if (traceFilename != NULL)
+	{
+		strncpy(p->TraceFilename, traceFilename, CDOGS_PATH_MAX - 1);
+	}
+	p->TraceStart = SDL_GetPerformanceCounter();
+	p->WindowStart = p->TraceStart;
+	p->Starts[PROFILE_FRAME] = p->TraceStart;
+	LOG(LM_MAIN, LL_INFO, "profiler enabled, trace(%s)", p->TraceFilename);
+}
+void ProfilerTerminate(Profiler *p)
+{
+	if (!p->Enabled)
+	{
+		return;
+	}
+	if (strlen(p->TraceFilename) > 0)
+	{
+		ProfilerWriteTrace(p, p->TraceFilename);
+	}
+	CArrayTerminate(&p->TraceEvents);
+	p->Enabled = false;
+}
+
+void ProfilerBegin(Profiler *p, const ProfileSection s)
+{
+	p->Starts[s] = SDL_GetPerformanceCounter();
+}
+void ProfilerEnd(Profiler *p, const ProfileSection s)
+{
+	const Uint64 duration = SDL_GetPerformanceCounter() - p->Starts[s];
+	p->FrameTicks[s] += duration;
+	if (strlen(p->TraceFilename) == 0)
+	{
+		return;
+	}
+	if (p->TraceEvents.size == TRACE_EVENTS_MAX)
+	{
+		LOG(LM_MAIN, LL_WARN, "trace full; no longer recording");
+	}
+	if (p->TraceEvents.size >= TRACE_EVENTS_MAX)
+	{
+		return;
+	}
+	ProfileTraceEvent e;
+	e.Section = s;
+	e.Start = p->Starts[s] - p->TraceStart;
+	e.Duration = duration;
+	CArrayPushBack(&p->TraceEvents, &e);
+}
+
+static double TicksToMs(const Profiler *p, const Uint64 ticks)
+{
+	return (double)ticks * 1000.0 / (double)p->Freq;
+}
+void ProfilerFrameEnd(Profiler *p)
+{
+	ProfilerEnd(p, PROFILE_FRAME);
+	for (int i = 0; i < (int)PROFILE_COUNT; i++)
+	{
+		p->WindowTicks[i] += p->FrameTicks[i];
+		p->WindowPeak[i] = MAX(p->WindowPeak[i], p->FrameTicks[i]);
+		p->FrameTicks[i] = 0;
+	}
+	p->WindowFrames++;
+	const Uint64 now = SDL_GetPerformanceCounter();
+	if (TicksToMs(p, now - p->WindowStart) >= WINDOW_MS)
+	{
+		for (int i = 0; i < (int)PROFILE_COUNT; i++)
+		{
+			p->AvgMs[i] = TicksToMs(p, p->WindowTicks[i]) / p->WindowFrames;
+			p->PeakMs[i] = TicksToMs(p, p->WindowPeak[i]);
+			p->WindowTicks[i] = 0;
+			p->WindowPeak[i] = 0;
+		}
+		p->WindowFrames = 0;
+		p->WindowStart = now;
+	}
+	ProfilerBegin(p, PROFILE_FRAME);
+}
+
+void ProfilerDraw(const Profiler *p)
+{
+	struct vec2i pos = svec2i(5, 5);
+	FontStrMask("section: avg/peak ms", pos, colorYellow);
+	pos.y += FontH();
+	for (int i = 0; i < (int)PROFILE_COUNT; i++)
+	{
+		char buf[256];
+		sprintf(buf, "%s: %.2f/%.2f",
+			ProfileSectionStr((ProfileSection)i), p->AvgMs[i], p->PeakMs[i]);
+		FontStr(buf, pos);
+		pos.y += FontH();
+	}
+}
+
+bool ProfilerWriteTrace(const Profiler *p, const char *filename)
+{
+	FILE *f = fopen(filename, "w");
+	if (f == NULL)
+	{
+		LOG(LM_MAIN, LL_ERROR, "Cannot open trace file %s: %s",
+			filename, strerror(errno));
+		return false;
+	}
+	// Complete ("X") events, with timestamps in microseconds
+	fprintf(f, "{\"traceEvents\":[\n");
+	CA_FOREACH(const ProfileTraceEvent, e, p->TraceEvents)
+		fprintf(f,
+			"{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+			"\"ts\":%.3f,\"dur\":%.3f}%s\n",
+			ProfileSectionStr(e->Section),
+			TicksToMs(p, e->Start) * 1000.0,
+			TicksToMs(p, e->Duration) * 1000.0,
+			_ca_index + 1 < (int)p->TraceEvents.size ? "," : "");
+	CA_FOREACH_END()
+	fprintf(f, "],\"displayTimeUnit\":\"ms\"}\n");
+	fclose(f);
+	LOG(LM_MAIN, LL_INFO, "Wrote %d trace events to %s",
+		(int)p->TraceEvents.size, filename);
+	return true;
+}
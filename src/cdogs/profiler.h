@@ -0,0 +1,117 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+
+    Copyright (c) 2018 Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+
+#include <SDL_stdinc.h>
+
+#include "c_array.h"
+#include "sys_config.h"
+
+// Sections of the frame that can be timed; sections may nest
+typedef enum
+{
+	PROFILE_FRAME,
+	PROFILE_SLEEP,
+	PROFILE_NET_POLL,
+	PROFILE_UPDATE,
+	PROFILE_LOS,
+	PROFILE_AI,
+	PROFILE_ACTORS,
+	PROFILE_MOBILE_OBJECTS,
+	PROFILE_PARTICLES,
+	PROFILE_GAME_EVENTS,
+	PROFILE_NET_FLUSH,
+	PROFILE_DRAW,
+	PROFILE_CAMERA_DRAW,
+	PROFILE_DRAW_LIST,
+	PROFILE_HUD_DRAW,
+	PROFILE_COUNT
+} ProfileSection;
+const char *ProfileSectionStr(const ProfileSection s);
+
+typedef struct
+{
+	ProfileSection Section;
+	Uint64 Start;
+	Uint64 Duration;
+} ProfileTraceEvent;
+
+typedef struct
+{
+	bool Enabled;
+	Uint64 Freq;
+	Uint64 Starts[PROFILE_COUNT];
+	// Totals and peaks for the frames in the current window
+	Uint64 FrameTicks[PROFILE_COUNT];
+	Uint64 WindowTicks[PROFILE_COUNT];
+	Uint64 WindowPeak[PROFILE_COUNT];
+	int WindowFrames;
+	Uint64 WindowStart;
+	// Per-frame average and peak of the last complete window, in ms
+	double AvgMs[PROFILE_COUNT];
+	double PeakMs[PROFILE_COUNT];
+	// Chrome trace_event output, if a filename was given
+	char TraceFilename[CDOGS_PATH_MAX];
+	CArray TraceEvents;	// of ProfileTraceEvent
+	Uint64 TraceStart;
+} Profiler;
+extern Profiler gProfiler;
+
+// Enable the profiler; if traceFilename is non-empty, also record all
+// sections and write them as Chrome trace_event JSON on terminate
+void ProfilerInit(Profiler *p, const char *traceFilename);
+void ProfilerTerminate(Profiler *p);
+
+void ProfilerBegin(Profiler *p, const ProfileSection s);
+void ProfilerEnd(Profiler *p, const ProfileSection s);
+// Close the current frame and aggregate its timings
+void ProfilerFrameEnd(Profiler *p);
+
+void ProfilerDraw(const Profiler *p);
+// Write recorded sections as Chrome trace_event JSON
+bool ProfilerWriteTrace(const Profiler *p, const char *filename);
+
+// Timers cost a single branch when the profiler is disabled
+#define PROFILE_BEGIN(_s)\
+	do\
+	{\
+		if (gProfiler.Enabled) ProfilerBegin(&gProfiler, _s);\
+	} while ((void)0, 0)
+#define PROFILE_END(_s)\
+	do\
+	{\
+		if (gProfiler.Enabled) ProfilerEnd(&gProfiler, _s);\
+	} while ((void)0, 0)
+#define PROFILE_FRAME_END()\
+	do\
+	{\
+		if (gProfiler.Enabled) ProfilerFrameEnd(&gProfiler);\
+	} while ((void)0, 0)
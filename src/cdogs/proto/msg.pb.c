@@ -135,10 +135,11 @@ const pb_field_t NScore_fields[3] = {
     PB_LAST_FIELD
 };
 
-const pb_field_t NSound_fields[4] = {
+const pb_field_t NSound_fields[5] = {
     PB_FIELD(  1, STRING  , REQUIRED, STATIC  , FIRST, NSound, Sound, Sound, 0),
     PB_FIELD(  2, MESSAGE , REQUIRED, STATIC  , OTHER, NSound, Pos, Sound, &NVec2_fields),
     PB_FIELD(  3, BOOL    , REQUIRED, STATIC  , OTHER, NSound, IsHit, Pos, 0),
+    PB_FIELD(  4, INT32   , REQUIRED, STATIC  , OTHER, NSound, Count, IsHit, 0),
     PB_LAST_FIELD
 };
 
@@ -170,10 +171,11 @@ const pb_field_t NActorAdd_fields[8] = {
     PB_LAST_FIELD
 };
 
-const pb_field_t NActorMove_fields[4] = {
+const pb_field_t NActorMove_fields[5] = {
     PB_FIELD(  1, UINT32  , REQUIRED, STATIC  , FIRST, NActorMove, UID, UID, 0),
     PB_FIELD(  2, MESSAGE , REQUIRED, STATIC  , OTHER, NActorMove, Pos, UID, &NVec2_fields),
     PB_FIELD(  3, MESSAGE , REQUIRED, STATIC  , OTHER, NActorMove, MoveVel, Pos, &NVec2_fields),
+    PB_FIELD(  4, UINT32  , REQUIRED, STATIC  , OTHER, NActorMove, Seq, MoveVel, 0),
     PB_LAST_FIELD
 };
 
@@ -195,10 +197,12 @@ const pb_field_t NActorSlide_fields[3] = {
     PB_LAST_FIELD
 };
 
-const pb_field_t NActorImpulse_fields[4] = {
+const pb_field_t NActorImpulse_fields[6] = {
     PB_FIELD(  1, UINT32  , REQUIRED, STATIC  , FIRST, NActorImpulse, UID, UID, 0),
     PB_FIELD(  2, MESSAGE , REQUIRED, STATIC  , OTHER, NActorImpulse, Vel, UID, &NVec2_fields),
     PB_FIELD(  3, MESSAGE , REQUIRED, STATIC  , OTHER, NActorImpulse, Pos, Vel, &NVec2_fields),
+    PB_FIELD(  4, UINT32  , REQUIRED, STATIC  , OTHER, NActorImpulse, Seq, Pos, 0),
+    PB_FIELD(  5, INT32   , REQUIRED, STATIC  , OTHER, NActorImpulse, Ticks, Seq, 0),
     PB_LAST_FIELD
 };
 
@@ -214,6 +214,8 @@ typedef struct _NActorImpulse {
     uint32_t UID;
     NVec2 Vel;
     NVec2 Pos;
+    uint32_t Seq;
+    int32_t Ticks;
 /* @@protoc_insertion_point(struct:NActorImpulse) */
 } NActorImpulse;
 
@@ -221,6 +223,7 @@ typedef struct _NActorMove {
     uint32_t UID;
     NVec2 Pos;
     NVec2 MoveVel;
+    uint32_t Seq;
 /* @@protoc_insertion_point(struct:NActorMove) */
 } NActorMove;
 
@@ -325,6 +328,7 @@ typedef struct _NSound {
     char Sound[128];
     NVec2 Pos;
     bool IsHit;
+    int32_t Count;
 /* @@protoc_insertion_point(struct:NSound) */
 } NSound;
 
@@ -403,16 +407,16 @@ extern const int32_t NAddBullet_ActorUID_default;
 #define NMapObjectAdd_init_default               {0, "", NVec2_init_default, 0, 0}
 #define NMapObjectRemove_init_default            {0, 0, 0}
 #define NScore_init_default                      {0, 0}
-#define NSound_init_default                      {"", NVec2_init_default, 0}
+#define NSound_init_default                      {"", NVec2_init_default, 0, 0}
 #define NVec2i_init_default                      {0, 0}
 #define NVec2_init_default                       {0, 0}
 #define NGameBegin_init_default                  {0}
 #define NActorAdd_init_default                   {0, 0, 4, 0, -1, 0, NVec2_init_default}
-#define NActorMove_init_default                  {0, NVec2_init_default, NVec2_init_default}
+#define NActorMove_init_default                  {0, NVec2_init_default, NVec2_init_default, 0}
 #define NActorState_init_default                 {0, 0}
 #define NActorDir_init_default                   {0, 0}
 #define NActorSlide_init_default                 {0, NVec2_init_default}
-#define NActorImpulse_init_default               {0, NVec2_init_default, NVec2_init_default}
+#define NActorImpulse_init_default               {0, NVec2_init_default, NVec2_init_default, 0, 0}
 #define NActorSwitchGun_init_default             {0, 0}
 #define NActorPickupAll_init_default             {0, 0}
 #define NActorReplaceGun_init_default            {0, 0, ""}
@@ -451,16 +455,16 @@ extern const int32_t NAddBullet_ActorUID_default;
 #define NMapObjectAdd_init_zero                  {0, "", NVec2_init_zero, 0, 0}
 #define NMapObjectRemove_init_zero               {0, 0, 0}
 #define NScore_init_zero                         {0, 0}
-#define NSound_init_zero                         {"", NVec2_init_zero, 0}
+#define NSound_init_zero                         {"", NVec2_init_zero, 0, 0}
 #define NVec2i_init_zero                         {0, 0}
 #define NVec2_init_zero                          {0, 0}
 #define NGameBegin_init_zero                     {0}
 #define NActorAdd_init_zero                      {0, 0, 0, 0, 0, 0, NVec2_init_zero}
-#define NActorMove_init_zero                     {0, NVec2_init_zero, NVec2_init_zero}
+#define NActorMove_init_zero                     {0, NVec2_init_zero, NVec2_init_zero, 0}
 #define NActorState_init_zero                    {0, 0}
 #define NActorDir_init_zero                      {0, 0}
 #define NActorSlide_init_zero                    {0, NVec2_init_zero}
-#define NActorImpulse_init_zero                  {0, NVec2_init_zero, NVec2_init_zero}
+#define NActorImpulse_init_zero                  {0, NVec2_init_zero, NVec2_init_zero, 0, 0}
 #define NActorSwitchGun_init_zero                {0, 0}
 #define NActorPickupAll_init_zero                {0, 0}
 #define NActorReplaceGun_init_zero               {0, 0, ""}
@@ -569,9 +573,12 @@ extern const int32_t NAddBullet_ActorUID_default;
 #define NActorImpulse_UID_tag                    1
 #define NActorImpulse_Vel_tag                    2
 #define NActorImpulse_Pos_tag                    3
+#define NActorImpulse_Seq_tag                    4
+#define NActorImpulse_Ticks_tag                  5
 #define NActorMove_UID_tag                       1
 #define NActorMove_Pos_tag                       2
 #define NActorMove_MoveVel_tag                   3
+#define NActorMove_Seq_tag                       4
 #define NActorSlide_UID_tag                      1
 #define NActorSlide_Vel_tag                      2
 #define NAddBullet_UID_tag                       1
@@ -628,6 +635,7 @@ extern const int32_t NAddBullet_ActorUID_default;
 #define NSound_Sound_tag                         1
 #define NSound_Pos_tag                           2
 #define NSound_IsHit_tag                         3
+#define NSound_Count_tag                         4
 #define NThingDamage_UID_tag                     1
 #define NThingDamage_Kind_tag                    2
 #define NThingDamage_SourceActorUID_tag          3
@@ -669,16 +677,16 @@ extern const pb_field_t NThingDamage_fields[9];
 extern const pb_field_t NMapObjectAdd_fields[6];
 extern const pb_field_t NMapObjectRemove_fields[4];
 extern const pb_field_t NScore_fields[3];
-extern const pb_field_t NSound_fields[4];
+extern const pb_field_t NSound_fields[5];
 extern const pb_field_t NVec2i_fields[3];
 extern const pb_field_t NVec2_fields[3];
 extern const pb_field_t NGameBegin_fields[2];
 extern const pb_field_t NActorAdd_fields[8];
-extern const pb_field_t NActorMove_fields[4];
+extern const pb_field_t NActorMove_fields[5];
 extern const pb_field_t NActorState_fields[3];
 extern const pb_field_t NActorDir_fields[3];
 extern const pb_field_t NActorSlide_fields[3];
-extern const pb_field_t NActorImpulse_fields[4];
+extern const pb_field_t NActorImpulse_fields[6];
 extern const pb_field_t NActorSwitchGun_fields[3];
 extern const pb_field_t NActorPickupAll_fields[3];
 extern const pb_field_t NActorReplaceGun_fields[4];
@@ -719,16 +727,16 @@ extern const pb_field_t NMissionEnd_fields[4];
 #define NMapObjectAdd_size                       166
 #define NMapObjectRemove_size                    23
 #define NScore_size                              17
-#define NSound_size                              145
+#define NSound_size                              156
 #define NVec2i_size                              22
 #define NVec2_size                               10
 #define NGameBegin_size                          11
 #define NActorAdd_size                           63
-#define NActorMove_size                          30
+#define NActorMove_size                          36
 #define NActorState_size                         17
 #define NActorDir_size                           17
 #define NActorSlide_size                         18
-#define NActorImpulse_size                       30
+#define NActorImpulse_size                       47
 #define NActorSwitchGun_size                     12
 #define NActorPickupAll_size                     8
 #define NActorReplaceGun_size                    143
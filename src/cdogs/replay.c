@@ -0,0 +1,734 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+
+    Copyright (c) 2018 Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "replay.h"
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+
+#include <SDL_timer.h>
+
+#include "actors.h"
+#include "campaigns.h"
+#include "config.h"
+#include "log.h"
+#include "objs.h"
+#include "pickup.h"
+#include "proto/nanopb/pb_decode.h"
+#include "proto/nanopb/pb_encode.h"
+#include "utils.h"
+
+#define REPLAY_MAGIC "CDRP"
+#define REPLAY_VERSION 1
+// Record a state checksum after every this many ticks
+#define REPLAY_CHECKSUM_TICKS 70
+// Record tags; tick records hold a mask of the commands that changed from
+// the last tick in the low bits, one per local player
+#define REPLAY_TAG_END 0x00
+#define REPLAY_TAG_TICK 0x10
+#define REPLAY_TAG_MASK 0xf0
+// Guard against bad files nesting config groups indefinitely
+#define CONFIG_DEPTH_MAX 8
+
+
+Replay gReplay;
+
+static void ReplayInit(Replay *r, const ReplayMode mode, const char *filename)
+{
+	memset(r, 0, sizeof *r);
+	r->Mode = mode;
+	strncpy(r->Filename, filename, CDOGS_PATH_MAX - 1);
+	CArrayInit(&r->Players, sizeof(ReplayPlayer));
+}
+void ReplayRecordInit(Replay *r, const char *filename)
+{
+	ReplayInit(r, REPLAY_RECORD, filename);
+	LOG(LM_MAIN, LL_INFO, "recording replays to %s", r->Filename);
+}
+void ReplayPlaybackInit(Replay *r, const char *filename, const bool fast)
+{
+	ReplayInit(r, REPLAY_PLAYBACK, filename);
+	r->Fast = fast;
+}
+void ReplayTerminate(Replay *r)
+{
+	if (r->Mode == REPLAY_NONE)
+	{
+		return;
+	}
+	ReplayMissionEnd(r);
+	if (r->f != NULL)
+	{
+		fclose(r->f);
+	}
+	CArrayTerminate(&r->Players);
+	memset(r, 0, sizeof *r);
+}
+
+// Little-endian binary IO
+
+static void WriteU8(FILE *f, const Uint8 v)
+{
+	fputc(v, f);
+}
+static void WriteU32(FILE *f, const Uint32 v)
+{
+	const Uint8 b[4] =
+	{
+		(Uint8)v, (Uint8)(v >> 8), (Uint8)(v >> 16), (Uint8)(v >> 24)
+	};
+	fwrite(b, 1, sizeof b, f);
+}
+static void WriteVarint(FILE *f, Uint32 v)
+{
+	while (v >= 0x80)
+	{
+		WriteU8(f, (Uint8)(v | 0x80));
+		v >>= 7;
+	}
+	WriteU8(f, (Uint8)v);
+}
+static void WriteString(FILE *f, const char *s)
+{
+	const size_t len = s != NULL ? strlen(s) : 0;
+	WriteVarint(f, (Uint32)len);
+	if (len > 0)
+	{
+		fwrite(s, 1, len, f);
+	}
+}
+static void WriteDouble(FILE *f, const double v)
+{
+	Uint64 u;
+	memcpy(&u, &v, sizeof u);
+	WriteU32(f, (Uint32)u);
+	WriteU32(f, (Uint32)(u >> 32));
+}
+static bool ReadU8(FILE *f, Uint8 *v)
+{
+	const int c = fgetc(f);
+	if (c == EOF)
+	{
+		return false;
+	}
+	*v = (Uint8)c;
+	return true;
+}
+static bool ReadU32(FILE *f, Uint32 *v)
+{
+	Uint8 b[4];
+	if (fread(b, 1, sizeof b, f) != sizeof b)
+	{
+		return false;
+	}
+	*v = b[0] | (b[1] << 8) | (b[2] << 16) | ((Uint32)b[3] << 24);
+	return true;
+}
+static bool ReadVarint(FILE *f, Uint32 *v)
+{
+	*v = 0;
+	for (int shift = 0; shift < 35; shift += 7)
+	{
+		Uint8 b;
+		if (!ReadU8(f, &b))
+		{
+			return false;
+		}
+		*v |= (Uint32)(b & 0x7f) << shift;
+		if (!(b & 0x80))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+// Read a string into buf, truncating it to fit
+static bool ReadString(FILE *f, char *buf, const size_t size)
+{
+	Uint32 len;
+	if (!ReadVarint(f, &len))
+	{
+		return false;
+	}
+	const size_t readLen = MIN((size_t)len, size - 1);
+	if (fread(buf, 1, readLen, f) != readLen)
+	{
+		return false;
+	}
+	buf[readLen] = '\0';
+	return fseek(f, (long)(len - readLen), SEEK_CUR) == 0;
+}
+static bool ReadDouble(FILE *f, double *v)
+{
+	Uint32 lo, hi;
+	if (!ReadU32(f, &lo) || !ReadU32(f, &hi))
+	{
+		return false;
+	}
+	const Uint64 u = lo | ((Uint64)hi << 32);
+	memcpy(v, &u, sizeof *v);
+	return true;
+}
+
+// Config is saved by name, so that replays survive config entries being
+// added or removed; entries not in the current config are skipped
+
+static void WriteConfigGroup(FILE *f, const Config *group)
+{
+	WriteVarint(f, (Uint32)group->u.Group.size);
+	CA_FOREACH(const Config, c, group->u.Group)
+		WriteString(f, c->Name);
+		WriteU8(f, (Uint8)c->Type);
+		switch (c->Type)
+		{
+		case CONFIG_TYPE_STRING:
+			WriteString(f, c->u.String.Value);
+			break;
+		case CONFIG_TYPE_INT:
+			WriteU32(f, (Uint32)c->u.Int.Value);
+			break;
+		case CONFIG_TYPE_FLOAT:
+			WriteDouble(f, c->u.Float.Value);
+			break;
+		case CONFIG_TYPE_BOOL:
+			WriteU8(f, c->u.Bool.Value);
+			break;
+		case CONFIG_TYPE_ENUM:
+			WriteU32(f, (Uint32)c->u.Enum.Value);
+			break;
+		case CONFIG_TYPE_GROUP:
+			WriteConfigGroup(f, c);
+			break;
+		default:
+			CASSERT(false, "unknown config type");
+			break;
+		}
+	CA_FOREACH_END()
+}
+static Config *FindConfigChild(Config *group, const char *name);
+// Read config entries into group; if group is NULL, skip them
+static bool ReadConfigGroup(FILE *f, Config *group, const int depth)
+{
+	if (depth > CONFIG_DEPTH_MAX)
+	{
+		return false;
+	}
+	Uint32 count;
+	if (!ReadVarint(f, &count))
+	{
+		return false;
+	}
+	for (Uint32 i = 0; i < count; i++)
+	{
+		char name[256];
+		Uint8 type;
+		if (!ReadString(f, name, sizeof name) || !ReadU8(f, &type))
+		{
+			return false;
+		}
+		Config *c = FindConfigChild(group, name);
+		if (c != NULL && c->Type != (ConfigType)type)
+		{
+			c = NULL;
+		}
+		// Input bindings are for the devices that were recorded; they don't
+		// affect the commands played back
+		if (depth == 0 && strcmp(name, "Input") == 0)
+		{
+			c = NULL;
+		}
+		Uint32 u;
+		Uint8 b;
+		switch ((ConfigType)type)
+		{
+		case CONFIG_TYPE_STRING:
+			// No string config is used by the simulation
+			if (!ReadString(f, name, sizeof name)) return false;
+			break;
+		case CONFIG_TYPE_INT:
+			if (!ReadU32(f, &u)) return false;
+			if (c != NULL) c->u.Int.Value = (int)u;
+			break;
+		case CONFIG_TYPE_FLOAT:
+			{
+				double d;
+				if (!ReadDouble(f, &d)) return false;
+				if (c != NULL) c->u.Float.Value = d;
+			}
+			break;
+		case CONFIG_TYPE_BOOL:
+			if (!ReadU8(f, &b)) return false;
+			if (c != NULL) c->u.Bool.Value = b != 0;
+			break;
+		case CONFIG_TYPE_ENUM:
+			if (!ReadU32(f, &u)) return false;
+			if (c != NULL) c->u.Enum.Value = (int)u;
+			break;
+		case CONFIG_TYPE_GROUP:
+			if (!ReadConfigGroup(f, c, depth + 1)) return false;
+			break;
+		default:
+			return false;
+		}
+	}
+	return true;
+}
+static Config *FindConfigChild(Config *group, const char *name)
+{
+	if (group == NULL)
+	{
+		return NULL;
+	}
+	CA_FOREACH(Config, c, group->u.Group)
+		if (c->Name != NULL && strcmp(c->Name, name) == 0)
+		{
+			return c;
+		}
+	CA_FOREACH_END()
+	return NULL;
+}
+
+static bool WriteHeader(Replay *r)
+{
+	fwrite(REPLAY_MAGIC, 1, strlen(REPLAY_MAGIC), r->f);
+	WriteU8(r->f, REPLAY_VERSION);
+	WriteString(r->f, r->CampaignPath);
+	WriteU8(r->f, (Uint8)r->CampaignMode);
+	WriteVarint(r->f, (Uint32)r->MissionIndex);
+	WriteU32(r->f, r->Seed);
+	WriteConfigGroup(r->f, &gConfig);
+
+	// Players as they will be reset for the mission
+	WriteU8(r->f, (Uint8)GetNumPlayers(PLAYER_ANY, false, true));
+	CA_FOREACH(const PlayerData, p, gPlayerDatas)
+		if (!p->IsLocal) continue;
+		const NPlayerData pd = PlayerDataMissionReset(p);
+		Uint8 buf[NPlayerData_size];
+		pb_ostream_t stream = pb_ostream_from_buffer(buf, sizeof buf);
+		if (!pb_encode(&stream, NPlayerData_fields, &pd))
+		{
+			LOG(LM_MAIN, LL_ERROR, "failed to encode player data: %s",
+				PB_GET_ERROR(&stream));
+			return false;
+		}
+		WriteVarint(r->f, (Uint32)stream.bytes_written);
+		fwrite(buf, 1, stream.bytes_written, r->f);
+		WriteU8(r->f, (Uint8)p->inputDevice);
+	CA_FOREACH_END()
+	return !ferror(r->f);
+}
+static bool ReadHeader(Replay *r)
+{
+	char magic[sizeof REPLAY_MAGIC];
+	Uint8 version;
+	if (fread(magic, 1, strlen(REPLAY_MAGIC), r->f) != strlen(REPLAY_MAGIC) ||
+		memcmp(magic, REPLAY_MAGIC, strlen(REPLAY_MAGIC)) != 0 ||
+		!ReadU8(r->f, &version))
+	{
+		return false;
+	}
+	if (version != REPLAY_VERSION)
+	{
+		LOG(LM_MAIN, LL_ERROR, "unsupported replay version %d", (int)version);
+		return false;
+	}
+	Uint8 mode;
+	Uint32 missionIndex;
+	if (!ReadString(r->f, r->CampaignPath, sizeof r->CampaignPath) ||
+		!ReadU8(r->f, &mode) || mode > GAME_MODE_QUICK_PLAY ||
+		!ReadVarint(r->f, &missionIndex) ||
+		!ReadU32(r->f, &r->Seed) ||
+		!ReadConfigGroup(r->f, &gConfig, 0))
+	{
+		return false;
+	}
+	r->CampaignMode = (GameMode)mode;
+	r->MissionIndex = (int)missionIndex;
+
+	Uint8 numPlayers;
+	if (!ReadU8(r->f, &numPlayers) || numPlayers > MAX_LOCAL_PLAYERS)
+	{
+		return false;
+	}
+	for (int i = 0; i < (int)numPlayers; i++)
+	{
+		Uint32 len;
+		Uint8 buf[NPlayerData_size];
+		Uint8 device;
+		if (!ReadVarint(r->f, &len) || len > sizeof buf ||
+			fread(buf, 1, len, r->f) != len ||
+			!ReadU8(r->f, &device))
+		{
+			return false;
+		}
+		ReplayPlayer rp;
+		memset(&rp, 0, sizeof rp);
+		const NPlayerData pdDefault = NPlayerData_init_default;
+		rp.Data = pdDefault;
+		pb_istream_t stream = pb_istream_from_buffer(buf, len);
+		if (!pb_decode(&stream, NPlayerData_fields, &rp.Data))
+		{
+			LOG(LM_MAIN, LL_ERROR, "failed to decode player data: %s",
+				PB_GET_ERROR(&stream));
+			return false;
+		}
+		rp.InputDevice = (input_device_e)device;
+		CArrayPushBack(&r->Players, &rp);
+	}
+	return true;
+}
+
+bool ReplayPlaybackLoad(Replay *r)
+{
+	r->f = fopen(r->Filename, "rb");
+	if (r->f == NULL)
+	{
+		LOG(LM_MAIN, LL_ERROR, "cannot open replay %s: %s",
+			r->Filename, strerror(errno));
+		return false;
+	}
+	if (!ReadHeader(r))
+	{
+		LOG(LM_MAIN, LL_ERROR, "invalid replay %s", r->Filename);
+		fclose(r->f);
+		r->f = NULL;
+		return false;
+	}
+	LOG(LM_MAIN, LL_INFO, "replay %s: campaign(%s) mission(%d) players(%d)",
+		r->Filename, r->CampaignPath, r->MissionIndex, (int)r->Players.size);
+	return true;
+}
+
+bool ReplayPlaybackStart(Replay *r)
+{
+	gCampaign.Entry.Mode = r->CampaignMode;
+	CampaignEntry entry;
+	if (!CampaignEntryTryLoad(&entry, r->CampaignPath, r->CampaignMode) ||
+		!CampaignLoad(&gCampaign, &entry))
+	{
+		LOG(LM_MAIN, LL_ERROR, "failed to load replay campaign %s",
+			r->CampaignPath);
+		return false;
+	}
+	if (r->MissionIndex >= (int)gCampaign.Setting.Missions.size)
+	{
+		LOG(LM_MAIN, LL_ERROR, "replay mission %d not in campaign",
+			r->MissionIndex);
+		return false;
+	}
+	gCampaign.MissionIndex = r->MissionIndex;
+	gCampaign.OptionsSet = true;
+
+	CA_FOREACH(const ReplayPlayer, rp, r->Players)
+		PlayerDataAddOrUpdate(rp->Data);
+		PlayerData *p = PlayerDataGetByUID(rp->Data.UID);
+		// Commands come from the replay; use a device that needs no hardware
+		p->inputDevice = rp->InputDevice == INPUT_DEVICE_AI ?
+			INPUT_DEVICE_AI : INPUT_DEVICE_KEYBOARD;
+		p->deviceIndex = 0;
+	CA_FOREACH_END()
+	return true;
+}
+
+static bool RecordStart(Replay *r, const CampaignOptions *co);
+bool ReplayMissionStart(Replay *r, const CampaignOptions *co)
+{
+	switch (r->Mode)
+	{
+	case REPLAY_RECORD:
+		r->IsRunning = RecordStart(r, co);
+		break;
+	case REPLAY_PLAYBACK:
+		r->IsRunning = r->f != NULL && !r->IsDone;
+		r->StartCounter = SDL_GetPerformanceCounter();
+		break;
+	default:
+		return false;
+	}
+	if (!r->IsRunning)
+	{
+		return false;
+	}
+	srand(r->Seed);
+	r->Tick = 0;
+	memset(r->Cmds, 0, sizeof r->Cmds);
+	memset(r->LastCmds, 0, sizeof r->LastCmds);
+	return true;
+}
+static bool RecordStart(Replay *r, const CampaignOptions *co)
+{
+	// Remote players' commands aren't available here to be recorded
+	if (co->IsClient || ConfigGetBool(&gConfig, "StartServer"))
+	{
+		LOG(LM_MAIN, LL_WARN, "cannot record network games");
+		return false;
+	}
+	// Quick play campaigns are generated, and can't be reloaded
+	if (co->Entry.Mode == GAME_MODE_QUICK_PLAY || co->Entry.Path == NULL)
+	{
+		LOG(LM_MAIN, LL_WARN, "cannot record campaigns without a file");
+		return false;
+	}
+
+	char filename[CDOGS_PATH_MAX];
+	r->MissionsRecorded++;
+	if (r->MissionsRecorded == 1)
+	{
+		strcpy(filename, r->Filename);
+	}
+	else
+	{
+		snprintf(
+			filename, sizeof filename, "%s.%d",
+			r->Filename, r->MissionsRecorded);
+	}
+	r->f = fopen(filename, "wb");
+	if (r->f == NULL)
+	{
+		LOG(LM_MAIN, LL_ERROR, "cannot record replay %s: %s",
+			filename, strerror(errno));
+		return false;
+	}
+
+	strncpy(r->CampaignPath, co->Entry.Path, CDOGS_PATH_MAX - 1);
+	r->CampaignMode = co->Entry.Mode;
+	r->MissionIndex = co->MissionIndex;
+	// PVP modes would otherwise reseed from the time
+	r->Seed = IsPVP(co->Entry.Mode) ?
+		(unsigned int)time(NULL) : (unsigned int)CampaignGetSeed(co);
+	if (!WriteHeader(r))
+	{
+		LOG(LM_MAIN, LL_ERROR, "failed to write replay %s", filename);
+		fclose(r->f);
+		r->f = NULL;
+		return false;
+	}
+	LOG(LM_MAIN, LL_INFO, "recording mission %d to %s",
+		r->MissionIndex + 1, filename);
+	return true;
+}
+
+void ReplayMissionEnd(Replay *r)
+{
+	if (!r->IsRunning)
+	{
+		return;
+	}
+	r->IsRunning = false;
+	switch (r->Mode)
+	{
+	case REPLAY_RECORD:
+		WriteU8(r->f, REPLAY_TAG_END);
+		if (ferror(r->f))
+		{
+			LOG(LM_MAIN, LL_ERROR, "error writing replay");
+		}
+		fclose(r->f);
+		r->f = NULL;
+		LOG(LM_MAIN, LL_INFO, "recorded %d ticks", r->Tick);
+		break;
+	case REPLAY_PLAYBACK:
+		{
+			const double s =
+				(double)(SDL_GetPerformanceCounter() - r->StartCounter) /
+				SDL_GetPerformanceFrequency();
+			printf(
+				"Replay %s: %d ticks in %.2fs (%.0f ticks/s), "
+				"checksums matched %d mismatched %d\n",
+				r->Filename, r->Tick, s, s > 0 ? r->Tick / s : 0.0,
+				r->ChecksumsMatched, r->ChecksumMismatches);
+			fclose(r->f);
+			r->f = NULL;
+			r->IsDone = true;
+		}
+		break;
+	default:
+		CASSERT(false, "unknown replay mode");
+		break;
+	}
+}
+
+static bool PlaybackReadTick(Replay *r);
+bool ReplayTickBegin(Replay *r)
+{
+	if (!r->IsRunning || r->Mode != REPLAY_PLAYBACK || r->IsDone)
+	{
+		return true;
+	}
+	if (!PlaybackReadTick(r))
+	{
+		r->IsDone = true;
+		memset(r->Cmds, 0, sizeof r->Cmds);
+		return false;
+	}
+	return true;
+}
+static bool PlaybackReadTick(Replay *r)
+{
+	Uint8 tag;
+	if (!ReadU8(r->f, &tag))
+	{
+		LOG(LM_MAIN, LL_WARN, "replay truncated at tick %d", r->Tick);
+		return false;
+	}
+	if (tag == REPLAY_TAG_END)
+	{
+		return false;
+	}
+	if ((tag & REPLAY_TAG_MASK) != REPLAY_TAG_TICK)
+	{
+		LOG(LM_MAIN, LL_WARN, "invalid replay record at tick %d", r->Tick);
+		return false;
+	}
+	for (int i = 0; i < MAX_LOCAL_PLAYERS; i++)
+	{
+		if (!(tag & (1 << i))) continue;
+		Uint32 cmd;
+		if (!ReadVarint(r->f, &cmd))
+		{
+			LOG(LM_MAIN, LL_WARN, "replay truncated at tick %d", r->Tick);
+			return false;
+		}
+		r->Cmds[i] = (int)cmd;
+	}
+	return true;
+}
+
+int ReplayCmd(Replay *r, const int idx, const int cmd)
+{
+	if (!r->IsRunning || idx >= MAX_LOCAL_PLAYERS)
+	{
+		return cmd;
+	}
+	if (r->Mode == REPLAY_PLAYBACK)
+	{
+		return r->Cmds[idx];
+	}
+	r->Cmds[idx] = cmd;
+	return cmd;
+}
+
+void ReplayTickEnd(Replay *r)
+{
+	if (!r->IsRunning)
+	{
+		return;
+	}
+	if (r->Mode == REPLAY_RECORD)
+	{
+		Uint8 mask = 0;
+		for (int i = 0; i < MAX_LOCAL_PLAYERS; i++)
+		{
+			if (r->Cmds[i] != r->LastCmds[i]) mask |= (Uint8)(1 << i);
+		}
+		WriteU8(r->f, REPLAY_TAG_TICK | mask);
+		for (int i = 0; i < MAX_LOCAL_PLAYERS; i++)
+		{
+			if (mask & (1 << i)) WriteVarint(r->f, (Uint32)r->Cmds[i]);
+		}
+		memcpy(r->LastCmds, r->Cmds, sizeof r->LastCmds);
+	}
+	else if (r->IsDone)
+	{
+		return;
+	}
+	r->Tick++;
+	if (r->Tick % REPLAY_CHECKSUM_TICKS != 0)
+	{
+		return;
+	}
+
+	const Uint32 checksum = ReplayChecksum();
+	if (r->Mode == REPLAY_RECORD)
+	{
+		WriteU32(r->f, checksum);
+		return;
+	}
+	Uint32 recorded;
+	if (!ReadU32(r->f, &recorded))
+	{
+		LOG(LM_MAIN, LL_WARN, "replay truncated at tick %d", r->Tick);
+		r->IsDone = true;
+		return;
+	}
+	if (recorded == checksum)
+	{
+		r->ChecksumsMatched++;
+		return;
+	}
+	// Once diverged, every later checksum will mismatch too; just log the
+	// first
+	if (r->ChecksumMismatches == 0)
+	{
+		LOG(LM_MAIN, LL_WARN,
+			"replay diverged at tick %d: checksum %08x, recorded %08x",
+			r->Tick, checksum, recorded);
+	}
+	r->ChecksumMismatches++;
+}
+
+// FNV-1a
+static Uint32 HashBytes(Uint32 h, const void *data, const size_t len)
+{
+	const Uint8 *b = data;
+	for (size_t i = 0; i < len; i++)
+	{
+		h ^= b[i];
+		h *= 16777619u;
+	}
+	return h;
+}
+Uint32 ReplayChecksum(void)
+{
+	Uint32 h = 2166136261u;
+	h = HashBytes(h, &gMission.time, sizeof gMission.time);
+	CA_FOREACH(const TActor, a, gActors)
+		if (!a->isInUse) continue;
+		h = HashBytes(h, &a->uid, sizeof a->uid);
+		h = HashBytes(h, &a->thing.Pos, sizeof a->thing.Pos);
+		h = HashBytes(h, &a->health, sizeof a->health);
+		h = HashBytes(h, &a->dead, sizeof a->dead);
+	CA_FOREACH_END()
+	CA_FOREACH(const TMobileObject, m, gMobObjs)
+		if (!m->isInUse) continue;
+		h = HashBytes(h, &m->UID, sizeof m->UID);
+		h = HashBytes(h, &m->thing.Pos, sizeof m->thing.Pos);
+	CA_FOREACH_END()
+	CA_FOREACH(const TObject, o, gObjs)
+		if (!o->isInUse) continue;
+		h = HashBytes(h, &o->uid, sizeof o->uid);
+		h = HashBytes(h, &o->Health, sizeof o->Health);
+	CA_FOREACH_END()
+	CA_FOREACH(const Pickup, p, gPickups)
+		if (!p->isInUse) continue;
+		h = HashBytes(h, &p->UID, sizeof p->UID);
+		h = HashBytes(h, &p->thing.Pos, sizeof p->thing.Pos);
+	CA_FOREACH_END()
+	return h;
+}
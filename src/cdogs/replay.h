@@ -0,0 +1,116 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+
+    Copyright (c) 2018 Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include <SDL_stdinc.h>
+
+#include "c_array.h"
+#include "gamedata.h"
+#include "player.h"
+#include "sys_config.h"
+
+// Replays record everything needed to re-run a mission exactly: the
+// campaign, config, players and random seed, followed by the local players'
+// commands for every simulated tick. State checksums are recorded
+// periodically so that playback can detect when it has diverged.
+
+typedef enum
+{
+	REPLAY_NONE,
+	REPLAY_RECORD,
+	REPLAY_PLAYBACK
+} ReplayMode;
+
+typedef struct
+{
+	NPlayerData Data;
+	input_device_e InputDevice;
+} ReplayPlayer;
+
+typedef struct
+{
+	ReplayMode Mode;
+	char Filename[CDOGS_PATH_MAX];
+	FILE *f;
+	// Play back as fast as possible rather than in real time
+	bool Fast;
+	// Whether the current mission is being recorded/played back
+	bool IsRunning;
+	int MissionsRecorded;
+
+	// Header
+	char CampaignPath[CDOGS_PATH_MAX];
+	GameMode CampaignMode;
+	int MissionIndex;
+	unsigned int Seed;
+	CArray Players;	// of ReplayPlayer
+
+	int Tick;
+	// Commands for the current tick, by local player index
+	int Cmds[MAX_LOCAL_PLAYERS];
+	int LastCmds[MAX_LOCAL_PLAYERS];
+
+	// Playback results
+	bool IsDone;
+	int ChecksumsMatched;
+	int ChecksumMismatches;
+	Uint64 StartCounter;
+} Replay;
+extern Replay gReplay;
+
+// Set up recording of each mission played to filename; missions after the
+// first are saved to filename.2, filename.3 etc.
+void ReplayRecordInit(Replay *r, const char *filename);
+void ReplayPlaybackInit(Replay *r, const char *filename, const bool fast);
+void ReplayTerminate(Replay *r);
+
+// Read the replay header, applying its config; call before
+// ReplayPlaybackStart. The config is not saved while playing back.
+bool ReplayPlaybackLoad(Replay *r);
+// Load the campaign and add the players from the replay header
+bool ReplayPlaybackStart(Replay *r);
+
+// Call at the start of a mission, before the map is built; seeds the random
+// number generator and starts recording/playback
+// Returns whether the mission is being recorded/played back
+bool ReplayMissionStart(Replay *r, const CampaignOptions *co);
+void ReplayMissionEnd(Replay *r);
+
+// Call around each tick's player commands
+// On playback, returns false once the recorded ticks run out
+bool ReplayTickBegin(Replay *r);
+// Record, or replace with the recorded, command for local player idx
+int ReplayCmd(Replay *r, const int idx, const int cmd);
+void ReplayTickEnd(Replay *r);
+
+// Checksum of the simulation state, for detecting divergence
+Uint32 ReplayChecksum(void);
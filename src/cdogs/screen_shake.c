@@ -32,6 +32,7 @@
 
 #include "config.h"
 #include "sys_config.h"
+#include "utils.h"
 
 #define MAX_SHAKE (100 * ConfigGetInt(&gConfig, "Game.FPS") / 100)
 #define SHAKE_STANDARD (70 * 1 * ConfigGetInt(&gConfig, "Game.FPS") / 100)
@@ -64,7 +65,9 @@ struct vec2 ScreenShakeGetDelta(ScreenShake s)
 	{
 		return svec2_zero();
 	}
-	return svec2(RAND_FLOAT(0, maxDelta), RAND_FLOAT(0, maxDelta));
+	return svec2(
+		(float)CosmeticRand() / RAND_MAX * maxDelta,
+		(float)CosmeticRand() / RAND_MAX * maxDelta);
 }
 
 ScreenShake ScreenShakeUpdate(ScreenShake s, int ticks)
@@ -96,6 +96,7 @@ int OpenAudio(int frequency, Uint16 format, int channels, int chunkSize)
 }
 
 static Mix_Chunk *LoadSound(const char *path);
+static void AddChunk(SoundDevice *s, Mix_Chunk *chunk, const void *group);
 static void AddSound(map_t sounds, const char *name, SoundData *sound);
 static void SoundLoad(map_t sounds, const char *name, const char *path)
 {
@@ -140,6 +141,7 @@ static void SoundLoad(map_t sounds, const char *name, const char *path)
 			Mix_Chunk *data = LoadSound(buf);
 			if (data == NULL) break;
 			CArrayPushBack(&sound->u.random.sounds, &data);
+			AddChunk(&gSoundDevice, data, sound);
 		}
 		// Remove "/0" from name and add
 		*strrchr(nameNoExt, '/') = '\0';
@@ -154,6 +156,7 @@ static void SoundLoad(map_t sounds, const char *name, const char *path)
 			CMALLOC(sound, sizeof *sound);
 			sound->Type = SOUND_NORMAL;
 			sound->u.normal = data;
+			AddChunk(&gSoundDevice, data, sound);
 			AddSound(sounds, nameNoExt, sound);
 		}
 	}
@@ -171,6 +174,103 @@ static Mix_Chunk *LoadSound(const char *path)
 	LOG(LM_MAIN, LL_TRACE, "loading sound file %s", path);
 	return Mix_LoadWAV(path);
 }
+static size_t FindChunk(
+	const SoundDevice *s, const Mix_Chunk *chunk, bool *found)
+{
+	// Binary search for the chunk or where it should be inserted
+	size_t lo = 0, hi = s->chunks.size;
+	while (lo < hi)
+	{
+		const size_t mid = (lo + hi) / 2;
+		const SoundChunk *sc = CArrayGet(&s->chunks, mid);
+		if ((uintptr_t)sc->Chunk < (uintptr_t)chunk)
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+	*found = lo < s->chunks.size &&
+		((const SoundChunk *)CArrayGet(&s->chunks, lo))->Chunk == chunk;
+	return lo;
+}
+static const SoundChunk *GetChunk(const SoundDevice *s, const Mix_Chunk *chunk)
+{
+	bool found;
+	const size_t i = FindChunk(s, chunk, &found);
+	return found ? CArrayGet(&s->chunks, i) : NULL;
+}
+static void MakeMuffled(SoundChunk *sc)
+{
+	// Filter sounds once here rather than on every mix
+	int frequency;
+	Uint16 format;
+	int channels;
+	if (!Mix_QuerySpec(&frequency, &format, &channels) ||
+		format != AUDIO_S16SYS || channels != 2)
+	{
+		return;
+	}
+	const int frames = (int)(sc->Chunk->alen / (channels * sizeof(int16_t)));
+	CMALLOC(sc->MuffledBuf, sc->Chunk->alen);
+	memcpy(sc->MuffledBuf, sc->Chunk->abuf, sc->Chunk->alen);
+	// 3-tap moving average, a cheap low-pass filter
+	const int16_t *in = (const int16_t *)sc->Chunk->abuf;
+	int16_t *out = (int16_t *)sc->MuffledBuf;
+	for (int i = 0; i < frames - 2; i++)
+	{
+		for (int c = 0; c < channels; c++)
+		{
+			out[i * channels + c] = (int16_t)((
+				in[i * channels + c] +
+				in[(i + 1) * channels + c] +
+				in[(i + 2) * channels + c]) / 3);
+		}
+	}
+	sc->Muffled = Mix_QuickLoad_RAW(sc->MuffledBuf, sc->Chunk->alen);
+	if (sc->Muffled == NULL)
+	{
+		LOG(LM_SOUND, LL_ERROR, "cannot make muffled sound: %s",
+			Mix_GetError());
+		CFREE(sc->MuffledBuf);
+		sc->MuffledBuf = NULL;
+		return;
+	}
+	sc->Muffled->volume = sc->Chunk->volume;
+}
+static void AddChunk(SoundDevice *s, Mix_Chunk *chunk, const void *group)
+{
+	bool found;
+	const size_t i = FindChunk(s, chunk, &found);
+	if (found)
+	{
+		return;
+	}
+	SoundChunk sc;
+	memset(&sc, 0, sizeof sc);
+	sc.Chunk = chunk;
+	sc.Group = group;
+	MakeMuffled(&sc);
+	CArrayInsert(&s->chunks, i, &sc);
+}
+static void FreeChunk(SoundDevice *s, Mix_Chunk *chunk)
+{
+	bool found;
+	const size_t i = FindChunk(s, chunk, &found);
+	if (found)
+	{
+		SoundChunk *sc = CArrayGet(&s->chunks, i);
+		if (sc->Muffled != NULL)
+		{
+			Mix_FreeChunk(sc->Muffled);
+			CFREE(sc->MuffledBuf);
+		}
+		CArrayDelete(&s->chunks, i);
+	}
+	Mix_FreeChunk(chunk);
+}
 static void SoundDataTerminate(any_t data);
 static void AddSound(map_t sounds, const char *name, SoundData *sound)
 {
@@ -185,12 +285,13 @@ static void AddSound(map_t sounds, const char *name, SoundData *sound)
 void SoundInitialize(SoundDevice *device, const char *path)
 {
 	memset(device, 0, sizeof *device);
+	CArrayInit(&device->chunks, sizeof(SoundChunk));
+	CArrayInit(&device->pending, sizeof(SoundPending));
 	if (OpenAudio(44100, AUDIO_S16, 2, 1024) != 0)
 	{
 		return;
 	}
 
-	device->channels = 64;
 	SoundReconfigure(device);
 
 	device->sounds = hashmap_new();
@@ -250,7 +351,7 @@ void SoundReconfigure(SoundDevice *s)
 {
 	s->isInitialised = false;
 
-	if (Mix_AllocateChannels(s->channels) != s->channels)
+	if (Mix_AllocateChannels(SOUND_CHANNELS) != SOUND_CHANNELS)
 	{
 		printf("Couldn't allocate channels!\n");
 		return;
@@ -296,6 +397,8 @@ void SoundTerminate(SoundDevice *device, const bool waitForSoundsComplete)
 
 	hashmap_destroy(device->sounds, SoundDataTerminate);
 	hashmap_destroy(device->customSounds, SoundDataTerminate);
+	CArrayTerminate(&device->chunks);
+	CArrayTerminate(&device->pending);
 }
 static void SoundDataTerminate(any_t data)
 {
@@ -303,11 +406,11 @@ static void SoundDataTerminate(any_t data)
 	switch (s->Type)
 	{
 		case SOUND_NORMAL:
-			Mix_FreeChunk(s->u.normal);
+			FreeChunk(&gSoundDevice, s->u.normal);
 			break;
 		case SOUND_RANDOM:
 			CA_FOREACH(Mix_Chunk *, chunk, s->u.random.sounds)
-				Mix_FreeChunk(*chunk);
+				FreeChunk(&gSoundDevice, *chunk);
 			CA_FOREACH_END()
 			CArrayTerminate(&s->u.random.sounds);
 			break;
@@ -319,26 +422,20 @@ static void SoundDataTerminate(any_t data)
 }
 
 #define OUT_OF_SIGHT_DISTANCE_PLUS 100
-static int GetChannel(SoundDevice *s, Mix_Chunk *data);
-static void MuffleEffect(int chan, void *stream, int len, void *udata)
+static int GetChannel(
+	SoundDevice *s, const void *group, const SoundPriority priority,
+	const int distance);
+static void SetSoundEffect(
+	const int channel, const Sint16 bearingDegrees, const Uint8 distance);
+float SoundGetMaxDistance(const float screenWidth)
 {
-	UNUSED(chan);
-	UNUSED(udata);
-	const int channels = 2;
-	const int chunk = channels * 2;
-	for (int i = 0; i < len / chunk - 2; i++)
-	{
-		int16_t *samples = (int16_t *)((char *)stream + i * chunk);
-		samples[0] = (samples[0] + samples[2] + samples[4]) / 3;
-		samples[1] = (samples[1] + samples[3] + samples[5]) / 3;
-	}
+	const float halfScreen = screenWidth / 2;
+	return sqrtf(screenWidth * screenWidth + halfScreen * halfScreen);
 }
-static void SetSoundEffect(
-	const int channel, const Sint16 bearingDegrees, const Uint8 distance,
-	const bool isMuffled);
+
 static void SoundPlayAtPosition(
 	SoundDevice *device, Mix_Chunk *data, const struct vec2 dp,
-	const bool isMuffled)
+	const bool isMuffled, const SoundPriority priority, const int count)
 {
 	if (!device->isInitialised || data == NULL)
 	{
@@ -365,9 +462,7 @@ static void SoundPlayAtPosition(
 		const float d = svec2_length(dp);
 		// Scale so that sounds more than a full screen from centre have
 		// maximum distance (255)
-		const float maxDistance =
-			sqrtf(screen * screen + halfScreen * halfScreen);
-		distance = (int)(d * 255 / maxDistance);
+		distance = (int)(d * 255 / SoundGetMaxDistance(screen));
 
 		// Calculate bearing
 		const double bearing = atan((double)dp.x / halfScreen);
@@ -381,6 +476,12 @@ static void SoundPlayAtPosition(
 	{
 		distance += OUT_OF_SIGHT_DISTANCE_PLUS;
 	}
+	if (count > 1)
+	{
+		// Merged sounds add in power; scale loudness by sqrt(count)
+		const float loudness = (255 - distance) * sqrtf((float)count);
+		distance = 255 - (int)MIN(loudness, 255.0f);
+	}
 	// Don't play anything if it's too distant
 	// This means we don't waste sound channels
 	if (distance > 255)
@@ -391,51 +492,91 @@ static void SoundPlayAtPosition(
 	LOG(LM_SOUND, LL_TRACE, "distance(%d) bearing(%d)",
 		distance, bearingDegrees);
 
+	const SoundChunk *sc = GetChunk(device, data);
+	const void *group = sc != NULL ? sc->Group : data;
+	if (isMuffled && sc != NULL && sc->Muffled != NULL)
+	{
+		data = sc->Muffled;
+	}
+
 	// Get sound channel to play sound
-	const int channel = GetChannel(device, data);
+	const int channel = GetChannel(device, group, priority, distance);
 	if (channel < 0)
 	{
 		return;
 	}
+	if (Mix_PlayChannel(channel, data, 0) < 0)
+	{
+		LOG(LM_SOUND, LL_ERROR, "cannot play sound: %s", Mix_GetError());
+		return;
+	}
 
-	SetSoundEffect(channel, bearingDegrees, (Uint8)distance, isMuffled);
+	SetSoundEffect(channel, bearingDegrees, (Uint8)distance);
+}
+static bool VoiceIsLessImportant(const SoundVoice *a, const SoundVoice *b)
+{
+	return a->Priority < b->Priority ||
+		(a->Priority == b->Priority && a->Distance > b->Distance);
 }
-static int GetChannel(SoundDevice *s, Mix_Chunk *data)
+// Find a free channel, or stop the least important sound that's playing if
+// it is less important than this one
+static int GetChannel(
+	SoundDevice *s, const void *group, const SoundPriority priority,
+	const int distance)
 {
-	for (;;)
+	int freeChannel = -1;
+	int leastChannel = -1;
+	int groupCount = 0;
+	int groupLeastChannel = -1;
+	for (int i = 0; i < SOUND_CHANNELS; i++)
 	{
-		const int channel = Mix_PlayChannel(-1, data, 0);
-		if (channel >= 0 || s->channels > 128)
+		if (!Mix_Playing(i))
 		{
-			return channel;
+			if (freeChannel < 0) freeChannel = i;
+			continue;
+		}
+		const SoundVoice *v = &s->voices[i];
+		if (leastChannel < 0 ||
+			VoiceIsLessImportant(v, &s->voices[leastChannel]))
+		{
+			leastChannel = i;
 		}
-		// Check if we cannot play the sound; allocate more channels
-		s->channels *= 2;
-		if (Mix_AllocateChannels(s->channels) != s->channels)
+		if (v->Group == group)
 		{
-			LOG(LM_SOUND, LL_ERROR, "Cannot allocate channels");
-			return -1;
+			groupCount++;
+			if (groupLeastChannel < 0 ||
+				VoiceIsLessImportant(v, &s->voices[groupLeastChannel]))
+			{
+				groupLeastChannel = i;
+			}
 		}
-		// When allocating new channels, need to reset their volume
-		Mix_Volume(-1, ConfigGetInt(&gConfig, "Sound.SoundVolume"));
 	}
+	const SoundVoice voice = { group, priority, distance };
+	int channel = freeChannel;
+	if (groupCount >= SOUND_MAX_VOICES_PER_SOUND)
+	{
+		channel = groupLeastChannel;
+	}
+	else if (channel < 0)
+	{
+		channel = leastChannel;
+	}
+	if (channel != freeChannel &&
+		VoiceIsLessImportant(&voice, &s->voices[channel]))
+	{
+		LOG(LM_SOUND, LL_TRACE, "dropped sound distance(%d)", distance);
+		return -1;
+	}
+	s->voices[channel] = voice;
+	return channel;
 }
 static void SetSoundEffect(
-	const int channel, const Sint16 bearingDegrees, const Uint8 distance,
-	const bool isMuffled)
+	const int channel, const Sint16 bearingDegrees, const Uint8 distance)
 {
 #ifndef __EMSCRIPTEN__
 	Mix_SetPosition(channel, bearingDegrees, (Uint8)distance);
-	if (isMuffled)
-	{
-		if (!Mix_RegisterEffect(channel, MuffleEffect, NULL, NULL))
-		{
-			fprintf(stderr, "Mix_RegisterEffect: %s\n", Mix_GetError());
-		}
-	}
 #else
-	// Mix_SetPosition and Mix_RegisterEffect not supported by emscripten;
-	// use plain panning instead
+	// Mix_SetPosition not supported by emscripten; use plain panning instead
 
 	// Calculate left/right channel as values from 0-180
 	int left;
@@ -456,7 +597,8 @@ void SoundPlay(SoundDevice *device, Mix_Chunk *data)
 		return;
 	}
 
-	SoundPlayAtPosition(device, data, svec2_zero(), false);
+	SoundPlayAtPosition(
+		device, data, svec2_zero(), false, SOUND_PRIORITY_HIGH, 1);
 }
 
 
@@ -505,13 +647,14 @@ void SoundPlayAt(SoundDevice *device, Mix_Chunk *data, const struct vec2 pos)
 
 static bool IsPosNoSee(void *data, struct vec2i pos)
 {
-	const Tile *t = MapGetTile(data, Vec2iToTile(pos));
-	return t != NULL && TileIsOpaque(t);
+	const Map *map = data;
+	const struct vec2i tilePos = Vec2iToTile(pos);
+	return MapIsTileIn(map, tilePos) &&
+		MapTileBit(map, MAP_BITS_OPAQUE, tilePos);
 }
-void SoundPlayAtPlusDistance(
-	SoundDevice *device, Mix_Chunk *data,
-	const struct vec2 pos, const int plusDistance)
+static void SoundPlayPending(SoundDevice *device, const SoundPending *p)
 {
+	const struct vec2 pos = p->Pos;
 	struct vec2 closestLeftEar, closestRightEar;
 
 	// Find closest set of ears to the sound
@@ -547,8 +690,54 @@ void SoundPlayAtPlusDistance(
 	}
 	const struct vec2 dp = svec2_subtract(pos, origin);
 	SoundPlayAtPosition(
-		&gSoundDevice, data, svec2(dp.x, fabsf(dp.y) + plusDistance),
-		isMuffled);
+		device, p->Chunk, svec2(dp.x, fabsf(dp.y) + p->PlusDistance),
+		isMuffled, SOUND_PRIORITY_NORMAL, p->Count);
+}
+static void SoundQueue(
+	SoundDevice *device, Mix_Chunk *data, const struct vec2 pos,
+	const int plusDistance, const int count)
+{
+	if (!device->isInitialised || data == NULL || count <= 0)
+	{
+		return;
+	}
+	// Merge with an identical sound nearby, e.g. enemies firing the same gun
+	const SoundChunk *sc = GetChunk(device, data);
+	const void *group = sc != NULL ? sc->Group : data;
+	CA_FOREACH(SoundPending, p, device->pending)
+		if (p->Group == group && p->PlusDistance == plusDistance &&
+			svec2_distance_squared(p->Pos, pos) <=
+			SOUND_COALESCE_DISTANCE * SOUND_COALESCE_DISTANCE)
+		{
+			const int total = p->Count + count;
+			p->Pos = svec2_scale(svec2_add(
+				svec2_scale(p->Pos, (float)p->Count),
+				svec2_scale(pos, (float)count)), 1.0f / total);
+			p->Count = total;
+			return;
+		}
+	CA_FOREACH_END()
+	const SoundPending p = { data, group, pos, plusDistance, count };
+	CArrayPushBack(&device->pending, &p);
+}
+void SoundPlayAtPlusDistance(
+	SoundDevice *device, Mix_Chunk *data,
+	const struct vec2 pos, const int plusDistance)
+{
+	SoundQueue(device, data, pos, plusDistance, 1);
+}
+void SoundPlayAtMerged(
+	SoundDevice *device, Mix_Chunk *data, const struct vec2 pos,
+	const int count)
+{
+	SoundQueue(device, data, pos, 0, count);
+}
+void SoundFlush(SoundDevice *device)
+{
+	CA_FOREACH(const SoundPending, p, device->pending)
+		SoundPlayPending(device, p);
+	CA_FOREACH_END()
+	CArrayClear(&device->pending);
 }
 
 static Mix_Chunk *SoundDataGet(SoundData *s);
@@ -559,12 +748,14 @@ Mix_Chunk *StrSound(const char *s)
 		return NULL;
 	}
 	SoundData *sound;
-	int error = hashmap_get(gSoundDevice.customSounds, s, (any_t *)&sound);
+	const unsigned int hash = hashmap_hash_key(s);
+	int error = hashmap_get_hashed(
+		gSoundDevice.customSounds, s, hash, (any_t *)&sound);
 	if (error == MAP_OK)
 	{
 		return SoundDataGet(sound);
 	}
-	error = hashmap_get(gSoundDevice.sounds, s, (any_t *)&sound);
+	error = hashmap_get_hashed(gSoundDevice.sounds, s, hash, (any_t *)&sound);
 	if (error == MAP_OK)
 	{
 		return SoundDataGet(sound);
@@ -589,7 +780,7 @@ static Mix_Chunk *SoundDataGet(SoundData *s)
 				while ((int)s->u.random.sounds.size > 1 &&
 					idx == s->u.random.lastPlayed)
 				{
-					idx = rand() % s->u.random.sounds.size;
+					idx = CosmeticRand() % (int)s->u.random.sounds.size;
 				}
 				Mix_Chunk **sound = CArrayGet(&s->u.random.sounds, idx);
 				s->u.random.lastPlayed = idx;
@@ -85,6 +85,49 @@ typedef struct
 	} u;
 } SoundData;
 
+// Loaded sound chunk, with its pre-computed variants
+typedef struct
+{
+	Mix_Chunk *Chunk;
+	// Sound the chunk belongs to; random sounds share one
+	const void *Group;
+	// Low-pass filtered, for sounds out of sight
+	Mix_Chunk *Muffled;
+	Uint8 *MuffledBuf;
+} SoundChunk;
+
+// Sounds play on a fixed number of channels; when they run out, or too many
+// of the same sound are playing, less important sounds are stopped
+#define SOUND_CHANNELS 32
+#define SOUND_MAX_VOICES_PER_SOUND 4
+
+typedef enum
+{
+	SOUND_PRIORITY_NORMAL,
+	// Non-positional sounds, e.g. announcements
+	SOUND_PRIORITY_HIGH
+} SoundPriority;
+
+typedef struct
+{
+	const void *Group;
+	SoundPriority Priority;
+	int Distance;
+} SoundVoice;
+
+// Positional sounds are queued and played on SoundFlush; identical sounds
+// within this distance of each other are merged into one, louder sound
+#define SOUND_COALESCE_DISTANCE 48.0f
+
+typedef struct
+{
+	Mix_Chunk *Chunk;
+	const void *Group;
+	struct vec2 Pos;
+	int PlusDistance;
+	int Count;
+} SoundPending;
+
 typedef enum
 {
 	MUSIC_OK,
@@ -99,7 +142,7 @@ typedef struct
 	Mix_Music *music;
 	music_status_e musicStatus;
 	char musicErrorMessage[128];
-	int channels;
+	SoundVoice voices[SOUND_CHANNELS];
 
 	// Two sets of ears for 4-player split screen
 	struct vec2 earLeft1;
@@ -109,6 +152,8 @@ typedef struct
 
 	map_t sounds;		// of SoundData
 	map_t customSounds;	// of SoundData
+	CArray chunks;		// of SoundChunk, sorted by Chunk
+	CArray pending;		// of SoundPending
 } SoundDevice;
 
 extern SoundDevice gSoundDevice;
@@ -147,5 +192,14 @@ void SoundPlayAt(SoundDevice *device, Mix_Chunk *data, const struct vec2 pos);
 void SoundPlayAtPlusDistance(
 	SoundDevice *device, Mix_Chunk *data,
 	const struct vec2 pos, const int plusDistance);
+// Play a sound that stands for count identical sounds
+void SoundPlayAtMerged(
+	SoundDevice *device, Mix_Chunk *data, const struct vec2 pos,
+	const int count);
+// Distance from the listener beyond which sounds are silent, for a screen
+// of this width
+float SoundGetMaxDistance(const float screenWidth);
+// Play the positional sounds queued this tick
+void SoundFlush(SoundDevice *device);
 
 Mix_Chunk *StrSound(const char *s);
@@ -48,6 +48,8 @@
 	RAND_FLOAT(-DRAW_SHAKE_MAX, DRAW_SHAKE_MAX) * 0.7f,\
 	RAND_FLOAT(-DRAW_SHAKE_MAX, DRAW_SHAKE_MAX) * 0.7f)
 
+ThingInterpolation gThingInterpolation = { 0, 1.0f };
+
 
 bool IsThingInsideTile(const Thing *i, const struct vec2i tilePos)
 {
@@ -70,6 +72,8 @@ void ThingInit(
 	t->flags = flags;
 	// Ininitalise pos
 	t->Pos = svec2(-1, -1);
+	t->LastPos = t->Pos;
+	t->LastMoveTick = -1;
 }
 
 void ThingUpdate(Thing *t, const int ticks)
@@ -102,6 +106,30 @@ void ThingAddDrawShake(Thing *t, const struct vec2 shake)
 	}
 }
 
+void ThingSetPos(Thing *t, const struct vec2 pos)
+{
+	// Only remember the first position of this tick, so that things which
+	// move several times in one tick are interpolated over the whole move
+	// Newly placed things (position -1) are never interpolated
+	if (t->LastMoveTick != gThingInterpolation.Ticks || t->Pos.x < 0)
+	{
+		t->LastPos = t->Pos;
+		t->LastMoveTick = gThingInterpolation.Ticks;
+	}
+	t->Pos = pos;
+}
+
+struct vec2 ThingGetDrawPos(const Thing *t)
+{
+	// Things that haven't moved this tick are drawn where they are
+	if (t->LastMoveTick != gThingInterpolation.Ticks ||
+		t->LastPos.x < 0 || t->LastPos.y < 0)
+	{
+		return t->Pos;
+	}
+	return Vec2Interpolate(t->LastPos, t->Pos, gThingInterpolation.Alpha);
+}
+
 void ThingDamage(const NThingDamage d)
 {
 	Thing *ti = ThingGetByUID(d.Kind, d.UID);
@@ -43,7 +43,8 @@ typedef enum
 	KIND_PARTICLE,
 	KIND_MOBILEOBJECT,
 	KIND_OBJECT,
-	KIND_PICKUP
+	KIND_PICKUP,
+	KIND_COUNT
 } ThingKind;
 
 #define THING_IMPASSABLE     1
@@ -71,7 +72,9 @@ typedef void (*ThingDrawFunc)(const struct vec2i, const ThingDrawFuncData *);
 typedef struct
 {
 	struct vec2 Pos;
+	// Position at the start of the simulation tick in which it last moved
 	struct vec2 LastPos;
+	int LastMoveTick;
 	struct vec2 Vel;
 	struct vec2i size;
 	ThingKind kind;
@@ -84,10 +87,23 @@ typedef struct
 	struct vec2 drawShake;
 	struct vec2i ShadowSize;
 	int SoundLock;
+	// Marks the things found while building a view's draw list
+	unsigned int drawListStamp;
 } Thing;
 #define SOUND_LOCK_THING 12
 
 
+// Interpolation of drawn positions between fixed simulation ticks
+typedef struct
+{
+	// Simulation ticks elapsed; advanced once per game update
+	int Ticks;
+	// Fraction of a tick elapsed since the last update, in [0, 1]
+	float Alpha;
+} ThingInterpolation;
+extern ThingInterpolation gThingInterpolation;
+
+
 typedef struct
 {
 	// TODO: add an entity id system
@@ -103,6 +119,8 @@ void ThingInit(
 	const int flags);
 void ThingUpdate(Thing *t, const int ticks);
 void ThingAddDrawShake(Thing *t, const struct vec2 shake);
+void ThingSetPos(Thing *t, const struct vec2 pos);
+struct vec2 ThingGetDrawPos(const Thing *t);
 void ThingDamage(const NThingDamage d);
 
 Thing *ThingGetByUID(const ThingKind kind, const int uid);
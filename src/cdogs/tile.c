@@ -55,15 +55,15 @@
 Tile TileNone(void)
 {
 	Tile t;
-	TileInit(&t);
+	TileInit(&t, NULL);
 	t.Class = &gTileNothing;
 	return t;
 }
-void TileInit(Tile *t)
+void TileInit(Tile *t, struct MemArena *arena)
 {
 	memset(t, 0, sizeof *t);
-	CArrayInit(&t->triggers, sizeof(Trigger *));
-	CArrayInit(&t->things, sizeof(ThingId));
+	CArrayInitArena(&t->triggers, sizeof(Trigger *), arena);
+	CArrayInitArena(&t->things, sizeof(ThingId), arena);
 }
 void TileDestroy(Tile *t)
 {
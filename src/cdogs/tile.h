@@ -64,7 +64,8 @@ typedef struct
 
 
 Tile TileNone(void);
-void TileInit(Tile *t);
+// arena may be NULL to allocate from the heap
+void TileInit(Tile *t, struct MemArena *arena);
 void TileDestroy(Tile *t);
 bool TileIsOpaque(const Tile *t);
 bool TileIsShootable(const Tile *t);
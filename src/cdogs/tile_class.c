@@ -89,12 +89,14 @@ const TileClass *StrTileClass(const char *name)
 		return &gTileNothing;
 	}
 	TileClass *t;
-	int error = hashmap_get(gTileClasses.customClasses, name, (any_t *)&t);
+	const unsigned int hash = hashmap_hash_key(name);
+	int error = hashmap_get_hashed(
+		gTileClasses.customClasses, name, hash, (any_t *)&t);
 	if (error == MAP_OK)
 	{
 		return t;
 	}
-	error = hashmap_get(gTileClasses.classes, name, (any_t *)&t);
+	error = hashmap_get_hashed(gTileClasses.classes, name, hash, (any_t *)&t);
 	if (error == MAP_OK)
 	{
 		return t;
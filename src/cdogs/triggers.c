@@ -63,19 +63,13 @@ static int watchIndex = 1;
 #define CANNOT_ACTIVATE_LOCK 50
 
 
-Trigger *TriggerNew(void)
+Trigger *TriggerNew(MemArena *arena)
 {
-	Trigger *t;
-	CCALLOC(t, sizeof *t);
+	Trigger *t = MemArenaCalloc(arena, sizeof *t);
 	t->isActive = 1;
-	CArrayInit(&t->actions, sizeof(Action));
+	CArrayInitArena(&t->actions, sizeof(Action), arena);
 	return t;
 }
-void TriggerTerminate(Trigger *t)
-{
-	CArrayTerminate(&t->actions);
-	CFREE(t);
-}
 Action *TriggerAddAction(Trigger *t)
 {
 	Action a;
@@ -89,8 +83,8 @@ TWatch *WatchNew(void)
 	TWatch t;
 	memset(&t, 0, sizeof(TWatch));
 	t.index = watchIndex++;
-	CArrayInit(&t.actions, sizeof(Action));
-	CArrayInit(&t.conditions, sizeof(Condition));
+	CArrayInitArena(&t.actions, sizeof(Action), gWatches.arena);
+	CArrayInitArena(&t.conditions, sizeof(Condition), gWatches.arena);
 	t.active = false;
 	CArrayPushBack(&gWatches, &t);
 	return CArrayGet(&gWatches, gWatches.size - 1);
@@ -146,16 +140,13 @@ static void DeactivateWatch(int idx)
 	CASSERT(false, "Cannot find watch");
 }
 
-void WatchesInit(void)
+void WatchesInit(MemArena *arena)
 {
-	CArrayInit(&gWatches, sizeof(TWatch));
+	CArrayInitArena(&gWatches, sizeof(TWatch), arena);
 }
 void WatchesTerminate(void)
 {
-	CA_FOREACH(TWatch, w, gWatches)
-		CArrayTerminate(&w->conditions);
-		CArrayTerminate(&w->actions);
-	CA_FOREACH_END()
+	// Watch conditions and actions are freed with the mission arena
 	CArrayTerminate(&gWatches);
 }
 
@@ -57,6 +57,7 @@
 
 #include "c_array.h"
 #include "game_events.h"
+#include "mem_arena.h"
 #include "pic.h"
 #include "proto/msg.pb.h"
 
@@ -128,11 +129,11 @@ bool TriggerCannotActivate(const Trigger *t);
 void TriggerSetCannotActivate(Trigger *t);
 void TriggerActivate(Trigger *t, CArray *mapTriggers);
 void UpdateWatches(CArray *mapTriggers, const int ticks);
-Trigger *TriggerNew(void);
-void TriggerTerminate(Trigger *t);
+// Triggers live as long as the map; they are freed with its arena
+Trigger *TriggerNew(MemArena *arena);
 Action *TriggerAddAction(Trigger *t);
 
-void WatchesInit(void);
+void WatchesInit(MemArena *arena);
 void WatchesTerminate(void);
 
 TWatch *WatchNew(void);
@@ -384,6 +384,28 @@ double ToDegrees(double radians)
 	return radians * 180.0 / MPI;
 }
 
+#if !defined(__GNUC__) && !defined(__clang__)
+int CountTrailingZeros64(uint64_t x)
+{
+	int n = 0;
+	while (!(x & 1))
+	{
+		x >>= 1;
+		n++;
+	}
+	return n;
+}
+int CountBits64(uint64_t x)
+{
+	int n = 0;
+	for (; x; x &= x - 1)
+	{
+		n++;
+	}
+	return n;
+}
+#endif
+
 struct vec2 CalcClosestPointOnLineSegmentToPoint(
 	const struct vec2 l1, const struct vec2 l2, const struct vec2 p)
 {
@@ -507,6 +529,16 @@ BodyPart StrBodyPart(const char *s)
 	return BODY_PART_HEAD;
 }
 
+static Uint64 sCosmeticRandState = 0x9E3779B97F4A7C15ull;
+int CosmeticRand(void)
+{
+	// xorshift64*
+	sCosmeticRandState ^= sCosmeticRandState >> 12;
+	sCosmeticRandState ^= sCosmeticRandState << 25;
+	sCosmeticRandState ^= sCosmeticRandState >> 27;
+	return (int)((sCosmeticRandState * 0x2545F4914F6CDD1Dull) >> 33) & RAND_MAX;
+}
+
 int Pulse256(const int t)
 {
 	const int pulsePeriod = ConfigGetInt(&gConfig, "Game.FPS");
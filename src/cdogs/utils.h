@@ -50,6 +50,7 @@
 
 #include <assert.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h> /* for stderr */
 #include <stdlib.h>
 #include <string.h>
@@ -146,6 +147,15 @@ double Round(double x);
 
 double ToDegrees(double radians);
 
+// Bit scanning on 64-bit words; CountTrailingZeros64(0) is undefined
+#if defined(__GNUC__) || defined(__clang__)
+#define CountTrailingZeros64(x) __builtin_ctzll(x)
+#define CountBits64(x) __builtin_popcountll(x)
+#else
+int CountTrailingZeros64(uint64_t x);
+int CountBits64(uint64_t x);
+#endif
+
 struct vec2 CalcClosestPointOnLineSegmentToPoint(
 	const struct vec2 l1, const struct vec2 l2, const struct vec2 p);
 
@@ -187,6 +197,11 @@ bool StrEndsWith(const char *str, const char *suffix);
 #define RAND_FLOAT(_low, _high) ((_low) + ((float)rand() / RAND_MAX * ((_high) - (_low))))
 #define RAND_DOUBLE(_low, _high) ((_low) + ((double)rand() / RAND_MAX * ((_high) - (_low))))
 
+// Like rand(), for effects that don't change the game state (sound variants,
+// screen shake); these don't consume the game's random sequence, which keeps
+// it reproducible for replays
+int CosmeticRand(void);
+
 typedef struct
 {
 	int Id;
@@ -29,6 +29,8 @@
 
 #include "tile.h"
 
+#define INTERPOLATE_MAX_DIST (TILE_WIDTH * 4)
+
 struct vec2i svec2i_scale_divide(const struct vec2i v, const mint_t scale)
 {
 	return svec2i(v.x / scale, v.y / scale);
@@ -56,6 +58,18 @@ struct vec2 Vec2CenterOfTile(const struct vec2i v)
 	return svec2_assign_vec2i(Vec2iCenterOfTile(v));
 }
 
+struct vec2 Vec2Interpolate(
+	const struct vec2 from, const struct vec2 to, const float alpha)
+{
+	if (alpha >= 1.0f ||
+		svec2_distance_squared(from, to) >
+		INTERPOLATE_MAX_DIST * INTERPOLATE_MAX_DIST)
+	{
+		return to;
+	}
+	return svec2_lerp(from, to, alpha);
+}
+
 Rect2i Rect2iNew(const struct vec2i pos, const struct vec2i size)
 {
 	Rect2i r;
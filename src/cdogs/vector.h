@@ -39,6 +39,10 @@ struct vec2i Vec2iToTile(struct vec2i v);
 struct vec2i Vec2iCenterOfTile(struct vec2i v);
 struct vec2i Vec2ToTile(const struct vec2 v);
 struct vec2 Vec2CenterOfTile(const struct vec2i v);
+// Linear interpolation for drawing between ticks; long jumps (teleports)
+// are not interpolated
+struct vec2 Vec2Interpolate(
+	const struct vec2 from, const struct vec2 to, const float alpha);
 
 // Helper macros for positioning
 #define CENTER_X(_pos, _size, _w) ((_pos).x + ((_size).x - (_w)) / 2)
@@ -66,6 +66,7 @@
 #include <cdogs/files.h>
 #include <cdogs/font_utils.h>
 #include <cdogs/log.h>
+#include <cdogs/map_build.h>
 #include <cdogs/player_template.h>
 
 #include <tinydir/tinydir.h>
@@ -73,6 +74,7 @@
 #include <cdogsed/char_editor.h>
 #include <cdogsed/editor_ui.h>
 #include <cdogsed/editor_ui_common.h>
+#include <cdogsed/editor_undo.h>
 
 
 // Mouse click areas:
@@ -82,8 +84,10 @@ static UIObject *sLastHighlightedObj = NULL;
 static UIObject *sTooltipObj = NULL;
 static DrawBuffer sDrawBuffer;
 static bool sJustLoaded = true;
+// Whether the brush has changed tiles that are not in the undo history yet
 static bool sHasUnbakedChanges = false;
 static int sAutosaveIndex = 0;
+static MapArchiveSaver sAutosaver;
 // State for whether to ignore the current mouse click
 // This is to prevent painting immediately after selecting a new tool,
 // but before the user has clicked again.
@@ -101,9 +105,14 @@ EditorContext ec;
 static char lastFile[CDOGS_PATH_MAX];
 static EditorBrush brush;
 #define CAMERA_PAN_SPEED 3
-Mission currentMission;
-Mission lastMission;
+#define UNDO_MAX_SIZE (16 * 1024 * 1024)
+static EditorUndo sUndo;
+// The mission being tracked by the undo history
+static const Mission *sUndoMission = NULL;
 #define AUTOSAVE_INTERVAL_SECONDS 60
+// Autosaves cycle through this many directories, so that files that haven't
+// changed since a directory was last used aren't written again
+#define AUTOSAVE_SLOTS 3
 Uint32 ticksAutosave;
 Uint32 sTicksElapsed;
 bool fileChanged = false;
@@ -274,6 +283,10 @@ static void Change(UIObject *o, const int d, const bool shift)
 	{
 		Setup(false);
 	}
+	else if (r & EDITOR_RESULT_CHANGED)
+	{
+		EditorUndoCommit(&sUndo, CampaignGetCurrentMission(&gCampaign));
+	}
 }
 
 static void AddObjective(Mission *m)
@@ -383,14 +396,18 @@ static void Autosave(void)
 {
 	if (fileChanged && sTicksElapsed > ticksAutosave)
 	{
-		ticksAutosave = sTicksElapsed + AUTOSAVE_INTERVAL_SECONDS * 1000;
 		char dirname[CDOGS_PATH_MAX];
 		PathGetDirname(dirname, lastFile);
 		char buf[CDOGS_PATH_MAX];
 		sprintf(
 			buf, "%s~%d%s", dirname, sAutosaveIndex, PathGetBasename(lastFile));
-		MapArchiveSave(buf, &gCampaign.Setting);
-		sAutosaveIndex++;
+		// Save in the background; if the last autosave is still running,
+		// try again next time
+		if (MapArchiveSaveAsync(&sAutosaver, buf, &gCampaign.Setting))
+		{
+			ticksAutosave = sTicksElapsed + AUTOSAVE_INTERVAL_SECONDS * 1000;
+			sAutosaveIndex = (sAutosaveIndex + 1) % AUTOSAVE_SLOTS;
+		}
 	}
 }
 
@@ -401,10 +418,20 @@ static void Setup(const bool changedMission)
 	{
 		return;
 	}
-	MissionCopy(&lastMission, &currentMission);
-	MissionCopy(&currentMission, m);
+	// Record the change for undo, or start a new history if this is a
+	// different mission
+	if (changedMission || m != sUndoMission)
+	{
+		EditorUndoReset(&sUndo, m);
+		sUndoMission = m;
+	}
+	else
+	{
+		EditorUndoCommit(&sUndo, m);
+	}
 	MissionOptionsTerminate(&gMission);
-	CampaignAndMissionSetup(&gCampaign, &gMission);
+	// Rebuilds the whole map; only needed for changes that tile edits
+	// cannot apply to the map directly, e.g. items or map size
 	MakeBackground(changedMission);
 
 	Autosave();
@@ -707,6 +734,7 @@ static void HelpScreen(void)
 		"Ctrl+O:                         Open file\n"
 		"Ctrl+S:                         Save file\n"
 		"Ctrl+X, C, V:                   Cut/copy/paste\n"
+		"Ctrl+Z, Y:                      Undo/redo\n"
 		"Ctrl+M:                         Preview automap\n"
 		"F1:                             This screen\n";
 	ClearScreen(&gGraphicsDevice);
@@ -773,6 +801,35 @@ static void Delete(int xc, int yc)
 	Setup(changedMission);
 }
 
+// Undo or redo the last change; returns whether anything changed
+static bool Undo(Mission *mission, const bool redo)
+{
+	if (mission == NULL)
+	{
+		return false;
+	}
+	Rect2i tiles;
+	const EditorResult r = redo ?
+		EditorUndoRedo(&sUndo, mission, &tiles) :
+		EditorUndoUndo(&sUndo, mission, &tiles);
+	if (r == EDITOR_RESULT_NONE)
+	{
+		return false;
+	}
+	fileChanged = true;
+	if (r & EDITOR_RESULT_RELOAD)
+	{
+		Setup(false);
+	}
+	else
+	{
+		// Only tiles changed; rebuild them in place
+		MapBuildTiles(&gMap, mission, tiles);
+		Autosave();
+	}
+	return true;
+}
+
 static void InputInsert(int *xc, const int yc, Mission *mission);
 static void InputDelete(const int xc, const int yc);
 static HandleInputResult HandleInput(
@@ -949,6 +1006,12 @@ static HandleInputResult HandleInput(
 			{
 				Setup(false);
 			}
+			else if (sHasUnbakedChanges)
+			{
+				// End of a brush stroke; record it as one undo step
+				EditorUndoCommit(&sUndo, mission);
+				sHasUnbakedChanges = false;
+			}
 		}
 	}
 	// Pan the camera based on keyboard cursor keys
@@ -996,34 +1059,17 @@ static HandleInputResult HandleInput(
 		switch (kc)
 		{
 		case 'z':
-			// Undo
-			// Do this by swapping the current mission with the last mission
-			// This requires a bit of copy-acrobatics; because missions
-			// are saved in Setup(), but by this stage the mission has already
-			// changed, _two_ mission caches are used, copied in sequence.
-			// That is, if the current mission is at state B, the first cache
-			// is still at state B (copied after the mission has changed
-			// already), and the second cache is at state A.
-			// If we were to perform an undo and still maintain functionality,
-			// we need to copy such that the states change from B,B,A to
-			// A,A,B.
-
-			// However! The above is true only if we have "baked" changes
-			// The editor has been optimised to perform some changes
-			// without reloading map files; that is, the files are actually
-			// in states C,B,A.
-			// In this case, another set of "acrobatics" is required
-			if (sHasUnbakedChanges)
+			if (Undo(mission, false))
 			{
-				MissionCopy(&lastMission, mission);	// B,A,Z -> B,A,B
+				result.RemakeBg = true;
 			}
-			else
+			break;
+
+		case 'y':
+			if (Undo(mission, true))
 			{
-				MissionCopy(mission, &lastMission);	// B,B,A -> A,B,A
-				MissionCopy(&lastMission, &currentMission);	// A,B,A -> A,B,B
+				result.RemakeBg = true;
 			}
-			fileChanged = true;
-			Setup(false);	// A,B,B -> A,A,B
 			break;
 
 		case 'x':
@@ -1047,7 +1093,7 @@ static HandleInputResult HandleInput(
 			{
 				InsertMission(&gCampaign, scrap, gCampaign.MissionIndex);
 				fileChanged = true;
-				Setup(false);
+				Setup(true);
 			}
 			break;
 
@@ -1375,8 +1421,7 @@ int main(int argc, char *argv[])
 		&gMapObjects, "data/map_objects.json", &gAmmo, &gWeaponClasses);
 	CollisionSystemInit(&gCollisionSystem);
 	CampaignInit(&gCampaign);
-	MissionInit(&lastMission);
-	MissionInit(&currentMission);
+	EditorUndoInit(&sUndo, UNDO_MAX_SIZE);
 
 	// initialise UI collections
 	// Note: must do this after text init since positions depend on text height
@@ -1414,8 +1459,10 @@ int main(int argc, char *argv[])
 	}
 
 	EditCampaign();
+	MapArchiveSaveWait(&sAutosaver);
 
 	MapTerminate(&gMap);
+	MemArenaTerminate(&gMissionArena);
 	MapObjectsTerminate(&gMapObjects);
 	PickupClassesTerminate(&gPickupClasses);
 	ParticleClassesTerminate(&gParticleClasses);
@@ -1424,8 +1471,7 @@ int main(int argc, char *argv[])
 	BulletTerminate(&gBulletClasses);
 	CharacterClassesTerminate(&gCharacterClasses);
 	CampaignTerminate(&gCampaign);
-	MissionTerminate(&lastMission);
-	MissionTerminate(&currentMission);
+	EditorUndoTerminate(&sUndo);
 	CollisionSystemTerminate(&gCollisionSystem);
 
 	DrawBufferTerminate(&sDrawBuffer);
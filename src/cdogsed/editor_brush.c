@@ -517,8 +517,7 @@ EditorResult EditorBrushStopPainting(EditorBrush *b, Mission *m)
 			result = EDITOR_RESULT_CHANGED;
 			break;
 		case BRUSHTYPE_ROOM_PAINTER:
-			// Reload map to update tiles
-			result = EDITOR_RESULT_RELOAD;
+			// Tiles have already been updated while painting
 			break;
 		case BRUSHTYPE_SELECT:
 			if (b->IsMoving)
@@ -544,6 +543,7 @@ EditorResult EditorBrushStopPainting(EditorBrush *b, Mission *m)
 						*tile = MAP_FLOOR;
 					}
 				}
+				const struct vec2i oldStart = b->SelectionStart;
 				// Move the selection to the new position
 				b->SelectionStart.x += b->Pos.x - b->DragPos.x;
 				b->SelectionStart.y += b->Pos.y - b->DragPos.y;
@@ -563,11 +563,16 @@ EditorResult EditorBrushStopPainting(EditorBrush *b, Mission *m)
 							uint16_t *tileTo = CArrayGet(
 								&m->u.Static.Tiles, idx);
 							*tileTo = *tileFrom;
-							result = EDITOR_RESULT_CHANGED_AND_RELOAD;
+							result = EDITOR_RESULT_CHANGED;
 						}
 						i++;
 					}
 				}
+				CArrayTerminate(&movedTiles);
+				MapBuildTiles(
+					&gMap, m, Rect2iNew(oldStart, b->SelectionSize));
+				MapBuildTiles(
+					&gMap, m, Rect2iNew(b->SelectionStart, b->SelectionSize));
 				// Update the selection to fit within map boundaries
 				delta = -b->SelectionStart.x;
 				if (delta > 0)
@@ -0,0 +1,465 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+
+    Copyright (c) 2018 Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "editor_undo.h"
+
+#include <string.h>
+
+#include <cdogs/utils.h>
+
+
+static void ClearSteps(EditorUndo *u, const int start);
+static void StepTerminate(EditorUndoStep *s);
+static void MissionCopyWithoutTiles(Mission *dst, const Mission *src);
+static const CArray *StaticTiles(const Mission *m);
+
+void EditorUndoInit(EditorUndo *u, const size_t maxSize)
+{
+	memset(u, 0, sizeof *u);
+	CArrayInit(&u->Steps, sizeof(EditorUndoStep));
+	u->MaxSize = maxSize;
+	MissionInit(&u->last);
+	CArrayInit(&u->lastTiles, sizeof(uint16_t));
+}
+void EditorUndoTerminate(EditorUndo *u)
+{
+	ClearSteps(u, 0);
+	CArrayTerminate(&u->Steps);
+	MissionTerminate(&u->last);
+	CArrayTerminate(&u->lastTiles);
+}
+// Remove steps from start onwards
+static void ClearSteps(EditorUndo *u, const int start)
+{
+	while ((int)u->Steps.size > start)
+	{
+		EditorUndoStep *s = CArrayGet(&u->Steps, u->Steps.size - 1);
+		u->Size -= s->Size;
+		StepTerminate(s);
+		CArrayDelete(&u->Steps, u->Steps.size - 1);
+	}
+	u->Index = MIN(u->Index, start);
+}
+static void StepTerminate(EditorUndoStep *s)
+{
+	CArrayTerminate(&s->TilesBefore);
+	CArrayTerminate(&s->TilesAfter);
+	if (s->HasMission)
+	{
+		MissionTerminate(&s->Before);
+		MissionTerminate(&s->After);
+	}
+}
+
+void EditorUndoReset(EditorUndo *u, const Mission *m)
+{
+	ClearSteps(u, 0);
+	MissionCopyWithoutTiles(&u->last, m);
+	const CArray *tiles = StaticTiles(m);
+	if (tiles != NULL)
+	{
+		CArrayCopy(&u->lastTiles, tiles);
+	}
+	else
+	{
+		CArrayClear(&u->lastTiles);
+	}
+}
+
+static void MissionCopyWithoutTiles(Mission *dst, const Mission *src)
+{
+	// Copy from a shallow copy that has no tiles
+	Mission m = *src;
+	if (m.Type == MAPTYPE_STATIC)
+	{
+		CArrayInit(&m.u.Static.Tiles, sizeof(uint16_t));
+	}
+	MissionCopy(dst, &m);
+}
+static const CArray *StaticTiles(const Mission *m)
+{
+	return m->Type == MAPTYPE_STATIC ? &m->u.Static.Tiles : NULL;
+}
+
+static bool IsResized(const Mission *a, const Mission *b);
+static Rect2i FindChangedTiles(
+	const CArray *before, const CArray *after, const int width);
+static void TilesGetRect(
+	CArray *dst, const CArray *tiles, const int width, const Rect2i r);
+static void TilesSetRect(
+	CArray *tiles, const int width, const Rect2i r, const CArray *src);
+static bool MissionEqual(const Mission *a, const Mission *b);
+static size_t MissionSize(const Mission *m);
+bool EditorUndoCommit(EditorUndo *u, const Mission *m)
+{
+	EditorUndoStep s;
+	memset(&s, 0, sizeof s);
+	CArrayInit(&s.TilesBefore, sizeof(uint16_t));
+	CArrayInit(&s.TilesAfter, sizeof(uint16_t));
+	const bool resized = IsResized(&u->last, m);
+	const CArray *tiles = StaticTiles(m);
+	if (resized)
+	{
+		CArrayCopy(&s.TilesBefore, &u->lastTiles);
+		if (tiles != NULL)
+		{
+			CArrayCopy(&s.TilesAfter, tiles);
+		}
+	}
+	else if (tiles != NULL)
+	{
+		CASSERT(tiles->size == u->lastTiles.size, "undo tiles out of sync");
+		s.TileRect = FindChangedTiles(&u->lastTiles, tiles, m->Size.x);
+		TilesGetRect(&s.TilesBefore, &u->lastTiles, m->Size.x, s.TileRect);
+		TilesGetRect(&s.TilesAfter, tiles, m->Size.x, s.TileRect);
+	}
+	s.HasMission = resized || !MissionEqual(&u->last, m);
+	if (!s.HasMission && s.TilesAfter.size == 0)
+	{
+		StepTerminate(&s);
+		return false;
+	}
+
+	// Bring the shadow copy up to date
+	if (s.HasMission)
+	{
+		s.Before = u->last;
+		MissionInit(&u->last);
+		MissionCopyWithoutTiles(&u->last, m);
+		MissionInit(&s.After);
+		MissionCopy(&s.After, &u->last);
+	}
+	if (resized)
+	{
+		CArrayCopy(&u->lastTiles, &s.TilesAfter);
+	}
+	else
+	{
+		TilesSetRect(&u->lastTiles, m->Size.x, s.TileRect, &s.TilesAfter);
+	}
+
+	s.Size = sizeof s +
+		(s.TilesBefore.size + s.TilesAfter.size) * sizeof(uint16_t);
+	if (s.HasMission)
+	{
+		s.Size += MissionSize(&s.Before) + MissionSize(&s.After);
+	}
+
+	// A new step discards anything that could be redone
+	ClearSteps(u, u->Index);
+	CArrayPushBack(&u->Steps, &s);
+	u->Size += s.Size;
+	u->Index = (int)u->Steps.size;
+
+	// Drop the oldest steps to stay within budget, but always keep the
+	// latest one so it can be undone
+	while (u->Size > u->MaxSize && u->Steps.size > 1)
+	{
+		EditorUndoStep *oldest = CArrayGet(&u->Steps, 0);
+		u->Size -= oldest->Size;
+		StepTerminate(oldest);
+		CArrayDelete(&u->Steps, 0);
+		u->Index--;
+	}
+	return true;
+}
+static bool IsResized(const Mission *a, const Mission *b)
+{
+	return a->Type != b->Type || !svec2i_is_equal(a->Size, b->Size);
+}
+static Rect2i FindChangedTiles(
+	const CArray *before, const CArray *after, const int width)
+{
+	const int height = width > 0 ? (int)after->size / width : 0;
+	struct vec2i min = svec2i(width, height);
+	struct vec2i max = svec2i(-1, -1);
+	const uint16_t *b = before->data;
+	const uint16_t *a = after->data;
+	for (int y = 0; y < height; y++)
+	{
+		const int row = y * width;
+		if (memcmp(b + row, a + row, width * sizeof *a) == 0)
+		{
+			continue;
+		}
+		min.y = MIN(min.y, y);
+		max.y = y;
+		for (int x = 0; x < width; x++)
+		{
+			if (b[row + x] != a[row + x])
+			{
+				min.x = MIN(min.x, x);
+				max.x = MAX(max.x, x);
+			}
+		}
+	}
+	if (max.y < 0)
+	{
+		return Rect2iZero();
+	}
+	return Rect2iNew(min, svec2i_add(svec2i_subtract(max, min), svec2i_one()));
+}
+static void TilesGetRect(
+	CArray *dst, const CArray *tiles, const int width, const Rect2i r)
+{
+	CArrayClear(dst);
+	CArrayReserve(dst, r.Size.x * r.Size.y);
+	for (int y = r.Pos.y; y < r.Pos.y + r.Size.y; y++)
+	{
+		for (int x = r.Pos.x; x < r.Pos.x + r.Size.x; x++)
+		{
+			CArrayPushBack(dst, CArrayGet(tiles, y * width + x));
+		}
+	}
+}
+static void TilesSetRect(
+	CArray *tiles, const int width, const Rect2i r, const CArray *src)
+{
+	for (int y = 0; y < r.Size.y; y++)
+	{
+		memcpy(
+			CArrayGet(tiles, (r.Pos.y + y) * width + r.Pos.x),
+			CArrayGet(src, y * r.Size.x),
+			r.Size.x * sizeof(uint16_t));
+	}
+}
+
+static bool StrEqual(const char *a, const char *b);
+static bool ArrayEqual(const CArray *a, const CArray *b);
+static bool ObjectivesEqual(const CArray *a, const CArray *b);
+static bool DensitiesEqual(const CArray *a, const CArray *b);
+static bool StaticEqual(const MissionStatic *a, const MissionStatic *b);
+static bool MissionEqual(const Mission *a, const Mission *b)
+{
+	if (!StrEqual(a->Title, b->Title) ||
+		!StrEqual(a->Description, b->Description) ||
+		IsResized(a, b) ||
+		strcmp(a->WallStyle, b->WallStyle) != 0 ||
+		strcmp(a->FloorStyle, b->FloorStyle) != 0 ||
+		strcmp(a->RoomStyle, b->RoomStyle) != 0 ||
+		strcmp(a->ExitStyle, b->ExitStyle) != 0 ||
+		strcmp(a->KeyStyle, b->KeyStyle) != 0 ||
+		strcmp(a->DoorStyle, b->DoorStyle) != 0 ||
+		!ObjectivesEqual(&a->Objectives, &b->Objectives) ||
+		!ArrayEqual(&a->Enemies, &b->Enemies) ||
+		!ArrayEqual(&a->SpecialChars, &b->SpecialChars) ||
+		!DensitiesEqual(&a->MapObjectDensities, &b->MapObjectDensities) ||
+		a->EnemyDensity != b->EnemyDensity ||
+		!ArrayEqual(&a->Weapons, &b->Weapons) ||
+		strcmp(a->Song, b->Song) != 0 ||
+		!ColorEquals(a->WallMask, b->WallMask) ||
+		!ColorEquals(a->FloorMask, b->FloorMask) ||
+		!ColorEquals(a->RoomMask, b->RoomMask) ||
+		!ColorEquals(a->AltMask, b->AltMask))
+	{
+		return false;
+	}
+	if (a->Type == MAPTYPE_STATIC)
+	{
+		return StaticEqual(&a->u.Static, &b->u.Static);
+	}
+	return memcmp(&a->u, &b->u, sizeof a->u) == 0;
+}
+static bool StrEqual(const char *a, const char *b)
+{
+	if (a == NULL || b == NULL) return a == b;
+	return strcmp(a, b) == 0;
+}
+static bool ArrayEqual(const CArray *a, const CArray *b)
+{
+	return a->size == b->size &&
+		(a->size == 0 || memcmp(a->data, b->data, a->size * a->elemSize) == 0);
+}
+static bool ObjectivesEqual(const CArray *a, const CArray *b)
+{
+	if (a->size != b->size) return false;
+	// Ignore play state (placed/done)
+	CA_FOREACH(const Objective, oa, *a)
+		const Objective *ob = CArrayGet(b, _ca_index);
+		if (!StrEqual(oa->Description, ob->Description) ||
+			oa->Type != ob->Type ||
+			memcmp(&oa->u, &ob->u, sizeof oa->u) != 0 ||
+			oa->Count != ob->Count || oa->Required != ob->Required ||
+			oa->Flags != ob->Flags || !ColorEquals(oa->color, ob->color))
+		{
+			return false;
+		}
+	CA_FOREACH_END()
+	return true;
+}
+static bool DensitiesEqual(const CArray *a, const CArray *b)
+{
+	if (a->size != b->size) return false;
+	CA_FOREACH(const MapObjectDensity, da, *a)
+		const MapObjectDensity *db = CArrayGet(b, _ca_index);
+		if (da->M != db->M || da->Density != db->Density) return false;
+	CA_FOREACH_END()
+	return true;
+}
+static bool StaticEqual(const MissionStatic *a, const MissionStatic *b)
+{
+	if (!svec2i_is_equal(a->Start, b->Start) ||
+		!svec2i_is_equal(a->Exit.Start, b->Exit.Start) ||
+		!svec2i_is_equal(a->Exit.End, b->Exit.End) ||
+		a->Items.size != b->Items.size ||
+		a->Characters.size != b->Characters.size ||
+		a->Objectives.size != b->Objectives.size ||
+		a->Keys.size != b->Keys.size)
+	{
+		return false;
+	}
+	CA_FOREACH(const MapObjectPositions, pa, a->Items)
+		const MapObjectPositions *pb = CArrayGet(&b->Items, _ca_index);
+		if (pa->M != pb->M || !ArrayEqual(&pa->Positions, &pb->Positions))
+		{
+			return false;
+		}
+	CA_FOREACH_END()
+	CA_FOREACH(const CharacterPositions, pa, a->Characters)
+		const CharacterPositions *pb = CArrayGet(&b->Characters, _ca_index);
+		if (pa->Index != pb->Index ||
+			!ArrayEqual(&pa->Positions, &pb->Positions))
+		{
+			return false;
+		}
+	CA_FOREACH_END()
+	CA_FOREACH(const ObjectivePositions, pa, a->Objectives)
+		const ObjectivePositions *pb = CArrayGet(&b->Objectives, _ca_index);
+		if (pa->Index != pb->Index ||
+			!ArrayEqual(&pa->Positions, &pb->Positions) ||
+			!ArrayEqual(&pa->Indices, &pb->Indices))
+		{
+			return false;
+		}
+	CA_FOREACH_END()
+	CA_FOREACH(const KeyPositions, pa, a->Keys)
+		const KeyPositions *pb = CArrayGet(&b->Keys, _ca_index);
+		if (pa->Index != pb->Index ||
+			!ArrayEqual(&pa->Positions, &pb->Positions))
+		{
+			return false;
+		}
+	CA_FOREACH_END()
+	return true;
+}
+
+// Rough estimate of the memory used by a mission's arrays
+static size_t MissionSize(const Mission *m)
+{
+	size_t size = m->Objectives.size * sizeof(Objective) +
+		m->Enemies.size * sizeof(int) +
+		m->SpecialChars.size * sizeof(int) +
+		m->MapObjectDensities.size * sizeof(MapObjectDensity) +
+		m->Weapons.size * sizeof(const WeaponClass *);
+	if (m->Type == MAPTYPE_STATIC)
+	{
+		const MissionStatic *s = &m->u.Static;
+		CA_FOREACH(const MapObjectPositions, p, s->Items)
+			size += sizeof *p + p->Positions.size * sizeof(struct vec2i);
+		CA_FOREACH_END()
+		CA_FOREACH(const CharacterPositions, p, s->Characters)
+			size += sizeof *p + p->Positions.size * sizeof(struct vec2i);
+		CA_FOREACH_END()
+		CA_FOREACH(const ObjectivePositions, p, s->Objectives)
+			size += sizeof *p + p->Positions.size * sizeof(struct vec2i) +
+				p->Indices.size * sizeof(int);
+		CA_FOREACH_END()
+		CA_FOREACH(const KeyPositions, p, s->Keys)
+			size += sizeof *p + p->Positions.size * sizeof(struct vec2i);
+		CA_FOREACH_END()
+	}
+	return size;
+}
+
+static void ApplyStep(
+	EditorUndo *u, Mission *m, const EditorUndoStep *s, const bool undo);
+EditorResult EditorUndoUndo(EditorUndo *u, Mission *m, Rect2i *tiles)
+{
+	if (u->Index == 0)
+	{
+		return EDITOR_RESULT_NONE;
+	}
+	u->Index--;
+	const EditorUndoStep *s = CArrayGet(&u->Steps, u->Index);
+	ApplyStep(u, m, s, true);
+	*tiles = s->TileRect;
+	return s->HasMission ?
+		EDITOR_RESULT_CHANGED_AND_RELOAD : EDITOR_RESULT_CHANGED;
+}
+EditorResult EditorUndoRedo(EditorUndo *u, Mission *m, Rect2i *tiles)
+{
+	if (u->Index == (int)u->Steps.size)
+	{
+		return EDITOR_RESULT_NONE;
+	}
+	const EditorUndoStep *s = CArrayGet(&u->Steps, u->Index);
+	u->Index++;
+	ApplyStep(u, m, s, false);
+	*tiles = s->TileRect;
+	return s->HasMission ?
+		EDITOR_RESULT_CHANGED_AND_RELOAD : EDITOR_RESULT_CHANGED;
+}
+static void ApplyStep(
+	EditorUndo *u, Mission *m, const EditorUndoStep *s, const bool undo)
+{
+	const CArray *tiles = undo ? &s->TilesBefore : &s->TilesAfter;
+	const bool resized = s->HasMission && IsResized(&s->Before, &s->After);
+	if (s->HasMission)
+	{
+		const Mission *src = undo ? &s->Before : &s->After;
+		// Keep the live tiles across the copy unless they are replaced
+		const bool keepTiles = !resized && m->Type == MAPTYPE_STATIC;
+		CArray liveTiles;
+		memset(&liveTiles, 0, sizeof liveTiles);
+		if (keepTiles)
+		{
+			liveTiles = m->u.Static.Tiles;
+			CArrayInit(&m->u.Static.Tiles, sizeof(uint16_t));
+		}
+		MissionCopy(m, src);
+		if (keepTiles)
+		{
+			CArrayTerminate(&m->u.Static.Tiles);
+			m->u.Static.Tiles = liveTiles;
+		}
+		else if (m->Type == MAPTYPE_STATIC)
+		{
+			CArrayCopy(&m->u.Static.Tiles, tiles);
+		}
+		MissionCopy(&u->last, src);
+	}
+	if (resized)
+	{
+		CArrayCopy(&u->lastTiles, tiles);
+	}
+	else if (m->Type == MAPTYPE_STATIC)
+	{
+		TilesSetRect(&m->u.Static.Tiles, m->Size.x, s->TileRect, tiles);
+		TilesSetRect(&u->lastTiles, m->Size.x, s->TileRect, tiles);
+	}
+}
@@ -0,0 +1,78 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+
+    Copyright (c) 2018 Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <cdogs/c_array.h>
+#include <cdogs/mission.h>
+#include <cdogs/vector.h>
+
+#include "editor_brush.h"
+
+// Bounded history of mission edits, stored as deltas
+// Tile edits store only the changed rectangle of tiles; other edits store
+// the mission without its tiles.
+// Changes are found by comparing the mission against a shadow copy, so
+// callers only need to commit after each edit.
+typedef struct
+{
+	// Changed tiles, the rectangle before and after the change
+	// If the map was resized these are the whole maps
+	Rect2i TileRect;
+	CArray TilesBefore;	// of uint16_t
+	CArray TilesAfter;	// of uint16_t
+	// Non-tile changes; the mission before and after, without tiles
+	bool HasMission;
+	Mission Before;
+	Mission After;
+	size_t Size;
+} EditorUndoStep;
+typedef struct
+{
+	CArray Steps;	// of EditorUndoStep
+	// Steps before this index can be undone, the rest redone
+	int Index;
+	size_t Size;
+	size_t MaxSize;
+	// The mission as of the latest step, without tiles
+	Mission last;
+	CArray lastTiles;	// of uint16_t
+} EditorUndo;
+
+void EditorUndoInit(EditorUndo *u, const size_t maxSize);
+void EditorUndoTerminate(EditorUndo *u);
+// Clear the history and start tracking a mission
+void EditorUndoReset(EditorUndo *u, const Mission *m);
+// Record any changes since the last step as a new step
+// Returns whether there were changes
+bool EditorUndoCommit(EditorUndo *u, const Mission *m);
+// Returns EDITOR_RESULT_CHANGED if only the tiles in *tiles changed,
+// EDITOR_RESULT_CHANGED_AND_RELOAD if the mission needs reloading,
+// or EDITOR_RESULT_NONE if there is nothing to undo/redo
+EditorResult EditorUndoUndo(EditorUndo *u, Mission *m, Rect2i *tiles);
+EditorResult EditorUndoRedo(EditorUndo *u, Mission *m, Rect2i *tiles);
@@ -31,6 +31,9 @@
 
 #include <cdogs/config.h>
 #include <cdogs/log.h>
+#include <cdogs/net_stats.h>
+#include <cdogs/profiler.h>
+#include <cdogs/replay.h>
 #include <cdogs/sys_config.h>
 #include <cdogs/utils.h>
 
@@ -89,6 +92,16 @@ void PrintHelp(void)
 	printf("%s\n",
 		"Other:\n"
 		"    --connect=host   (Experimental) connect to a game server\n"
+		"    --dedicated      Host the campaign given as a headless server\n"
+		"    --netstats       Show network statistics overlay\n"
+		"    --netstats=F     Also write per-mission stats to file F\n"
+		"                     (CSV if F ends in .csv, otherwise JSON lines)\n"
+		"    --profile        Show frame timings overlay\n"
+		"    --profile=F      Also write Chrome trace_event JSON to file F\n"
+		"    --record=F       Record a replay of each mission played to file F\n"
+		"    --replay=F       Play back the replay in file F\n"
+		"    --replay-fast=F  Play back as fast as possible, as a benchmark\n"
+		"                     Use with --dedicated to play back without video\n"
 		);
 }
 
@@ -113,7 +126,7 @@ void ProcessCommandLine(char *buf, const int argc, char *argv[])
 static void PrintConfig(const Config *c, const int indent);
 bool ParseArgs(
 	const int argc, char *argv[],
-	ENetAddress *connectAddr, const char **loadCampaign)
+	ENetAddress *connectAddr, const char **loadCampaign, bool *dedicated)
 {
 	struct option longopts[] =
 	{
@@ -124,6 +137,12 @@ bool ParseArgs(
 		{ "config",		optional_argument,	NULL,	'C' },
 		{ "log",		required_argument,	NULL,	1000 },
 		{ "logfile",	required_argument,	NULL,	1001 },
+		{ "profile",	optional_argument,	NULL,	1002 },
+		{ "dedicated",	no_argument,		NULL,	1003 },
+		{ "record",		required_argument,	NULL,	1004 },
+		{ "replay",		required_argument,	NULL,	1005 },
+		{ "replay-fast",	required_argument,	NULL,	1006 },
+		{ "netstats",	optional_argument,	NULL,	1007 },
 		{ "help",		no_argument,		NULL,	'h' },
 		{ 0,			0,					NULL,	0 }
 	};
@@ -185,6 +204,24 @@ bool ParseArgs(
 		case 1001:
 			LogOpenFile(optarg);
 			break;
+		case 1002:
+			ProfilerInit(&gProfiler, optarg);
+			break;
+		case 1003:
+			*dedicated = true;
+			break;
+		case 1004:
+			ReplayRecordInit(&gReplay, optarg);
+			break;
+		case 1005:
+			ReplayPlaybackInit(&gReplay, optarg, false);
+			break;
+		case 1006:
+			ReplayPlaybackInit(&gReplay, optarg, true);
+			break;
+		case 1007:
+			NetStatsInit(&gNetStats, optarg);
+			break;
 		case 'x':
 			if (enet_address_set_host(connectAddr, optarg) != 0)
 			{
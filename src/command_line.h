@@ -41,4 +41,4 @@ void ProcessCommandLine(char *buf, const int argc, char *argv[]);
 // Parse command-line arguments and set config. Returns whether to run the game
 bool ParseArgs(
 	const int argc, char *argv[],
-	ENetAddress *connectAddr, const char **loadCampaign);
+	ENetAddress *connectAddr, const char **loadCampaign, bool *dedicated);
@@ -0,0 +1,101 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+
+    Copyright (c) 2018 Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "dedicated.h"
+
+#include <cdogs/campaigns.h>
+#include <cdogs/config.h>
+#include <cdogs/events.h>
+#include <cdogs/game_events.h>
+#include <cdogs/gamedata.h>
+#include <cdogs/log.h>
+#include <cdogs/map.h>
+#include <cdogs/net_server.h>
+
+#include "game.h"
+
+
+static void DedicatedServerTerminate(GameLoopData *data);
+static void DedicatedServerOnEnter(GameLoopData *data);
+static GameLoopResult DedicatedServerUpdate(
+	GameLoopData *data, LoopRunner *l);
+GameLoopData *ScreenDedicatedServer(void)
+{
+	// There are no menus to go through; set everything the prep screens
+	// would have set up
+	GameEventsInit(&gGameEvents);
+	ConfigGet(&gConfig, "StartServer")->u.Bool.Value = true;
+	gCampaign.OptionsSet = true;
+	NetServerOpen(&gNetServer);
+	GameLoopData *g = GameLoopDataNew(
+		NULL, DedicatedServerTerminate, DedicatedServerOnEnter, NULL,
+		NULL, DedicatedServerUpdate, NULL);
+	g->FPS = ConfigGetInt(&gConfig, "Game.FPS");
+	return g;
+}
+static void DedicatedServerTerminate(GameLoopData *data)
+{
+	UNUSED(data);
+	NetServerClose(&gNetServer);
+	GameEventsTerminate(&gGameEvents);
+}
+static void DedicatedServerOnEnter(GameLoopData *data)
+{
+	UNUSED(data);
+	if (gMission.IsQuit || gEventHandlers.HasQuit)
+	{
+		return;
+	}
+
+	// Loop the campaign
+	if (gCampaign.IsComplete ||
+		gCampaign.MissionIndex >= (int)gCampaign.Setting.Missions.size)
+	{
+		LOG(LM_MAIN, LL_INFO, "campaign complete; restarting");
+		gCampaign.MissionIndex = 0;
+		gCampaign.IsComplete = false;
+	}
+	MissionOptionsTerminate(&gMission);
+	CampaignAndMissionSetup(&gCampaign, &gMission);
+	LOG(LM_MAIN, LL_INFO, "mission %d/%d: %s",
+		gCampaign.MissionIndex + 1, (int)gCampaign.Setting.Missions.size,
+		gMission.missionData->Title);
+}
+static GameLoopResult DedicatedServerUpdate(
+	GameLoopData *data, LoopRunner *l)
+{
+	UNUSED(data);
+	if (!gCampaign.IsLoaded || gMission.IsQuit || gEventHandlers.HasQuit)
+	{
+		LOG(LM_MAIN, LL_INFO, "dedicated server shutting down");
+		LoopRunnerPop(l);
+		return UPDATE_RESULT_OK;
+	}
+	LoopRunnerPush(l, RunGame(&gCampaign, &gMission, &gMap));
+	return UPDATE_RESULT_OK;
+}
@@ -66,8 +66,11 @@
 #include <cdogs/music.h>
 #include <cdogs/net_client.h>
 #include <cdogs/net_server.h>
+#include <cdogs/net_stats.h>
 #include <cdogs/objs.h>
 #include <cdogs/pickup.h>
+#include <cdogs/profiler.h>
+#include <cdogs/replay.h>
 
 #include "briefing_screens.h"
 #include "hiscores.h"
@@ -182,15 +185,20 @@ GameLoopData *RunGame(
 	g->FPS = ConfigGetInt(&gConfig, "Game.FPS");
 	g->SuperhotMode = ConfigGetBool(&gConfig, "Game.Superhot(tm)Mode");
 	g->InputEverySecondFrame = true;
+	g->Interpolate = true;
+	g->Unthrottled = gReplay.Mode == REPLAY_PLAYBACK && gReplay.Fast;
 	return g;
 }
 static void RunGameReset(RunGameData *rData)
 {
-	// Clear the background
-	DrawRectangle(
-		&gGraphicsDevice, svec2i_zero(), gGraphicsDevice.cachedConfig.Res,
-		colorBlack, 0);
-	BlitUpdateFromBuf(&gGraphicsDevice, gGraphicsDevice.bkg);
+	if (!gGraphicsDevice.IsHeadless)
+	{
+		// Clear the background
+		DrawRectangle(
+			&gGraphicsDevice, svec2i_zero(), gGraphicsDevice.cachedConfig.Res,
+			colorBlack, 0);
+		BlitUpdateFromBuf(&gGraphicsDevice, gGraphicsDevice.bkg);
+	}
 	CameraReset(&rData->Camera);
 }
 static void RunGameTerminate(GameLoopData *data)
@@ -205,11 +213,14 @@ static void RunGameOnEnter(GameLoopData *data)
 
 	RunGameReset(rData);
 
+	// Replays reseed so that the mission plays out the same from here on
+	const bool isReplay = ReplayMissionStart(&gReplay, rData->co);
+
 	MapBuild(rData->map, rData->m->missionData, rData->co);
 
 	// Seed random if PVP mode (otherwise players will always spawn in same
 	// position)
-	if (IsPVP(rData->co->Entry.Mode))
+	if (IsPVP(rData->co->Entry.Mode) && !isReplay)
 	{
 		srand((unsigned int)time(NULL));
 	}
@@ -252,7 +263,7 @@ static void RunGameOnEnter(GameLoopData *data)
 	// If there are no players, show the full map before starting
 	if (GetNumPlayers(PLAYER_ANY, false, true) == 0)
 	{
-		LOSSetAllVisible(&rData->map->LOS);
+		LOSSetAllVisible(rData->map);
 		rData->Camera.lastPosition =
 			Vec2CenterOfTile(svec2i_scale_divide(rData->map->Size, 2));
 		rData->Camera.FollowNextPlayer = true;
@@ -286,6 +297,14 @@ static void RunGameOnExit(GameLoopData *data)
 
 	LOG(LM_MAIN, LL_INFO, "Game finished");
 
+	ReplayMissionEnd(&gReplay);
+	if (gNetStats.Enabled)
+	{
+		NetStatsMissionEnd(&gNetStats);
+	}
+
+	gThingInterpolation.Alpha = 1.0f;
+
 	// Flush events
 	HandleGameEvents(&gGameEvents, NULL, NULL, NULL);
 
@@ -296,14 +315,17 @@ static void RunGameOnExit(GameLoopData *data)
 	CArrayTerminate(&rData->ammoSpawners);
 	CameraTerminate(&rData->Camera);
 
-	// Draw background
-	GrafxRedrawBackground(&gGraphicsDevice, rData->Camera.lastPosition);
-	// Clear other texures
-	BlitClearBuf(&gGraphicsDevice);
-	BlitUpdateFromBuf(&gGraphicsDevice, gGraphicsDevice.hud);
-	if (gGraphicsDevice.cachedConfig.SecondWindow)
+	if (!gGraphicsDevice.IsHeadless)
 	{
-		BlitUpdateFromBuf(&gGraphicsDevice, gGraphicsDevice.hud2);
+		// Draw background
+		GrafxRedrawBackground(&gGraphicsDevice, rData->Camera.lastPosition);
+		// Clear other texures
+		BlitClearBuf(&gGraphicsDevice);
+		BlitUpdateFromBuf(&gGraphicsDevice, gGraphicsDevice.hud);
+		if (gGraphicsDevice.cachedConfig.SecondWindow)
+		{
+			BlitUpdateFromBuf(&gGraphicsDevice, gGraphicsDevice.hud2);
+		}
 	}
 
 	// Unready all the players
@@ -336,6 +358,18 @@ static void RunGameInput(GameLoopData *data)
 		return;
 	}
 
+	if (gReplay.Mode == REPLAY_PLAYBACK)
+	{
+		// Commands come from the replay; only allow quitting
+		if (KeyIsPressed(&gEventHandlers.keyboard, SDL_SCANCODE_ESCAPE))
+		{
+			GameEvent e = GameEventNew(GAME_EVENT_MISSION_END);
+			e.u.MissionEnd.IsQuit = true;
+			GameEventsEnqueue(&gGameEvents, e);
+		}
+		return;
+	}
+
 	int lastCmdAll = 0;
 	for (int i = 0; i < MAX_LOCAL_PLAYERS; i++)
 	{
@@ -468,6 +502,10 @@ static GameLoopResult RunGameUpdate(GameLoopData *data, LoopRunner *l)
 {
 	RunGameData *rData = data->Data;
 
+	// New simulation tick; things moved from here on are drawn interpolated
+	// until the next tick
+	gThingInterpolation.Ticks++;
+
 	// Detect exit
 	if (rData->m->isDone)
 	{
@@ -517,9 +555,19 @@ static GameLoopResult RunGameUpdate(GameLoopData *data, LoopRunner *l)
 	// Update all the things in the game
 	const int ticksPerFrame = 1;
 
+	if (!ReplayTickBegin(&gReplay))
+	{
+		// Out of recorded commands
+		GameEvent e = GameEventNew(GAME_EVENT_MISSION_END);
+		e.u.MissionEnd.IsQuit = true;
+		GameEventsEnqueue(&gGameEvents, e);
+	}
+
 	if (gPlayerDatas.size > 0)
 	{
-		LOSReset(&gMap.LOS);
+		PROFILE_BEGIN(PROFILE_LOS);
+		LOSReset(&gMap);
+		PROFILE_END(PROFILE_LOS);
 		for (int i = 0, idx = 0; i < (int)gPlayerDatas.size; i++, idx++)
 		{
 			const PlayerData *p = CArrayGet(&gPlayerDatas, i);
@@ -527,8 +575,10 @@ static GameLoopResult RunGameUpdate(GameLoopData *data, LoopRunner *l)
 			TActor *player = ActorGetByUID(p->ActorUID);
 			if (player->dead > DEATH_MAX) continue;
 			// Calculate LOS for all players alive or dying
+			PROFILE_BEGIN(PROFILE_LOS);
 			LOSCalcFrom(
 				&gMap, Vec2ToTile(player->thing.Pos), !gCampaign.IsClient);
+			PROFILE_END(PROFILE_LOS);
 
 			if (player->dead) continue;
 
@@ -542,6 +592,7 @@ static GameLoopResult RunGameUpdate(GameLoopData *data, LoopRunner *l)
 			{
 				rData->cmds[idx] = AICoopGetCmd(player, ticksPerFrame);
 			}
+			rData->cmds[idx] = ReplayCmd(&gReplay, idx, rData->cmds[idx]);
 			PlayerSpecialCommands(player, rData->cmds[idx]);
 			CommandActor(player, rData->cmds[idx], ticksPerFrame);
 		}
@@ -549,6 +600,7 @@ static GameLoopResult RunGameUpdate(GameLoopData *data, LoopRunner *l)
 
 	if (!gCampaign.IsClient)
 	{
+		PROFILE_BEGIN(PROFILE_AI);
 		rData->aiUpdateCounter -= ticksPerFrame;
 		if (rData->aiUpdateCounter <= 0)
 		{
@@ -560,6 +612,7 @@ static GameLoopResult RunGameUpdate(GameLoopData *data, LoopRunner *l)
 		{
 			AICommandLast(ticksPerFrame);
 		}
+		PROFILE_END(PROFILE_AI);
 	}
 
 	// If split screen never and players are too close to the
@@ -614,11 +667,17 @@ static GameLoopResult RunGameUpdate(GameLoopData *data, LoopRunner *l)
 		CA_FOREACH_END()
 	}
 
+	PROFILE_BEGIN(PROFILE_ACTORS);
 	UpdateAllActors(ticksPerFrame);
+	PROFILE_END(PROFILE_ACTORS);
 	UpdateObjects(ticksPerFrame);
+	PROFILE_BEGIN(PROFILE_MOBILE_OBJECTS);
 	UpdateMobileObjects(ticksPerFrame);
+	PROFILE_END(PROFILE_MOBILE_OBJECTS);
 	PickupsUpdate(&gPickups, ticksPerFrame);
+	PROFILE_BEGIN(PROFILE_PARTICLES);
 	ParticlesUpdate(&gParticles, ticksPerFrame);
+	PROFILE_END(PROFILE_PARTICLES);
 
 	UpdateWatches(&rData->map->triggers, ticksPerFrame);
 
@@ -638,12 +697,21 @@ static GameLoopResult RunGameUpdate(GameLoopData *data, LoopRunner *l)
 		MissionDone(&gMission, me);
 	}
 
+	PROFILE_BEGIN(PROFILE_GAME_EVENTS);
 	HandleGameEvents(
 		&gGameEvents, &rData->Camera,
 		&rData->healthSpawner, &rData->ammoSpawners);
+	PROFILE_END(PROFILE_GAME_EVENTS);
+
+	if (!gCampaign.IsClient)
+	{
+		NetServerUpdateInterest(&gNetServer);
+	}
 
 	rData->m->time += ticksPerFrame;
 
+	ReplayTickEnd(&gReplay);
+
 	if (gEventHandlers.HasResolutionChanged)
 	{
 		RunGameReset(rData);
@@ -654,6 +722,13 @@ static GameLoopResult RunGameUpdate(GameLoopData *data, LoopRunner *l)
 }
 static void NextLoop(RunGameData *rData, LoopRunner *l)
 {
+	// Replays play a single mission, with no menus after
+	if (gReplay.Mode == REPLAY_PLAYBACK)
+	{
+		LoopRunnerPop(l);
+		return;
+	}
+
 	// Find the next screen to switch to
 	const bool hasLocalPlayers = GetNumPlayers(PLAYER_ANY, false, true) > 0;
 	const int survivingPlayers =
@@ -745,17 +820,31 @@ static void RunGameDraw(GameLoopData *data)
 {
 	RunGameData *rData = data->Data;
 
+	gThingInterpolation.Alpha = data->DrawAlpha;
+
 	// Draw game layer
 	BlitClearBuf(&gGraphicsDevice);
+	PROFILE_BEGIN(PROFILE_CAMERA_DRAW);
 	CameraDraw(&rData->Camera, rData->Camera.HUD.DrawData);
+	PROFILE_END(PROFILE_CAMERA_DRAW);
 	BlitUpdateFromBuf(&gGraphicsDevice, gGraphicsDevice.screen);
 
 	// Draw HUD layer
 	BlitClearBuf(&gGraphicsDevice);
 	CameraDrawMode(&rData->Camera);
+	PROFILE_BEGIN(PROFILE_HUD_DRAW);
 	HUDDraw(
 		&rData->Camera.HUD, rData->pausingDevice, rData->controllerUnplugged,
 		rData->Camera.NumViews);
+	PROFILE_END(PROFILE_HUD_DRAW);
+	if (gProfiler.Enabled)
+	{
+		ProfilerDraw(&gProfiler);
+	}
+	if (gNetStats.Enabled)
+	{
+		NetStatsDraw(&gNetStats);
+	}
 	const bool isMouse = GameIsMouseUsed();
 	SDL_SetRelativeMouseMode(isMouse);
 	if (isMouse)
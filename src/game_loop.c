@@ -32,8 +32,12 @@
 
 #include "config.h"
 #include "events.h"
+#include "grafx.h"
+#include "log.h"
 #include "net_client.h"
 #include "net_server.h"
+#include "net_stats.h"
+#include "profiler.h"
 #include "sounds.h"
 
 #ifdef __EMSCRIPTEN__
@@ -172,10 +176,21 @@ typedef struct
 {
 	GameLoopResult Result;
 	Uint32 TicksNow;
+	// Time accumulated that has not been simulated yet
 	Uint32 TicksElapsed;
 	int FrameDurationMs;
-	int FramesSkipped;
-	int MaxFrameskip;
+	// Most ticks to simulate before drawing; if we fall further behind than
+	// this, the excess time is dropped and the game slows down instead
+	int MaxCatchUp;
+	// Draws between ticks are limited to the display refresh rate
+	int DrawDurationMs;
+	Uint32 LastDrawTicks;
+	// Tick timing stats, logged periodically
+	Uint32 StatsStart;
+	int StatsTicks;
+	int StatsTicksDropped;
+	Uint64 StatsTickTotal;
+	Uint64 StatsTickMax;
 } LoopRunParams;
 typedef struct
 {
@@ -184,19 +199,93 @@ typedef struct
     LoopRunParams p;
 }LoopRunInnerData;
 static LoopRunParams LoopRunParamsNew(const GameLoopData *data);
-static bool LoopRunParamsShouldSleep(LoopRunParams *p);
-static bool LoopRunParamsShouldSkip(LoopRunParams *p);
+static void LoopRunParamsUpdateTicks(LoopRunParams *p);
+static int LoopRunParamsTicksDue(LoopRunParams *p);
+static int LoopRunParamsTicksUnthrottled(LoopRunParams *p);
+static bool LoopRunParamsShouldDrawBetweenTicks(
+	const LoopRunParams *p, const GameLoopData *data);
+static float LoopRunParamsGetAlpha(
+	const LoopRunParams *p, const GameLoopData *data);
+static Uint32 LoopRunParamsGetSleepMs(
+	const LoopRunParams *p, const GameLoopData *data);
+static void LoopRunParamsLogStats(LoopRunParams *p);
+static bool LoopRunnerTick(LoopRunInnerData *ctx, bool *draw);
 bool LoopRunnerRunInner(LoopRunInnerData *ctx)
 {
-#ifndef __EMSCRIPTEN__
+    LoopRunParamsUpdateTicks(&ctx->p);
+#ifdef __EMSCRIPTEN__
+    // The browser schedules our frames; simulate one tick per frame
+    const int ticks = 1;
+    ctx->p.TicksElapsed = 0;
+#else
+    const int ticks = ctx->data->Unthrottled ?
+        LoopRunParamsTicksUnthrottled(&ctx->p) :
+        LoopRunParamsTicksDue(&ctx->p);
     // Frame rate control
-    if (LoopRunParamsShouldSleep(&(ctx->p)))
+    if (ticks == 0 &&
+        !LoopRunParamsShouldDrawBetweenTicks(&ctx->p, ctx->data))
     {
-        SDL_Delay(1);
+        PROFILE_BEGIN(PROFILE_SLEEP);
+        SDL_Delay(LoopRunParamsGetSleepMs(&ctx->p, ctx->data));
+        PROFILE_END(PROFILE_SLEEP);
         return true;
     }
 #endif
 
+    // Simulate at a fixed rate, catching up if we've fallen behind
+    bool draw = ticks == 0;
+    for (int i = 0; i < ticks; i++)
+    {
+        GameLoopData *data = ctx->data;
+        if (!LoopRunnerTick(ctx, &draw))
+        {
+            return false;
+        }
+        if (ctx->data != data)
+        {
+            // State change; restart loop
+            return true;
+        }
+    }
+    draw = draw || !ctx->data->HasDrawnFirst;
+    if (ctx->data->Unthrottled && ctx->data->HasDrawnFirst &&
+        (int)(ctx->p.TicksNow - ctx->p.LastDrawTicks) < ctx->p.DrawDurationMs)
+    {
+        draw = false;
+    }
+    LoopRunParamsLogStats(&ctx->p);
+
+    // Draw
+    if (draw && !gGraphicsDevice.IsHeadless)
+    {
+        PROFILE_BEGIN(PROFILE_DRAW);
+        ctx->data->DrawAlpha = LoopRunParamsGetAlpha(&ctx->p, ctx->data);
+		WindowContextPreRender(&gGraphicsDevice.gameWindow);
+		if (gGraphicsDevice.cachedConfig.SecondWindow)
+		{
+			WindowContextPreRender(&gGraphicsDevice.secondWindow);
+		}
+        if (ctx->data->DrawFunc)
+        {
+            ctx->data->DrawFunc(ctx->data);
+        }
+		WindowContextPostRender(&gGraphicsDevice.gameWindow);
+		if (gGraphicsDevice.cachedConfig.SecondWindow)
+		{
+			WindowContextPostRender(&gGraphicsDevice.secondWindow);
+		}
+        ctx->data->HasDrawnFirst = true;
+        ctx->p.LastDrawTicks = ctx->p.TicksNow;
+        PROFILE_END(PROFILE_DRAW);
+    }
+
+    PROFILE_FRAME_END();
+    return true;
+}
+// Run one simulation tick: input, network and update
+// Returns false if there are no more loops to run
+static bool LoopRunnerTick(LoopRunInnerData *ctx, bool *draw)
+{
     // Input
     if ((ctx->data->Frames & 1) || !ctx->data->InputEverySecondFrame)
     {
@@ -207,11 +296,21 @@ bool LoopRunnerRunInner(LoopRunInnerData *ctx)
         }
     }
 
+    const Uint64 tickStart = SDL_GetPerformanceCounter();
+    PROFILE_BEGIN(PROFILE_NET_POLL);
     NetClientPoll(&gNetClient);
     NetServerPoll(&gNetServer);
+    if (gNetStats.Enabled)
+    {
+        NetStatsUpdate(&gNetStats, ctx->p.TicksNow);
+    }
+    PROFILE_END(PROFILE_NET_POLL);
 
     // Update
+    PROFILE_BEGIN(PROFILE_UPDATE);
     ctx->p.Result = ctx->data->UpdateFunc(ctx->data, ctx->l);
+    PROFILE_END(PROFILE_UPDATE);
+    SoundFlush(&gSoundDevice);
     GameLoopData *newData = GetCurrentLoop(ctx->l);
     if (newData == NULL)
     {
@@ -219,7 +318,6 @@ bool LoopRunnerRunInner(LoopRunInnerData *ctx)
     }
     else if (newData != ctx->data)
     {
-        // State change; restart loop
         GameLoopOnExit(ctx->data);
         ctx->data = newData;
         GameLoopOnEnter(ctx->data);
@@ -227,51 +325,29 @@ bool LoopRunnerRunInner(LoopRunInnerData *ctx)
         return true;
     }
 
+    PROFILE_BEGIN(PROFILE_NET_FLUSH);
     NetServerFlush(&gNetServer);
     NetClientFlush(&gNetClient);
+    PROFILE_END(PROFILE_NET_FLUSH);
 
-    bool draw = !ctx->data->HasDrawnFirst;
     switch (ctx->p.Result)
     {
     case UPDATE_RESULT_OK:
         // Do nothing
         break;
     case UPDATE_RESULT_DRAW:
-        draw = true;
+        *draw = true;
         break;
     default:
         CASSERT(false, "Unknown loop result");
         break;
     }
     ctx->data->Frames++;
-#ifndef __EMSCRIPTEN__
-    // frame skip
-    if (LoopRunParamsShouldSkip(&(ctx->p)))
-    {
-        return true;
-    }
-#endif
-
-    // Draw
-    if (draw)
-    {
-		WindowContextPreRender(&gGraphicsDevice.gameWindow);
-		if (gGraphicsDevice.cachedConfig.SecondWindow)
-		{
-			WindowContextPreRender(&gGraphicsDevice.secondWindow);
-		}
-        if (ctx->data->DrawFunc)
-        {
-            ctx->data->DrawFunc(ctx->data);
-        }
-		WindowContextPostRender(&gGraphicsDevice.gameWindow);
-		if (gGraphicsDevice.cachedConfig.SecondWindow)
-		{
-			WindowContextPostRender(&gGraphicsDevice.secondWindow);
-		}
-        ctx->data->HasDrawnFirst = true;
-    }
 
+    const Uint64 tickDuration = SDL_GetPerformanceCounter() - tickStart;
+    ctx->p.StatsTicks++;
+    ctx->p.StatsTickTotal += tickDuration;
+    ctx->p.StatsTickMax = MAX(ctx->p.StatsTickMax, tickDuration);
     return true;
 }
 
@@ -312,6 +388,7 @@ void LoopRunnerRun(LoopRunner *l)
 #endif
 	GameLoopOnExit(data);
 }
+static int GetDisplayRefreshRate(void);
 static LoopRunParams LoopRunParamsNew(const GameLoopData *data)
 {
 	LoopRunParams p;
@@ -319,36 +396,109 @@ static LoopRunParams LoopRunParamsNew(const GameLoopData *data)
 	p.TicksNow = SDL_GetTicks();
 	p.TicksElapsed = 0;
 	p.FrameDurationMs = 1000 / data->FPS;
-	p.FramesSkipped = 0;
-	p.MaxFrameskip = data->FPS / 5;
+	p.MaxCatchUp = MAX(1, data->FPS / 5);
+	p.DrawDurationMs = 1000 / GetDisplayRefreshRate();
+	p.LastDrawTicks = p.TicksNow;
+	p.StatsStart = p.TicksNow;
+	p.StatsTicks = 0;
+	p.StatsTicksDropped = 0;
+	p.StatsTickTotal = 0;
+	p.StatsTickMax = 0;
 	return p;
 }
-static bool LoopRunParamsShouldSleep(LoopRunParams *p)
+#define DEFAULT_REFRESH_RATE 60
+static int GetDisplayRefreshRate(void)
+{
+	SDL_Window *w = gGraphicsDevice.gameWindow.window;
+	if (w == NULL)
+	{
+		return DEFAULT_REFRESH_RATE;
+	}
+	SDL_DisplayMode mode;
+	if (SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(w), &mode) != 0 ||
+		mode.refresh_rate <= 0)
+	{
+		return DEFAULT_REFRESH_RATE;
+	}
+	return mode.refresh_rate;
+}
+static void LoopRunParamsUpdateTicks(LoopRunParams *p)
 {
 	const Uint32 ticksThen = p->TicksNow;
 	p->TicksNow = SDL_GetTicks();
 	p->TicksElapsed += p->TicksNow - ticksThen;
-	return (int)p->TicksElapsed < p->FrameDurationMs;
 }
-static bool LoopRunParamsShouldSkip(LoopRunParams *p)
+static int LoopRunParamsTicksDue(LoopRunParams *p)
 {
-	p->TicksElapsed -= p->FrameDurationMs;
-	// frame skip
-	if ((int)p->TicksElapsed > p->FrameDurationMs)
+	int ticks = (int)p->TicksElapsed / p->FrameDurationMs;
+	if (ticks > p->MaxCatchUp)
 	{
-		p->FramesSkipped++;
-		if (p->FramesSkipped == p->MaxFrameskip)
-		{
-			// We've skipped too many frames; give up
-			p->TicksElapsed = 0;
-		}
-		else
-		{
-			return true;
-		}
+		// We've fallen too far behind; give up on the excess
+		p->StatsTicksDropped += ticks - p->MaxCatchUp;
+		ticks = p->MaxCatchUp;
+		p->TicksElapsed = (Uint32)(ticks * p->FrameDurationMs);
+	}
+	p->TicksElapsed -= (Uint32)(ticks * p->FrameDurationMs);
+	return ticks;
+}
+// Simulate one tick per pass, without waiting for it to be due
+static int LoopRunParamsTicksUnthrottled(LoopRunParams *p)
+{
+	p->TicksElapsed = 0;
+	return 1;
+}
+static bool LoopRunParamsShouldDrawBetweenTicks(
+	const LoopRunParams *p, const GameLoopData *data)
+{
+	return
+		data->Interpolate && data->HasDrawnFirst &&
+		!gGraphicsDevice.IsHeadless &&
+		p->Result == UPDATE_RESULT_DRAW &&
+		(int)(p->TicksNow - p->LastDrawTicks) >= p->DrawDurationMs;
+}
+static float LoopRunParamsGetAlpha(
+	const LoopRunParams *p, const GameLoopData *data)
+{
+	if (!data->Interpolate)
+	{
+		return 1.0f;
+	}
+	return MIN(1.0f, (float)p->TicksElapsed / p->FrameDurationMs);
+}
+// Sleep until the next tick is due, or the next draw if drawing between ticks
+static Uint32 LoopRunParamsGetSleepMs(
+	const LoopRunParams *p, const GameLoopData *data)
+{
+	int ms = p->FrameDurationMs - (int)p->TicksElapsed;
+	if (data->Interpolate && !gGraphicsDevice.IsHeadless)
+	{
+		ms = MIN(
+			ms, p->DrawDurationMs - (int)(p->TicksNow - p->LastDrawTicks));
+	}
+	return (Uint32)MAX(1, ms);
+}
+#define TICK_STATS_PERIOD_MS 10000
+static void LoopRunParamsLogStats(LoopRunParams *p)
+{
+	if (p->TicksNow - p->StatsStart < TICK_STATS_PERIOD_MS ||
+		p->StatsTicks == 0)
+	{
+		return;
 	}
-	p->FramesSkipped = 0;
-	return false;
+	// Dedicated servers have nothing else to show; log at a visible level
+	const LogLevel ll = gGraphicsDevice.IsHeadless ? LL_INFO : LL_DEBUG;
+	const double msPerCount = 1000.0 / (double)SDL_GetPerformanceFrequency();
+	LOG(LM_MAIN, ll,
+		"ticks(%d) avg(%.2fms) max(%.2fms) budget(%dms) dropped(%d)",
+		p->StatsTicks,
+		(double)p->StatsTickTotal * msPerCount / p->StatsTicks,
+		(double)p->StatsTickMax * msPerCount,
+		p->FrameDurationMs, p->StatsTicksDropped);
+	p->StatsStart = p->TicksNow;
+	p->StatsTicks = 0;
+	p->StatsTicksDropped = 0;
+	p->StatsTickTotal = 0;
+	p->StatsTickMax = 0;
 }
 
 void LoopRunnerChange(LoopRunner *l, GameLoopData *newData)
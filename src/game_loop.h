@@ -56,11 +56,20 @@ typedef struct sGameLoopData
 	void (*InputFunc)(struct sGameLoopData *);
 	GameLoopResult (*UpdateFunc)(struct sGameLoopData *, LoopRunner *);
 	void (*DrawFunc)(struct sGameLoopData *);
+	// Simulation ticks per second; UpdateFunc is called at this fixed rate
 	int FPS;
+	// Draw at the display refresh rate, between simulation ticks;
+	// DrawFunc should interpolate using DrawAlpha
+	bool Interpolate;
+	// Fraction of a tick elapsed since the last update, in [0, 1]
+	float DrawAlpha;
+	// Simulate as fast as possible instead of in real time, e.g. for
+	// benchmarking replays; draws are still limited to the refresh rate
+	bool Unthrottled;
 	bool SuperhotMode;
 	bool InputEverySecondFrame;
 	bool SkipNextFrame;
-	int Frames;		// total frames looped
+	int Frames;		// total ticks simulated
 	bool HasDrawnFirst;
 	bool IsUsed;
 } GameLoopData;
@@ -0,0 +1,73 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+
+    Copyright (c) 2018 Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "replay_screen.h"
+
+#include <cdogs/campaigns.h>
+#include <cdogs/config.h>
+#include <cdogs/events.h>
+#include <cdogs/game_events.h>
+#include <cdogs/gamedata.h>
+#include <cdogs/log.h>
+#include <cdogs/map.h>
+#include <cdogs/replay.h>
+
+#include "game.h"
+
+
+static void ReplayScreenTerminate(GameLoopData *data);
+static GameLoopResult ReplayScreenUpdate(GameLoopData *data, LoopRunner *l);
+GameLoopData *ScreenReplay(void)
+{
+	GameEventsInit(&gGameEvents);
+	GameLoopData *g = GameLoopDataNew(
+		NULL, ReplayScreenTerminate, NULL, NULL,
+		NULL, ReplayScreenUpdate, NULL);
+	g->FPS = ConfigGetInt(&gConfig, "Game.FPS");
+	return g;
+}
+static void ReplayScreenTerminate(GameLoopData *data)
+{
+	UNUSED(data);
+	GameEventsTerminate(&gGameEvents);
+}
+static GameLoopResult ReplayScreenUpdate(GameLoopData *data, LoopRunner *l)
+{
+	UNUSED(data);
+	if (gReplay.IsDone || gReplay.f == NULL || gEventHandlers.HasQuit)
+	{
+		LoopRunnerPop(l);
+		return UPDATE_RESULT_OK;
+	}
+	MissionOptionsTerminate(&gMission);
+	CampaignAndMissionSetup(&gCampaign, &gMission);
+	LOG(LM_MAIN, LL_INFO, "replaying mission %d: %s",
+		gCampaign.MissionIndex + 1, gMission.missionData->Title);
+	LoopRunnerPush(l, RunGame(&gCampaign, &gMission, &gMap));
+	return UPDATE_RESULT_OK;
+}
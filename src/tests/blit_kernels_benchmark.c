@@ -0,0 +1,73 @@
+// Micro-benchmark for the blit kernels; not run as part of the tests
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <SDL_timer.h>
+
+#include <blit_kernels.h>
+
+
+#define AMASK 0xFF000000
+#define ASHIFT 24
+#define W 320
+#define H 240
+#define ITERATIONS 500
+
+static Uint32 sSrc[W * H];
+static Uint32 sDst[W * H];
+
+static double Elapsed(const Uint64 start)
+{
+	return (double)(SDL_GetPerformanceCounter() - start) * 1000.0 /
+		(double)SDL_GetPerformanceFrequency();
+}
+
+int main(int argc, char *argv[])
+{
+	(void)argc;
+	(void)argv;
+	for (int i = 0; i < W * H; i++)
+	{
+		sSrc[i] = (Uint32)rand() << 16 ^ (Uint32)rand();
+		sDst[i] = (Uint32)rand() << 16 ^ (Uint32)rand();
+	}
+	printf("%dx%d, %d iterations\n", W, H, ITERATIONS);
+	printf("%-8s %12s %12s %12s\n", "kernels", "Copy", "MaskedMult", "Blend");
+	for (int t = 0; t < (int)BLIT_KERNELS_COUNT; t++)
+	{
+		const BlitKernels *k = BlitKernelsGet((BlitKernelsType)t);
+		if (k == NULL) continue;
+		Uint64 start = SDL_GetPerformanceCounter();
+		for (int n = 0; n < ITERATIONS; n++)
+		{
+			for (int y = 0; y < H; y++)
+			{
+				k->Copy(sDst + y * W, sSrc + y * W, W, AMASK, ASHIFT);
+			}
+		}
+		const double copyMs = Elapsed(start);
+		start = SDL_GetPerformanceCounter();
+		for (int n = 0; n < ITERATIONS; n++)
+		{
+			for (int y = 0; y < H; y++)
+			{
+				k->MaskedMult(
+					sDst + y * W, sSrc + y * W, W, 0xFFC08040,
+					AMASK, ASHIFT, 3);
+			}
+		}
+		const double maskedMs = Elapsed(start);
+		start = SDL_GetPerformanceCounter();
+		for (int n = 0; n < ITERATIONS; n++)
+		{
+			for (int y = 0; y < H; y++)
+			{
+				k->Blend(sDst + y * W, W, 0x80402010, AMASK, ASHIFT);
+			}
+		}
+		const double blendMs = Elapsed(start);
+		printf("%-8s %10.2fms %10.2fms %10.2fms\n",
+			BlitKernelsTypeStr((BlitKernelsType)t), copyMs, maskedMs, blendMs);
+	}
+	return 0;
+}
@@ -0,0 +1,162 @@
+#include <cbehave/cbehave.h>
+
+#include <stdlib.h>
+
+#include <blit.h>
+#include <blit_kernels.h>
+
+
+#define AMASK 0xFF000000
+#define ASHIFT 24
+// Not a multiple of any vector width, to exercise the scalar tails
+#define N 67
+
+static void RandPixels(Uint32 *p, const int n)
+{
+	for (int i = 0; i < n; i++)
+	{
+		p[i] = (Uint32)(rand() & 0xFFFF) << 16 | (Uint32)(rand() & 0xFFFF);
+		// Bias towards the alpha values that the blitters test for
+		switch (rand() % 4)
+		{
+		case 0: p[i] &= ~AMASK; break;
+		case 1: p[i] = (p[i] & ~AMASK) | ((Uint32)(rand() % 4) << ASHIFT); break;
+		default: break;
+		}
+	}
+}
+
+// Reference implementations, as per the original per-pixel blitters
+static void CopyRef(Uint32 *dst, const Uint32 *src, const int n)
+{
+	for (int i = 0; i < n; i++)
+	{
+		if ((src[i] & AMASK) == 0) continue;
+		dst[i] = src[i];
+	}
+}
+static void MaskedMultRef(
+	Uint32 *dst, const Uint32 *src, const int n, const Uint32 mask,
+	const bool isTransparent)
+{
+	for (int i = 0; i < n; i++)
+	{
+		if (isTransparent && ((src[i] & AMASK) >> ASHIFT) < 3) continue;
+		dst[i] = PixelMult(src[i], mask) | AMASK;
+	}
+}
+static void BlendRef(Uint32 *dst, const int n, const Uint32 c)
+{
+	const int a = (int)(c >> ASHIFT);
+	for (int i = 0; i < n; i++)
+	{
+		const int r = (int)((dst[i] >> 16) & 0xFF);
+		const int g = (int)((dst[i] >> 8) & 0xFF);
+		const int b = (int)(dst[i] & 0xFF);
+		dst[i] =
+			AMASK |
+			(Uint32)((r * (255 - a) + (int)((c >> 16) & 0xFF) * a) / 255) << 16 |
+			(Uint32)((g * (255 - a) + (int)((c >> 8) & 0xFF) * a) / 255) << 8 |
+			(Uint32)((b * (255 - a) + (int)(c & 0xFF) * a) / 255);
+	}
+}
+
+FEATURE(BlitKernels, "Blit kernels")
+	SCENARIO("Copy matches the per-pixel blitter")
+		GIVEN("random source and destination pixels")
+			srand(1);
+			Uint32 src[N], dst[N], expected[N];
+			RandPixels(src, N);
+			RandPixels(dst, N);
+			memcpy(expected, dst, sizeof dst);
+			CopyRef(expected, src, N);
+
+		THEN("every supported kernel should produce identical pixels")
+			for (int t = 0; t < (int)BLIT_KERNELS_COUNT; t++)
+			{
+				const BlitKernels *k = BlitKernelsGet((BlitKernelsType)t);
+				if (k == NULL) continue;
+				Uint32 out[N];
+				memcpy(out, dst, sizeof dst);
+				k->Copy(out, src, N, AMASK, ASHIFT);
+				SHOULD_MEM_EQUAL(out, expected, sizeof out);
+			}
+	SCENARIO_END
+
+	SCENARIO("Masked multiply matches the per-pixel blitter")
+		GIVEN("random source and destination pixels, and a mask")
+			srand(2);
+			Uint32 src[N], dst[N], expected[N], expectedTransparent[N];
+			RandPixels(src, N);
+			RandPixels(dst, N);
+			const Uint32 mask = 0xFFC08040;
+			memcpy(expected, dst, sizeof dst);
+			MaskedMultRef(expected, src, N, mask, false);
+			memcpy(expectedTransparent, dst, sizeof dst);
+			MaskedMultRef(expectedTransparent, src, N, mask, true);
+
+		THEN("every supported kernel should produce identical pixels")
+			for (int t = 0; t < (int)BLIT_KERNELS_COUNT; t++)
+			{
+				const BlitKernels *k = BlitKernelsGet((BlitKernelsType)t);
+				if (k == NULL) continue;
+				Uint32 out[N];
+				memcpy(out, dst, sizeof dst);
+				k->MaskedMult(out, src, N, mask, AMASK, ASHIFT, 0);
+				SHOULD_MEM_EQUAL(out, expected, sizeof out);
+				memcpy(out, dst, sizeof dst);
+				k->MaskedMult(out, src, N, mask, AMASK, ASHIFT, 3);
+				SHOULD_MEM_EQUAL(out, expectedTransparent, sizeof out);
+			}
+	SCENARIO_END
+
+	SCENARIO("Multiply is exact for all channel values")
+		GIVEN("every pair of channel values")
+			Uint32 src[256], expected[256];
+			for (int i = 0; i < 256; i++)
+			{
+				src[i] = (Uint32)i * 0x01010101;
+			}
+
+		THEN("every supported kernel should match PixelMult")
+			for (int t = 0; t < (int)BLIT_KERNELS_COUNT; t++)
+			{
+				const BlitKernels *k = BlitKernelsGet((BlitKernelsType)t);
+				if (k == NULL) continue;
+				for (int m = 0; m < 256; m++)
+				{
+					const Uint32 mask = (Uint32)m * 0x01010101;
+					MaskedMultRef(expected, src, 256, mask, false);
+					Uint32 out[256];
+					k->MaskedMult(out, src, 256, mask, AMASK, ASHIFT, 0);
+					SHOULD_MEM_EQUAL(out, expected, sizeof out);
+				}
+			}
+	SCENARIO_END
+
+	SCENARIO("Blend matches the colour alpha blend")
+		GIVEN("random destination pixels")
+			srand(3);
+			Uint32 dst[N];
+			RandPixels(dst, N);
+
+		THEN("every supported kernel should produce identical pixels")
+			const Uint32 colors[] = { 0x00FFFFFF, 0x80402010, 0xFF123456 };
+			for (int t = 0; t < (int)BLIT_KERNELS_COUNT; t++)
+			{
+				const BlitKernels *k = BlitKernelsGet((BlitKernelsType)t);
+				if (k == NULL) continue;
+				for (int i = 0; i < 3; i++)
+				{
+					Uint32 expected[N], out[N];
+					memcpy(expected, dst, sizeof dst);
+					BlendRef(expected, N, colors[i]);
+					memcpy(out, dst, sizeof dst);
+					k->Blend(out, N, colors[i], AMASK, ASHIFT);
+					SHOULD_MEM_EQUAL(out, expected, sizeof out);
+				}
+			}
+	SCENARIO_END
+FEATURE_END
+
+CBEHAVE_RUN("Blit kernels features are:", TEST_FEATURE(BlitKernels))
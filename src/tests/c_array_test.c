@@ -1,6 +1,7 @@
 #include <cbehave/cbehave.h>
 
 #include <c_array.h>
+#include <mem_arena.h>
 
 #include <SDL_joystick.h>
 
@@ -113,9 +114,67 @@ FEATURE(CArrayRemoveIf, "Array remove if")
 	SCENARIO_END
 FEATURE_END
 
+FEATURE(CArrayArena, "Array in arena")
+	SCENARIO("Grow and reset")
+		GIVEN("an array allocated from an arena")
+			MemArena arena;
+			MemArenaInit(&arena);
+			CArray a;
+			CArrayInitArena(&a, sizeof(int), &arena);
+
+		WHEN("I add many elements")
+			for (int i = 0; i < 10000; i++)
+			{
+				CArrayPushBack(&a, &i);
+			}
+
+		THEN("the array should contain all the elements")
+			SHOULD_INT_EQUAL((int)a.size, 10000);
+			for (int i = 0; i < (int)a.size; i++)
+			{
+				SHOULD_INT_EQUAL(*(int *)CArrayGet(&a, i), i);
+			}
+		AND("the arena should have served it with few heap allocations")
+			SHOULD_INT_LE(arena.Stats.HeapAllocs, 3);
+
+		WHEN("I reset the arena and allocate again")
+			MemArenaReset(&arena);
+			CArrayInitArena(&a, sizeof(int), &arena);
+			for (int i = 0; i < 100; i++)
+			{
+				CArrayPushBack(&a, &i);
+			}
+
+		THEN("the arena should reuse its blocks")
+			SHOULD_INT_EQUAL(arena.Stats.HeapAllocs, 0);
+			MemArenaTerminate(&arena);
+	SCENARIO_END
+	SCENARIO("Reuse freed arrays")
+		GIVEN("a small array allocated from an arena")
+			MemArena arena;
+			MemArenaInit(&arena);
+			CArray a;
+			CArrayInitArena(&a, sizeof(int), &arena);
+			int n = 1;
+			CArrayPushBack(&a, &n);
+			void *data = a.data;
+
+		WHEN("I free it and allocate another of the same size")
+			CArrayTerminate(&a);
+			CArrayInitArena(&a, sizeof(int), &arena);
+			CArrayPushBack(&a, &n);
+
+		THEN("the arena should reuse the freed slot")
+			SHOULD_BE_TRUE(a.data == data);
+			SHOULD_INT_EQUAL(arena.Stats.SlabReuses, 1);
+			MemArenaTerminate(&arena);
+	SCENARIO_END
+FEATURE_END
+
 CBEHAVE_RUN(
 	"CArray features are:",
 	TEST_FEATURE(CArrayInsert),
 	TEST_FEATURE(CArrayDelete),
-	TEST_FEATURE(CArrayRemoveIf)
+	TEST_FEATURE(CArrayRemoveIf),
+	TEST_FEATURE(CArrayArena)
 )
@@ -0,0 +1,113 @@
+// Micro-benchmark for c_hashmap lookups; not run as part of the tests
+#include <stdbool.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <c_hashmap/hashmap.h>
+
+
+// Key sets shaped like the pic and tile class names used in draw paths,
+// e.g. "wall/steel/o" and "floor/tile/normal/FFFFFFFF/808080FF"
+static const char *sStyles[] = {
+	"steel", "brick", "carbon", "stone", "wood", "plasteel", "granite",
+	"cross", "dirt", "tile", "alien", "tech", "hex", "grate"
+};
+static const char *sTypes[] = {
+	"o", "w", "e", "n", "s", "nw", "ne", "sw", "se", "h", "v", "x",
+	"normal", "shadow", "alt1", "alt2"
+};
+static const char *sColors[] = {
+	"FFFFFFFF", "808080FF", "C0C0C0FF", "FF0000FF", "00FF00FF", "0000FFFF"
+};
+#define NUM_STYLES (sizeof sStyles / sizeof sStyles[0])
+#define NUM_TYPES (sizeof sTypes / sizeof sTypes[0])
+#define NUM_COLORS (sizeof sColors / sizeof sColors[0])
+#define NUM_KEYS (NUM_STYLES * NUM_TYPES * (1 + NUM_COLORS))
+#define LOOKUPS 2000000
+
+static char sKeys[NUM_KEYS][64];
+static int MakeKeys(void)
+{
+	int n = 0;
+	for (int s = 0; s < (int)NUM_STYLES; s++)
+	{
+		for (int t = 0; t < (int)NUM_TYPES; t++)
+		{
+			sprintf(sKeys[n++], "wall/%s/%s", sStyles[s], sTypes[t]);
+			for (int c = 0; c < (int)NUM_COLORS; c++)
+			{
+				sprintf(sKeys[n++], "floor/%s/%s/%s/%s",
+					sStyles[s], sTypes[t], sColors[c], sColors[NUM_COLORS - 1 - c]);
+			}
+		}
+	}
+	return n;
+}
+
+static double Elapsed(const clock_t start)
+{
+	return (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char *argv[])
+{
+	(void)argc;
+	(void)argv;
+	const int numKeys = MakeKeys();
+	map_t map = hashmap_new();
+	clock_t start = clock();
+	for (int i = 0; i < numKeys; i++)
+	{
+		hashmap_put(map, sKeys[i], sKeys[i]);
+	}
+	const double putMs = Elapsed(start);
+
+	int found = 0;
+	int k = 0;
+	start = clock();
+	for (int i = 0; i < LOOKUPS; i++)
+	{
+		k = (k + 7919) % numKeys;
+		const char *key = sKeys[k];
+		char *valueOut;
+		if (hashmap_get(map, key, (void **)&valueOut) == MAP_OK &&
+			valueOut == key)
+		{
+			found++;
+		}
+	}
+	const double getMs = Elapsed(start);
+
+	start = clock();
+	for (int i = 0; i < LOOKUPS; i++)
+	{
+		char *valueOut;
+		// A missing custom lookup followed by a hit, sharing the hash
+		k = (k + 7919) % numKeys;
+		const char *key = sKeys[k];
+		const unsigned int hash = hashmap_hash_key(key);
+		if (hashmap_get_hashed(
+				map, key + 1, hash, (void **)&valueOut) == MAP_OK)
+		{
+			found--;
+		}
+		if (hashmap_get_hashed(map, key, hash, (void **)&valueOut) == MAP_OK)
+		{
+			found++;
+		}
+	}
+	const double getHashedMs = Elapsed(start);
+
+	printf("%d keys\n", numKeys);
+	printf("%-24s %10.2fms\n", "put", putMs);
+	printf("%-24s %10.2fms\n", "get", getMs);
+	printf("%-24s %10.2fms\n", "get hashed (miss, hit)", getHashedMs);
+	const bool ok = found == 2 * LOOKUPS && hashmap_length(map) == numKeys;
+	hashmap_free(map);
+	if (!ok)
+	{
+		printf("lookups failed\n");
+		return 1;
+	}
+	return 0;
+}
@@ -1,5 +1,8 @@
 #include <cbehave/cbehave.h>
 
+#include <stdio.h>
+#include <string.h>
+
 #include <c_hashmap/hashmap.h>
 
 
@@ -57,6 +60,26 @@ FEATURE(hashmap_get, "Hashmap get")
 
 		hashmap_free(map);
 	SCENARIO_END
+
+	SCENARIO("Get with a pre-hashed key")
+		GIVEN("a hashmap with a value")
+			map_t map = hashmap_new();
+			int value = 42;
+			hashmap_put(map, "somekey", &value);
+
+		WHEN("I get it via its hash")
+			int *valueHashed;
+			const int errorHashed = hashmap_get_hashed(
+				map, "somekey", hashmap_hash_key("somekey"),
+				(void **)&valueHashed);
+
+		THEN("the get operation should be successful")
+			SHOULD_INT_EQUAL(errorHashed, (int)MAP_OK);
+		AND("the values should match");
+			SHOULD_INT_EQUAL(value, *valueHashed);
+
+		hashmap_free(map);
+	SCENARIO_END
 FEATURE_END
 
 FEATURE(hashmap_remove, "Hashmap remove")
@@ -74,6 +97,44 @@ FEATURE(hashmap_remove, "Hashmap remove")
 
 		hashmap_free(map);
 	SCENARIO_END
+
+	SCENARIO("Remove values from a grown hashmap")
+		GIVEN("a hashmap with many values")
+			map_t map = hashmap_new();
+			static int values[1000];
+			char key[32];
+			for (int i = 0; i < 1000; i++)
+			{
+				values[i] = i;
+				sprintf(key, "key%d", i);
+				hashmap_put(map, key, &values[i]);
+			}
+
+		WHEN("I remove every other value")
+			for (int i = 0; i < 1000; i += 2)
+			{
+				sprintf(key, "key%d", i);
+				hashmap_remove(map, key);
+			}
+
+		THEN("the removed values should be missing")
+			int removedMissing = 0;
+			int keptFound = 0;
+			for (int i = 0; i < 1000; i++)
+			{
+				int *valueOut;
+				sprintf(key, "key%d", i);
+				const int error = hashmap_get(map, key, (void **)&valueOut);
+				if (i % 2 == 0 && error == MAP_MISSING) removedMissing++;
+				if (i % 2 == 1 && error == MAP_OK && *valueOut == i) keptFound++;
+			}
+			SHOULD_INT_EQUAL(removedMissing, 500);
+		AND("the remaining values should be found");
+			SHOULD_INT_EQUAL(keptFound, 500);
+			SHOULD_INT_EQUAL(hashmap_length(map), 500);
+
+		hashmap_free(map);
+	SCENARIO_END
 FEATURE_END
 
 CBEHAVE_RUN(
@@ -0,0 +1,131 @@
+#define SDL_MAIN_HANDLED
+#include <cbehave/cbehave.h>
+
+#include <collision/collision.h>
+
+#include <stdlib.h>
+
+// Stubs
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+
+
+#define MAX_WALK_TILES 16
+
+// Walk a line and record the tiles it passes through; returns the count
+static int Walk(
+	const struct vec2 from, const struct vec2 to, struct vec2i *tiles)
+{
+	TileWalk w;
+	TileWalkInit(&w, from, to);
+	int n = 0;
+	do
+	{
+		tiles[n++] = w.Tile;
+	} while (n < MAX_WALK_TILES && TileWalkNext(&w));
+	return n;
+}
+// Whether each tile is next to the one before it, without cutting corners
+static bool IsEdgeConnected(const struct vec2i *tiles, const int n)
+{
+	for (int i = 1; i < n; i++)
+	{
+		const int dx = abs(tiles[i].x - tiles[i - 1].x);
+		const int dy = abs(tiles[i].y - tiles[i - 1].y);
+		if (dx + dy != 1) return false;
+	}
+	return true;
+}
+
+
+FEATURE(tile_walk, "Walk tiles along a line")
+	SCENARIO("Axis-aligned line")
+		GIVEN("a horizontal line across four tiles")
+			const struct vec2 from = svec2(TILE_WIDTH / 2, TILE_HEIGHT / 2);
+			const struct vec2 to = svec2(
+				TILE_WIDTH * 3 + TILE_WIDTH / 2, TILE_HEIGHT / 2);
+
+		WHEN("I walk it forwards and backwards")
+			struct vec2i tiles[MAX_WALK_TILES];
+			const int n = Walk(from, to, tiles);
+			struct vec2i back[MAX_WALK_TILES];
+			const int nBack = Walk(to, from, back);
+
+		THEN("it should pass through each tile in the row in order")
+			SHOULD_INT_EQUAL(n, 4);
+			for (int i = 0; i < n; i++)
+			{
+				SHOULD_INT_EQUAL(tiles[i].x, i);
+				SHOULD_INT_EQUAL(tiles[i].y, 0);
+			}
+		AND("backwards should pass through the same tiles in reverse")
+			SHOULD_INT_EQUAL(nBack, 4);
+			for (int i = 0; i < nBack; i++)
+			{
+				SHOULD_INT_EQUAL(back[i].x, 3 - i);
+				SHOULD_INT_EQUAL(back[i].y, 0);
+			}
+	SCENARIO_END
+
+	SCENARIO("Diagonal line")
+		GIVEN("a line that crosses tile edges at different points")
+			const struct vec2 from = svec2(2, 2);
+			const struct vec2 to = svec2(
+				TILE_WIDTH * 2 + 8, TILE_HEIGHT * 2 + 6);
+
+		WHEN("I walk it")
+			struct vec2i tiles[MAX_WALK_TILES];
+			const int n = Walk(from, to, tiles);
+
+		THEN("it should step one tile edge at a time")
+			SHOULD_INT_EQUAL(n, 5);
+			SHOULD_BE_TRUE(IsEdgeConnected(tiles, n));
+		AND("cross the edge it reaches first")
+			SHOULD_INT_EQUAL(tiles[1].x, 0);
+			SHOULD_INT_EQUAL(tiles[1].y, 1);
+		AND("end at the tile of the end point")
+			SHOULD_INT_EQUAL(tiles[n - 1].x, 2);
+			SHOULD_INT_EQUAL(tiles[n - 1].y, 2);
+	SCENARIO_END
+
+	SCENARIO("Line through tile corners")
+		GIVEN("a line that passes exactly through tile corners")
+			const struct vec2 from = svec2(TILE_WIDTH / 2, TILE_HEIGHT / 2);
+			const struct vec2 to = svec2(
+				TILE_WIDTH * 2 + TILE_WIDTH / 2,
+				TILE_HEIGHT * 2 + TILE_HEIGHT / 2);
+
+		WHEN("I walk it")
+			struct vec2i tiles[MAX_WALK_TILES];
+			const int n = Walk(from, to, tiles);
+
+		THEN("it should not skip diagonally past the corners")
+			SHOULD_INT_EQUAL(n, 5);
+			SHOULD_BE_TRUE(IsEdgeConnected(tiles, n));
+		AND("end at the tile of the end point")
+			SHOULD_INT_EQUAL(tiles[n - 1].x, 2);
+			SHOULD_INT_EQUAL(tiles[n - 1].y, 2);
+	SCENARIO_END
+
+	SCENARIO("Zero-length line")
+		GIVEN("a line that starts and ends at the same point")
+			const struct vec2 from = svec2(TILE_WIDTH + 3, TILE_HEIGHT + 5);
+
+		WHEN("I walk it")
+			TileWalk w;
+			TileWalkInit(&w, from, from);
+
+		THEN("it should only visit the tile of the point")
+			SHOULD_INT_EQUAL(w.Tile.x, 1);
+			SHOULD_INT_EQUAL(w.Tile.y, 1);
+			SHOULD_BE_FALSE(TileWalkNext(&w));
+	SCENARIO_END
+FEATURE_END
+
+CBEHAVE_RUN(
+	"Collision features are:",
+	TEST_FEATURE(tile_walk)
+)
@@ -0,0 +1,249 @@
+#define SDL_MAIN_HANDLED
+#include <cbehave/cbehave.h>
+
+#include <cdogsed/editor_undo.h>
+
+#include <string.h>
+
+#include <utils.h>
+
+// Stubs
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+
+#define WIDTH 8
+#define HEIGHT 6
+
+static void StaticMissionInit(Mission *m, const struct vec2i size)
+{
+	MissionInit(m);
+	m->Type = MAPTYPE_STATIC;
+	m->Size = size;
+	CArrayInit(&m->u.Static.Tiles, sizeof(uint16_t));
+	const uint16_t t = 0;
+	CArrayResize(&m->u.Static.Tiles, size.x * size.y, &t);
+	CArrayInit(&m->u.Static.Items, sizeof(MapObjectPositions));
+	CArrayInit(&m->u.Static.Characters, sizeof(CharacterPositions));
+	CArrayInit(&m->u.Static.Objectives, sizeof(ObjectivePositions));
+	CArrayInit(&m->u.Static.Keys, sizeof(KeyPositions));
+}
+static uint16_t *TileAt(Mission *m, const int x, const int y)
+{
+	return CArrayGet(&m->u.Static.Tiles, y * m->Size.x + x);
+}
+
+
+FEATURE(editor_undo_tiles, "Undo tile edits")
+	SCENARIO("Undo and redo a rectangle of tiles")
+		GIVEN("a tracked mission")
+			Mission m;
+			StaticMissionInit(&m, svec2i(WIDTH, HEIGHT));
+			EditorUndo u;
+			EditorUndoInit(&u, 1024 * 1024);
+			EditorUndoReset(&u, &m);
+
+		WHEN("I change two tiles and commit")
+			*TileAt(&m, 2, 1) = 1;
+			*TileAt(&m, 4, 3) = 2;
+			const bool changed = EditorUndoCommit(&u, &m);
+
+		THEN("one step should be recorded")
+			SHOULD_BE_TRUE(changed);
+			SHOULD_INT_EQUAL((int)u.Steps.size, 1);
+		AND("it should hold only the bounding rectangle of the change")
+			const EditorUndoStep *s = CArrayGet(&u.Steps, 0);
+			SHOULD_INT_EQUAL(s->TileRect.Pos.x, 2);
+			SHOULD_INT_EQUAL(s->TileRect.Pos.y, 1);
+			SHOULD_INT_EQUAL(s->TileRect.Size.x, 3);
+			SHOULD_INT_EQUAL(s->TileRect.Size.y, 3);
+			SHOULD_INT_EQUAL((int)s->TilesBefore.size, 9);
+			SHOULD_BE_FALSE(s->HasMission);
+
+		WHEN("I undo")
+			Rect2i r;
+			const EditorResult er = EditorUndoUndo(&u, &m, &r);
+
+		THEN("only the tiles should change, back to before")
+			SHOULD_INT_EQUAL((int)er, (int)EDITOR_RESULT_CHANGED);
+			SHOULD_INT_EQUAL(r.Pos.x, 2);
+			SHOULD_INT_EQUAL(r.Size.y, 3);
+			SHOULD_INT_EQUAL(*TileAt(&m, 2, 1), 0);
+			SHOULD_INT_EQUAL(*TileAt(&m, 4, 3), 0);
+
+		WHEN("I redo")
+			const EditorResult er2 = EditorUndoRedo(&u, &m, &r);
+
+		THEN("the tiles should be changed again")
+			SHOULD_INT_EQUAL((int)er2, (int)EDITOR_RESULT_CHANGED);
+			SHOULD_INT_EQUAL(*TileAt(&m, 2, 1), 1);
+			SHOULD_INT_EQUAL(*TileAt(&m, 4, 3), 2);
+		AND("there should be nothing more to redo")
+			SHOULD_INT_EQUAL(
+				(int)EditorUndoRedo(&u, &m, &r), (int)EDITOR_RESULT_NONE);
+		AND("committing without changes should record nothing")
+			SHOULD_BE_FALSE(EditorUndoCommit(&u, &m));
+			SHOULD_INT_EQUAL((int)u.Steps.size, 1);
+
+		EditorUndoTerminate(&u);
+		MissionTerminate(&m);
+	SCENARIO_END
+
+	SCENARIO("A new change discards what could be redone")
+		GIVEN("a mission with two committed changes, one undone")
+			Mission m;
+			StaticMissionInit(&m, svec2i(WIDTH, HEIGHT));
+			EditorUndo u;
+			EditorUndoInit(&u, 1024 * 1024);
+			EditorUndoReset(&u, &m);
+			*TileAt(&m, 0, 0) = 1;
+			EditorUndoCommit(&u, &m);
+			*TileAt(&m, 1, 0) = 1;
+			EditorUndoCommit(&u, &m);
+			Rect2i r;
+			EditorUndoUndo(&u, &m, &r);
+
+		WHEN("I make another change")
+			*TileAt(&m, 5, 5) = 3;
+			EditorUndoCommit(&u, &m);
+
+		THEN("the undone step should be gone")
+			SHOULD_INT_EQUAL((int)u.Steps.size, 2);
+			SHOULD_INT_EQUAL(u.Index, 2);
+			SHOULD_INT_EQUAL(
+				(int)EditorUndoRedo(&u, &m, &r), (int)EDITOR_RESULT_NONE);
+		AND("undoing everything should restore the original tiles")
+			while (EditorUndoUndo(&u, &m, &r) != EDITOR_RESULT_NONE);
+			SHOULD_INT_EQUAL(*TileAt(&m, 0, 0), 0);
+			SHOULD_INT_EQUAL(*TileAt(&m, 1, 0), 0);
+			SHOULD_INT_EQUAL(*TileAt(&m, 5, 5), 0);
+
+		EditorUndoTerminate(&u);
+		MissionTerminate(&m);
+	SCENARIO_END
+FEATURE_END
+
+FEATURE(editor_undo_mission, "Undo mission edits")
+	SCENARIO("Undo a mission setting")
+		GIVEN("a tracked mission with a tile change")
+			Mission m;
+			StaticMissionInit(&m, svec2i(WIDTH, HEIGHT));
+			EditorUndo u;
+			EditorUndoInit(&u, 1024 * 1024);
+			EditorUndoReset(&u, &m);
+			*TileAt(&m, 3, 3) = 1;
+			EditorUndoCommit(&u, &m);
+
+		WHEN("I change a setting and commit")
+			m.EnemyDensity = 42;
+			EditorUndoCommit(&u, &m);
+
+		THEN("the step should hold the mission but no tiles")
+			const EditorUndoStep *s = CArrayGet(&u.Steps, 1);
+			SHOULD_BE_TRUE(s->HasMission);
+			SHOULD_INT_EQUAL((int)s->TilesBefore.size, 0);
+
+		WHEN("I undo")
+			Rect2i r;
+			const EditorResult er = EditorUndoUndo(&u, &m, &r);
+
+		THEN("the mission should need reloading")
+			SHOULD_INT_EQUAL((int)er, (int)EDITOR_RESULT_CHANGED_AND_RELOAD);
+		AND("the setting should be restored and the tiles kept")
+			SHOULD_INT_EQUAL(m.EnemyDensity, 0);
+			SHOULD_INT_EQUAL(*TileAt(&m, 3, 3), 1);
+		AND("redo should reapply the setting")
+			EditorUndoRedo(&u, &m, &r);
+			SHOULD_INT_EQUAL(m.EnemyDensity, 42);
+
+		EditorUndoTerminate(&u);
+		MissionTerminate(&m);
+	SCENARIO_END
+
+	SCENARIO("Undo a resize")
+		GIVEN("a tracked mission with some tiles")
+			Mission m;
+			StaticMissionInit(&m, svec2i(WIDTH, HEIGHT));
+			*TileAt(&m, 7, 5) = 4;
+			EditorUndo u;
+			EditorUndoInit(&u, 1024 * 1024);
+			EditorUndoReset(&u, &m);
+
+		WHEN("I resize the map and commit")
+			Mission resized;
+			StaticMissionInit(&resized, svec2i(WIDTH + 2, HEIGHT + 1));
+			*TileAt(&resized, 9, 6) = 5;
+			MissionCopy(&m, &resized);
+			MissionTerminate(&resized);
+			EditorUndoCommit(&u, &m);
+
+		THEN("the step should hold both whole maps")
+			const EditorUndoStep *s = CArrayGet(&u.Steps, 0);
+			SHOULD_INT_EQUAL((int)s->TilesBefore.size, WIDTH * HEIGHT);
+			SHOULD_INT_EQUAL(
+				(int)s->TilesAfter.size, (WIDTH + 2) * (HEIGHT + 1));
+
+		WHEN("I undo")
+			Rect2i r;
+			const EditorResult er = EditorUndoUndo(&u, &m, &r);
+
+		THEN("the old size and tiles should be restored")
+			SHOULD_INT_EQUAL((int)er, (int)EDITOR_RESULT_CHANGED_AND_RELOAD);
+			SHOULD_INT_EQUAL(m.Size.x, WIDTH);
+			SHOULD_INT_EQUAL(m.Size.y, HEIGHT);
+			SHOULD_INT_EQUAL((int)m.u.Static.Tiles.size, WIDTH * HEIGHT);
+			SHOULD_INT_EQUAL(*TileAt(&m, 7, 5), 4);
+		AND("redo should restore the new size and tiles")
+			EditorUndoRedo(&u, &m, &r);
+			SHOULD_INT_EQUAL(m.Size.x, WIDTH + 2);
+			SHOULD_INT_EQUAL(*TileAt(&m, 9, 6), 5);
+
+		EditorUndoTerminate(&u);
+		MissionTerminate(&m);
+	SCENARIO_END
+FEATURE_END
+
+FEATURE(editor_undo_budget, "Undo memory budget")
+	SCENARIO("Drop the oldest steps")
+		GIVEN("a history with room for only a few steps")
+			Mission m;
+			StaticMissionInit(&m, svec2i(WIDTH, HEIGHT));
+			EditorUndo u;
+			EditorUndoInit(&u, 3 * (sizeof(EditorUndoStep) + 2 * sizeof(uint16_t)));
+			EditorUndoReset(&u, &m);
+
+		WHEN("I commit more single-tile changes than fit")
+			for (int i = 0; i < WIDTH; i++)
+			{
+				*TileAt(&m, i, 0) = 1;
+				EditorUndoCommit(&u, &m);
+			}
+
+		THEN("only the latest steps should be kept, within budget")
+			SHOULD_INT_EQUAL((int)u.Steps.size, 3);
+			SHOULD_INT_EQUAL(u.Index, 3);
+			SHOULD_BE_TRUE(u.Size <= u.MaxSize);
+		AND("undoing everything should only undo the latest changes")
+			Rect2i r;
+			int undos = 0;
+			while (EditorUndoUndo(&u, &m, &r) != EDITOR_RESULT_NONE)
+			{
+				undos++;
+			}
+			SHOULD_INT_EQUAL(undos, 3);
+			SHOULD_INT_EQUAL(*TileAt(&m, WIDTH - 4, 0), 1);
+			SHOULD_INT_EQUAL(*TileAt(&m, WIDTH - 3, 0), 0);
+
+		EditorUndoTerminate(&u);
+		MissionTerminate(&m);
+	SCENARIO_END
+FEATURE_END
+
+CBEHAVE_RUN(
+	"Editor undo features are:",
+	TEST_FEATURE(editor_undo_tiles),
+	TEST_FEATURE(editor_undo_mission),
+	TEST_FEATURE(editor_undo_budget)
+)
@@ -0,0 +1,166 @@
+#define SDL_MAIN_HANDLED
+#include <cbehave/cbehave.h>
+
+#include <map_archive.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <json/json.h>
+
+// Stubs
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+
+
+#define ARCHIVE "map_archive_test.cdogscpn"
+
+static void StaticMissionInit(
+	Mission *m, const char *title, const struct vec2i size)
+{
+	MissionInit(m);
+	CSTRDUP(m->Title, title);
+	CSTRDUP(m->Description, "");
+	m->Type = MAPTYPE_STATIC;
+	m->Size = size;
+	CArrayInit(&m->u.Static.Tiles, sizeof(uint16_t));
+	for (int i = 0; i < size.x * size.y; i++)
+	{
+		// Mix tiles of different widths
+		const uint16_t t = (uint16_t)(i * 4099);
+		CArrayPushBack(&m->u.Static.Tiles, &t);
+	}
+	CArrayInit(&m->u.Static.Items, sizeof(MapObjectPositions));
+	CArrayInit(&m->u.Static.Characters, sizeof(CharacterPositions));
+	CArrayInit(&m->u.Static.Objectives, sizeof(ObjectivePositions));
+	CArrayInit(&m->u.Static.Keys, sizeof(KeyPositions));
+}
+static void ClassicMissionInit(Mission *m, const char *title)
+{
+	MissionInit(m);
+	CSTRDUP(m->Title, title);
+	CSTRDUP(m->Description, "A \"quoted\"\nmission");
+	m->Type = MAPTYPE_CLASSIC;
+	m->Size = svec2i(32, 32);
+}
+
+static char *ReadFile(const char *path)
+{
+	FILE *f = fopen(path, "r");
+	if (f == NULL) return NULL;
+	char *data = NULL;
+	size_t len = 0;
+	char buf[4096];
+	size_t n;
+	while ((n = fread(buf, 1, sizeof buf, f)) > 0)
+	{
+		CREALLOC(data, len + n + 1);
+		memcpy(data + len, buf, n);
+		len += n;
+	}
+	fclose(f);
+	if (data != NULL) data[len] = '\0';
+	return data;
+}
+
+// Tiles as they were saved before being streamed: a json array of CSV rows
+static json_t *SaveStaticTiles(const Mission *m)
+{
+	json_t *rows = json_new_array();
+	char *rowBuf;
+	CMALLOC(rowBuf, m->Size.x * 6);
+	for (int i = 0; i < m->Size.y; i++)
+	{
+		char *pBuf = rowBuf;
+		*pBuf = '\0';
+		for (int j = 0; j < m->Size.x; j++)
+		{
+			char buf[32];
+			sprintf(buf, "%d", *(const uint16_t *)CArrayGet(
+				&m->u.Static.Tiles, i * m->Size.x + j));
+			strcpy(pBuf, buf);
+			pBuf += strlen(buf);
+			if (j < m->Size.x - 1)
+			{
+				*pBuf++ = ',';
+			}
+		}
+		json_insert_child(rows, json_new_string(rowBuf));
+	}
+	CFREE(rowBuf);
+	return rows;
+}
+// Format the missions the way the whole json tree used to be formatted,
+// but with the tiles rebuilt from the missions themselves
+static char *FormatMissionsTree(const char *saved, const CampaignSetting *c)
+{
+	json_t *root = NULL;
+	if (json_parse_document(&root, saved) != JSON_OK)
+	{
+		return NULL;
+	}
+	const json_t *missions = json_find_first_label(root, "Missions")->child;
+	const json_t *missionNode = missions->child;
+	CA_FOREACH(const Mission, m, c->Missions)
+		json_t *tiles = json_find_first_label(missionNode, "Tiles");
+		if (m->Type == MAPTYPE_STATIC)
+		{
+			json_free_value(&tiles->child);
+			json_insert_child(tiles, SaveStaticTiles(m));
+		}
+		missionNode = missionNode->next;
+	CA_FOREACH_END()
+	char *text;
+	json_tree_to_string(root, &text);
+	char *ftext = json_format_string(text);
+	CFREE(text);
+	json_free_value(&root);
+	return ftext;
+}
+
+
+FEATURE(map_archive_save, "Save map archives")
+	SCENARIO("Save static missions")
+		GIVEN("a campaign with static and classic missions")
+			CampaignSetting c;
+			CampaignSettingInit(&c);
+			CSTRDUP(c.Title, "test");
+			CSTRDUP(c.Author, "test");
+			CSTRDUP(c.Description, "test");
+			Mission m;
+			StaticMissionInit(&m, "static", svec2i(7, 5));
+			CArrayPushBack(&c.Missions, &m);
+			ClassicMissionInit(&m, "classic");
+			CArrayPushBack(&c.Missions, &m);
+			StaticMissionInit(&m, "narrow", svec2i(1, 3));
+			CArrayPushBack(&c.Missions, &m);
+
+		WHEN("I save it")
+			const int res = MapArchiveSave(ARCHIVE, &c);
+
+		THEN("the save should succeed")
+			SHOULD_INT_EQUAL(res, 1);
+		AND("the missions should be the same as formatting the whole tree")
+			char *saved = ReadFile(ARCHIVE "/missions.json");
+			SHOULD_BE_TRUE(saved != NULL);
+			char *formatted = FormatMissionsTree(saved, &c);
+			SHOULD_BE_TRUE(formatted != NULL);
+			SHOULD_STR_EQUAL(saved, formatted);
+			CFREE(saved);
+			CFREE(formatted);
+
+		remove(ARCHIVE "/campaign.json");
+		remove(ARCHIVE "/missions.json");
+		remove(ARCHIVE "/characters.json");
+		remove(ARCHIVE);
+		CampaignSettingTerminate(&c);
+	SCENARIO_END
+FEATURE_END
+
+CBEHAVE_RUN(
+	"Map archive features are:",
+	TEST_FEATURE(map_archive_save)
+)
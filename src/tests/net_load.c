@@ -0,0 +1,540 @@
+// Network load generator
+// Connects headless bot clients to a server on this machine, adding them in
+// steps, and reports per-client bandwidth, round trip time, an estimate of
+// the server's tick time (the interval between bursts of server updates, as
+// seen by clients) and how long the server takes to echo each bot's moves,
+// which grows with its event backlog.
+//
+// Either start a dedicated server as a child process, which is stopped at
+// the end, e.g.
+//   net_load --server=cdogs-sdl --campaign=missions/ogre.cdogscpn
+//     --clients=32 --step=4 --seconds=10 --latency=50 --loss=1
+// or start a server yourself and let this find it on localhost.
+// Exits with failure if any bot cannot connect or join, so that a short run
+// can be used as a smoke test.
+// Options:
+//   --server=PATH        Start the game at PATH as a dedicated server
+//   --campaign=F         Campaign for the started server to host
+//   --connect=host:port  Server address; otherwise scan localhost
+//   --clients=N          Maximum number of bots (default 16)
+//   --step=N             Bots added per step (default 4)
+//   --seconds=S          Duration of each step (default 5)
+//   --latency=MS         Delay added to each message, each way (default 0)
+//   --jitter=MS          Random variation of the delay (default 0)
+//   --loss=P             Percent of received datagrams dropped (default 0)
+//   --csv=F              Also write the report to file F
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <process.h>
+#include <windows.h>
+#else
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <SDL_timer.h>
+
+#include <log.h>
+#include <net_client.h>
+#include <player.h>
+#include <utils.h>
+
+
+// How often bots change direction and send a move
+#define MOVE_INTERVAL_MS 100
+#define MOVE_SPEED 1.0f
+// Moves awaiting their echo are tracked in a ring
+#define MOVES_TRACKED 256
+
+typedef struct
+{
+	int Clients;
+	int Step;
+	int Seconds;
+	int LatencyMs;
+	int JitterMs;
+	float LossPercent;
+	const char *CSV;
+	const char *Connect;
+	char *Server;
+	char *Campaign;
+} Options;
+static Options sOptions = { 16, 4, 5, 0, 0, 0, NULL, NULL, NULL, NULL };
+
+typedef struct
+{
+	ENetPacket *Packet;
+	GameEventType Type;
+	Uint32 Due;
+} Delayed;
+
+typedef struct
+{
+	NetClient Client;
+	int Id;
+	int PlayerUID;
+	int ActorUID;
+	struct vec2 Pos;
+	struct vec2 Vel;
+	Uint32 LastMove;
+	uint32_t Seq;
+	uint32_t LastEchoSeq;
+	Uint32 MoveTicks[MOVES_TRACKED];
+	// Messages held back to simulate latency, in order
+	CArray Recv;	// of Delayed
+	CArray Send;	// of Delayed
+	Uint32 LastRecvDue;
+	Uint32 LastSendDue;
+	// Counters for the current step
+	Uint64 BytesSent;
+	Uint64 BytesRecv;
+	int MsgsRecv;
+	Uint32 LastArrival;
+	Uint32 ArrivalGaps;
+	int Arrivals;
+	Uint32 EchoTotal;
+	Uint32 EchoMax;
+	int Echoes;
+} Bot;
+
+
+static Uint32 DelayMs(Uint32 *lastDue)
+{
+	int delay = sOptions.LatencyMs;
+	if (sOptions.JitterMs > 0)
+	{
+		delay += rand() % (2 * sOptions.JitterMs + 1) - sOptions.JitterMs;
+	}
+	// Keep messages in order, as they are on a reliable channel
+	const Uint32 due = MAX(SDL_GetTicks() + MAX(delay, 0), *lastDue);
+	*lastDue = due;
+	return due;
+}
+
+static int DropIntercept(ENetHost *host, ENetEvent *event)
+{
+	UNUSED(host);
+	UNUSED(event);
+	return rand() % 10000 < (int)(sOptions.LossPercent * 100) ? 1 : 0;
+}
+
+static void BotRecv(void *data, const GameEventType e, ENetPacket *packet)
+{
+	Bot *b = data;
+	// Server updates arrive in a burst each server tick
+	const Uint32 now = SDL_GetTicks();
+	if (now != b->LastArrival)
+	{
+		if (b->LastArrival != 0)
+		{
+			b->ArrivalGaps += now - b->LastArrival;
+			b->Arrivals++;
+		}
+		b->LastArrival = now;
+	}
+	Delayed d = { packet, e, DelayMs(&b->LastRecvDue) };
+	CArrayPushBack(&b->Recv, &d);
+}
+
+static void BotSend(Bot *b, const GameEventType e, const void *data)
+{
+	Delayed d = { NetEncode(e, data), e, DelayMs(&b->LastSendDue) };
+	CArrayPushBack(&b->Send, &d);
+}
+
+static void BotJoin(Bot *b)
+{
+	NPlayerData pd = NPlayerData_init_default;
+	sprintf(pd.Name, "Bot %d", b->Id);
+	strcpy(pd.CharacterClass, "Jones");
+	pd.Weapons_count = MAX_WEAPONS;
+	strcpy(pd.Weapons[0], "Machine gun");
+	pd.MaxHealth = 200;
+	pd.UID = b->PlayerUID;
+	BotSend(b, GAME_EVENT_PLAYER_DATA, &pd);
+	BotSend(b, GAME_EVENT_CLIENT_READY, NULL);
+}
+
+static void BotHandle(Bot *b, const Delayed *d)
+{
+	b->BytesRecv += d->Packet->dataLength;
+	b->MsgsRecv++;
+	switch (d->Type)
+	{
+	case GAME_EVENT_CLIENT_ID:
+		{
+			NClientId cid;
+			if (NetDecode(d->Packet, &cid, NClientId_fields))
+			{
+				b->PlayerUID = (int)cid.FirstPlayerUID;
+				BotJoin(b);
+			}
+		}
+		break;
+	case GAME_EVENT_ACTOR_ADD:
+		{
+			NActorAdd aa = NActorAdd_init_default;
+			if (NetDecode(d->Packet, &aa, NActorAdd_fields) &&
+				aa.PlayerUID == b->PlayerUID)
+			{
+				b->ActorUID = (int)aa.UID;
+				b->Pos = NetToVec2(aa.Pos);
+			}
+		}
+		break;
+	case GAME_EVENT_ACTOR_MOVE:
+		{
+			// The server echoes our moves once it has processed them
+			NActorMove am = NActorMove_init_default;
+			if (NetDecode(d->Packet, &am, NActorMove_fields) &&
+				(int)am.UID == b->ActorUID && am.Seq > b->LastEchoSeq &&
+				b->Seq - am.Seq < MOVES_TRACKED)
+			{
+				const Uint32 echo =
+					SDL_GetTicks() - b->MoveTicks[am.Seq % MOVES_TRACKED];
+				b->EchoTotal += echo;
+				b->EchoMax = MAX(b->EchoMax, echo);
+				b->Echoes++;
+				b->LastEchoSeq = am.Seq;
+			}
+		}
+		break;
+	default:
+		break;
+	}
+	enet_packet_destroy(d->Packet);
+}
+
+static void BotMove(Bot *b, const Uint32 now)
+{
+	if (b->ActorUID < 0 || now - b->LastMove < MOVE_INTERVAL_MS) return;
+	b->Pos = svec2_add(
+		b->Pos, svec2_scale(b->Vel, (now - b->LastMove) * 0.06f));
+	b->LastMove = now;
+	const float a = (float)rand() / RAND_MAX * 2 * MPI;
+	b->Vel = svec2(cosf(a) * MOVE_SPEED, sinf(a) * MOVE_SPEED);
+	b->Seq++;
+	b->MoveTicks[b->Seq % MOVES_TRACKED] = now;
+	NActorMove am = NActorMove_init_default;
+	am.UID = b->ActorUID;
+	am.Pos = Vec2ToNet(b->Pos);
+	am.MoveVel = Vec2ToNet(b->Vel);
+	am.Seq = b->Seq;
+	BotSend(b, GAME_EVENT_ACTOR_MOVE, &am);
+}
+
+static void BotUpdate(Bot *b, const Uint32 now)
+{
+	NetClientPoll(&b->Client);
+	while (b->Recv.size > 0)
+	{
+		const Delayed *d = CArrayGet(&b->Recv, 0);
+		if (d->Due > now) break;
+		BotHandle(b, d);
+		CArrayDelete(&b->Recv, 0);
+	}
+	BotMove(b, now);
+	while (b->Send.size > 0)
+	{
+		const Delayed *d = CArrayGet(&b->Send, 0);
+		if (d->Due > now) break;
+		if (NetClientIsConnected(&b->Client))
+		{
+			b->BytesSent += d->Packet->dataLength;
+			enet_peer_send(b->Client.peer, NET_CHANNEL_GAME, d->Packet);
+		}
+		else
+		{
+			enet_packet_destroy(d->Packet);
+		}
+		CArrayDelete(&b->Send, 0);
+	}
+	NetClientFlush(&b->Client);
+}
+
+static bool BotConnect(Bot *b, const int id, const ENetAddress addr)
+{
+	memset(b, 0, sizeof *b);
+	b->Id = id;
+	b->PlayerUID = -1;
+	b->ActorUID = -1;
+	CArrayInit(&b->Recv, sizeof(Delayed));
+	CArrayInit(&b->Send, sizeof(Delayed));
+	NetClientInit(&b->Client);
+	b->Client.RecvFunc = BotRecv;
+	b->Client.RecvData = b;
+	if (b->Client.client == NULL) return false;
+	b->Client.client->intercept = DropIntercept;
+	return NetClientTryConnect(&b->Client, addr);
+}
+
+static void BotTerminate(Bot *b)
+{
+	CA_FOREACH(const Delayed, d, b->Recv)
+		enet_packet_destroy(d->Packet);
+	CA_FOREACH_END()
+	CA_FOREACH(const Delayed, d, b->Send)
+		enet_packet_destroy(d->Packet);
+	CA_FOREACH_END()
+	CArrayTerminate(&b->Recv);
+	CArrayTerminate(&b->Send);
+	NetClientTerminate(&b->Client);
+}
+
+static void BotResetCounters(Bot *b)
+{
+	b->BytesSent = 0;
+	b->BytesRecv = 0;
+	b->MsgsRecv = 0;
+	b->ArrivalGaps = 0;
+	b->Arrivals = 0;
+	b->EchoTotal = 0;
+	b->EchoMax = 0;
+	b->Echoes = 0;
+}
+
+// Returns the number of bots that have joined
+static int Report(FILE *csv, const Bot *bots, const int n)
+{
+	double sent = 0, recv = 0, msgs = 0, rtt = 0, gap = 0, echo = 0;
+	Uint32 echoMax = 0;
+	int joined = 0, arrivals = 0, echoes = 0, backlog = 0;
+	for (int i = 0; i < n; i++)
+	{
+		const Bot *b = &bots[i];
+		sent += b->BytesSent;
+		recv += b->BytesRecv;
+		msgs += b->MsgsRecv;
+		if (b->Client.peer != NULL) rtt += b->Client.peer->roundTripTime;
+		gap += b->ArrivalGaps;
+		arrivals += b->Arrivals;
+		echo += b->EchoTotal;
+		echoes += b->Echoes;
+		echoMax = MAX(echoMax, b->EchoMax);
+		if (b->ActorUID >= 0) joined++;
+		backlog += (int)(b->Seq - b->LastEchoSeq);
+	}
+	const double perClientSec = (double)n * sOptions.Seconds;
+	const double values[] = {
+		sent / perClientSec, recv / perClientSec, msgs / perClientSec,
+		rtt / n, arrivals > 0 ? gap / arrivals : 0,
+		echoes > 0 ? echo / echoes : 0
+	};
+	printf("%7d %6d %10.0f %10.0f %8.1f %7.1f %8.1f %8.1f %8u %8d\n",
+		n, joined, values[0], values[1], values[2], values[3], values[4],
+		values[5], (unsigned)echoMax, backlog);
+	if (csv != NULL)
+	{
+		fprintf(csv, "%d,%d,%.0f,%.0f,%.1f,%.1f,%.1f,%.1f,%u,%d\n", n, joined, values[0], values[1], values[2],
+			values[3], values[4], values[5], (unsigned)echoMax, backlog);
+		fflush(csv);
+	}
+	return joined;
+}
+
+static void Run(Bot *bots, const int n, const Uint32 ms)
+{
+	const Uint32 end = SDL_GetTicks() + ms;
+	for (;;)
+	{
+		const Uint32 now = SDL_GetTicks();
+		if (now >= end) break;
+		for (int i = 0; i < n; i++)
+		{
+			BotUpdate(&bots[i], now);
+		}
+		SDL_Delay(1);
+	}
+}
+
+// Dedicated server started by us, if any
+#ifdef _WIN32
+static intptr_t sServer = -1;
+#else
+static pid_t sServer = -1;
+#endif
+static bool StartServer(void)
+{
+	if (sOptions.Server == NULL) return true;
+	if (sOptions.Campaign == NULL)
+	{
+		fprintf(stderr, "--server needs a --campaign to host\n");
+		return false;
+	}
+	char *args[] = {
+		sOptions.Server, "--dedicated", "--log=WARN", sOptions.Campaign, NULL
+	};
+#ifdef _WIN32
+	sServer = _spawnv(
+		_P_NOWAIT, sOptions.Server, (const char *const *)args);
+#else
+	sServer = fork();
+	if (sServer == 0)
+	{
+		execv(sOptions.Server, args);
+		fprintf(stderr, "Cannot start server %s\n", sOptions.Server);
+		_exit(EXIT_FAILURE);
+	}
+#endif
+	if (sServer == -1)
+	{
+		fprintf(stderr, "Cannot start server %s\n", sOptions.Server);
+		return false;
+	}
+	return true;
+}
+static void StopServer(void)
+{
+	if (sServer == -1) return;
+#ifdef _WIN32
+	TerminateProcess((HANDLE)sServer, 0);
+	_cwait(NULL, sServer, 0);
+#else
+	kill(sServer, SIGTERM);
+	waitpid(sServer, NULL, 0);
+#endif
+	sServer = -1;
+}
+
+static bool FindServer(ENetAddress *addr)
+{
+	if (sOptions.Connect != NULL)
+	{
+		char host[256];
+		strncpy(host, sOptions.Connect, sizeof host - 1);
+		host[sizeof host - 1] = '\0';
+		char *port = strchr(host, ':');
+		if (port == NULL)
+		{
+			fprintf(stderr, "Address must be host:port\n");
+			return false;
+		}
+		*port = '\0';
+		addr->port = (enet_uint16)atoi(port + 1);
+		return enet_address_set_host(addr, host) == 0;
+	}
+	// Scan localhost, in case the server is still starting up
+	for (int i = 0; i < 10; i++)
+	{
+		NetClient scanner;
+		NetClientInit(&scanner);
+		const bool found = NetClientTryScanAndConnect(
+			&scanner, ENET_HOST_TO_NET_32(0x7F000001));
+		if (found)
+		{
+			*addr = scanner.peer->address;
+		}
+		NetClientTerminate(&scanner);
+		if (found) return true;
+		SDL_Delay(1000);
+	}
+	fprintf(stderr, "No server found on localhost\n");
+	return false;
+}
+
+static void ParseArgs(const int argc, char *argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		char *v = strchr(argv[i], '=');
+		if (v == NULL) continue;
+		v++;
+#define ARG(_name) strncmp(argv[i], "--" _name "=", strlen("--" _name "=")) == 0
+		if (ARG("connect")) sOptions.Connect = v;
+		else if (ARG("server")) sOptions.Server = v;
+		else if (ARG("campaign")) sOptions.Campaign = v;
+		else if (ARG("clients")) sOptions.Clients = MAX(atoi(v), 1);
+		else if (ARG("step")) sOptions.Step = MAX(atoi(v), 1);
+		else if (ARG("seconds")) sOptions.Seconds = MAX(atoi(v), 1);
+		else if (ARG("latency")) sOptions.LatencyMs = atoi(v);
+		else if (ARG("jitter")) sOptions.JitterMs = atoi(v);
+		else if (ARG("loss")) sOptions.LossPercent = (float)atof(v);
+		else if (ARG("csv")) sOptions.CSV = v;
+#undef ARG
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	ParseArgs(argc, argv);
+	LogInit();
+	LogModuleSetLevel(LM_NET, LL_WARN);
+	if (enet_initialize() != 0)
+	{
+		fprintf(stderr, "An error occurred while initializing ENet\n");
+		return EXIT_FAILURE;
+	}
+	int res = EXIT_FAILURE;
+	FILE *csv = NULL;
+	Bot *bots = NULL;
+	int n = 0;
+	ENetAddress addr;
+	if (!StartServer() || !FindServer(&addr))
+	{
+		goto bail;
+	}
+	if (sOptions.CSV != NULL)
+	{
+		csv = fopen(sOptions.CSV, "w");
+		if (csv != NULL)
+		{
+			fprintf(csv,
+				"clients,joined,sent_bps,recv_bps,recv_msgs_ps,rtt_ms,"
+				"tick_est_ms,echo_ms,echo_max_ms,backlog\n");
+		}
+	}
+	printf("latency %dms jitter %dms loss %.1f%%\n",
+		sOptions.LatencyMs, sOptions.JitterMs, sOptions.LossPercent);
+	printf("%7s %6s %10s %10s %8s %7s %8s %8s %8s %8s\n",
+		"clients", "joined", "sent B/s", "recv B/s", "msgs/s", "rtt",
+		"tick est", "echo ms", "echo max", "backlog");
+
+	CCALLOC(bots, sOptions.Clients * sizeof *bots);
+	res = EXIT_SUCCESS;
+	while (n < sOptions.Clients)
+	{
+		const int target = MIN(n + sOptions.Step, sOptions.Clients);
+		for (; n < target; n++)
+		{
+			if (!BotConnect(&bots[n], n, addr))
+			{
+				fprintf(stderr, "Bot %d failed to connect\n", n);
+				BotTerminate(&bots[n]);
+				res = EXIT_FAILURE;
+				goto bail;
+			}
+		}
+		// Let the new bots join before measuring
+		Run(bots, n, 1000);
+		for (int i = 0; i < n; i++)
+		{
+			BotResetCounters(&bots[i]);
+		}
+		Run(bots, n, sOptions.Seconds * 1000);
+		if (Report(csv, bots, n) < n)
+		{
+			fprintf(stderr, "Not all bots joined\n");
+			res = EXIT_FAILURE;
+		}
+	}
+
+bail:
+	for (int i = 0; i < n; i++)
+	{
+		BotTerminate(&bots[i]);
+	}
+	CFREE(bots);
+	if (csv != NULL)
+	{
+		fclose(csv);
+	}
+	StopServer();
+	enet_deinitialize();
+	LogTerminate();
+	return res;
+}
@@ -0,0 +1,179 @@
+#include <cbehave/cbehave.h>
+
+#include <string.h>
+
+#include <net_predict.h>
+
+
+// Loopback simulation of one player moving along x, with messages between
+// client and server delayed by LATENCY ticks each way.
+// The server simulates the player from its last received move, and every
+// CORRECT_INTERVAL ticks sends the client its position (as with actor
+// impulses), optionally shoving the player first.
+#define LATENCY 6
+#define SIM_TICKS 600
+#define CORRECT_INTERVAL 10
+#define WALL_X 200.0f
+
+typedef struct
+{
+	int Due;
+	uint32_t Seq;
+	int Ticks;
+	struct vec2 Pos;
+	struct vec2 Vel;
+} Msg;
+
+#define QUEUE_SIZE 64
+typedef struct
+{
+	Msg Msgs[QUEUE_SIZE];
+	int Count;
+} Queue;
+static void QueuePush(Queue *q, const Msg m)
+{
+	q->Msgs[q->Count++] = m;
+}
+static bool QueuePop(Queue *q, const int now, Msg *m)
+{
+	if (q->Count == 0 || q->Msgs[0].Due > now) return false;
+	*m = q->Msgs[0];
+	q->Count--;
+	memmove(q->Msgs, q->Msgs + 1, q->Count * sizeof *m);
+	return true;
+}
+
+static struct vec2 Move(
+	void *data, const struct vec2 from, const struct vec2 delta)
+{
+	(void)data;
+	struct vec2 to = svec2_add(from, delta);
+	if (to.x > WALL_X) to.x = WALL_X;
+	return to;
+}
+
+// Returns the total magnitude of corrections applied on the client
+static float Simulate(const bool predict, const float shove, const int hold)
+{
+	NetPredict p;
+	NetPredictInit(&p, 0);
+	Queue toServer, toClient;
+	memset(&toServer, 0, sizeof toServer);
+	memset(&toClient, 0, sizeof toClient);
+	struct vec2 clientPos = svec2_zero();
+	struct vec2 serverPos = svec2_zero();
+	struct vec2 serverVel = svec2_zero();
+	uint32_t seq = 0;
+	uint32_t serverSeq = 0;
+	int serverTicks = 0;
+	float total = 0;
+	for (int t = 0; t < SIM_TICKS; t++)
+	{
+		// Client: change direction every hold ticks and send the move
+		const struct vec2 vel =
+			svec2((t / hold) % 3 == 2 ? -1.0f : 1.0f, 0);
+		if (t % hold == 0)
+		{
+			seq++;
+			const Msg m = { t + LATENCY, seq, 0, clientPos, vel };
+			QueuePush(&toServer, m);
+		}
+		Msg m;
+		while (QueuePop(&toClient, t, &m))
+		{
+			const struct vec2 corrected = predict ?
+				NetPredictReconcile(
+					&p, m.Seq, m.Ticks, m.Pos, clientPos, Move, NULL) :
+				m.Pos;
+			total += svec2_distance(corrected, clientPos);
+			clientPos = corrected;
+		}
+		NetPredictRecord(&p, seq, 1, clientPos, vel);
+		clientPos = Move(NULL, clientPos, vel);
+
+		// Server: process moves, simulate, send corrections
+		while (QueuePop(&toServer, t, &m))
+		{
+			serverPos = m.Pos;
+			serverVel = m.Vel;
+			serverSeq = m.Seq;
+			serverTicks = 0;
+		}
+		serverPos = Move(NULL, serverPos, serverVel);
+		serverTicks++;
+		if (t % CORRECT_INTERVAL == CORRECT_INTERVAL - 1)
+		{
+			serverPos.y += shove;
+			const Msg c = {
+				t + LATENCY, serverSeq, serverTicks, serverPos, svec2_zero()
+			};
+			QueuePush(&toClient, c);
+		}
+	}
+	return total;
+}
+
+
+FEATURE(net_predict_reconcile, "Reconcile predicted movement")
+	SCENARIO("Server agrees with the prediction")
+		GIVEN("a client moving with latency")
+		WHEN("the server sends its positions without changing them")
+			const float naive = Simulate(false, 0, 50);
+			const float predicted = Simulate(true, 0, 50);
+
+		THEN("snapping to the server's position causes corrections")
+			SHOULD_BE_TRUE(naive > 100.0f);
+		AND("prediction causes no corrections")
+			SHOULD_BE_TRUE(predicted < NET_PREDICT_EPSILON);
+	SCENARIO_END
+
+	SCENARIO("Server moves the player")
+		GIVEN("a client moving with latency")
+		WHEN("the server shoves the player before sending positions")
+			const float naive = Simulate(false, 1.0f, 50);
+			const float predicted = Simulate(true, 1.0f, 50);
+
+		THEN("prediction only corrects by the shoves")
+			SHOULD_BE_TRUE(predicted < 1.01f * SIM_TICKS / CORRECT_INTERVAL);
+		AND("prediction corrects much less than snapping")
+			SHOULD_BE_TRUE(predicted * 2 < naive);
+	SCENARIO_END
+
+	SCENARIO("Hold an input for longer than the history")
+		GIVEN("a client moving with latency")
+		WHEN("each input is held for longer than the history keeps")
+			const float predicted =
+				Simulate(true, 0, NET_PREDICT_HISTORY * 2 + 10);
+
+		THEN("prediction causes no corrections")
+			SHOULD_BE_TRUE(predicted < NET_PREDICT_EPSILON);
+	SCENARIO_END
+FEATURE_END
+
+FEATURE(net_predict_ack, "Acknowledge predicted movement")
+	SCENARIO("Acknowledge an input")
+		GIVEN("a prediction history with several inputs")
+			NetPredict p;
+			NetPredictInit(&p, 0);
+			for (uint32_t seq = 1; seq <= 3; seq++)
+			{
+				for (int i = 0; i < 4; i++)
+				{
+					NetPredictRecord(&p, seq, 1, svec2_zero(), svec2(1, 0));
+				}
+			}
+
+		WHEN("the server acknowledges the second input")
+			NetPredictAck(&p, 2);
+
+		THEN("the frames of the first input should be dropped")
+			SHOULD_INT_EQUAL(p.Count, 8);
+			SHOULD_INT_EQUAL((int)p.Frames[p.Start].Seq, 2);
+	SCENARIO_END
+FEATURE_END
+
+CBEHAVE_RUN(
+	"Net prediction features are:",
+	TEST_FEATURE(net_predict_reconcile),
+	TEST_FEATURE(net_predict_ack)
+)
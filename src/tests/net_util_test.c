@@ -0,0 +1,133 @@
+#define SDL_MAIN_HANDLED
+#include <cbehave/cbehave.h>
+
+#include <net_util.h>
+
+#include <string.h>
+
+// Stubs
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+
+
+#define POOL_LOOPS 100
+
+FEATURE(net_packet_pool, "Packet pool")
+	SCENARIO("Encode and destroy packets")
+		GIVEN("a packet that has been encoded and destroyed")
+			NClientId msg = NClientId_init_default;
+			msg.Id = 1;
+			ENetPacket *packet = NetEncode(GAME_EVENT_CLIENT_ID, &msg);
+			const uint8_t *data = packet->data;
+			enet_packet_destroy(packet);
+			const int allocs = NetPacketPoolAllocs();
+
+		WHEN("I encode and destroy packets of the same size in a loop")
+			int reused = 0;
+			for (int i = 0; i < POOL_LOOPS; i++)
+			{
+				packet = NetEncode(GAME_EVENT_CLIENT_ID, &msg);
+				if (packet->data == data) reused++;
+				enet_packet_destroy(packet);
+			}
+
+		THEN("every packet should reuse the pooled buffer")
+			SHOULD_INT_EQUAL(reused, POOL_LOOPS);
+		AND("no more buffers should be allocated")
+			SHOULD_INT_EQUAL(NetPacketPoolAllocs(), allocs);
+
+		NetPacketPoolTerminate();
+	SCENARIO_END
+FEATURE_END
+
+FEATURE(net_decode, "Decode packets")
+	SCENARIO("Decode an encoded packet")
+		GIVEN("an encoded message")
+			NClientId msg = NClientId_init_default;
+			msg.Id = 123456;
+			msg.FirstPlayerUID = 7;
+			ENetPacket *packet = NetEncode(GAME_EVENT_CLIENT_ID, &msg);
+
+		WHEN("I decode it")
+			GameEventType e;
+			const bool typeOk = NetDecodeType(packet, &e);
+			NClientId out = NClientId_init_default;
+			const bool ok = NetDecode(packet, &out, NClientId_fields);
+
+		THEN("the type and message should be the same")
+			SHOULD_BE_TRUE(typeOk);
+			SHOULD_INT_EQUAL(e, GAME_EVENT_CLIENT_ID);
+			SHOULD_BE_TRUE(ok);
+			SHOULD_INT_EQUAL(out.Id, msg.Id);
+			SHOULD_INT_EQUAL(out.FirstPlayerUID, msg.FirstPlayerUID);
+
+		enet_packet_destroy(packet);
+		NetPacketPoolTerminate();
+	SCENARIO_END
+
+	SCENARIO("Reject packets shorter than the message type")
+		GIVEN("a packet with only part of the message type")
+			ENetPacket *packet = NetEncode(GAME_EVENT_CLIENT_ID, NULL);
+			const size_t length = packet->dataLength;
+			packet->dataLength = NET_MSG_SIZE - 1;
+
+		WHEN("I decode it")
+			GameEventType e;
+			const bool typeOk = NetDecodeType(packet, &e);
+			NClientId out = NClientId_init_default;
+			const bool ok = NetDecode(packet, &out, NClientId_fields);
+
+		THEN("the type and message should be rejected")
+			SHOULD_BE_FALSE(typeOk);
+			SHOULD_BE_FALSE(ok);
+
+		packet->dataLength = length;
+		enet_packet_destroy(packet);
+		NetPacketPoolTerminate();
+	SCENARIO_END
+
+	SCENARIO("Reject unknown message types")
+		GIVEN("a packet with a message type past the last event")
+			ENetPacket *packet = NetEncode(GAME_EVENT_CLIENT_ID, NULL);
+			const uint32_t msgId = (uint32_t)GAME_EVENT_MISSION_END + 1;
+			memcpy(packet->data, &msgId, NET_MSG_SIZE);
+
+		WHEN("I decode its type")
+			GameEventType e;
+			const bool typeOk = NetDecodeType(packet, &e);
+
+		THEN("it should be rejected")
+			SHOULD_BE_FALSE(typeOk);
+
+		enet_packet_destroy(packet);
+		NetPacketPoolTerminate();
+	SCENARIO_END
+
+	SCENARIO("Reject truncated messages")
+		GIVEN("an encoded message missing its last byte")
+			NClientId msg = NClientId_init_default;
+			msg.Id = 123456;
+			ENetPacket *packet = NetEncode(GAME_EVENT_CLIENT_ID, &msg);
+			packet->dataLength--;
+
+		WHEN("I decode it")
+			NClientId out = NClientId_init_default;
+			const bool ok = NetDecode(packet, &out, NClientId_fields);
+
+		THEN("it should be rejected")
+			SHOULD_BE_FALSE(ok);
+
+		packet->dataLength++;
+		enet_packet_destroy(packet);
+		NetPacketPoolTerminate();
+	SCENARIO_END
+FEATURE_END
+
+CBEHAVE_RUN(
+	"Net util features are:",
+	TEST_FEATURE(net_packet_pool),
+	TEST_FEATURE(net_decode)
+)